@@ -362,6 +362,17 @@ namespace mge {
         return m_access->data();
     }
 
+    mge::mapped_region_ref asset::map() const
+    {
+        if (!m_access) {
+            if (!resolve()) {
+                MGE_THROW(asset_not_found)
+                    << "Asset not found: " << m_path.string();
+            }
+        }
+        return m_access->map();
+    }
+
     mge::output_stream_ref asset::output_stream() const
     {
         if (!m_access) {
@@ -7,6 +7,7 @@
 #include "mge/asset/asset_source.hpp"
 #include "mge/asset/asset_type.hpp"
 #include "mge/asset/dllexport.hpp"
+#include "mge/asset/mapped_region.hpp"
 #include "mge/core/gist.hpp"
 #include "mge/core/input_stream.hpp"
 #include "mge/core/path.hpp"
@@ -145,6 +146,18 @@ namespace mge {
          */
         mge::input_stream_ref data() const;
 
+        /**
+         * Get the asset data mapped into memory.
+         *
+         * Loaders should prefer this over @c data() to parse the asset
+         * in place, and fall back to the stream if it returns
+         * @c nullptr.
+         *
+         * @return read-only view of the data, @c nullptr if the asset
+         *  source does not support mapping
+         */
+        mge::mapped_region_ref map() const;
+
         /**
          * Get a stream to write the output data.
          *
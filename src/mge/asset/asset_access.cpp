@@ -2,9 +2,15 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/asset/asset_access.hpp"
+#include "mge/asset/mapped_region.hpp"
 
 namespace mge {
     asset_access::asset_access() {}
 
     asset_access::~asset_access() {}
+
+    mapped_region_ref asset_access::map() const
+    {
+        return mapped_region_ref();
+    }
 } // namespace mge
\ No newline at end of file
@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #pragma once
+#include "mge/asset/asset_fwd.hpp"
 #include "mge/asset/asset_type.hpp"
 #include "mge/asset/dllexport.hpp"
 #include "mge/core/input_stream.hpp"
@@ -35,6 +36,15 @@ namespace mge {
          * @return input stream of asset data
          */
         virtual input_stream_ref data() const = 0;
+        /**
+         * @brief Asset data mapped into memory.
+         *
+         * The default implementation does not support mapping.
+         *
+         * @return read-only view of the asset data, @c nullptr if the
+         *  asset cannot be mapped
+         */
+        virtual mapped_region_ref map() const;
         /**
          * @brief Asset type.
          *
@@ -9,6 +9,7 @@ namespace mge {
     MGE_DECLARE_REF(asset);
     MGE_DECLARE_REF(asset_access);
     MGE_DECLARE_REF(asset_handler);
+    MGE_DECLARE_REF(mapped_region);
 
     class asset_type;
 } // namespace mge
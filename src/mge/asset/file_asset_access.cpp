@@ -3,6 +3,7 @@
 // All rights reserved.
 #include "mge/asset/file_asset_access.hpp"
 #include "mge/asset/asset_type.hpp"
+#include "mge/asset/file_mapped_region.hpp"
 #include "mge/core/file_output_stream.hpp"
 #include "mge/core/io_exception.hpp"
 #include "mge/core/stdexceptions.hpp"
@@ -34,6 +35,11 @@ namespace mge {
         return std::make_shared<file_input_stream>(m_file_path);
     }
 
+    mapped_region_ref file_asset_access::map() const
+    {
+        return std::make_shared<file_mapped_region>(m_file_path);
+    }
+
     asset_type file_asset_access::type() const
     {
         return asset_type::UNKNOWN;
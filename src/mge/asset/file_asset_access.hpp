@@ -18,6 +18,7 @@ namespace mge {
 
         size_t            size() const override;
         input_stream_ref  data() const override;
+        mapped_region_ref map() const override;
         asset_type        type() const override;
         bool              has_properties() const override;
         properties_ref    properties() const override;
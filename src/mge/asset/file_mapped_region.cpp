@@ -0,0 +1,125 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/asset/file_mapped_region.hpp"
+#include "mge/config.hpp"
+#include "mge/core/io_exception.hpp"
+#include "mge/core/system_error.hpp"
+
+#if defined(MGE_OS_WINDOWS)
+#    include <windows.h>
+#elif defined(MGE_OS_LINUX) || defined(MGE_OS_MACOSX)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#else
+#    error Missing port
+#endif
+
+namespace mge {
+
+#if defined(MGE_OS_WINDOWS)
+    file_mapped_region::file_mapped_region(const mge::path& file_path)
+        : m_path(file_path)
+    {
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+        try {
+            file = ::CreateFileW(file_path.native().c_str(),
+                                 GENERIC_READ,
+                                 FILE_SHARE_READ,
+                                 nullptr,
+                                 OPEN_EXISTING,
+                                 FILE_FLAG_SEQUENTIAL_SCAN,
+                                 nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                MGE_CHECK_SYSTEM_ERROR(CreateFileW);
+            }
+            LARGE_INTEGER size;
+            if (!::GetFileSizeEx(file, &size)) {
+                MGE_CHECK_SYSTEM_ERROR(GetFileSizeEx);
+            }
+            m_size = static_cast<size_t>(size.QuadPart);
+            if (m_size != 0) {
+                mapping = ::CreateFileMappingW(file,
+                                               nullptr,
+                                               PAGE_READONLY,
+                                               0,
+                                               0,
+                                               nullptr);
+                if (!mapping) {
+                    MGE_CHECK_SYSTEM_ERROR(CreateFileMappingW);
+                }
+                void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (!view) {
+                    MGE_CHECK_SYSTEM_ERROR(MapViewOfFile);
+                }
+                m_data = static_cast<const uint8_t*>(view);
+                // the view keeps the mapping alive
+                ::CloseHandle(mapping);
+            }
+            ::CloseHandle(file);
+        } catch (const mge::exception& e) {
+            if (mapping) {
+                ::CloseHandle(mapping);
+            }
+            if (file != INVALID_HANDLE_VALUE) {
+                ::CloseHandle(file);
+            }
+            MGE_THROW_WITH_CAUSE(io_exception, e)
+                << "Mapping file '" << m_path << "' failed";
+        }
+    }
+
+    file_mapped_region::~file_mapped_region()
+    {
+        if (m_data) {
+            ::UnmapViewOfFile(m_data);
+        }
+    }
+#else
+    file_mapped_region::file_mapped_region(const mge::path& file_path)
+        : m_path(file_path)
+    {
+        int fd = -1;
+        try {
+            fd = ::open(file_path.string().c_str(), O_RDONLY);
+            if (fd == -1) {
+                MGE_CHECK_SYSTEM_ERROR(open);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) == -1) {
+                MGE_CHECK_SYSTEM_ERROR(fstat);
+            }
+            m_size = static_cast<size_t>(st.st_size);
+            // mapping an empty file fails, an empty region has no data
+            if (m_size != 0) {
+                void* addr =
+                    ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr == MAP_FAILED) {
+                    MGE_CHECK_SYSTEM_ERROR(mmap);
+                }
+                // loaders read the whole asset, start reading ahead
+                ::madvise(addr, m_size, MADV_WILLNEED);
+                m_data = static_cast<const uint8_t*>(addr);
+            }
+            ::close(fd);
+        } catch (const mge::exception& e) {
+            if (fd != -1) {
+                ::close(fd);
+            }
+            MGE_THROW_WITH_CAUSE(io_exception, e)
+                << "Mapping file '" << m_path << "' failed";
+        }
+    }
+
+    file_mapped_region::~file_mapped_region()
+    {
+        if (m_data) {
+            ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+    }
+#endif
+
+} // namespace mge
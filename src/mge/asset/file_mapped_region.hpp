@@ -0,0 +1,26 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/asset/mapped_region.hpp"
+#include "mge/core/path.hpp"
+
+namespace mge {
+
+    /**
+     * @brief Memory mapped view of a file.
+     *
+     * The file is mapped read-only and private, changes to the file
+     * while it is mapped are undefined.
+     */
+    class file_mapped_region : public mapped_region
+    {
+    public:
+        explicit file_mapped_region(const mge::path& file_path);
+        ~file_mapped_region() override;
+
+    private:
+        mge::path m_path;
+    };
+
+} // namespace mge
@@ -0,0 +1,8 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/asset/mapped_region.hpp"
+
+namespace mge {
+    mapped_region::~mapped_region() {}
+} // namespace mge
@@ -0,0 +1,65 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/asset/asset_fwd.hpp"
+#include "mge/asset/dllexport.hpp"
+#include "mge/core/noncopyable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mge {
+
+    /**
+     * @brief Read-only view of asset data in memory.
+     *
+     * A mapped region lets loaders parse an asset in place instead of
+     * copying it through an input stream. The data stays valid as long
+     * as the region exists.
+     */
+    class MGEASSET_EXPORT mapped_region : public noncopyable
+    {
+    protected:
+        mapped_region() = default;
+
+    public:
+        virtual ~mapped_region();
+
+        /**
+         * @brief Start of the region.
+         *
+         * @return region data, @c nullptr for an empty region
+         */
+        const uint8_t* data() const noexcept
+        {
+            return m_data;
+        }
+
+        /**
+         * @brief Size of the region in bytes.
+         *
+         * @return region size
+         */
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        /**
+         * @brief Region as span.
+         *
+         * @return bytes of the region
+         */
+        std::span<const uint8_t> bytes() const noexcept
+        {
+            return std::span<const uint8_t>(m_data, m_size);
+        }
+
+    protected:
+        const uint8_t* m_data{nullptr};
+        size_t         m_size{0};
+    };
+
+} // namespace mge
@@ -2,12 +2,16 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/asset/asset.hpp"
+#include "mge/asset/asset_type.hpp"
 #include "mge/core/configuration.hpp"
 #include "mge/core/module.hpp"
 #include "mge/core/package.hpp"
 #include "mge/core/program_options.hpp"
 #include "mge/core/properties.hpp"
 #include "mge/core/trace.hpp"
+#include "mge/graphics/block_compression.hpp"
+#include "mge/graphics/image.hpp"
+#include "mge/graphics/mipmap.hpp"
 #include <iostream>
 
 namespace mge {
@@ -116,8 +120,92 @@ public:
     }
 };
 
+class compress_command : public command
+{
+public:
+    compress_command()
+    {
+        m_name = "compress";
+        m_description = "Compress an image to a block compressed DDS file";
+        m_options.option("h,help", "Show help message")
+            .option("f,format",
+                    "Compressed format (bc1, bc3, bc4, bc5), default bc3",
+                    mge::program_options::value<std::string>())
+            .option("n,no-mipmaps", "Do not generate mip levels")
+            .positional("assets",
+                        "source image and target DDS file",
+                        mge::program_options::value<std::string>().composing());
+    }
+    virtual ~compress_command() = default;
+
+    int execute(const mge::program_options::options& opts) override
+    {
+        const std::vector<std::string>* assets = nullptr;
+        if (opts.has_positional("assets")) {
+            assets = &std::any_cast<const std::vector<std::string>&>(
+                opts.positional("assets"));
+        }
+        if (opts.has_option("help") || !assets || assets->size() != 2) {
+            std::cout << "usage: mgeassettool compress [options] <source> "
+                         "<target>"
+                      << std::endl
+                      << std::endl;
+            std::cout << m_options << std::endl;
+            return 0;
+        }
+
+        auto format = mge::image_format::data_format::BC3;
+        if (opts.has_option("format")) {
+            const auto& name =
+                std::any_cast<const std::string&>(opts.option("format"));
+            if (name == "bc1") {
+                format = mge::image_format::data_format::BC1;
+            } else if (name == "bc3") {
+                format = mge::image_format::data_format::BC3;
+            } else if (name == "bc4") {
+                format = mge::image_format::data_format::BC4;
+            } else if (name == "bc5") {
+                format = mge::image_format::data_format::BC5;
+            } else {
+                std::cerr << "Unsupported format: " << name << std::endl;
+                return 1;
+            }
+        }
+
+        mge::properties p;
+        p.set("directory", ".");
+        mge::asset::mount("/",
+                          "file",
+                          mge::asset_source::access_mode::READ_WRITE,
+                          p);
+
+        mge::asset source((*assets)[0]);
+        auto       img = std::any_cast<mge::image_ref>(source.load());
+        MGE_DEBUG_TRACE(ASSETTOOL,
+                        "Loaded {}: {}x{}, {}",
+                        (*assets)[0],
+                        img->extent().width,
+                        img->extent().height,
+                        img->format());
+        if (!opts.has_option("no-mipmaps") && img->mip_levels() == 1) {
+            img = mge::generate_mip_chain(*img);
+        }
+        auto compressed = mge::compress_image(*img, format);
+
+        using namespace mge::literals;
+        mge::asset target((*assets)[1]);
+        target.store("image/vnd-ms.dds"_at, compressed);
+        std::cout << "Compressed " << (*assets)[0] << " ("
+                  << img->binary_size() << " bytes) to " << (*assets)[1]
+                  << " (" << compressed->binary_size() << " bytes, "
+                  << compressed->mip_levels() << " mip levels)" << std::endl;
+        return 0;
+    }
+};
+
 std::vector<std::shared_ptr<command>> commands = {
-    std::make_shared<info_command>()};
+    std::make_shared<info_command>(),
+    std::make_shared<compress_command>()};
 
 int main(int argc, const char** argv)
 {
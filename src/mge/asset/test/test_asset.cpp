@@ -42,6 +42,18 @@ TEST_F(test_asset, red_jpg)
     EXPECT_EQ("image/jpeg"_at, a->type());
 }
 
+TEST_F(test_asset, red_jpg_map)
+{
+    mge::asset_ref         a = std::make_shared<mge::asset>("/images/red.jpg");
+    mge::mapped_region_ref region = a->map();
+    ASSERT_TRUE(region);
+    EXPECT_EQ(382u, region->size());
+    // JPEG start of image marker
+    EXPECT_EQ(0xFF, region->data()[0]);
+    EXPECT_EQ(0xD8, region->data()[1]);
+    EXPECT_EQ(region->size(), region->bytes().size());
+}
+
 TEST_F(test_asset, red_jpg_load)
 {
     using namespace mge::literals;
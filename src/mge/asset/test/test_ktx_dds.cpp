@@ -0,0 +1,189 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "asset_test.hpp"
+#include "mge/asset/asset.hpp"
+#include "mge/asset/asset_corrupted.hpp"
+#include "mge/graphics/image.hpp"
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+    constexpr uint32_t DDS_MAGIC = 0x20534444;
+    constexpr uint32_t DDS_FLAGS = 0x1 | 0x2 | 0x4 | 0x1000;
+    constexpr uint32_t DDPF_ALPHAPIXELS = 0x1;
+    constexpr uint32_t DDPF_FOURCC = 0x4;
+    constexpr uint32_t DDPF_RGB = 0x40;
+    constexpr uint32_t FOURCC_DX10 = 0x30315844; // "DX10"
+
+    constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58,
+                                             0x20, 0x32, 0x30, 0xBB,
+                                             0x0D, 0x0A, 0x1A, 0x0A};
+    constexpr uint32_t VK_FORMAT_R8G8B8A8_UNORM = 37;
+
+    void put_u32(std::vector<uint8_t>& data, size_t offset, uint32_t v)
+    {
+        if (data.size() < offset + 4) {
+            data.resize(offset + 4);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            data[offset + i] = static_cast<uint8_t>(v >> (8 * i));
+        }
+    }
+
+    void put_u64(std::vector<uint8_t>& data, size_t offset, uint64_t v)
+    {
+        put_u32(data, offset, static_cast<uint32_t>(v));
+        put_u32(data, offset + 4, static_cast<uint32_t>(v >> 32));
+    }
+
+    // DDS header of an uncompressed RGBA image, 128 bytes
+    std::vector<uint8_t> dds_header(uint32_t width, uint32_t height)
+    {
+        std::vector<uint8_t> data(128);
+        put_u32(data, 0, DDS_MAGIC);
+        put_u32(data, 4, 124);
+        put_u32(data, 8, DDS_FLAGS);
+        put_u32(data, 12, height);
+        put_u32(data, 16, width);
+        put_u32(data, 76, 32);
+        put_u32(data, 80, DDPF_RGB | DDPF_ALPHAPIXELS);
+        put_u32(data, 88, 32);
+        put_u32(data, 92, 0x000000FF);
+        put_u32(data, 96, 0x0000FF00);
+        put_u32(data, 100, 0x00FF0000);
+        put_u32(data, 104, 0xFF000000);
+        return data;
+    }
+
+    // KTX2 header of an uncompressed RGBA image with one level, the
+    // level index entry ends at byte 104
+    std::vector<uint8_t> ktx2_header(uint32_t width, uint32_t height)
+    {
+        std::vector<uint8_t> data(80);
+        std::copy(std::begin(KTX2_IDENTIFIER),
+                  std::end(KTX2_IDENTIFIER),
+                  data.begin());
+        put_u32(data, 12, VK_FORMAT_R8G8B8A8_UNORM);
+        put_u32(data, 16, 1);
+        put_u32(data, 20, width);
+        put_u32(data, 24, height);
+        put_u32(data, 36, 1);
+        put_u32(data, 40, 1);
+        return data;
+    }
+
+} // namespace
+
+class test_ktx_dds : public mge::asset_test
+{
+protected:
+    void SetUp() override
+    {
+        mge::properties p;
+        p.set("directory", std::filesystem::temp_directory_path().string());
+        mge::asset::mount("/temp", "file", p);
+    }
+
+    void TearDown() override
+    {
+        for (const auto& name : m_files) {
+            std::filesystem::remove(std::filesystem::temp_directory_path() /
+                                    name);
+        }
+        mge::asset::unmount("/temp");
+    }
+
+    std::any load(const std::string& name, const std::vector<uint8_t>& data)
+    {
+        std::ofstream output(std::filesystem::temp_directory_path() / name,
+                             std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(data.data()),
+                     static_cast<std::streamsize>(data.size()));
+        output.close();
+        m_files.push_back(name);
+        return mge::asset("/temp/" + name).load();
+    }
+
+    std::vector<std::string> m_files;
+};
+
+TEST_F(test_ktx_dds, dds_rgba)
+{
+    auto data = dds_header(4, 4);
+    data.resize(data.size() + 4 * 4 * 4, 0x7F);
+    auto img = std::any_cast<mge::image_ref>(load("mge_test_rgba.dds", data));
+    ASSERT_TRUE(img);
+    EXPECT_EQ(4u, img->extent().width);
+    EXPECT_EQ(4u, img->extent().height);
+}
+
+TEST_F(test_ktx_dds, dds_truncated_data)
+{
+    auto data = dds_header(4, 4);
+    data.resize(data.size() + 4 * 4 * 4 - 1);
+    EXPECT_THROW(load("mge_test_truncated.dds", data), mge::asset_corrupted);
+}
+
+TEST_F(test_ktx_dds, dds_oversized_header)
+{
+    // would be a 16 GiB image, rejected before allocation
+    auto data = dds_header(65536, 65536);
+    data.resize(data.size() + 64);
+    EXPECT_THROW(load("mge_test_oversized.dds", data), mge::asset_corrupted);
+}
+
+TEST_F(test_ktx_dds, dds_truncated_dx10_header)
+{
+    auto data = dds_header(1, 1);
+    put_u32(data, 80, DDPF_FOURCC);
+    put_u32(data, 84, FOURCC_DX10);
+    put_u32(data, 128, 28); // DXGI_FORMAT_R8G8B8A8_UNORM
+    put_u32(data, 132, 3);  // texture 2D
+    put_u32(data, 140, 1);  // array size
+    // the array size is readable, the DX10 header is not complete
+    for (size_t size = 144; size < 148; ++size) {
+        data.resize(size);
+        EXPECT_THROW(load("mge_test_dx10.dds", data), mge::asset_corrupted);
+    }
+}
+
+TEST_F(test_ktx_dds, ktx2_rgba)
+{
+    auto data = ktx2_header(4, 4);
+    put_u64(data, 80, 104);
+    put_u64(data, 88, 4 * 4 * 4);
+    put_u64(data, 96, 4 * 4 * 4);
+    data.resize(104 + 4 * 4 * 4, 0x7F);
+    auto img = std::any_cast<mge::image_ref>(load("mge_test_rgba.ktx2", data));
+    ASSERT_TRUE(img);
+    EXPECT_EQ(4u, img->extent().width);
+    EXPECT_EQ(4u, img->extent().height);
+}
+
+TEST_F(test_ktx_dds, ktx2_truncated_level_index)
+{
+    auto data = ktx2_header(4, 4);
+    data.resize(90);
+    EXPECT_THROW(load("mge_test_index.ktx2", data), mge::asset_corrupted);
+}
+
+TEST_F(test_ktx_dds, ktx2_oversized_header)
+{
+    // would be a 16 GiB image, rejected before allocation
+    auto data = ktx2_header(65536, 65536);
+    put_u64(data, 80, 104);
+    put_u64(data, 88, 65536ull * 65536ull * 4);
+    put_u64(data, 96, 65536ull * 65536ull * 4);
+    data.resize(104 + 64);
+    EXPECT_THROW(load("mge_test_oversized.ktx2", data),
+                 mge::asset_corrupted);
+}
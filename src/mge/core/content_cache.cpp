@@ -0,0 +1,168 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/content_cache.hpp"
+#include "mge/core/fnv1a.hpp"
+#include "mge/core/trace.hpp"
+
+#include <fstream>
+#include <mutex>
+
+namespace mge {
+    MGE_USE_TRACE(CORE);
+
+    namespace {
+        struct content_cache_file_header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            uint64_t data_size;
+            uint64_t data_hash;
+        };
+
+        constexpr uint32_t CONTENT_CACHE_MAGIC = 0x4d474343; // 'MGCC'
+        constexpr uint32_t CONTENT_CACHE_VERSION = 1;
+
+        std::filesystem::path file_path(const std::filesystem::path& directory,
+                                        uint64_t                     key)
+        {
+            return directory / fmt::format("{:016x}.bin", key);
+        }
+
+        buffer_ref read_file(const std::filesystem::path& path, uint64_t key)
+        {
+            std::ifstream input(path, std::ios::binary);
+            if (!input) {
+                return nullptr;
+            }
+            content_cache_file_header header{};
+            input.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!input || header.magic != CONTENT_CACHE_MAGIC ||
+                header.version != CONTENT_CACHE_VERSION ||
+                header.key != key) {
+                return nullptr;
+            }
+            auto data = make_buffer(static_cast<size_t>(header.data_size));
+            input.read(reinterpret_cast<char*>(data->data()),
+                       static_cast<std::streamsize>(data->size()));
+            if (!input ||
+                fnv1a(data->data(), data->size()) != header.data_hash) {
+                MGE_WARNING_TRACE(CORE,
+                                  "Ignoring corrupt cache file {}",
+                                  path.string());
+                return nullptr;
+            }
+            return data;
+        }
+
+        void write_file(const std::filesystem::path& directory,
+                        uint64_t                     key,
+                        std::span<const std::byte>   data)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(directory, ec);
+            auto path = file_path(directory, key);
+            auto tmp_path = path;
+            tmp_path += ".tmp";
+            {
+                content_cache_file_header header{CONTENT_CACHE_MAGIC,
+                                                 CONTENT_CACHE_VERSION,
+                                                 key,
+                                                 data.size(),
+                                                 fnv1a(data.data(),
+                                                       data.size())};
+                std::ofstream output(tmp_path,
+                                     std::ios::binary | std::ios::trunc);
+                output.write(reinterpret_cast<const char*>(&header),
+                             sizeof(header));
+                output.write(reinterpret_cast<const char*>(data.data()),
+                             static_cast<std::streamsize>(data.size()));
+                if (!output) {
+                    MGE_WARNING_TRACE(CORE,
+                                      "Cannot write cache file {}",
+                                      tmp_path.string());
+                    output.close();
+                    std::filesystem::remove(tmp_path, ec);
+                    return;
+                }
+            }
+            // rename so concurrent readers never see a partial file
+            std::filesystem::rename(tmp_path, path, ec);
+            if (ec) {
+                MGE_WARNING_TRACE(CORE,
+                                  "Cannot store cache file {}: {}",
+                                  path.string(),
+                                  ec.message());
+                std::filesystem::remove(tmp_path, ec);
+            }
+        }
+    } // namespace
+
+    content_cache::content_cache()
+        : m_lock("content_cache")
+    {}
+
+    content_cache::content_cache(const std::filesystem::path& directory)
+        : m_lock("content_cache")
+        , m_directory(directory)
+    {}
+
+    content_cache::~content_cache() = default;
+
+    buffer_ref content_cache::get(uint64_t key)
+    {
+        std::filesystem::path directory;
+        {
+            std::lock_guard<mge::mutex> lock(m_lock);
+            auto                        it = m_entries.find(key);
+            if (it != m_entries.end()) {
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+            directory = m_directory;
+        }
+        if (directory.empty()) {
+            return nullptr;
+        }
+        auto data = read_file(file_path(directory, key), key);
+        if (data) {
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<mge::mutex> lock(m_lock);
+            m_entries.try_emplace(key, data);
+        }
+        return data;
+    }
+
+    void content_cache::put(uint64_t key, std::span<const std::byte> data)
+    {
+        std::filesystem::path directory;
+        {
+            std::lock_guard<mge::mutex> lock(m_lock);
+            m_entries[key] = make_buffer(data.data(), data.size());
+            directory = m_directory;
+        }
+        if (!directory.empty()) {
+            write_file(directory, key, data);
+        }
+    }
+
+    void content_cache::set_directory(const std::filesystem::path& directory)
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        m_directory = directory;
+    }
+
+    std::filesystem::path content_cache::directory() const
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        return m_directory;
+    }
+
+    void content_cache::clear()
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        m_entries.clear();
+    }
+
+} // namespace mge
@@ -0,0 +1,107 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/buffer.hpp"
+#include "mge/core/dllexport.hpp"
+#include "mge/core/mutex.hpp"
+#include "mge/core/noncopyable.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <unordered_map>
+
+namespace mge {
+
+    /**
+     * @brief Content-addressed cache of binary data.
+     *
+     * Entries are keyed by a hash of everything that determines their
+     * content, e.g. a compiler's input, options and version, so an entry
+     * never needs to be invalidated. Entries are kept in memory and, if
+     * a directory is set, stored as one file per key in that directory so
+     * they survive the process.
+     *
+     * All methods are thread-safe.
+     */
+    class MGECORE_EXPORT content_cache : public noncopyable
+    {
+    public:
+        /**
+         * @brief Create a cache kept in memory only.
+         */
+        content_cache();
+
+        /**
+         * @brief Create a cache stored in a directory.
+         *
+         * @param directory directory of the cache files, created on
+         *  first store
+         */
+        explicit content_cache(const std::filesystem::path& directory);
+
+        ~content_cache();
+
+        /**
+         * @brief Look up an entry.
+         *
+         * If the entry is not in memory, it is read from the cache
+         * directory. Files that are truncated or corrupt are ignored.
+         *
+         * @param key content key
+         * @return cached data, @c nullptr if not found
+         */
+        buffer_ref get(uint64_t key);
+
+        /**
+         * @brief Store an entry.
+         *
+         * Failing to write the cache file is not an error, the entry is
+         * still kept in memory.
+         *
+         * @param key  content key
+         * @param data data to store
+         */
+        void put(uint64_t key, std::span<const std::byte> data);
+
+        /**
+         * @brief Set the cache directory.
+         *
+         * @param directory directory of cache files, empty to keep
+         *  entries in memory only
+         */
+        void set_directory(const std::filesystem::path& directory);
+
+        /**
+         * @brief Current cache directory.
+         *
+         * @return directory of cache files, empty if entries are kept in
+         *  memory only
+         */
+        std::filesystem::path directory() const;
+
+        /**
+         * @brief Drop all entries kept in memory.
+         */
+        void clear();
+
+        /**
+         * @brief Number of lookups that found an entry.
+         *
+         * @return lookups answered from memory or the cache directory
+         */
+        uint64_t hits() const noexcept
+        {
+            return m_hits.load(std::memory_order_relaxed);
+        }
+
+    private:
+        mutable mge::mutex                       m_lock;
+        std::filesystem::path                    m_directory;
+        std::unordered_map<uint64_t, buffer_ref> m_entries;
+        std::atomic<uint64_t>                    m_hits{0};
+    };
+
+} // namespace mge
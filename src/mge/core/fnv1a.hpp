@@ -0,0 +1,52 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace mge {
+
+    /**
+     * @brief Offset basis of the 64-bit FNV-1a hash.
+     */
+    inline constexpr uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325ull;
+
+    /**
+     * @brief 64-bit FNV-1a hash of a byte range.
+     *
+     * Unlike @c std::hash the result is the same on every platform and
+     * in every run, so it can be used for keys that are persisted.
+     * Hashes can be chained by passing a previous result as @c hash.
+     *
+     * @param data  data to hash
+     * @param size  data size in bytes
+     * @param hash  initial hash value
+     * @return hash value
+     */
+    inline uint64_t fnv1a(const void* data,
+                          size_t      size,
+                          uint64_t    hash = FNV1A_OFFSET_BASIS) noexcept
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief 64-bit FNV-1a hash of a string.
+     *
+     * @param s     string to hash
+     * @param hash  initial hash value
+     * @return hash value
+     */
+    inline uint64_t fnv1a(std::string_view s,
+                          uint64_t         hash = FNV1A_OFFSET_BASIS) noexcept
+    {
+        return fnv1a(s.data(), s.size(), hash);
+    }
+
+} // namespace mge
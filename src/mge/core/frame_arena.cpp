@@ -0,0 +1,118 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/frame_arena.hpp"
+
+#include <optional>
+
+namespace mge {
+
+    /**
+     * One buffer of the arena. Acts as upstream of its monotonic resource
+     * to learn how many bytes did not fit into the block.
+     */
+    class frame_arena::buffer : public std::pmr::memory_resource
+    {
+    public:
+        buffer(size_t size, std::pmr::memory_resource* upstream)
+            : m_upstream(upstream)
+            , m_size(size)
+        {
+            allocate_block();
+        }
+
+        ~buffer() override
+        {
+            m_monotonic.reset();
+            m_upstream->deallocate(m_block, m_size, BLOCK_ALIGNMENT);
+        }
+
+        std::pmr::memory_resource* resource() noexcept
+        {
+            return &*m_monotonic;
+        }
+
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        void reset()
+        {
+            m_monotonic->release();
+            if (m_overflow == 0) {
+                return;
+            }
+            // grow the block to the peak use of the last frame
+            size_t size = m_size + m_overflow;
+            size = (size + BLOCK_GRANULARITY - 1) & ~(BLOCK_GRANULARITY - 1);
+            m_monotonic.reset();
+            m_upstream->deallocate(m_block, m_size, BLOCK_ALIGNMENT);
+            m_block = nullptr;
+            m_size = size;
+            m_overflow = 0;
+            allocate_block();
+        }
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            m_overflow += bytes;
+            return m_upstream->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            m_upstream->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(
+            const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        static constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+        static constexpr size_t BLOCK_GRANULARITY = 4096;
+
+        void allocate_block()
+        {
+            m_block = m_upstream->allocate(m_size, BLOCK_ALIGNMENT);
+            m_monotonic.emplace(m_block, m_size, this);
+        }
+
+        std::pmr::memory_resource*                         m_upstream;
+        void*                                              m_block{nullptr};
+        size_t                                             m_size;
+        size_t                                             m_overflow{0};
+        std::optional<std::pmr::monotonic_buffer_resource> m_monotonic;
+    };
+
+    frame_arena::frame_arena(size_t                     initial_size,
+                             std::pmr::memory_resource* upstream)
+    {
+        m_buffers[0] = std::make_unique<buffer>(initial_size, upstream);
+        m_buffers[1] = std::make_unique<buffer>(initial_size, upstream);
+    }
+
+    frame_arena::~frame_arena() = default;
+
+    std::pmr::memory_resource* frame_arena::resource() noexcept
+    {
+        return m_buffers[m_current]->resource();
+    }
+
+    void frame_arena::next_frame()
+    {
+        size_t next = m_current ^ 1;
+        m_buffers[next]->reset();
+        m_current = next;
+    }
+
+    size_t frame_arena::block_size() const noexcept
+    {
+        return m_buffers[m_current]->size();
+    }
+
+} // namespace mge
@@ -0,0 +1,73 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/dllexport.hpp"
+#include "mge/core/noncopyable.hpp"
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace mge {
+
+    /**
+     * @brief Double-buffered monotonic arena for per-frame allocations.
+     *
+     * Allocations are served from the buffer of the current frame and
+     * never freed individually. Two buffers alternate: @c next_frame
+     * releases the buffer used two frames ago and makes it current, so
+     * data of the previous frame stays valid for one more frame.
+     *
+     * Each buffer starts as a single block taken from the upstream
+     * resource. If a frame overflows its block, the block is enlarged to
+     * the frame's peak use when the buffer is reused, so in steady state
+     * a frame does not allocate from upstream at all.
+     *
+     * The arena is not thread-safe, use one arena per recording thread.
+     */
+    class MGECORE_EXPORT frame_arena : public noncopyable
+    {
+    public:
+        /**
+         * @brief Create a frame arena.
+         *
+         * @param initial_size initial block size of each buffer
+         * @param upstream     resource providing the blocks
+         */
+        explicit frame_arena(size_t                     initial_size = 65536,
+                             std::pmr::memory_resource* upstream =
+                                 std::pmr::get_default_resource());
+        ~frame_arena();
+
+        /**
+         * @brief Memory resource of the current frame.
+         *
+         * @return resource valid until the next but one @c next_frame
+         */
+        std::pmr::memory_resource* resource() noexcept;
+
+        /**
+         * @brief Advance to the next frame.
+         *
+         * Releases all memory allocated two frames ago and makes that
+         * buffer current.
+         */
+        void next_frame();
+
+        /**
+         * @brief Size of the block of the current buffer.
+         *
+         * @return block size in bytes
+         */
+        size_t block_size() const noexcept;
+
+    private:
+        class buffer;
+
+        std::array<std::unique_ptr<buffer>, 2> m_buffers;
+        size_t                                 m_current{0};
+    };
+
+} // namespace mge
@@ -116,6 +116,27 @@ namespace mge {
             return get() != nullptr;
         }
 
+        /**
+         * @brief Compare handles.
+         * @param other compared handle
+         * @return @c true if both handles refer to the same object
+         */
+        bool operator==(const handle& other) const noexcept
+        {
+            return m_context_index == other.m_context_index &&
+                   m_flags == other.m_flags &&
+                   m_object_index == other.m_object_index;
+        }
+
+        /**
+         * @brief Index of the object in its context.
+         * @return object index
+         */
+        uint32_t object_index() const noexcept
+        {
+            return m_object_index;
+        }
+
         void destroy()
         {
             Context* ctx = Context::get(m_context_index);
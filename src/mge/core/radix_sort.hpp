@@ -0,0 +1,111 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/stdexceptions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace mge {
+
+    /**
+     * @brief Stable LSD radix sort of 64-bit keys with attached values.
+     *
+     * Sorts @c keys ascending and applies the same permutation to
+     * @c values. Keys are processed in 8-bit digits, digits that are
+     * identical for all keys are skipped, so sorting keys that only use
+     * their low bits costs only as many passes as bits are actually used.
+     * Equal keys keep their relative order.
+     *
+     * Typical use is sorting an index array by a key column without
+     * moving the data the indices refer to.
+     *
+     * @param keys      keys to sort
+     * @param values    values permuted along with the keys
+     * @param resource  memory resource used for scratch storage
+     * @throws illegal_argument if @c keys and @c values differ in size
+     */
+    inline void
+    radix_sort(std::span<uint64_t>        keys,
+               std::span<uint32_t>        values,
+               std::pmr::memory_resource* resource =
+                   std::pmr::get_default_resource())
+    {
+        if (keys.size() != values.size()) {
+            MGE_THROW(mge::illegal_argument)
+                << "Key count " << keys.size() << " does not match value count "
+                << values.size();
+        }
+
+        const size_t count = keys.size();
+        if (count < 2) {
+            return;
+        }
+
+        // insertion sort beats the histogram setup for tiny inputs
+        if (count <= 32) {
+            for (size_t i = 1; i < count; ++i) {
+                uint64_t key = keys[i];
+                uint32_t value = values[i];
+                size_t   j = i;
+                while (j > 0 && keys[j - 1] > key) {
+                    keys[j] = keys[j - 1];
+                    values[j] = values[j - 1];
+                    --j;
+                }
+                keys[j] = key;
+                values[j] = value;
+            }
+            return;
+        }
+
+        constexpr size_t digits = sizeof(uint64_t);
+        std::array<std::array<size_t, 256>, digits> histograms{};
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t key = keys[i];
+            for (size_t d = 0; d < digits; ++d) {
+                ++histograms[d][(key >> (d * 8)) & 0xFF];
+            }
+        }
+
+        std::pmr::vector<uint64_t> key_scratch(count, resource);
+        std::pmr::vector<uint32_t> value_scratch(count, resource);
+
+        uint64_t* src_keys = keys.data();
+        uint32_t* src_values = values.data();
+        uint64_t* dst_keys = key_scratch.data();
+        uint32_t* dst_values = value_scratch.data();
+
+        for (size_t d = 0; d < digits; ++d) {
+            auto&    histogram = histograms[d];
+            unsigned shift = static_cast<unsigned>(d * 8);
+            if (histogram[(src_keys[0] >> shift) & 0xFF] == count) {
+                continue;
+            }
+            size_t offset = 0;
+            for (auto& bucket : histogram) {
+                size_t bucket_count = bucket;
+                bucket = offset;
+                offset += bucket_count;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                size_t pos = histogram[(src_keys[i] >> shift) & 0xFF]++;
+                dst_keys[pos] = src_keys[i];
+                dst_values[pos] = src_values[i];
+            }
+            std::swap(src_keys, dst_keys);
+            std::swap(src_values, dst_values);
+        }
+
+        if (src_keys != keys.data()) {
+            std::copy(src_keys, src_keys + count, keys.data());
+            std::copy(src_values, src_values + count, values.data());
+        }
+    }
+
+} // namespace mge
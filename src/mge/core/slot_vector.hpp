@@ -0,0 +1,139 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mge {
+
+    /**
+     * @brief Vector of object pointers with reusable, generation-checked
+     * slots.
+     *
+     * Inserting an object returns its slot index and the slot's current
+     * generation. Erasing an object puts the slot on a free list and
+     * advances its generation, so a later insert reuses the slot while
+     * lookups with the old generation fail instead of finding the new
+     * object. Generations are 16 bit and never 0, so a zero generation
+     * never refers to an object.
+     *
+     * Iteration visits all slots, including free ones that hold
+     * @c nullptr.
+     *
+     * @tparam T object type
+     */
+    template <typename T> class slot_vector
+    {
+    public:
+        using iterator = typename std::vector<T*>::iterator;
+        using const_iterator = typename std::vector<T*>::const_iterator;
+
+        slot_vector() = default;
+
+        /**
+         * @brief Insert an object.
+         *
+         * @param object object to insert, must not be @c nullptr
+         * @return slot index and generation of the object
+         */
+        std::pair<uint32_t, uint16_t> insert(T* object)
+        {
+            uint32_t index;
+            if (m_free.empty()) {
+                index = static_cast<uint32_t>(m_objects.size());
+                m_objects.push_back(object);
+                m_generations.push_back(1);
+            } else {
+                index = m_free.back();
+                m_free.pop_back();
+                m_objects[index] = object;
+            }
+            return {index, m_generations[index]};
+        }
+
+        /**
+         * @brief Look up an object.
+         *
+         * @param index      slot index
+         * @param generation generation the object was inserted with
+         * @return object, @c nullptr if the slot is free or was reused
+         */
+        T* get(uint32_t index, uint16_t generation) const noexcept
+        {
+            if (index < m_objects.size() &&
+                m_generations[index] == generation) {
+                return m_objects[index];
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Remove an object and free its slot.
+         *
+         * @param index      slot index
+         * @param generation generation the object was inserted with
+         * @return removed object, @c nullptr if the slot is free or was
+         *  reused
+         */
+        T* erase(uint32_t index, uint16_t generation) noexcept
+        {
+            T* object = get(index, generation);
+            if (object) {
+                m_objects[index] = nullptr;
+                uint16_t next = static_cast<uint16_t>(generation + 1);
+                m_generations[index] = next == 0 ? 1 : next;
+                m_free.push_back(index);
+            }
+            return object;
+        }
+
+        /**
+         * @brief Number of slots, including free ones.
+         *
+         * @return slot count
+         */
+        std::size_t size() const noexcept
+        {
+            return m_objects.size();
+        }
+
+        /**
+         * @brief Number of free slots.
+         *
+         * @return free slot count
+         */
+        std::size_t free_slots() const noexcept
+        {
+            return m_free.size();
+        }
+
+        iterator begin() noexcept
+        {
+            return m_objects.begin();
+        }
+
+        iterator end() noexcept
+        {
+            return m_objects.end();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_objects.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_objects.end();
+        }
+
+    private:
+        std::vector<T*>       m_objects;
+        std::vector<uint16_t> m_generations;
+        std::vector<uint32_t> m_free;
+    };
+
+} // namespace mge
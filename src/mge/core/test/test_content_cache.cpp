@@ -0,0 +1,88 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/content_cache.hpp"
+#include "test/googletest.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+class content_cache_test : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_directory =
+            std::filesystem::temp_directory_path() / "mge_test_content_cache";
+        std::filesystem::remove_all(m_directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    static std::vector<std::byte> sample_data()
+    {
+        return {std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+    }
+
+    std::filesystem::path m_directory;
+};
+
+TEST_F(content_cache_test, memory_only)
+{
+    mge::content_cache cache;
+    EXPECT_EQ(cache.get(42), nullptr);
+    cache.put(42, sample_data());
+    auto data = cache.get(42);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(*data, sample_data());
+    cache.clear();
+    EXPECT_EQ(cache.get(42), nullptr);
+}
+
+TEST_F(content_cache_test, counts_hits)
+{
+    mge::content_cache cache(m_directory);
+    EXPECT_EQ(cache.get(42), nullptr);
+    EXPECT_EQ(0u, cache.hits());
+    cache.put(42, sample_data());
+    EXPECT_NE(cache.get(42), nullptr);
+    EXPECT_EQ(1u, cache.hits());
+    // entries read from the directory are hits too
+    cache.clear();
+    EXPECT_NE(cache.get(42), nullptr);
+    EXPECT_EQ(2u, cache.hits());
+    EXPECT_EQ(m_directory, cache.directory());
+}
+
+TEST_F(content_cache_test, stored_in_directory)
+{
+    {
+        mge::content_cache cache(m_directory);
+        cache.put(42, sample_data());
+    }
+    mge::content_cache cache(m_directory);
+    auto               data = cache.get(42);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(*data, sample_data());
+    EXPECT_EQ(cache.get(43), nullptr);
+}
+
+TEST_F(content_cache_test, ignores_corrupt_file)
+{
+    {
+        mge::content_cache cache(m_directory);
+        cache.put(42, sample_data());
+    }
+    for (const auto& entry :
+         std::filesystem::directory_iterator(m_directory)) {
+        std::fstream f(entry.path(),
+                       std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(-1, std::ios::end);
+        f.put('x');
+    }
+    mge::content_cache cache(m_directory);
+    EXPECT_EQ(cache.get(42), nullptr);
+}
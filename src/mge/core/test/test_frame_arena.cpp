@@ -0,0 +1,85 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/frame_arena.hpp"
+#include "mge/core/memory_resource.hpp"
+#include "test/googletest.hpp"
+
+#include <vector>
+
+using namespace std::string_view_literals;
+
+namespace {
+    uint64_t allocations(const mge::named_memory_resource& r)
+    {
+        const auto& s = r.resource_statistics();
+        const auto& desc = s.describe();
+        for (mge::statistics::description::size_type i = 0; i < desc.size();
+             ++i) {
+            if (desc.at(i).name() == "allocations"sv) {
+                return std::get<uint64_t>(desc.at(i).get(s));
+            }
+        }
+        return 0;
+    }
+} // namespace
+
+TEST(frame_arena, allocates_blocks_upfront)
+{
+    mge::named_memory_resource upstream("frame_arena_blocks"sv);
+    mge::frame_arena           arena(1024, &upstream);
+    EXPECT_EQ(allocations(upstream), 2u);
+    EXPECT_EQ(arena.block_size(), 1024u);
+
+    void* p = arena.resource()->allocate(512);
+    EXPECT_NE(p, nullptr);
+    EXPECT_EQ(allocations(upstream), 2u);
+}
+
+TEST(frame_arena, previous_frame_stays_valid)
+{
+    mge::frame_arena arena(1024);
+    auto*            first = arena.resource();
+    auto*            p = static_cast<int*>(first->allocate(sizeof(int)));
+    *p = 42;
+    arena.next_frame();
+    EXPECT_NE(arena.resource(), first);
+    void* q = arena.resource()->allocate(sizeof(int));
+    EXPECT_NE(q, nullptr);
+    EXPECT_NE(q, static_cast<void*>(p));
+    EXPECT_EQ(*p, 42);
+    arena.next_frame();
+    EXPECT_EQ(arena.resource(), first);
+}
+
+TEST(frame_arena, grows_to_peak_use)
+{
+    mge::named_memory_resource upstream("frame_arena_growth"sv);
+    mge::frame_arena           arena(1024, &upstream);
+
+    auto record_frame = [&] {
+        std::pmr::vector<uint64_t> v(arena.resource());
+        for (uint64_t i = 0; i < 1000; ++i) {
+            v.push_back(i);
+        }
+    };
+
+    // first two frames overflow both buffers
+    record_frame();
+    arena.next_frame();
+    record_frame();
+    arena.next_frame();
+    EXPECT_GT(arena.block_size(), 1024u);
+
+    // frame 3 and 4 grow the blocks, then no frame allocates
+    record_frame();
+    arena.next_frame();
+    record_frame();
+    arena.next_frame();
+    auto steady = allocations(upstream);
+    for (int i = 0; i < 4; ++i) {
+        record_frame();
+        arena.next_frame();
+    }
+    EXPECT_EQ(allocations(upstream), steady);
+}
@@ -0,0 +1,70 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/radix_sort.hpp"
+#include "test/googletest.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+TEST(radix_sort, empty)
+{
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> values;
+    mge::radix_sort(keys, values);
+    EXPECT_TRUE(keys.empty());
+}
+
+TEST(radix_sort, size_mismatch_throws)
+{
+    std::vector<uint64_t> keys{1, 2, 3};
+    std::vector<uint32_t> values{0, 1};
+    EXPECT_THROW(mge::radix_sort(keys, values), mge::illegal_argument);
+}
+
+TEST(radix_sort, small_input)
+{
+    std::vector<uint64_t> keys{5, 3, 9, 1};
+    std::vector<uint32_t> values{0, 1, 2, 3};
+    mge::radix_sort(keys, values);
+    EXPECT_EQ(keys, (std::vector<uint64_t>{1, 3, 5, 9}));
+    EXPECT_EQ(values, (std::vector<uint32_t>{3, 1, 0, 2}));
+}
+
+TEST(radix_sort, large_input_matches_stable_sort)
+{
+    std::mt19937_64                         rng(42);
+    std::uniform_int_distribution<uint64_t> dist;
+
+    std::vector<uint64_t> keys(10000);
+    for (auto& k : keys) {
+        // restrict to a few distinct values in the high and low digits
+        // to exercise both digit skipping and stability
+        k = (dist(rng) & 0xFF000000000000FFull);
+    }
+    std::vector<uint32_t> values(keys.size());
+    std::iota(values.begin(), values.end(), 0u);
+
+    std::vector<uint32_t> expected(values);
+    std::stable_sort(expected.begin(),
+                     expected.end(),
+                     [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    auto sorted_keys = keys;
+    mge::radix_sort(sorted_keys, values);
+
+    EXPECT_TRUE(std::is_sorted(sorted_keys.begin(), sorted_keys.end()));
+    EXPECT_EQ(values, expected);
+}
+
+TEST(radix_sort, equal_keys_keep_order)
+{
+    std::vector<uint64_t> keys(100, 7);
+    std::vector<uint32_t> values(keys.size());
+    std::iota(values.begin(), values.end(), 0u);
+    auto expected = values;
+    mge::radix_sort(keys, values);
+    EXPECT_EQ(values, expected);
+}
@@ -0,0 +1,77 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/slot_vector.hpp"
+#include "test/googletest.hpp"
+
+TEST(slot_vector, insert_and_get)
+{
+    int                   a = 1, b = 2;
+    mge::slot_vector<int> v;
+    auto [ia, ga] = v.insert(&a);
+    auto [ib, gb] = v.insert(&b);
+    EXPECT_NE(ia, ib);
+    EXPECT_NE(0, ga);
+    EXPECT_EQ(&a, v.get(ia, ga));
+    EXPECT_EQ(&b, v.get(ib, gb));
+    EXPECT_EQ(nullptr, v.get(ia, 0));
+    EXPECT_EQ(nullptr, v.get(17, ga));
+}
+
+TEST(slot_vector, erase_reuses_slot)
+{
+    int                   a = 1, b = 2;
+    mge::slot_vector<int> v;
+    auto [ia, ga] = v.insert(&a);
+    EXPECT_EQ(&a, v.erase(ia, ga));
+    EXPECT_EQ(1u, v.free_slots());
+    auto [ib, gb] = v.insert(&b);
+    EXPECT_EQ(ia, ib);
+    EXPECT_NE(ga, gb);
+    EXPECT_EQ(1u, v.size());
+    EXPECT_EQ(0u, v.free_slots());
+}
+
+TEST(slot_vector, stale_generation_is_rejected)
+{
+    int                   a = 1, b = 2;
+    mge::slot_vector<int> v;
+    auto [ia, ga] = v.insert(&a);
+    v.erase(ia, ga);
+    EXPECT_EQ(nullptr, v.get(ia, ga));
+    EXPECT_EQ(nullptr, v.erase(ia, ga));
+    auto [ib, gb] = v.insert(&b);
+    EXPECT_EQ(nullptr, v.get(ia, ga));
+    EXPECT_EQ(nullptr, v.erase(ia, ga));
+    EXPECT_EQ(&b, v.get(ib, gb));
+}
+
+TEST(slot_vector, generation_skips_zero)
+{
+    int                   a = 1;
+    mge::slot_vector<int> v;
+    for (uint32_t i = 0; i < 0x10000; ++i) {
+        auto [index, generation] = v.insert(&a);
+        EXPECT_NE(0, generation);
+        v.erase(index, generation);
+    }
+    EXPECT_EQ(1u, v.size());
+}
+
+TEST(slot_vector, iterate_includes_free_slots)
+{
+    int                   a = 1, b = 2;
+    mge::slot_vector<int> v;
+    auto [ia, ga] = v.insert(&a);
+    v.insert(&b);
+    v.erase(ia, ga);
+    size_t count = 0, null_count = 0;
+    for (auto* p : v) {
+        ++count;
+        if (!p) {
+            ++null_count;
+        }
+    }
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(1u, null_count);
+}
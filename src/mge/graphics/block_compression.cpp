@@ -0,0 +1,227 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/graphics/block_compression.hpp"
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/image.hpp"
+#include "mge/graphics/memory_image.hpp"
+#include "mge/graphics/mipmap.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
+namespace mge {
+
+    namespace {
+
+        uint16_t to_rgb565(const int* c)
+        {
+            return static_cast<uint16_t>(((c[0] >> 3) << 11) |
+                                         ((c[1] >> 2) << 5) | (c[2] >> 3));
+        }
+
+        void from_rgb565(uint16_t c, int* rgb)
+        {
+            int r = (c >> 11) & 0x1F;
+            int g = (c >> 5) & 0x3F;
+            int b = c & 0x1F;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        void write_le(uint8_t* out, uint64_t value, size_t bytes)
+        {
+            for (size_t i = 0; i < bytes; ++i) {
+                out[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+
+    } // namespace
+
+    void encode_bc1_block(const uint8_t* rgba, uint8_t* out)
+    {
+        int lo[3] = {255, 255, 255};
+        int hi[3] = {0, 0, 0};
+        for (size_t i = 0; i < 16; ++i) {
+            for (size_t c = 0; c < 3; ++c) {
+                lo[c] = std::min<int>(lo[c], rgba[4 * i + c]);
+                hi[c] = std::max<int>(hi[c], rgba[4 * i + c]);
+            }
+        }
+
+        // pick the bounding box diagonal that follows the colors
+        int cov_g = 0;
+        int cov_b = 0;
+        for (size_t i = 0; i < 16; ++i) {
+            int dr = 2 * rgba[4 * i] - lo[0] - hi[0];
+            cov_g += dr * (2 * rgba[4 * i + 1] - lo[1] - hi[1]);
+            cov_b += dr * (2 * rgba[4 * i + 2] - lo[2] - hi[2]);
+        }
+        if (cov_g < 0) {
+            std::swap(lo[1], hi[1]);
+        }
+        if (cov_b < 0) {
+            std::swap(lo[2], hi[2]);
+        }
+        // inset the endpoints to reduce the error of outliers
+        for (size_t c = 0; c < 3; ++c) {
+            int inset = (hi[c] - lo[c]) / 16;
+            hi[c] -= inset;
+            lo[c] += inset;
+        }
+
+        uint16_t c0 = to_rgb565(hi);
+        uint16_t c1 = to_rgb565(lo);
+        if (c0 < c1) {
+            std::swap(c0, c1);
+        }
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            int palette[4][3];
+            from_rgb565(c0, palette[0]);
+            from_rgb565(c1, palette[1]);
+            for (size_t c = 0; c < 3; ++c) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            for (size_t i = 0; i < 16; ++i) {
+                uint32_t best = 0;
+                int      best_error = std::numeric_limits<int>::max();
+                for (uint32_t p = 0; p < 4; ++p) {
+                    int error = 0;
+                    for (size_t c = 0; c < 3; ++c) {
+                        int d = rgba[4 * i + c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < best_error) {
+                        best_error = error;
+                        best = p;
+                    }
+                }
+                indices |= best << (2 * i);
+            }
+        }
+        write_le(out, c0, 2);
+        write_le(out + 2, c1, 2);
+        write_le(out + 4, indices, 4);
+    }
+
+    void encode_bc4_block(const uint8_t* values, uint8_t* out)
+    {
+        int lo = 255;
+        int hi = 0;
+        for (size_t i = 0; i < 16; ++i) {
+            lo = std::min<int>(lo, values[i]);
+            hi = std::max<int>(hi, values[i]);
+        }
+        uint64_t indices = 0;
+        if (lo != hi) {
+            // first endpoint greater than second selects 8 value mode
+            int palette[8] = {hi, lo};
+            for (int p = 2; p < 8; ++p) {
+                palette[p] = ((8 - p) * hi + (p - 1) * lo) / 7;
+            }
+            for (size_t i = 0; i < 16; ++i) {
+                uint64_t best = 0;
+                int      best_error = 256;
+                for (uint64_t p = 0; p < 8; ++p) {
+                    int error = std::abs(values[i] - palette[p]);
+                    if (error < best_error) {
+                        best_error = error;
+                        best = p;
+                    }
+                }
+                indices |= best << (3 * i);
+            }
+        }
+        out[0] = static_cast<uint8_t>(hi);
+        out[1] = static_cast<uint8_t>(lo);
+        write_le(out + 2, indices, 6);
+    }
+
+    image_ref compress_image(const image& img, image_format::data_format target)
+    {
+        const image_format source_format = img.format();
+        if ((source_format.format() != image_format::data_format::RGB &&
+             source_format.format() != image_format::data_format::RGBA) ||
+            source_format.type() != data_type::UINT8) {
+            MGE_THROW(illegal_argument)
+                << "Cannot compress image of format " << source_format;
+        }
+        const image_format target_format(target, data_type::UINT8);
+        if (target != image_format::data_format::BC1 &&
+            target != image_format::data_format::BC3 &&
+            target != image_format::data_format::BC4 &&
+            target != image_format::data_format::BC5) {
+            MGE_THROW(illegal_argument)
+                << "Unsupported compressed format " << target_format;
+        }
+
+        const size_t components = source_format.components();
+        const auto&  e = img.extent();
+        auto         result =
+            memory_image::create_mip_chain(target_format, e, img.mip_levels());
+        const auto* src = static_cast<const uint8_t*>(img.data());
+        auto*       dst = static_cast<uint8_t*>(result->data());
+
+        for (uint32_t level = 0; level < img.mip_levels(); ++level) {
+            const mge::extent level_extent = mip_level_extent(e, level);
+            const uint8_t*    level_data =
+                src + mip_level_offset(source_format, e, level);
+            uint8_t* out = dst + mip_level_offset(target_format, e, level);
+            for (uint32_t by = 0; by < level_extent.height; by += 4) {
+                for (uint32_t bx = 0; bx < level_extent.width; bx += 4) {
+                    // blocks at the border repeat the last row and column
+                    uint8_t block[64];
+                    uint8_t alpha[16];
+                    uint8_t green[16];
+                    for (uint32_t i = 0; i < 16; ++i) {
+                        uint32_t x =
+                            std::min(bx + i % 4, level_extent.width - 1);
+                        uint32_t y =
+                            std::min(by + i / 4, level_extent.height - 1);
+                        const uint8_t* pixel =
+                            level_data +
+                            (static_cast<size_t>(y) * level_extent.width + x) *
+                                components;
+                        block[4 * i] = pixel[0];
+                        block[4 * i + 1] = pixel[1];
+                        block[4 * i + 2] = pixel[2];
+                        block[4 * i + 3] = components == 4 ? pixel[3] : 255;
+                        alpha[i] = block[4 * i + 3];
+                        green[i] = pixel[1];
+                    }
+                    switch (target) {
+                    case image_format::data_format::BC1:
+                        encode_bc1_block(block, out);
+                        break;
+                    case image_format::data_format::BC3:
+                        encode_bc4_block(alpha, out);
+                        encode_bc1_block(block, out + 8);
+                        break;
+                    case image_format::data_format::BC4:
+                    case image_format::data_format::BC5: {
+                        uint8_t red[16];
+                        for (uint32_t i = 0; i < 16; ++i) {
+                            red[i] = block[4 * i];
+                        }
+                        encode_bc4_block(red, out);
+                        if (target == image_format::data_format::BC5) {
+                            encode_bc4_block(green, out + 8);
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                    }
+                    out += target_format.block_size();
+                }
+            }
+        }
+        return result;
+    }
+
+} // namespace mge
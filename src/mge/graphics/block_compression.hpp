@@ -0,0 +1,52 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/graphics/dllexport.hpp"
+#include "mge/graphics/graphics_fwd.hpp"
+#include "mge/graphics/image_format.hpp"
+
+#include <cstdint>
+
+namespace mge {
+
+    /**
+     * @brief Encode a 4x4 block of RGBA pixels as BC1.
+     *
+     * Endpoints are taken from the bounding box of the block colors, the
+     * block is always encoded in 4 color mode and alpha is ignored.
+     *
+     * @param rgba 16 pixels of 4 bytes, row by row
+     * @param out  8 bytes of encoded block
+     */
+    MGEGRAPHICS_EXPORT void encode_bc1_block(const uint8_t* rgba, uint8_t* out);
+
+    /**
+     * @brief Encode a 4x4 block of single channel values as BC4.
+     *
+     * @param values 16 values, row by row
+     * @param out    8 bytes of encoded block
+     */
+    MGEGRAPHICS_EXPORT void encode_bc4_block(const uint8_t* values,
+                                             uint8_t*       out);
+
+    /**
+     * @brief Compress an image on the CPU.
+     *
+     * The source must be an RGB or RGBA image of @c UINT8 components.
+     * All mip levels of the image are compressed. Supported targets are
+     * BC1, BC3, BC4 (red channel) and BC5 (red and green channels).
+     *
+     * This is a fast encoder intended for offline asset conversion, it
+     * does not search for optimal endpoints.
+     *
+     * @param img    source image
+     * @param target block compressed format
+     * @return compressed image
+     * @throws illegal_argument if source or target format is not
+     *  supported
+     */
+    MGEGRAPHICS_EXPORT image_ref
+    compress_image(const image& img, image_format::data_format target);
+
+} // namespace mge
@@ -18,7 +18,8 @@ namespace mge {
     enum class MGEGRAPHICS_EXPORT buffer_type : uint8_t
     {
         VERTEX,  //!< buffer containing vertex data
-        INDEX,   //!< buffer containing indices, offsets into vertex data
-        CONSTANT //!< buffer containing shader input values
+        INDEX,    //!< buffer containing indices, offsets into vertex data
+        CONSTANT, //!< buffer containing shader input values
+        STORAGE   //!< buffer read and written by shaders
     };
 } // namespace mge
\ No newline at end of file
@@ -2,26 +2,82 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/graphics/command_buffer.hpp"
+#include "mge/core/radix_sort.hpp"
 #include "mge/graphics/pass.hpp"
+#include "mge/graphics/uniform_block.hpp"
+
+#include <cstring>
 
 namespace mge {
 
+    namespace {
+        inline uint64_t fold_bits(uint64_t value, unsigned bits) noexcept
+        {
+            return (value * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+        }
+
+        // State part of the sort key, lower 32 bits. Most expensive
+        // state changes are placed in the most significant bits:
+        // program (10 bits), pipeline state (8 bits), textures (8 bits),
+        // vertex buffer (6 bits). Collisions only cost efficiency, the
+        // stable sort keeps recording order for equal keys.
+        uint64_t state_sort_key(const program_handle&       program,
+                                const pipeline_state&       state,
+                                const texture_binding_list& textures,
+                                const vertex_buffer_handle& vertices) noexcept
+        {
+            uint64_t texture_hash = 0;
+            for (const auto& b : textures) {
+                texture_hash = texture_hash * 31 +
+                               reinterpret_cast<uintptr_t>(b.texture) +
+                               b.slot;
+            }
+            return ((program.object_index() & 0x3FFull) << 22) |
+                   (fold_bits(state.raw(), 8) << 14) |
+                   (fold_bits(texture_hash, 8) << 6) |
+                   (vertices.object_index() & 0x3Full);
+        }
+    } // namespace
+
     command_buffer::command_buffer(std::pmr::memory_resource* resource)
-        : m_pass_indices(resource)
+        : m_uniform_data(resource)
+        , m_pass_indices(resource)
         , m_sort_keys(resource)
         , m_pipeline_states(resource)
         , m_programs(resource)
         , m_vertex_buffers(resource)
         , m_index_buffers(resource)
         , m_uniform_blocks(resource)
+        , m_uniform_ranges(resource)
         , m_textures(resource)
         , m_index_counts(resource)
         , m_index_offsets(resource)
         , m_scissor_rects(resource)
+        , m_instance_buffers(resource)
+        , m_instance_counts(resource)
+        , m_opaque_draws(resource)
+        , m_translucent_draws(resource)
+        , m_sorted_keys(resource)
+        , m_indirect_programs(resource)
+        , m_indirect_vertex_buffers(resource)
+        , m_indirect_index_buffers(resource)
+        , m_indirect_pipeline_states(resource)
+        , m_indirect_uniform_blocks(resource)
+        , m_indirect_uniform_ranges(resource)
+        , m_indirect_textures(resource)
+        , m_indirect_scissor_rects(resource)
+        , m_indirect_command_buffers(resource)
+        , m_indirect_ranges(resource)
+        , m_indirect_draws(resource)
+        , m_dispatch_programs(resource)
+        , m_dispatch_uniform_blocks(resource)
+        , m_dispatch_uniform_ranges(resource)
+        , m_dispatch_storage_buffers(resource)
+        , m_dispatch_groups(resource)
+        , m_dispatches(resource)
     {}
 
-    void command_buffer::bind_texture(uint32_t      slot,
-                                      mge::texture* tex) noexcept
+    void command_buffer::bind_texture(uint32_t slot, mge::texture* tex)
     {
         for (auto& b : m_current_textures) {
             if (b.slot == slot) {
@@ -32,6 +88,110 @@ namespace mge {
         m_current_textures.push_back({slot, tex});
     }
 
+    void command_buffer::bind_storage_buffer(uint32_t              slot,
+                                             mge::hardware_buffer* buffer)
+    {
+        for (auto& b : m_current_storage_buffers) {
+            if (b.slot == slot) {
+                b.buffer = buffer;
+                return;
+            }
+        }
+        m_current_storage_buffers.push_back({slot, buffer});
+    }
+
+    command_buffer::uniform_range command_buffer::snapshot_uniform_block()
+    {
+        uniform_block* block = m_current_uniform_block;
+        if (!block) {
+            return {};
+        }
+        block->sync_from_globals();
+        if (block == m_snapshot_block &&
+            block->version() == m_snapshot_version) {
+            return m_snapshot_range;
+        }
+        const size_t offset = m_uniform_data.size();
+        m_uniform_data.resize(offset + block->data_size());
+        std::memcpy(m_uniform_data.data() + offset,
+                    block->data(),
+                    block->data_size());
+        m_snapshot_block = block;
+        m_snapshot_version = block->version();
+        m_snapshot_range = {static_cast<uint32_t>(offset),
+                            static_cast<uint32_t>(block->data_size())};
+        return m_snapshot_range;
+    }
+
+    bool command_buffer::same_uniform_data(uint32_t              index,
+                                           const command_buffer& other,
+                                           uint32_t other_index) const noexcept
+    {
+        if (this == &other &&
+            m_uniform_ranges[index] == m_uniform_ranges[other_index]) {
+            return true;
+        }
+        const auto data = uniform_data(m_uniform_ranges[index]);
+        const auto other_data =
+            other.uniform_data(other.m_uniform_ranges[other_index]);
+        return std::ranges::equal(data, other_data);
+    }
+
+    void command_buffer::draw_indirect(mge::pass&                   pass,
+                                       const program_handle&        program,
+                                       const vertex_buffer_handle&  vertices,
+                                       const index_buffer_handle&   indices,
+                                       const storage_buffer_handle& commands,
+                                       uint32_t draw_count,
+                                       uint32_t first_command)
+    {
+        pass.touch();
+        if (draw_count != 0) {
+            const uint32_t pass_index = pass.index();
+            if (pass_index >= m_indirect_draws.size()) {
+                m_indirect_draws.resize(pass_index + 1);
+            }
+            m_indirect_draws[pass_index].push_back(
+                static_cast<uint32_t>(m_indirect_programs.size()));
+            m_indirect_programs.push_back(program);
+            m_indirect_vertex_buffers.push_back(vertices);
+            m_indirect_index_buffers.push_back(indices);
+            m_indirect_pipeline_states.push_back(m_current_pipeline_state);
+            m_indirect_uniform_blocks.push_back(m_current_uniform_block);
+            m_indirect_uniform_ranges.push_back(snapshot_uniform_block());
+            m_indirect_textures.push_back(m_current_textures);
+            m_indirect_scissor_rects.push_back(m_current_scissor_rect);
+            m_indirect_command_buffers.push_back(commands);
+            m_indirect_ranges.push_back({first_command, draw_count});
+        }
+        m_current_uniform_block = nullptr;
+        m_current_textures.clear();
+    }
+
+    void command_buffer::dispatch(mge::pass&            pass,
+                                  const program_handle& program,
+                                  uint32_t              groups_x,
+                                  uint32_t              groups_y,
+                                  uint32_t              groups_z)
+    {
+        pass.touch();
+        if (groups_x != 0 && groups_y != 0 && groups_z != 0) {
+            const uint32_t pass_index = pass.index();
+            if (pass_index >= m_dispatches.size()) {
+                m_dispatches.resize(pass_index + 1);
+            }
+            m_dispatches[pass_index].push_back(
+                static_cast<uint32_t>(m_dispatch_programs.size()));
+            m_dispatch_programs.push_back(program);
+            m_dispatch_uniform_blocks.push_back(m_current_uniform_block);
+            m_dispatch_uniform_ranges.push_back(snapshot_uniform_block());
+            m_dispatch_storage_buffers.push_back(m_current_storage_buffers);
+            m_dispatch_groups.push_back({groups_x, groups_y, groups_z});
+        }
+        m_current_uniform_block = nullptr;
+        m_current_storage_buffers.clear();
+    }
+
     void command_buffer::draw(mge::pass&                  pass,
                               const program_handle&       program,
                               const vertex_buffer_handle& vertices,
@@ -39,21 +199,160 @@ namespace mge {
                               uint32_t                    index_count,
                               uint32_t                    index_offset,
                               uint32_t                    sort_key)
+    {
+        draw_instanced(pass,
+                       program,
+                       vertices,
+                       vertex_buffer_handle(),
+                       indices,
+                       1,
+                       index_count,
+                       index_offset,
+                       sort_key);
+    }
+
+    void command_buffer::draw_instanced(mge::pass&                  pass,
+                                        const program_handle&       program,
+                                        const vertex_buffer_handle& vertices,
+                                        const vertex_buffer_handle& instances,
+                                        const index_buffer_handle&  indices,
+                                        uint32_t instance_count,
+                                        uint32_t index_count,
+                                        uint32_t index_offset,
+                                        uint32_t sort_key)
     {
         pass.touch();
-        m_pass_indices.push_back(pass.index());
-        m_sort_keys.push_back(sort_key);
+        if (instance_count == 0) {
+            m_current_uniform_block = nullptr;
+            m_current_textures.clear();
+            return;
+        }
+        const uint32_t pass_index = pass.index();
+        const uint32_t draw_index = static_cast<uint32_t>(m_programs.size());
+        uint64_t       key = 0;
+        if (m_current_pipeline_state.color_blend_operation() ==
+            blend_operation::NONE) {
+            // opaque draws are reordered by state within the same key
+            key = (static_cast<uint64_t>(sort_key) << 32) |
+                  state_sort_key(program,
+                                 m_current_pipeline_state,
+                                 m_current_textures,
+                                 vertices);
+            if (pass_index >= m_opaque_draws.size()) {
+                m_opaque_draws.resize(pass_index + 1);
+            }
+            m_opaque_draws[pass_index].push_back(draw_index);
+        } else {
+            // translucent draws depend on their order, draw back to front
+            // by inverting the depth, equal keys keep recording order
+            constexpr uint32_t depth_mask = (1u << SORT_KEY_DEPTH_BITS) - 1;
+            uint32_t           translucent_key =
+                (sort_key & ~depth_mask) | (~sort_key & depth_mask);
+            key = static_cast<uint64_t>(translucent_key) << 32;
+            if (pass_index >= m_translucent_draws.size()) {
+                m_translucent_draws.resize(pass_index + 1);
+            }
+            m_translucent_draws[pass_index].push_back(draw_index);
+        }
+        m_pass_indices.push_back(pass_index);
+        m_sort_keys.push_back(key);
         m_programs.push_back(program);
         m_vertex_buffers.push_back(vertices);
         m_index_buffers.push_back(indices);
         m_pipeline_states.push_back(m_current_pipeline_state);
         m_uniform_blocks.push_back(m_current_uniform_block);
+        m_uniform_ranges.push_back(snapshot_uniform_block());
         m_textures.push_back(m_current_textures);
         m_index_counts.push_back(index_count);
         m_index_offsets.push_back(index_offset);
         m_scissor_rects.push_back(m_current_scissor_rect);
+        m_instance_buffers.push_back(instances);
+        m_instance_counts.push_back(instance_count);
         m_current_uniform_block = nullptr;
         m_current_textures.clear();
+        m_sorted = false;
+    }
+
+    void command_buffer::sort()
+    {
+        sort_lists(m_opaque_draws);
+        sort_lists(m_translucent_draws);
+        m_sorted = true;
+    }
+
+    void command_buffer::sort_lists(draw_lists& lists)
+    {
+        auto* resource = m_sort_keys.get_allocator().resource();
+        for (auto& draws : lists) {
+            m_sorted_keys.resize(draws.size());
+            for (size_t i = 0; i < draws.size(); ++i) {
+                m_sorted_keys[i] = m_sort_keys[draws[i]];
+            }
+            mge::radix_sort(m_sorted_keys, draws, resource);
+        }
+    }
+
+    bool command_buffer::mergeable(uint32_t first,
+                                   uint32_t second) const noexcept
+    {
+        // compare against the invalid handle, converting a handle to bool
+        // resolves the object
+        const vertex_buffer_handle no_instances;
+        return m_instance_buffers[first] == no_instances &&
+               m_instance_buffers[second] == no_instances &&
+               m_programs[first] == m_programs[second] &&
+               m_vertex_buffers[first] == m_vertex_buffers[second] &&
+               m_index_buffers[first] == m_index_buffers[second] &&
+               m_pipeline_states[first] == m_pipeline_states[second] &&
+               m_uniform_blocks[first] == m_uniform_blocks[second] &&
+               same_uniform_data(first, *this, second) &&
+               m_textures[first] == m_textures[second] &&
+               m_index_counts[first] == m_index_counts[second] &&
+               m_index_offsets[first] == m_index_offsets[second] &&
+               m_scissor_rects[first] == m_scissor_rects[second];
+    }
+
+    bool command_buffer::packable(uint32_t              index,
+                                  const command_buffer& other,
+                                  uint32_t other_index) const noexcept
+    {
+        const uint32_t i = index;
+        const uint32_t j = other_index;
+        return m_programs[i] == other.m_programs[j] &&
+               m_vertex_buffers[i] == other.m_vertex_buffers[j] &&
+               m_index_buffers[i] == other.m_index_buffers[j] &&
+               m_instance_buffers[i] == other.m_instance_buffers[j] &&
+               m_pipeline_states[i] == other.m_pipeline_states[j] &&
+               m_uniform_blocks[i] == other.m_uniform_blocks[j] &&
+               same_uniform_data(i, other, j) &&
+               m_textures[i] == other.m_textures[j] &&
+               m_scissor_rects[i] == other.m_scissor_rects[j];
+    }
+
+    void command_buffer::merge_list(std::pmr::vector<uint32_t>& draws)
+    {
+        if (draws.size() < 2) {
+            return;
+        }
+        size_t out = 0;
+        for (size_t i = 1; i < draws.size(); ++i) {
+            if (mergeable(draws[out], draws[i])) {
+                m_instance_counts[draws[out]] += m_instance_counts[draws[i]];
+            } else {
+                draws[++out] = draws[i];
+            }
+        }
+        draws.resize(out + 1);
+    }
+
+    void command_buffer::merge_instances(uint32_t pass_index)
+    {
+        if (pass_index < m_opaque_draws.size()) {
+            merge_list(m_opaque_draws[pass_index]);
+        }
+        if (pass_index < m_translucent_draws.size()) {
+            merge_list(m_translucent_draws[pass_index]);
+        }
     }
 
     void command_buffer::depth_write(bool enable) noexcept
@@ -2,22 +2,31 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #pragma once
+#include "mge/core/stdexceptions.hpp"
 #include "mge/graphics/cull_mode.hpp"
 #include "mge/graphics/dllexport.hpp"
+#include "mge/graphics/draw_indirect_command.hpp"
 #include "mge/graphics/index_buffer_handle.hpp"
 #include "mge/graphics/pipeline_state.hpp"
 #include "mge/graphics/program_handle.hpp"
 #include "mge/graphics/rectangle.hpp"
+#include "mge/graphics/storage_buffer_handle.hpp"
 #include "mge/graphics/test.hpp"
 #include "mge/graphics/vertex_buffer_handle.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
 #include <memory_resource>
+#include <span>
 #include <vector>
 
 namespace mge {
 
     class pass;
 
+    class hardware_buffer;
     class texture;
     class uniform_block;
 
@@ -28,9 +37,202 @@ namespace mge {
     {
         uint32_t      slot{0};
         mge::texture* texture{nullptr};
+
+        bool operator==(const texture_binding&) const noexcept = default;
+    };
+
+    /**
+     * @brief Texture bindings of a draw command.
+     *
+     * Bindings are stored inline with a fixed capacity, so recording
+     * a draw never allocates for its textures.
+     */
+    class texture_binding_list
+    {
+    public:
+        /// Maximum number of textures bound to one draw command.
+        static constexpr uint32_t MAX_TEXTURE_BINDINGS = 8;
+
+        using value_type = texture_binding;
+        using iterator = texture_binding*;
+        using const_iterator = const texture_binding*;
+
+        texture_binding_list() = default;
+
+        texture_binding_list(std::initializer_list<texture_binding> bindings)
+        {
+            for (const auto& b : bindings) {
+                push_back(b);
+            }
+        }
+
+        /**
+         * @brief Append a binding.
+         * @param binding binding to append
+         * @throws mge::illegal_state if the list is full
+         */
+        void push_back(const texture_binding& binding)
+        {
+            if (m_size == MAX_TEXTURE_BINDINGS) {
+                MGE_THROW(mge::illegal_state)
+                    << "More than " << MAX_TEXTURE_BINDINGS
+                    << " textures bound to draw command";
+            }
+            m_bindings[m_size++] = binding;
+        }
+
+        void clear() noexcept
+        {
+            m_size = 0;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        const texture_binding& operator[](size_t index) const noexcept
+        {
+            return m_bindings[index];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_bindings.data();
+        }
+
+        iterator end() noexcept
+        {
+            return m_bindings.data() + m_size;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_bindings.data();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_bindings.data() + m_size;
+        }
+
+        bool operator==(const texture_binding_list& other) const noexcept
+        {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+    private:
+        std::array<texture_binding, MAX_TEXTURE_BINDINGS> m_bindings{};
+        uint32_t                                          m_size{0};
+    };
+
+    /**
+     * @brief Binding of a storage buffer to a slot.
+     */
+    struct storage_buffer_binding
+    {
+        uint32_t              slot{0};
+        mge::hardware_buffer* buffer{nullptr};
+
+        bool operator==(const storage_buffer_binding&) const noexcept = default;
     };
 
-    using texture_binding_list = std::vector<texture_binding>;
+    /**
+     * @brief Storage buffer bindings of a dispatch command.
+     *
+     * Bindings are stored inline with a fixed capacity, so recording
+     * a dispatch never allocates for its buffers.
+     */
+    class storage_buffer_binding_list
+    {
+    public:
+        /// Maximum number of storage buffers bound to one command.
+        static constexpr uint32_t MAX_STORAGE_BUFFER_BINDINGS = 8;
+
+        using value_type = storage_buffer_binding;
+        using iterator = storage_buffer_binding*;
+        using const_iterator = const storage_buffer_binding*;
+
+        storage_buffer_binding_list() = default;
+
+        storage_buffer_binding_list(
+            std::initializer_list<storage_buffer_binding> bindings)
+        {
+            for (const auto& b : bindings) {
+                push_back(b);
+            }
+        }
+
+        /**
+         * @brief Append a binding.
+         * @param binding binding to append
+         * @throws mge::illegal_state if the list is full
+         */
+        void push_back(const storage_buffer_binding& binding)
+        {
+            if (m_size == MAX_STORAGE_BUFFER_BINDINGS) {
+                MGE_THROW(mge::illegal_state)
+                    << "More than " << MAX_STORAGE_BUFFER_BINDINGS
+                    << " storage buffers bound to dispatch command";
+            }
+            m_bindings[m_size++] = binding;
+        }
+
+        void clear() noexcept
+        {
+            m_size = 0;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return m_size;
+        }
+
+        const storage_buffer_binding& operator[](size_t index) const noexcept
+        {
+            return m_bindings[index];
+        }
+
+        iterator begin() noexcept
+        {
+            return m_bindings.data();
+        }
+
+        iterator end() noexcept
+        {
+            return m_bindings.data() + m_size;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_bindings.data();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_bindings.data() + m_size;
+        }
+
+        bool operator==(const storage_buffer_binding_list& other) const noexcept
+        {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+    private:
+        std::array<storage_buffer_binding, MAX_STORAGE_BUFFER_BINDINGS>
+                 m_bindings{};
+        uint32_t m_size{0};
+    };
 
     /**
      * @brief A command buffer records rendering commands to be
@@ -117,8 +319,12 @@ namespace mge {
         /**
          * @brief Bind a uniform block for subsequent draw commands.
          *
-         * The block is attached to the next draw() call. After draw(),
-         * the binding is cleared.
+         * The block is attached to the next draw() or dispatch() call.
+         * After it, the binding is cleared. The command records a copy
+         * of the block data, after synchronizing the block with the
+         * global uniforms, so the block can be changed for the next
+         * command right away. Commands that bind the block while its
+         * version did not change share one copy.
          *
          * @param block pointer to the uniform block to bind (nullptr to clear)
          */
@@ -135,7 +341,7 @@ namespace mge {
          *
          * @param tex pointer to the texture to bind (nullptr to clear)
          */
-        void bind_texture(mge::texture* tex) noexcept
+        void bind_texture(mge::texture* tex)
         {
             bind_texture(0, tex);
         }
@@ -149,8 +355,28 @@ namespace mge {
          *
          * @param slot texture slot index
          * @param tex  pointer to the texture to bind
+         * @throws mge::illegal_state if more than
+         *  @c texture_binding_list::MAX_TEXTURE_BINDINGS slots are bound
+         */
+        void bind_texture(uint32_t slot, mge::texture* tex);
+
+        /**
+         * @brief Bind a storage buffer to a slot for the next dispatch
+         * command.
+         *
+         * The slot is the binding index of the buffer in the compute
+         * shader. Storage buffers, vertex buffers and index buffers can
+         * be bound, so a compute shader can write vertices or indices
+         * that are drawn later in the same pass. After dispatch(), all
+         * storage buffer bindings are cleared.
+         *
+         * @param slot   storage buffer slot index
+         * @param buffer buffer to bind
+         * @throws mge::illegal_state if more than
+         *  @c storage_buffer_binding_list::MAX_STORAGE_BUFFER_BINDINGS
+         *  slots are bound
          */
-        void bind_texture(uint32_t slot, mge::texture* tex) noexcept;
+        void bind_storage_buffer(uint32_t slot, mge::hardware_buffer* buffer);
 
         /**
          * @brief Set the scissor rectangle for subsequent draw commands.
@@ -177,17 +403,54 @@ namespace mge {
             m_current_scissor_rect = mge::rectangle{};
         }
 
+        /**
+         * @brief Number of bits of the sort key holding the depth.
+         */
+        static constexpr uint32_t SORT_KEY_DEPTH_BITS = 24;
+
+        /**
+         * @brief Build a sort key from a layer and a depth.
+         *
+         * The layer occupies the upper 8 bits, the depth the lower
+         * @c SORT_KEY_DEPTH_BITS bits of the key. Depth values are
+         * clamped.
+         *
+         * @param layer draw layer, lower layers are drawn first
+         * @param depth distance to the viewer, smaller is nearer
+         * @return sort key to pass to @c draw()
+         */
+        static constexpr uint32_t make_sort_key(uint8_t  layer,
+                                                uint32_t depth) noexcept
+        {
+            constexpr uint32_t max_depth = (1u << SORT_KEY_DEPTH_BITS) - 1;
+            return (static_cast<uint32_t>(layer) << SORT_KEY_DEPTH_BITS) |
+                   (depth < max_depth ? depth : max_depth);
+        }
+
         /**
          * @brief Record a draw command into the command buffer.
          *
          * Marks the target @p pass as active.
          *
+         * Draw commands are partitioned into opaque and translucent
+         * (blended) draws when recorded, all opaque draws of a pass are
+         * executed before its translucent draws.
+         *
+         * The sort key consists of a layer and a depth component, see
+         * @c make_sort_key. Opaque draws are executed ordered by ascending
+         * sort key, i.e. front to back within a layer, and draws with equal
+         * sort key are further ordered to minimize state changes
+         * (program, pipeline state, textures, vertex buffer). Translucent
+         * draws are executed by ascending layer and back to front within
+         * a layer, draws with equal sort key keep their recording order.
+         *
          * @param pass        pass to render this draw command into
          * @param program     program to use for drawing
          * @param vertices    vertex buffer to use
          * @param indices     index buffer to use
          * @param index_count number of indices to draw (0 = all)
          * @param index_offset offset in index buffer (in indices, not bytes)
+         * @param sort_key    sort key, 0 to order by state only
          */
         void draw(mge::pass&                  pass,
                   const program_handle&       program,
@@ -197,37 +460,166 @@ namespace mge {
                   uint32_t                    index_offset = 0,
                   uint32_t                    sort_key = 0);
 
+        /**
+         * @brief Record an instanced draw command into the command buffer.
+         *
+         * Draws @p instance_count instances of the geometry. Per-instance
+         * attributes are taken from @p instances, whose layout must have
+         * a non-zero instance step rate. Its attributes follow the
+         * attributes of @p vertices in attribute location order.
+         *
+         * Ordering is the same as for @c draw().
+         *
+         * @param pass           pass to render this draw command into
+         * @param program        program to use for drawing
+         * @param vertices       per-vertex buffer
+         * @param instances      per-instance buffer, may be invalid to
+         *                       draw instances without per-instance data
+         * @param indices        index buffer to use
+         * @param instance_count number of instances to draw
+         * @param index_count    number of indices to draw (0 = all)
+         * @param index_offset   offset in index buffer (in indices)
+         * @param sort_key       sort key, 0 to order by state only
+         */
+        void draw_instanced(mge::pass&                  pass,
+                            const program_handle&       program,
+                            const vertex_buffer_handle& vertices,
+                            const vertex_buffer_handle& instances,
+                            const index_buffer_handle&  indices,
+                            uint32_t                    instance_count,
+                            uint32_t                    index_count = 0,
+                            uint32_t                    index_offset = 0,
+                            uint32_t                    sort_key = 0);
+
+        /**
+         * @brief Record an indirect draw command into the command buffer.
+         *
+         * Marks the target @p pass as active.
+         *
+         * Draws @p draw_count indexed draws whose arguments are read by
+         * the GPU from @p commands, an array of
+         * @c draw_indexed_indirect_command starting at @p first_command.
+         * The commands can be written by a dispatch of the same pass.
+         * Each draw uses the program, buffers, pipeline state, uniform
+         * block, textures and scissor of this command.
+         *
+         * The indirect draws of a pass are executed in recording order
+         * after its dispatches and before its other draw commands, they
+         * are not sorted.
+         *
+         * @param pass          pass to render this draw command into
+         * @param program       program to use for drawing
+         * @param vertices      vertex buffer to use
+         * @param indices       index buffer to use
+         * @param commands      buffer holding the draw arguments
+         * @param draw_count    number of draws to execute
+         * @param first_command index of first command in @p commands
+         */
+        void draw_indirect(mge::pass&                   pass,
+                           const program_handle&        program,
+                           const vertex_buffer_handle&  vertices,
+                           const index_buffer_handle&   indices,
+                           const storage_buffer_handle& commands,
+                           uint32_t                     draw_count,
+                           uint32_t                     first_command = 0);
+
+        /**
+         * @brief Record a compute dispatch into the command buffer.
+         *
+         * Marks the target @p pass as active.
+         *
+         * The dispatches of a pass are executed in recording order
+         * before any draw command of the pass. The backend inserts
+         * barriers so that each dispatch sees the storage writes of the
+         * dispatches before it, and the draws of the pass see the writes
+         * of all its dispatches as vertex, index and shader data. Work
+         * of earlier passes that reads the buffers is finished before
+         * the first dispatch writes them.
+         *
+         * The bound uniform block and storage buffers are attached to
+         * the dispatch, texture bindings are left for the next draw.
+         *
+         * @param pass     pass to execute this dispatch in
+         * @param program  program with a compute shader
+         * @param groups_x number of work groups in x direction
+         * @param groups_y number of work groups in y direction
+         * @param groups_z number of work groups in z direction
+         */
+        void dispatch(mge::pass&            pass,
+                      const program_handle& program,
+                      uint32_t              groups_x,
+                      uint32_t              groups_y = 1,
+                      uint32_t              groups_z = 1);
+
         /**
          * @brief Iterate over all recorded draw commands.
          *
          * Calls @c f for each recorded draw command with the program,
          * vertex buffer, index buffer, pipeline state, uniform block,
-         * texture bindings, index count, index offset, and scissor.
+         * uniform data, texture bindings, index count, index offset,
+         * scissor, instance buffer and instance count. The uniform data
+         * is the copy of the block taken when the draw was recorded,
+         * backends bind it instead of the current block data. The
+         * instance buffer is invalid for draws without per-instance
+         * data.
          *
          * @tparam F callable type
          * @param f callable invoked for each draw command
          */
         template <typename F> void for_each(F&& f) const
         {
-            auto count = m_programs.size();
-            for (size_t i = 0; i < count; ++i) {
-                f(m_programs[i],
-                  m_vertex_buffers[i],
-                  m_index_buffers[i],
-                  m_pipeline_states[i],
-                  m_uniform_blocks[i],
-                  m_textures[i],
-                  m_index_counts[i],
-                  m_index_offsets[i],
-                  m_scissor_rects[i]);
+            auto count = static_cast<uint32_t>(m_programs.size());
+            for (uint32_t i = 0; i < count; ++i) {
+                visit(i, f);
             }
         }
 
+        /**
+         * @brief Sort the recorded draw commands by their sort key.
+         *
+         * Sorts the draw list of each pass used by @c for_each_in_pass
+         * using a radix sort over the index lists, the recorded commands
+         * themselves are not moved. Recording another draw command
+         * invalidates the order until @c sort() is called again.
+         */
+        void sort();
+
+        /**
+         * @brief Merge consecutive identical draws of a pass into
+         * instanced draws.
+         *
+         * Draws without per-instance buffer that use the same program,
+         * buffers, pipeline state, uniform block and data, textures,
+         * index range and scissor and directly follow each other in
+         * execution order are collapsed into one draw with the summed
+         * instance count. Shaders can tell the instances apart by the
+         * instance index. Call after @c sort(), as sorting brings
+         * identical opaque draws together.
+         *
+         * @param pass_index pass to merge draws in
+         */
+        void merge_instances(uint32_t pass_index);
+
+        /**
+         * @brief Whether the execution order is up to date.
+         *
+         * @return true if @c sort() was called after the last recorded draw
+         */
+        bool sorted() const noexcept
+        {
+            return m_sorted;
+        }
+
         /**
          * @brief Iterate over draw commands targeting a specific pass.
          *
          * Calls @c f for each draw command whose target pass index matches
-         * @p pass_index, with the same arguments as @c for_each.
+         * @p pass_index, with the same arguments as @c for_each. Draw
+         * commands are bucketed by pass when recorded, so only the
+         * commands of the pass are visited. Opaque draws are visited
+         * before translucent draws, each in the order established by the
+         * last @c sort(), commands recorded after it follow in recording
+         * order.
          *
          * @tparam F callable type
          * @param pass_index pass index to filter by
@@ -236,34 +628,280 @@ namespace mge {
         template <typename F>
         void for_each_in_pass(uint32_t pass_index, F&& f) const
         {
-            auto count = m_programs.size();
-            for (size_t i = 0; i < count; ++i) {
-                if (m_pass_indices[i] == pass_index) {
-                    f(m_programs[i],
-                      m_vertex_buffers[i],
-                      m_index_buffers[i],
-                      m_pipeline_states[i],
-                      m_uniform_blocks[i],
-                      m_textures[i],
-                      m_index_counts[i],
-                      m_index_offsets[i],
-                      m_scissor_rects[i]);
-                }
+            for_each_opaque_in_pass(pass_index, f);
+            for_each_translucent_in_pass(pass_index, f);
+        }
+
+        /**
+         * @brief Iterate over opaque draw commands targeting a pass.
+         *
+         * Same as @c for_each_in_pass, but only visits draw commands
+         * without blending.
+         *
+         * @tparam F callable type
+         * @param pass_index pass index to filter by
+         * @param f callable invoked for each matching draw command
+         */
+        template <typename F>
+        void for_each_opaque_in_pass(uint32_t pass_index, F&& f) const
+        {
+            for_each_in_list(m_opaque_draws, pass_index, f);
+        }
+
+        /**
+         * @brief Iterate over translucent draw commands targeting a pass.
+         *
+         * Same as @c for_each_in_pass, but only visits draw commands
+         * with blending.
+         *
+         * @tparam F callable type
+         * @param pass_index pass index to filter by
+         * @param f callable invoked for each matching draw command
+         */
+        template <typename F>
+        void for_each_translucent_in_pass(uint32_t pass_index, F&& f) const
+        {
+            for_each_in_list(m_translucent_draws, pass_index, f);
+        }
+
+        /**
+         * @brief Call @c f for a single draw command.
+         *
+         * @tparam F callable type, with the same signature as for
+         *  @c for_each
+         * @param index draw command index, as found in @c opaque_draws
+         *  or @c translucent_draws
+         * @param f callable invoked for the draw command
+         */
+        template <typename F> void visit(uint32_t index, F&& f) const
+        {
+            f(m_programs[index],
+              m_vertex_buffers[index],
+              m_index_buffers[index],
+              m_pipeline_states[index],
+              m_uniform_blocks[index],
+              uniform_data(m_uniform_ranges[index]),
+              m_textures[index],
+              m_index_counts[index],
+              m_index_offsets[index],
+              m_scissor_rects[index],
+              m_instance_buffers[index],
+              m_instance_counts[index]);
+        }
+
+        /**
+         * @brief Iterate over indirect draw commands targeting a pass.
+         *
+         * Calls @c f for each indirect draw command of the pass in
+         * recording order, with the program, vertex buffer, index
+         * buffer, pipeline state, uniform block, uniform data, texture
+         * bindings, scissor, command buffer, index of the first command
+         * and draw count.
+         *
+         * @tparam F callable type
+         * @param pass_index pass index to filter by
+         * @param f callable invoked for each matching indirect draw
+         */
+        template <typename F>
+        void for_each_indirect_draw_in_pass(uint32_t pass_index, F&& f) const
+        {
+            for (uint32_t i : indirect_draws(pass_index)) {
+                visit_indirect_draw(i, f);
+            }
+        }
+
+        /**
+         * @brief Call @c f for a single indirect draw command.
+         *
+         * @tparam F callable type, with the same signature as for
+         *  @c for_each_indirect_draw_in_pass
+         * @param index indirect draw command index, as found in
+         *  @c indirect_draws
+         * @param f callable invoked for the indirect draw command
+         */
+        template <typename F>
+        void visit_indirect_draw(uint32_t index, F&& f) const
+        {
+            const auto& range = m_indirect_ranges[index];
+            f(m_indirect_programs[index],
+              m_indirect_vertex_buffers[index],
+              m_indirect_index_buffers[index],
+              m_indirect_pipeline_states[index],
+              m_indirect_uniform_blocks[index],
+              uniform_data(m_indirect_uniform_ranges[index]),
+              m_indirect_textures[index],
+              m_indirect_scissor_rects[index],
+              m_indirect_command_buffers[index],
+              range[0],
+              range[1]);
+        }
+
+        /**
+         * @brief Indices of the indirect draw commands of a pass, in
+         * recording order.
+         *
+         * @param pass_index pass index
+         * @return indirect draw command indices
+         */
+        std::span<const uint32_t>
+        indirect_draws(uint32_t pass_index) const noexcept
+        {
+            if (pass_index >= m_indirect_draws.size()) {
+                return {};
+            }
+            return m_indirect_draws[pass_index];
+        }
+
+        /**
+         * @brief Iterate over dispatch commands targeting a pass.
+         *
+         * Calls @c f for each dispatch command of the pass in recording
+         * order, with the program, uniform block, uniform data, storage
+         * buffer bindings and the work group counts in x, y and z
+         * direction.
+         *
+         * @tparam F callable type
+         * @param pass_index pass index to filter by
+         * @param f callable invoked for each matching dispatch command
+         */
+        template <typename F>
+        void for_each_dispatch_in_pass(uint32_t pass_index, F&& f) const
+        {
+            for (uint32_t i : dispatches(pass_index)) {
+                visit_dispatch(i, f);
+            }
+        }
+
+        /**
+         * @brief Call @c f for a single dispatch command.
+         *
+         * @tparam F callable type, with the same signature as for
+         *  @c for_each_dispatch_in_pass
+         * @param index dispatch command index, as found in
+         *  @c dispatches
+         * @param f callable invoked for the dispatch command
+         */
+        template <typename F>
+        void visit_dispatch(uint32_t index, F&& f) const
+        {
+            const auto& groups = m_dispatch_groups[index];
+            f(m_dispatch_programs[index],
+              m_dispatch_uniform_blocks[index],
+              uniform_data(m_dispatch_uniform_ranges[index]),
+              m_dispatch_storage_buffers[index],
+              groups[0],
+              groups[1],
+              groups[2]);
+        }
+
+        /**
+         * @brief Indices of the dispatch commands of a pass, in
+         * recording order.
+         *
+         * @param pass_index pass index
+         * @return dispatch command indices
+         */
+        std::span<const uint32_t> dispatches(uint32_t pass_index) const noexcept
+        {
+            if (pass_index >= m_dispatches.size()) {
+                return {};
+            }
+            return m_dispatches[pass_index];
+        }
+
+        /**
+         * @brief Indices of the opaque draw commands of a pass, in
+         * execution order.
+         *
+         * @param pass_index pass index
+         * @return draw command indices
+         */
+        std::span<const uint32_t>
+        opaque_draws(uint32_t pass_index) const noexcept
+        {
+            if (pass_index >= m_opaque_draws.size()) {
+                return {};
+            }
+            return m_opaque_draws[pass_index];
+        }
+
+        /**
+         * @brief Indices of the translucent draw commands of a pass, in
+         * execution order.
+         *
+         * @param pass_index pass index
+         * @return draw command indices
+         */
+        std::span<const uint32_t>
+        translucent_draws(uint32_t pass_index) const noexcept
+        {
+            if (pass_index >= m_translucent_draws.size()) {
+                return {};
             }
+            return m_translucent_draws[pass_index];
+        }
+
+        /**
+         * @brief Full sort key of a draw command, as used by @c sort().
+         *
+         * @param index draw command index
+         * @return sort key
+         */
+        uint64_t draw_sort_key(uint32_t index) const noexcept
+        {
+            return m_sort_keys[index];
+        }
+
+        /**
+         * @brief Whether two draw commands can be submitted as one multi
+         * draw indirect.
+         *
+         * Draws are packable if they use the same program, vertex,
+         * index and instance buffer, pipeline state, uniform block and
+         * data, textures and scissor, i.e. they differ only in index
+         * range and instance count.
+         *
+         * @param index       draw command index in this buffer
+         * @param other       command buffer of the second draw
+         * @param other_index draw command index in @p other
+         * @return @c true if the draws are packable
+         */
+        bool packable(uint32_t              index,
+                      const command_buffer& other,
+                      uint32_t              other_index) const noexcept;
+
+        /**
+         * @brief Indexed indirect command equivalent to a draw command.
+         *
+         * An index count of 0 (draw all indices) is kept and has to be
+         * resolved by the caller.
+         *
+         * @param index draw command index
+         * @return indirect command arguments of the draw
+         */
+        draw_indexed_indirect_command
+        indirect_command(uint32_t index) const noexcept
+        {
+            draw_indexed_indirect_command cmd;
+            cmd.index_count = m_index_counts[index];
+            cmd.instance_count = m_instance_counts[index];
+            cmd.first_index = m_index_offsets[index];
+            return cmd;
         }
 
         /**
          * @brief Check whether the command buffer has no recorded commands.
          *
-         * @return true if no draw commands have been recorded
+         * @return true if no draw or dispatch commands have been recorded
          */
         bool empty() const noexcept
         {
-            return m_programs.empty();
+            return m_programs.empty() && m_indirect_programs.empty() &&
+                   m_dispatch_programs.empty();
         }
 
         /**
-         * @brief Clear all recorded draw commands.
+         * @brief Clear all recorded draw and dispatch commands.
          */
         void clear() noexcept
         {
@@ -274,28 +912,137 @@ namespace mge {
             m_index_buffers.clear();
             m_pipeline_states.clear();
             m_uniform_blocks.clear();
+            m_uniform_ranges.clear();
             m_textures.clear();
             m_index_counts.clear();
             m_index_offsets.clear();
             m_scissor_rects.clear();
+            m_instance_buffers.clear();
+            m_instance_counts.clear();
+            m_indirect_programs.clear();
+            m_indirect_vertex_buffers.clear();
+            m_indirect_index_buffers.clear();
+            m_indirect_pipeline_states.clear();
+            m_indirect_uniform_blocks.clear();
+            m_indirect_uniform_ranges.clear();
+            m_indirect_textures.clear();
+            m_indirect_scissor_rects.clear();
+            m_indirect_command_buffers.clear();
+            m_indirect_ranges.clear();
+            m_dispatch_programs.clear();
+            m_dispatch_uniform_blocks.clear();
+            m_dispatch_uniform_ranges.clear();
+            m_dispatch_storage_buffers.clear();
+            m_dispatch_groups.clear();
+            // keep the per-pass lists to reuse their capacity
+            for (auto& draws : m_opaque_draws) {
+                draws.clear();
+            }
+            for (auto& draws : m_translucent_draws) {
+                draws.clear();
+            }
+            for (auto& draws : m_indirect_draws) {
+                draws.clear();
+            }
+            for (auto& dispatches : m_dispatches) {
+                dispatches.clear();
+            }
+            m_sorted_keys.clear();
+            m_sorted = false;
+            m_uniform_data.clear();
+            m_snapshot_block = nullptr;
         }
 
     private:
+        using draw_lists = std::pmr::vector<std::pmr::vector<uint32_t>>;
+        /// Offset and size of a uniform block copy in @c m_uniform_data.
+        using uniform_range = std::array<uint32_t, 2>;
+
+        std::span<const std::byte>
+        uniform_data(const uniform_range& range) const noexcept
+        {
+            return {m_uniform_data.data() + range[0], range[1]};
+        }
+
+        uniform_range snapshot_uniform_block();
+
+        template <typename F>
+        void for_each_in_list(const draw_lists& lists,
+                              uint32_t          pass_index,
+                              F&                f) const
+        {
+            if (pass_index >= lists.size()) {
+                return;
+            }
+            for (uint32_t i : lists[pass_index]) {
+                visit(i, f);
+            }
+        }
+
+        void sort_lists(draw_lists& lists);
+        bool mergeable(uint32_t first, uint32_t second) const noexcept;
+        bool same_uniform_data(uint32_t              index,
+                               const command_buffer& other,
+                               uint32_t other_index) const noexcept;
+        void merge_list(std::pmr::vector<uint32_t>& draws);
+
         pipeline_state       m_current_pipeline_state{pipeline_state::DEFAULT};
         uniform_block*       m_current_uniform_block{nullptr};
-        texture_binding_list m_current_textures;
-        mge::rectangle       m_current_scissor_rect{};
+        texture_binding_list        m_current_textures;
+        storage_buffer_binding_list m_current_storage_buffers;
+        mge::rectangle              m_current_scissor_rect{};
+
+        /// Copies of the uniform blocks bound to the recorded commands.
+        std::pmr::vector<std::byte> m_uniform_data;
+        /// Block of the last copy, reused while the version is the same.
+        uniform_block* m_snapshot_block{nullptr};
+        uint64_t       m_snapshot_version{0};
+        uniform_range  m_snapshot_range{};
 
         std::pmr::vector<uint32_t>             m_pass_indices;
-        std::pmr::vector<uint32_t>             m_sort_keys;
+        std::pmr::vector<uint64_t>             m_sort_keys;
         std::pmr::vector<pipeline_state>       m_pipeline_states;
         std::pmr::vector<program_handle>       m_programs;
         std::pmr::vector<vertex_buffer_handle> m_vertex_buffers;
         std::pmr::vector<index_buffer_handle>  m_index_buffers;
         std::pmr::vector<uniform_block*>       m_uniform_blocks;
+        std::pmr::vector<uniform_range>        m_uniform_ranges;
         std::pmr::vector<texture_binding_list> m_textures;
         std::pmr::vector<uint32_t>             m_index_counts;
         std::pmr::vector<uint32_t>             m_index_offsets;
         std::pmr::vector<mge::rectangle>       m_scissor_rects;
+        std::pmr::vector<vertex_buffer_handle> m_instance_buffers;
+        std::pmr::vector<uint32_t>             m_instance_counts;
+
+        /// Indices of the opaque draw commands of each pass.
+        draw_lists m_opaque_draws;
+        /// Indices of the translucent draw commands of each pass.
+        draw_lists                 m_translucent_draws;
+        std::pmr::vector<uint64_t> m_sorted_keys;
+        bool                       m_sorted{false};
+
+        std::pmr::vector<program_handle>          m_indirect_programs;
+        std::pmr::vector<vertex_buffer_handle>    m_indirect_vertex_buffers;
+        std::pmr::vector<index_buffer_handle>     m_indirect_index_buffers;
+        std::pmr::vector<pipeline_state>          m_indirect_pipeline_states;
+        std::pmr::vector<uniform_block*>          m_indirect_uniform_blocks;
+        std::pmr::vector<uniform_range>           m_indirect_uniform_ranges;
+        std::pmr::vector<texture_binding_list>    m_indirect_textures;
+        std::pmr::vector<mge::rectangle>          m_indirect_scissor_rects;
+        std::pmr::vector<storage_buffer_handle>   m_indirect_command_buffers;
+        std::pmr::vector<std::array<uint32_t, 2>> m_indirect_ranges;
+        /// Indices of the indirect draw commands of each pass.
+        draw_lists m_indirect_draws;
+
+        using storage_buffer_bindings =
+            std::pmr::vector<storage_buffer_binding_list>;
+
+        std::pmr::vector<program_handle>          m_dispatch_programs;
+        std::pmr::vector<uniform_block*>          m_dispatch_uniform_blocks;
+        std::pmr::vector<uniform_range>           m_dispatch_uniform_ranges;
+        storage_buffer_bindings                   m_dispatch_storage_buffers;
+        std::pmr::vector<std::array<uint32_t, 3>> m_dispatch_groups;
+        /// Indices of the dispatch commands of each pass.
+        draw_lists m_dispatches;
     };
 } // namespace mge
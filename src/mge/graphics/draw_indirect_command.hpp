@@ -0,0 +1,32 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include <cstdint>
+
+namespace mge {
+
+    /**
+     * @brief Arguments of one indexed draw read from a buffer.
+     *
+     * The layout matches the indexed indirect command of OpenGL
+     * (@c DrawElementsIndirectCommand) and Vulkan
+     * (@c VkDrawIndexedIndirectCommand), so buffers of these commands
+     * can be written on the CPU or by a compute shader and consumed by
+     * any backend.
+     */
+    struct draw_indexed_indirect_command
+    {
+        uint32_t index_count{0};    //!< number of indices to draw
+        uint32_t instance_count{0}; //!< number of instances, 0 skips draw
+        uint32_t first_index{0};    //!< offset in index buffer, in indices
+        int32_t  vertex_offset{0};  //!< added to each index
+        uint32_t first_instance{0}; //!< first instance index
+
+        bool operator==(const draw_indexed_indirect_command&) const noexcept =
+            default;
+    };
+
+    static_assert(sizeof(draw_indexed_indirect_command) == 20);
+
+} // namespace mge
@@ -14,6 +14,7 @@ namespace mge {
     class hardware_buffer;
     class index_buffer;
     class vertex_buffer;
+    class storage_buffer;
     class shader;
     class program;
     class frame_buffer;
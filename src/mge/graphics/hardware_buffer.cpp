@@ -2,6 +2,9 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/graphics/hardware_buffer.hpp"
+#include "mge/core/stdexceptions.hpp"
+
+#include <cstring>
 
 namespace mge {
 
@@ -25,4 +28,61 @@ namespace mge {
         return m_size;
     }
 
+    void hardware_buffer::check_range(size_t offset, size_t size) const
+    {
+        if (offset > m_size || size > m_size - offset) {
+            MGE_THROW(out_of_range)
+                << "Range of " << size << " bytes at offset " << offset
+                << " exceeds buffer size " << m_size;
+        }
+    }
+
+    std::span<std::byte> hardware_buffer::map_range(size_t offset, size_t size)
+    {
+        check_range(offset, size);
+        auto* data = static_cast<std::byte*>(on_map_range(offset, size));
+        if (!data) {
+            return {};
+        }
+        return {data, size};
+    }
+
+    void hardware_buffer::flush_range(size_t offset, size_t size)
+    {
+        check_range(offset, size);
+        on_flush_range(offset, size);
+    }
+
+    void hardware_buffer::update(size_t offset, std::span<const std::byte> data)
+    {
+        if (data.empty()) {
+            return;
+        }
+        check_range(offset, data.size());
+        void* mapped = on_map_range(offset, data.size());
+        if (mapped) {
+            std::memcpy(mapped, data.data(), data.size());
+            on_flush_range(offset, data.size());
+        } else {
+            on_update(offset, data.data(), data.size());
+        }
+    }
+
+    void* hardware_buffer::on_map_range(size_t, size_t)
+    {
+        return nullptr;
+    }
+
+    void hardware_buffer::on_flush_range(size_t, size_t) {}
+
+    void
+    hardware_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
+        if (offset != 0 || size != m_size) {
+            MGE_THROW_NOT_IMPLEMENTED
+                << "Partial update of hardware buffer not supported";
+        }
+        on_set_data(const_cast<void*>(data), size);
+    }
+
 } // namespace mge
\ No newline at end of file
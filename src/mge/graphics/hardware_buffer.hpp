@@ -7,7 +7,9 @@
 #include "mge/graphics/dllexport.hpp"
 #include "mge/graphics/graphics_fwd.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace mge {
 
@@ -65,7 +67,83 @@ namespace mge {
          */
         virtual void on_set_data(void* data, size_t data_size) = 0;
 
+        /**
+         * @brief Get writable memory of a range of the buffer.
+         *
+         * Buffers in host visible memory stay mapped for their lifetime,
+         * so this does not call into the graphics API. After writing, the
+         * range must be passed to @c flush_range. The data is written
+         * while the GPU may still read it for frames in flight, so
+         * ranges used by these frames must not be changed.
+         *
+         * @param offset offset in bytes
+         * @param size   size of the range in bytes
+         * @return mapped memory, empty if the buffer memory is not host
+         *  visible
+         * @throws out_of_range if the range exceeds the buffer
+         */
+        std::span<std::byte> map_range(size_t offset, size_t size);
+
+        /**
+         * @brief Make writes to a mapped range visible to the device.
+         *
+         * @param offset offset in bytes
+         * @param size   size of the range in bytes
+         * @throws out_of_range if the range exceeds the buffer
+         */
+        void flush_range(size_t offset, size_t size);
+
+        /**
+         * @brief Write a range of the buffer immediately.
+         *
+         * The data is written into the mapped buffer memory if possible,
+         * otherwise it is passed to the graphics API. It is not retained,
+         * so it may be changed when this method returns. As with
+         * @c map_range, the range must not be in use by frames in flight.
+         *
+         * @param offset offset in bytes
+         * @param data   data to write
+         * @throws out_of_range if the range exceeds the buffer
+         */
+        void update(size_t offset, std::span<const std::byte> data);
+
     protected:
+        /**
+         * @brief Map a range of the buffer.
+         *
+         * The default implementation returns @c nullptr, for buffers
+         * that are not host visible.
+         *
+         * @param offset offset in bytes
+         * @param size   size of the range in bytes
+         * @return pointer to the range, @c nullptr if not mappable
+         */
+        virtual void* on_map_range(size_t offset, size_t size);
+
+        /**
+         * @brief Flush a mapped range of the buffer.
+         *
+         * The default implementation does nothing, for coherent memory.
+         *
+         * @param offset offset in bytes
+         * @param size   size of the range in bytes
+         */
+        virtual void on_flush_range(size_t offset, size_t size);
+
+        /**
+         * @brief Write a range of a buffer that is not mappable.
+         *
+         * The default implementation supports only writing the whole
+         * buffer, through @c on_set_data.
+         *
+         * @param offset offset in bytes
+         * @param data   data to write
+         * @param size   data size in bytes
+         */
+        virtual void on_update(size_t offset, const void* data, size_t size);
+
+        void check_range(size_t offset, size_t size) const;
+
         buffer_type m_type;
         size_t      m_size;
     };
@@ -14,7 +14,8 @@ namespace mge {
     /**
      * An image. Base class for image types.
      *
-     * An image has an extent (size) and a format.
+     * An image has an extent (size) and a format, and optionally a chain
+     * of mip levels.
      * Images are immutable, i.e. format and size cannot change inplace
      */
     class image
@@ -80,6 +81,20 @@ namespace mge {
          */
         virtual size_t binary_size() const = 0;
 
+        /**
+         * @brief Number of mip levels stored in the image.
+         *
+         * Images with more than one level store the smaller levels tightly
+         * packed after the base level (see @c mip_level_offset). Data and
+         * binary size cover all levels.
+         *
+         * @return number of mip levels
+         */
+        virtual uint32_t mip_levels() const noexcept
+        {
+            return 1;
+        }
+
     private:
         image_format m_format;
         mge::extent  m_extent;
@@ -17,6 +17,10 @@ namespace mge {
      * An image format consists of a data format and a data type.
      * The data format describes the layout of the data, e.g. RGB or RGBA.
      * The data type describes the type of the data, e.g. @c float.
+     *
+     * Block compressed formats store blocks of 4x4 pixels, their data
+     * type is the type of the decoded components (@c UINT8 for normalized
+     * formats, @c HALF for BC6H).
      */
     class MGEGRAPHICS_EXPORT image_format
     {
@@ -28,7 +32,17 @@ namespace mge {
             RGBA,
             DEPTH,
             DEPTH_STENCIL,
-            MAX_FORMAT = DEPTH_STENCIL
+            BC1,       //!< RGB with 1 bit alpha, 8 bytes per block
+            BC2,       //!< RGBA with explicit alpha, 16 bytes per block
+            BC3,       //!< RGBA with interpolated alpha, 16 bytes per block
+            BC4,       //!< one channel, 8 bytes per block
+            BC5,       //!< two channels, 16 bytes per block
+            BC6H,      //!< RGB half float, 16 bytes per block
+            BC7,       //!< RGBA, 16 bytes per block
+            ETC2_RGB,  //!< RGB, 8 bytes per block
+            ETC2_RGBA, //!< RGBA, 16 bytes per block
+            ASTC_4x4,  //!< RGBA, 16 bytes per 4x4 block
+            MAX_FORMAT = ASTC_4x4
         };
 
         image_format()
@@ -75,7 +89,56 @@ namespace mge {
                 return 4;
             case data_format::DEPTH:
             case data_format::DEPTH_STENCIL:
+            case data_format::BC4:
                 return 1;
+            case data_format::BC5:
+                return 2;
+            case data_format::BC6H:
+            case data_format::ETC2_RGB:
+                return 3;
+            case data_format::BC1:
+            case data_format::BC2:
+            case data_format::BC3:
+            case data_format::BC7:
+            case data_format::ETC2_RGBA:
+            case data_format::ASTC_4x4:
+                return 4;
+            default:
+                return 0;
+            }
+        }
+
+        /**
+         * @brief Whether the format stores compressed blocks of pixels.
+         *
+         * @return @c true for block compressed formats
+         */
+        inline constexpr bool compressed() const noexcept
+        {
+            return m_format >= data_format::BC1 &&
+                   m_format <= data_format::ASTC_4x4;
+        }
+
+        /**
+         * @brief Size of one compressed block in bytes.
+         *
+         * @return block size in bytes, 0 for uncompressed formats
+         */
+        inline constexpr size_t block_size() const noexcept
+        {
+            switch (m_format) {
+            case data_format::BC1:
+            case data_format::BC4:
+            case data_format::ETC2_RGB:
+                return 8;
+            case data_format::BC2:
+            case data_format::BC3:
+            case data_format::BC5:
+            case data_format::BC6H:
+            case data_format::BC7:
+            case data_format::ETC2_RGBA:
+            case data_format::ASTC_4x4:
+                return 16;
             default:
                 return 0;
             }
@@ -84,13 +147,36 @@ namespace mge {
         /**
          * @brief Size of one pixel in bytes.
          *
-         * @return pixel size in bytes
+         * @return pixel size in bytes, 0 for block compressed formats
          */
         inline size_t binary_size() const noexcept
         {
+            if (compressed()) {
+                return 0;
+            }
             return components() * data_type_size(m_type);
         }
 
+        /**
+         * @brief Size of an image of this format in bytes.
+         *
+         * Block compressed images are padded to whole blocks.
+         *
+         * @param width  image width
+         * @param height image height
+         * @return image size in bytes
+         */
+        inline size_t binary_size(uint32_t width,
+                                  uint32_t height) const noexcept
+        {
+            if (compressed()) {
+                size_t blocks_x = (static_cast<size_t>(width) + 3) / 4;
+                size_t blocks_y = (static_cast<size_t>(height) + 3) / 4;
+                return blocks_x * blocks_y * block_size();
+            }
+            return static_cast<size_t>(width) * height * binary_size();
+        }
+
         inline constexpr bool operator==(const image_format& other) const
         {
             return m_format == other.m_format && m_type == other.m_type;
@@ -4,6 +4,7 @@
 #include "mge/graphics/memory_image.hpp"
 #include "mge/core/memory.hpp"
 #include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/mipmap.hpp"
 
 namespace mge {
     memory_image::memory_image(image_format       format_,
@@ -14,7 +15,7 @@ namespace mge {
         , m_data_size(0)
     {
         if (size == 0) {
-            size = extent_.area() * format_.binary_size();
+            size = format_.binary_size(extent_.width, extent_.height);
             if (size == 0) {
                 MGE_THROW(illegal_argument)
                     << "Size must be specified for format " << format_;
@@ -34,7 +35,7 @@ namespace mge {
         , m_data_size(0)
     {
         if (size == 0) {
-            size = extent_.area() * format_.binary_size();
+            size = format_.binary_size(extent_.width, extent_.height);
             if (size == 0) {
                 MGE_THROW(illegal_argument)
                     << "Size must be specified for format " << format_;
@@ -67,4 +68,27 @@ namespace mge {
         return m_data_size;
     }
 
+    uint32_t memory_image::mip_levels() const noexcept
+    {
+        return m_mip_levels;
+    }
+
+    std::shared_ptr<memory_image>
+    memory_image::create_mip_chain(image_format       format_,
+                                   const mge::extent& extent_,
+                                   uint32_t           mip_levels_)
+    {
+        if (mip_levels_ == 0 || mip_levels_ > mip_level_count(extent_)) {
+            MGE_THROW(illegal_argument)
+                << "Invalid number of mip levels " << mip_levels_
+                << " for extent " << extent_;
+        }
+        auto result = std::make_shared<memory_image>(
+            format_,
+            extent_,
+            mip_level_offset(format_, extent_, mip_levels_));
+        result->m_mip_levels = mip_levels_;
+        return result;
+    }
+
 } // namespace mge
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include "mge/graphics/image.hpp"
 #include "mge/graphics/image_format.hpp"
 
+#include <memory>
+
 namespace mge {
 
     /**
@@ -29,6 +31,19 @@ namespace mge {
 
         virtual ~memory_image();
 
+        /**
+         * @brief Create an image with room for a mip chain.
+         *
+         * @param format_     pixel format
+         * @param extent_     extent of the base level
+         * @param mip_levels_ number of mip levels
+         * @return created image, its data is uninitialized
+         */
+        static std::shared_ptr<memory_image>
+        create_mip_chain(image_format       format_,
+                         const mge::extent& extent_,
+                         uint32_t           mip_levels_);
+
         /** @copydoc image::data() */
         void* data() const override;
 
@@ -38,8 +53,12 @@ namespace mge {
         /** @copydoc image::binary_size() */
         size_t binary_size() const override;
 
+        /** @copydoc image::mip_levels() */
+        uint32_t mip_levels() const noexcept override;
+
     private:
-        void*  m_data;
-        size_t m_data_size;
+        void*    m_data;
+        size_t   m_data_size;
+        uint32_t m_mip_levels{1};
     };
 } // namespace mge
\ No newline at end of file
@@ -0,0 +1,150 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/graphics/mipmap.hpp"
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/image.hpp"
+#include "mge/graphics/memory_image.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
+namespace mge {
+
+    uint32_t mip_level_count(const mge::extent& e) noexcept
+    {
+        uint32_t largest = std::max(e.width, e.height);
+        if (largest == 0) {
+            return 0;
+        }
+        return static_cast<uint32_t>(std::bit_width(largest));
+    }
+
+    mge::extent mip_level_extent(const mge::extent& e, uint32_t level) noexcept
+    {
+        if (level >= 32) {
+            return mge::extent(1, 1);
+        }
+        return mge::extent(std::max(e.width >> level, 1u),
+                           std::max(e.height >> level, 1u));
+    }
+
+    size_t mip_level_offset(const image_format& format,
+                            const mge::extent&  e,
+                            uint32_t            level) noexcept
+    {
+        size_t offset = 0;
+        for (uint32_t l = 0; l < level; ++l) {
+            mge::extent level_extent = mip_level_extent(e, l);
+            offset +=
+                format.binary_size(level_extent.width, level_extent.height);
+        }
+        return offset;
+    }
+
+    namespace {
+
+        template <typename T, size_t C>
+        void downsample(const mge::extent& e, const T* src, T* dst)
+        {
+            const mge::extent next = mip_level_extent(e, 1);
+            const size_t      row = static_cast<size_t>(e.width) * C;
+            for (uint32_t y = 0; y < next.height; ++y) {
+                const uint32_t y0 = std::min(2 * y, e.height - 1);
+                const uint32_t y1 = std::min(2 * y + 1, e.height - 1);
+                const T*       r0 = src + y0 * row;
+                const T*       r1 = src + y1 * row;
+                for (uint32_t x = 0; x < next.width; ++x) {
+                    const size_t x0 = std::min(2 * x, e.width - 1) * C;
+                    const size_t x1 = std::min(2 * x + 1, e.width - 1) * C;
+                    for (size_t c = 0; c < C; ++c) {
+                        if constexpr (std::is_floating_point_v<T>) {
+                            *dst++ = (r0[x0 + c] + r0[x1 + c] + r1[x0 + c] +
+                                      r1[x1 + c]) *
+                                     T(0.25);
+                        } else {
+                            uint32_t sum = uint32_t(r0[x0 + c]) +
+                                           uint32_t(r0[x1 + c]) +
+                                           uint32_t(r1[x0 + c]) +
+                                           uint32_t(r1[x1 + c]);
+                            *dst++ = static_cast<T>((sum + 2) >> 2);
+                        }
+                    }
+                }
+            }
+        }
+
+        template <typename T>
+        void downsample(size_t             components,
+                        const mge::extent& e,
+                        const void*        src,
+                        void*              dst)
+        {
+            const T* s = static_cast<const T*>(src);
+            T*       d = static_cast<T*>(dst);
+            if (components == 3) {
+                downsample<T, 3>(e, s, d);
+            } else {
+                downsample<T, 4>(e, s, d);
+            }
+        }
+
+    } // namespace
+
+    void downsample_box(const image_format& format,
+                        const mge::extent&  e,
+                        const void*         src,
+                        void*               dst)
+    {
+        if (format.format() != image_format::data_format::RGB &&
+            format.format() != image_format::data_format::RGBA) {
+            MGE_THROW(illegal_argument)
+                << "Cannot downsample image of format " << format;
+        }
+        switch (format.type()) {
+        case data_type::UINT8:
+            downsample<uint8_t>(format.components(), e, src, dst);
+            break;
+        case data_type::UINT16:
+            downsample<uint16_t>(format.components(), e, src, dst);
+            break;
+        case data_type::FLOAT:
+            downsample<float>(format.components(), e, src, dst);
+            break;
+        default:
+            MGE_THROW(illegal_argument)
+                << "Cannot downsample image of format " << format;
+        }
+    }
+
+    image_ref generate_mip_chain(const image& img, uint32_t levels)
+    {
+        return generate_mip_chain(img.format(),
+                                  img.extent(),
+                                  img.data(),
+                                  levels);
+    }
+
+    image_ref generate_mip_chain(const image_format& format,
+                                 const mge::extent&  e,
+                                 const void*         data,
+                                 uint32_t            levels)
+    {
+        if (levels == 0) {
+            levels = mip_level_count(e);
+        }
+        auto     result = memory_image::create_mip_chain(format, e, levels);
+        uint8_t* chain = static_cast<uint8_t*>(result->data());
+        std::memcpy(chain, data, mip_level_offset(format, e, 1));
+        for (uint32_t level = 1; level < levels; ++level) {
+            downsample_box(format,
+                           mip_level_extent(e, level - 1),
+                           chain + mip_level_offset(format, e, level - 1),
+                           chain + mip_level_offset(format, e, level));
+        }
+        return result;
+    }
+
+} // namespace mge
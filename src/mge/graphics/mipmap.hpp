@@ -0,0 +1,99 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/graphics/dllexport.hpp"
+#include "mge/graphics/extent.hpp"
+#include "mge/graphics/graphics_fwd.hpp"
+#include "mge/graphics/image_format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mge {
+
+    /**
+     * @brief Number of levels of a full mip chain.
+     *
+     * The chain ends with a level of 1x1 pixels.
+     *
+     * @param e extent of the base level
+     * @return number of levels including the base level
+     */
+    MGEGRAPHICS_EXPORT uint32_t mip_level_count(const mge::extent& e) noexcept;
+
+    /**
+     * @brief Extent of a mip level.
+     *
+     * Each level halves the extent of the previous one, rounded down,
+     * but at least 1.
+     *
+     * @param e     extent of the base level
+     * @param level mip level
+     * @return extent of the level
+     */
+    MGEGRAPHICS_EXPORT mge::extent mip_level_extent(const mge::extent& e,
+                                                    uint32_t level) noexcept;
+
+    /**
+     * @brief Byte offset of a mip level in a mip chain.
+     *
+     * Levels of a mip chain are stored tightly packed, one after the
+     * other, starting with the base level. Levels of block compressed
+     * formats are padded to whole blocks.
+     *
+     * @param format pixel format
+     * @param e      extent of the base level
+     * @param level  mip level
+     * @return offset of the level, the chain size if @c level is the
+     *  number of levels
+     */
+    MGEGRAPHICS_EXPORT size_t mip_level_offset(const image_format& format,
+                                               const mge::extent&  e,
+                                               uint32_t level) noexcept;
+
+    /**
+     * @brief Compute the next mip level with a 2x2 box filter.
+     *
+     * For odd extents the last row or column is repeated. Supported are
+     * RGB and RGBA images of 8 and 16 bit unsigned integers and floats.
+     *
+     * @param format pixel format
+     * @param e      extent of the source level
+     * @param src    source level
+     * @param dst    destination, of the size of the next level
+     * @throws illegal_argument if the format is not supported
+     */
+    MGEGRAPHICS_EXPORT void downsample_box(const image_format& format,
+                                           const mge::extent&  e,
+                                           const void*         src,
+                                           void*               dst);
+
+    /**
+     * @brief Create an image with a mip chain computed on the CPU.
+     *
+     * Used where the GPU does not generate mip levels, and to precompute
+     * mip chains for assets.
+     *
+     * @param img    base level
+     * @param levels number of levels, 0 for a full chain
+     * @return image with mip levels
+     */
+    MGEGRAPHICS_EXPORT image_ref generate_mip_chain(const image& img,
+                                                    uint32_t     levels = 0);
+
+    /**
+     * @brief Create an image with a mip chain computed on the CPU.
+     *
+     * @param format pixel format
+     * @param e      extent of the base level
+     * @param data   base level data
+     * @param levels number of levels, 0 for a full chain
+     * @return image with mip levels
+     */
+    MGEGRAPHICS_EXPORT image_ref generate_mip_chain(const image_format& format,
+                                                    const mge::extent&  e,
+                                                    const void*         data,
+                                                    uint32_t levels = 0);
+
+} // namespace mge
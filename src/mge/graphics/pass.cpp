@@ -17,9 +17,47 @@ namespace mge {
 
     pass::~pass() {}
 
+    pass::pass(pass&& p) noexcept
+        : m_context(p.m_context)
+        , m_frame_buffer(std::move(p.m_frame_buffer))
+        , m_viewport(p.m_viewport)
+        , m_scissor(p.m_scissor)
+        , m_clear_color(p.m_clear_color)
+        , m_clear_depth(p.m_clear_depth)
+        , m_clear_stencil(p.m_clear_stencil)
+        , m_index(p.m_index)
+        , m_active(p.active())
+        , m_clear_color_enabled(p.m_clear_color_enabled)
+        , m_clear_depth_enabled(p.m_clear_depth_enabled)
+        , m_clear_stencil_enabled(p.m_clear_stencil_enabled)
+        , m_auto_instancing(p.m_auto_instancing)
+        , m_draw_packing(p.m_draw_packing)
+    {}
+
+    pass& pass::operator=(pass&& p) noexcept
+    {
+        m_context = p.m_context;
+        m_frame_buffer = std::move(p.m_frame_buffer);
+        m_viewport = p.m_viewport;
+        m_scissor = p.m_scissor;
+        m_clear_color = p.m_clear_color;
+        m_clear_depth = p.m_clear_depth;
+        m_clear_stencil = p.m_clear_stencil;
+        m_index = p.m_index;
+        m_active.store(p.active(), std::memory_order_relaxed);
+        m_clear_color_enabled = p.m_clear_color_enabled;
+        m_clear_depth_enabled = p.m_clear_depth_enabled;
+        m_clear_stencil_enabled = p.m_clear_stencil_enabled;
+        m_auto_instancing = p.m_auto_instancing;
+        m_draw_packing = p.m_draw_packing;
+        return *this;
+    }
+
     void pass::touch()
     {
-        m_active = true;
+        // draws of several threads touch the pass concurrently, the frame
+        // reads the flag after recording has finished
+        m_active.store(true, std::memory_order_relaxed);
     }
 
     void pass::set_rect(const mge::rectangle& r)
@@ -49,7 +87,7 @@ namespace mge {
 
     void pass::reset()
     {
-        m_active = false;
+        m_active.store(false, std::memory_order_relaxed);
         m_viewport = mge::viewport{0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
         m_scissor = mge::rectangle{0, 0, 1, 1};
         m_clear_color = rgba_color{0.0f, 0.0f, 0.0f, 1.0f};
@@ -58,13 +96,25 @@ namespace mge {
         m_clear_color_enabled = false;
         m_clear_depth_enabled = false;
         m_clear_stencil_enabled = false;
+        m_auto_instancing = false;
+        m_draw_packing = false;
+    }
+
+    void pass::set_auto_instancing(bool enable) noexcept
+    {
+        m_auto_instancing = enable;
+    }
+
+    void pass::set_draw_packing(bool enable) noexcept
+    {
+        m_draw_packing = enable;
     }
 
     void pass::clear_color(const rgba_color& color)
     {
         m_clear_color = color;
         m_clear_color_enabled = true;
-        m_active = true;
+        m_active.store(true, std::memory_order_relaxed);
     }
 
     void pass::disable_clear_color()
@@ -76,7 +126,7 @@ namespace mge {
     {
         m_clear_depth = depth;
         m_clear_depth_enabled = true;
-        m_active = true;
+        m_active.store(true, std::memory_order_relaxed);
     }
 
     void pass::disable_clear_depth()
@@ -88,7 +138,7 @@ namespace mge {
     {
         m_clear_stencil = stencil;
         m_clear_stencil_enabled = true;
-        m_active = true;
+        m_active.store(true, std::memory_order_relaxed);
     }
 
     void pass::disable_clear_stencil()
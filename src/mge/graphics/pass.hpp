@@ -10,6 +10,8 @@
 #include "mge/graphics/rgba_color.hpp"
 #include "mge/graphics/viewport.hpp"
 
+#include <atomic>
+
 namespace mge {
 
     /**
@@ -31,9 +33,9 @@ namespace mge {
     {
     public:
         pass(const pass&) = delete;
-        pass(pass&&) noexcept = default;
+        pass(pass&& p) noexcept;
         pass& operator=(const pass&) = delete;
-        pass& operator=(pass&&) = default;
+        pass& operator=(pass&& p) noexcept;
 
         /**
          * @brief Default destructor.
@@ -114,6 +116,30 @@ namespace mge {
          */
         void set_frame_buffer(const frame_buffer_handle& fb) noexcept;
 
+        /**
+         * @brief Enable or disable automatic instancing.
+         *
+         * If enabled, consecutive identical draws of this pass are merged
+         * into a single instanced draw when the frame is rendered, see
+         * @c command_buffer::merge_instances.
+         *
+         * @param enable whether to merge identical draws
+         */
+        void set_auto_instancing(bool enable) noexcept;
+
+        /**
+         * @brief Enable or disable draw packing.
+         *
+         * If enabled, the backend submits runs of consecutive draws of
+         * this pass that differ only in index range and instance count
+         * as one multi draw indirect, see
+         * @c command_buffer::packable. Backends without indirect draw
+         * support ignore this setting.
+         *
+         * @param enable whether to pack compatible draws
+         */
+        void set_draw_packing(bool enable) noexcept;
+
         /**
          * @brief Reset this pass to its initial state.
          */
@@ -134,7 +160,7 @@ namespace mge {
          */
         bool active() const noexcept
         {
-            return m_active;
+            return m_active.load(std::memory_order_relaxed);
         }
 
         /**
@@ -217,6 +243,26 @@ namespace mge {
             return m_clear_stencil_enabled;
         }
 
+        /**
+         * @brief Whether automatic instancing is enabled.
+         *
+         * @return true if identical draws are merged
+         */
+        bool auto_instancing() const noexcept
+        {
+            return m_auto_instancing;
+        }
+
+        /**
+         * @brief Whether draw packing is enabled.
+         *
+         * @return true if compatible draws are packed
+         */
+        bool draw_packing() const noexcept
+        {
+            return m_draw_packing;
+        }
+
         /**
          * @brief Current frame buffer of this pass.
          *
@@ -260,10 +306,13 @@ namespace mge {
         float                    m_clear_depth{1.0f};
         int32_t                  m_clear_stencil{0};
         uint32_t                 m_index{0};
-        bool                     m_active{false};
+        /// Set by draws recorded on any thread, read after recording.
+        std::atomic<bool>        m_active{false};
         bool                     m_clear_color_enabled{false};
         bool                     m_clear_depth_enabled{false};
         bool                     m_clear_stencil_enabled{false};
+        bool                     m_auto_instancing{false};
+        bool                     m_draw_packing{false};
     };
 
 } // namespace mge
\ No newline at end of file
@@ -0,0 +1,115 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/graphics/pipeline_manifest.hpp"
+#include "mge/core/stdexceptions.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+namespace mge {
+
+    namespace {
+        constexpr uint32_t MANIFEST_MAGIC = 0x4d47504d; // 'MGPM'
+        constexpr uint32_t MANIFEST_VERSION = 1;
+
+        template <typename T> void write_value(std::ostream& os, T value)
+        {
+            os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename T> T read_value(std::istream& is)
+        {
+            T value{};
+            is.read(reinterpret_cast<char*>(&value), sizeof(value));
+            if (!is) {
+                MGE_THROW(mge::illegal_argument)
+                    << "Unexpected end of pipeline manifest";
+            }
+            return value;
+        }
+
+        void write_layout(std::ostream& os, const vertex_layout& layout)
+        {
+            write_value(os, static_cast<uint8_t>(layout.formats().size()));
+            for (const auto& el : layout) {
+                write_value(os, static_cast<uint8_t>(el.format.type()));
+                write_value(os, el.format.size());
+                write_value(os, el.format.instance_step_rate());
+                write_value(os, static_cast<uint8_t>(el.semantic));
+            }
+        }
+
+        vertex_layout read_layout(std::istream& is)
+        {
+            vertex_layout layout;
+            auto          count = read_value<uint8_t>(is);
+            for (uint8_t i = 0; i < count; ++i) {
+                auto type = static_cast<data_type>(read_value<uint8_t>(is));
+                auto size = read_value<uint8_t>(is);
+                auto step_rate = read_value<uint8_t>(is);
+                auto semantic =
+                    static_cast<attribute_semantic>(read_value<uint8_t>(is));
+                layout.push_back(vertex_format(type, size, step_rate),
+                                 semantic);
+            }
+            return layout;
+        }
+    } // namespace
+
+    bool pipeline_manifest::add(const entry& e)
+    {
+        if (std::find(m_entries.begin(), m_entries.end(), e) !=
+            m_entries.end()) {
+            return false;
+        }
+        m_entries.push_back(e);
+        return true;
+    }
+
+    void pipeline_manifest::save(std::ostream& os) const
+    {
+        write_value(os, MANIFEST_MAGIC);
+        write_value(os, MANIFEST_VERSION);
+        write_value(os, static_cast<uint32_t>(m_entries.size()));
+        for (const auto& e : m_entries) {
+            write_value(os, e.program);
+            write_value(os, e.state.raw());
+            write_value(os, static_cast<uint8_t>(e.render_target));
+            write_layout(os, e.vertices);
+            write_layout(os, e.instances);
+        }
+    }
+
+    pipeline_manifest pipeline_manifest::load(std::istream& is)
+    {
+        if (read_value<uint32_t>(is) != MANIFEST_MAGIC) {
+            MGE_THROW(mge::illegal_argument) << "Not a pipeline manifest";
+        }
+        auto version = read_value<uint32_t>(is);
+        if (version != MANIFEST_VERSION) {
+            MGE_THROW(mge::illegal_argument)
+                << "Unsupported pipeline manifest version " << version;
+        }
+        pipeline_manifest result;
+        auto              count = read_value<uint32_t>(is);
+        for (uint32_t i = 0; i < count; ++i) {
+            entry e;
+            e.program = read_value<uint64_t>(is);
+            e.state = pipeline_state(read_value<uint64_t>(is));
+            auto t = read_value<uint8_t>(is);
+            if (t > static_cast<uint8_t>(target::FRAME_BUFFER)) {
+                MGE_THROW(mge::illegal_argument)
+                    << "Invalid render target " << static_cast<uint32_t>(t)
+                    << " in pipeline manifest";
+            }
+            e.render_target = static_cast<target>(t);
+            e.vertices = read_layout(is);
+            e.instances = read_layout(is);
+            result.add(e);
+        }
+        return result;
+    }
+
+} // namespace mge
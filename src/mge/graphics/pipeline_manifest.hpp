@@ -0,0 +1,120 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/graphics/dllexport.hpp"
+#include "mge/graphics/pipeline_state.hpp"
+#include "mge/graphics/vertex_layout.hpp"
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace mge {
+
+    /**
+     * @brief List of pipeline keys used by an application.
+     *
+     * A render context records the key of every pipeline it creates.
+     * Saved at the end of a session, the manifest can be passed to
+     * @c render_context::prewarm_pipelines in the next run to create the
+     * pipelines before the first frame instead of on first draw.
+     *
+     * Keys only contain values that are stable across runs: programs are
+     * identified by their source hash, vertex input by the vertex layouts.
+     */
+    class MGEGRAPHICS_EXPORT pipeline_manifest
+    {
+    public:
+        /**
+         * @brief Kind of render target a pipeline renders into.
+         */
+        enum class target : uint8_t
+        {
+            DEFAULT = 0,     //!< default render target of the context
+            FRAME_BUFFER = 1 //!< an offscreen frame buffer
+        };
+
+        /**
+         * @brief Key of one pipeline.
+         */
+        struct entry
+        {
+            uint64_t            program{0}; //!< program source hash
+            mge::vertex_layout  vertices;   //!< vertex buffer layout
+            mge::vertex_layout  instances;  //!< instance layout, may be empty
+            mge::pipeline_state state;
+            target              render_target{target::DEFAULT};
+
+            bool operator==(const entry& e) const = default;
+        };
+
+        using const_iterator = std::vector<entry>::const_iterator;
+
+        pipeline_manifest() = default;
+        pipeline_manifest(const pipeline_manifest&) = default;
+        pipeline_manifest(pipeline_manifest&&) noexcept = default;
+        ~pipeline_manifest() = default;
+
+        pipeline_manifest& operator=(const pipeline_manifest&) = default;
+        pipeline_manifest& operator=(pipeline_manifest&&) noexcept = default;
+
+        /**
+         * @brief Add an entry.
+         *
+         * @param e entry to add
+         * @return @c true if added, @c false if already contained
+         */
+        bool add(const entry& e);
+
+        /**
+         * @brief Number of entries.
+         *
+         * @return entry count
+         */
+        size_t size() const noexcept
+        {
+            return m_entries.size();
+        }
+
+        /**
+         * @brief Whether the manifest is empty.
+         *
+         * @return @c true if there are no entries
+         */
+        bool empty() const noexcept
+        {
+            return m_entries.empty();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return m_entries.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return m_entries.end();
+        }
+
+        /**
+         * @brief Write the manifest in its binary format.
+         *
+         * @param os output stream
+         */
+        void save(std::ostream& os) const;
+
+        /**
+         * @brief Read a manifest written by @c save.
+         *
+         * @param is input stream
+         * @return read manifest
+         * @throw illegal_argument if the data is not a valid manifest
+         */
+        static pipeline_manifest load(std::istream& is);
+
+    private:
+        std::vector<entry> m_entries;
+    };
+
+} // namespace mge
@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/graphics/program.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/core/stdexceptions.hpp"
 #include "mge/graphics/render_context.hpp"
 #include "mge/graphics/uniform_block.hpp"
@@ -28,6 +29,9 @@ namespace mge {
                 << "Shader type must not be shader_type::COMPUTE";
         }
 
+        // shaders may be set in any order, so combine commutatively
+        m_source_hash += s->source_hash();
+
         context().prepare_frame([this, s]() {
             if (!s->initialized()) {
                 MGE_THROW(mge::illegal_argument)
@@ -54,6 +58,7 @@ namespace mge {
     void program::compile_and_link(const shader_language& language,
                                    const std::string_view source)
     {
+        m_source_hash = mge::fnv1a(source, mge::fnv1a(language.name()));
         context().prepare_frame([this, language, source]() {
             this->on_compile_and_link(language, source);
             this->m_needs_link = false;
@@ -94,6 +99,13 @@ namespace mge {
         return m_sampler_bindings;
     }
 
+    const program::storage_buffer_metadata_list&
+    program::storage_buffers() const
+    {
+        assert_linked();
+        return m_storage_buffers;
+    }
+
     uniform_block
     program::create_uniform_block(const std::string& block_name) const
     {
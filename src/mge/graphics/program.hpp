@@ -90,11 +90,22 @@ namespace mge {
 
         using sampler_binding_list = small_vector<sampler_binding, 2>;
 
+        /// Storage buffer description
+        struct storage_buffer_metadata
+        {
+            std::string name;    //!< buffer name
+            uint32_t    binding; //!< binding point/slot
+        };
+
+        using storage_buffer_metadata_list =
+            small_vector<storage_buffer_metadata, 2>;
+
         virtual ~program();
 
         /**
-         * Set a shader object. The shader object must be a shader designated
-         * for the graphics program (not a compute shader).
+         * Set a shader object. A program consists either of graphics
+         * pipeline stages, or of a single compute shader for use in
+         * dispatch commands.
          *
          * @param shader shader object that is set
          */
@@ -154,6 +165,12 @@ namespace mge {
          */
         const sampler_binding_list& sampler_bindings() const;
 
+        /**
+         * Get storage buffer meta data.
+         * @return storage buffers
+         */
+        const storage_buffer_metadata_list& storage_buffers() const;
+
         /**
          * @brief Create a uniform block instance from one of this program's
          * uniform buffers.
@@ -163,12 +180,27 @@ namespace mge {
          */
         uniform_block create_uniform_block(const std::string& block_name) const;
 
+        /**
+         * @brief Hash of the shader sources or code of the program.
+         *
+         * The hash is stable across runs and identifies the program in
+         * persisted data, e.g. pipeline manifests.
+         *
+         * @return source hash, 0 if no shader was set
+         */
+        uint64_t source_hash() const noexcept
+        {
+            return m_source_hash;
+        }
+
     protected:
-        bool                        m_needs_link;
-        attribute_list              m_attributes;
-        uniform_list                m_uniforms;
-        uniform_block_metadata_list m_uniform_block_metadata;
-        sampler_binding_list        m_sampler_bindings;
+        bool                         m_needs_link;
+        attribute_list               m_attributes;
+        uniform_list                 m_uniforms;
+        uniform_block_metadata_list  m_uniform_block_metadata;
+        sampler_binding_list         m_sampler_bindings;
+        storage_buffer_metadata_list m_storage_buffers;
+        uint64_t                     m_source_hash{0};
 
     private:
         void assert_linked() const;
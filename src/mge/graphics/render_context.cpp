@@ -3,6 +3,8 @@
 // All rights reserved.
 #include "mge/graphics/render_context.hpp"
 #include "mge/asset/asset.hpp"
+#include <atomic>
+#include <memory>
 #include <thread>
 #include "mge/asset/asset_source.hpp"
 #include "mge/asset/asset_type.hpp"
@@ -12,7 +14,9 @@
 #include "mge/core/mutex.hpp"
 #include "mge/core/parameter.hpp"
 #include "mge/core/properties.hpp"
+#include "mge/core/radix_sort.hpp"
 #include "mge/core/singleton.hpp"
+#include "mge/core/thread.hpp"
 #include "mge/core/trace.hpp"
 #include "mge/graphics/extent.hpp"
 #include "mge/graphics/frame_buffer.hpp"
@@ -22,8 +26,15 @@
 #include "mge/graphics/program.hpp"
 #include "mge/graphics/render_system.hpp"
 #include "mge/graphics/shader.hpp"
+#include "mge/graphics/storage_buffer.hpp"
 #include "mge/graphics/vertex_buffer.hpp"
 
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace mge {
     extern parameter<bool> p_graphics_record_frames;
 
@@ -32,6 +43,29 @@ namespace mge {
                                       screenshot_at_frame,
                                       "Frame number to capture screenshot",
                                       0);
+    MGE_DEFINE_PARAMETER_WITH_DEFAULT(
+        std::string,
+        graphics,
+        pipeline_manifest,
+        "File to record created pipelines to and prewarm them from, empty "
+        "to disable",
+        "");
+
+    namespace {
+        std::atomic<uint64_t> s_next_render_context_serial{1};
+
+        /// Command buffer of the calling thread in the last used context.
+        struct thread_command_buffer_cache
+        {
+            uint64_t             context_serial{0};
+            mge::command_buffer* buffer{nullptr};
+        };
+
+        thread_local thread_command_buffer_cache t_command_buffer;
+
+        constexpr size_t COMMAND_BUFFER_ARENA_SIZE = 256 * 1024;
+        constexpr uint32_t MAX_PREWARM_THREADS = 4;
+    } // namespace
 
     class render_context_registry
     {
@@ -158,6 +192,10 @@ namespace mge {
         , m_prepare_frame_resource(m_prepare_frame_memory.data(),
                                    m_prepare_frame_memory.size())
         , m_prepare_frame_actions(&m_prepare_frame_resource)
+        , m_command_buffer_memory("command_buffers")
+        , m_command_buffers_lock("render_context::command_buffers")
+        , m_serial(s_next_render_context_serial.fetch_add(1))
+        , m_pipeline_manifest_lock("render_context::pipeline_manifest")
     {
         m_index = render_context_registry::instance->register_context(this);
 
@@ -174,6 +212,24 @@ namespace mge {
 
     render_context::~render_context()
     {
+        const auto& manifest_file =
+            MGE_PARAMETER(graphics, pipeline_manifest).get();
+        if (!manifest_file.empty() && !m_pipeline_manifest.empty()) {
+            try {
+                std::ofstream output(std::filesystem::path(manifest_file),
+                                     std::ios::binary | std::ios::trunc);
+                m_pipeline_manifest.save(output);
+                MGE_DEBUG_TRACE(GRAPHICS,
+                                "Stored {} pipelines in manifest {}",
+                                m_pipeline_manifest.size(),
+                                manifest_file);
+            } catch (const std::exception& e) {
+                MGE_WARNING_TRACE(GRAPHICS,
+                                  "Failed to store pipeline manifest {}: {}",
+                                  manifest_file,
+                                  e.what());
+            }
+        }
         render_context_registry::instance->unregister_context(m_index, this);
     }
 
@@ -213,8 +269,22 @@ namespace mge {
                 throw;
             }
             reset_prepare_frame_actions();
+            // programs are linked by prepare frame actions
+            prewarm_linked_pipelines();
         }
         bool rendered = false;
+        {
+            std::lock_guard<mge::mutex> lock(m_command_buffers_lock);
+            for (auto& slot : m_command_buffers) {
+                slot.buffer->sort();
+                for (const auto& p : m_passes) {
+                    if (p.active() && p.auto_instancing()) {
+                        slot.buffer->merge_instances(p.index());
+                    }
+                }
+            }
+            merge_command_buffers();
+        }
         if (m_passes.size() > 0) {
             for (const auto& p : m_passes)
                 if (p.active()) {
@@ -225,9 +295,25 @@ namespace mge {
                 p.reset();
             }
         }
-        m_command_buffers.visit_all([](auto& entry) {
-            if (entry.second) entry.second->clear();
-        });
+        {
+            std::lock_guard<mge::mutex> lock(m_command_buffers_lock);
+            for (auto& draws : m_pass_draws) {
+                draws.clear();
+            }
+            for (auto& draws : m_pass_indirect_draws) {
+                draws.clear();
+            }
+            for (auto& dispatches : m_pass_dispatches) {
+                dispatches.clear();
+            }
+            // recreate the buffers on the next arena buffer instead of
+            // clearing, the arena releases the memory all at once
+            for (auto& slot : m_command_buffers) {
+                slot.arena->next_frame();
+                std::destroy_at(slot.buffer.get());
+                std::construct_at(slot.buffer.get(), slot.arena->resource());
+            }
+        }
         if (rendered) {
             if (m_screenshot_at_frame != 0 &&
                 m_frame_counter == m_screenshot_at_frame) {
@@ -261,6 +347,17 @@ namespace mge {
         delete vb;
     }
 
+    storage_buffer* render_context::on_create_storage_buffer(size_t)
+    {
+        MGE_THROW_NOT_IMPLEMENTED << "storage buffer creation not implemented";
+        return nullptr;
+    }
+
+    void render_context::on_destroy_storage_buffer(storage_buffer* sb)
+    {
+        delete sb;
+    }
+
     void render_context::on_destroy_shader(shader* s)
     {
         delete s;
@@ -287,11 +384,8 @@ namespace mge {
     {
         std::unique_ptr<shader> ptr{on_create_shader(t)};
         if (ptr) {
-            shader_handle handle{index(),
-                                 0,
-                                 static_cast<uint32_t>(m_shaders.size())};
-            m_shaders.emplace_back(ptr.release());
-            return handle;
+            auto [slot, generation] = m_shaders.insert(ptr.release());
+            return shader_handle{index(), generation, slot};
         } else {
             return shader_handle();
         }
@@ -301,11 +395,8 @@ namespace mge {
     {
         std::unique_ptr<program> ptr{on_create_program()};
         if (ptr) {
-            program_handle handle{index(),
-                                  0,
-                                  static_cast<uint32_t>(m_programs.size())};
-            m_programs.emplace_back(ptr.release());
-            return handle;
+            auto [slot, generation] = m_programs.insert(ptr.release());
+            return program_handle{index(), generation, slot};
         } else {
             return program_handle();
         }
@@ -317,18 +408,14 @@ namespace mge {
         std::unique_ptr<index_buffer> ptr{
             on_create_index_buffer(dt, data_size)};
         if (ptr) {
-            index_buffer_handle handle{
-                index(),
-                0,
-                static_cast<uint32_t>(m_index_buffers.size())};
             if (data) {
                 index_buffer* ib = ptr.get();
                 prepare_frame([ib, data]() {
                     ib->on_set_data(data->data(), data->size());
                 });
             }
-            m_index_buffers.emplace_back(ptr.release());
-            return handle;
+            auto [slot, generation] = m_index_buffers.insert(ptr.release());
+            return index_buffer_handle{index(), generation, slot};
         } else {
             return index_buffer_handle();
         }
@@ -346,18 +433,14 @@ namespace mge {
         std::unique_ptr<vertex_buffer> ptr{
             on_create_vertex_buffer(layout, data_size)};
         if (ptr) {
-            vertex_buffer_handle handle{
-                index(),
-                0,
-                static_cast<uint32_t>(m_vertex_buffers.size())};
             if (data) {
                 vertex_buffer* vb = ptr.get();
                 prepare_frame([vb, data]() {
                     vb->on_set_data(data->data(), data->size());
                 });
             }
-            m_vertex_buffers.emplace_back(ptr.release());
-            return handle;
+            auto [slot, generation] = m_vertex_buffers.insert(ptr.release());
+            return vertex_buffer_handle{index(), generation, slot};
         } else {
             return vertex_buffer_handle();
         }
@@ -370,6 +453,32 @@ namespace mge {
         return create_vertex_buffer(layout, data_size, buffer_ref());
     }
 
+    storage_buffer_handle
+    render_context::create_storage_buffer(size_t            data_size,
+                                          const buffer_ref& data)
+    {
+        std::unique_ptr<storage_buffer> ptr{
+            on_create_storage_buffer(data_size)};
+        if (ptr) {
+            if (data) {
+                storage_buffer* sb = ptr.get();
+                prepare_frame([sb, data]() {
+                    sb->on_set_data(data->data(), data->size());
+                });
+            }
+            auto [slot, generation] = m_storage_buffers.insert(ptr.release());
+            return storage_buffer_handle{index(), generation, slot};
+        } else {
+            return storage_buffer_handle();
+        }
+    }
+
+    storage_buffer_handle
+    render_context::create_storage_buffer(size_t data_size)
+    {
+        return create_storage_buffer(data_size, buffer_ref());
+    }
+
     frame_buffer_handle render_context::create_frame_buffer()
     {
         return create_frame_buffer(frame_buffer_info{});
@@ -382,12 +491,8 @@ namespace mge {
         if (!ptr) {
             MGE_THROW(null_pointer) << "on_create_frame_buffer returned nullptr";
         }
-        frame_buffer_handle handle{
-            index(),
-            0,
-            static_cast<uint32_t>(m_frame_buffers.size())};
-        m_frame_buffers.emplace_back(ptr.release());
-        return handle;
+        auto [slot, generation] = m_frame_buffers.insert(ptr.release());
+        return frame_buffer_handle{index(), generation, slot};
     }
 
     mge::pass& render_context::pass(uint32_t index)
@@ -401,19 +506,298 @@ namespace mge {
 
     mge::command_buffer& render_context::command_buffer(bool clear)
     {
-        auto              tid = std::this_thread::get_id();
-        mge::command_buffer* result = nullptr;
-        if (!m_command_buffers.visit(tid, [&](auto& entry) {
-                if (clear) entry.second->clear();
-                result = entry.second.get();
-            })) {
-            m_command_buffers.emplace(tid,
-                                      std::make_unique<mge::command_buffer>());
-            m_command_buffers.visit(tid, [&](auto& entry) {
-                result = entry.second.get();
-            });
-        }
-        return *result;
+        auto& cached = t_command_buffer;
+        if (cached.context_serial != m_serial) {
+            cached.buffer = thread_command_buffer();
+            cached.context_serial = m_serial;
+        }
+        if (clear) {
+            cached.buffer->clear();
+        }
+        return *cached.buffer;
+    }
+
+    mge::command_buffer* render_context::thread_command_buffer()
+    {
+        auto                        tid = std::this_thread::get_id();
+        std::lock_guard<mge::mutex> lock(m_command_buffers_lock);
+        for (auto& slot : m_command_buffers) {
+            if (slot.thread == tid) {
+                return slot.buffer.get();
+            }
+        }
+        auto& slot = m_command_buffers.emplace_back();
+        slot.thread = tid;
+        slot.arena = std::make_unique<mge::frame_arena>(
+            COMMAND_BUFFER_ARENA_SIZE,
+            &m_command_buffer_memory);
+        slot.buffer =
+            std::make_unique<mge::command_buffer>(slot.arena->resource());
+        return slot.buffer.get();
+    }
+
+    void render_context::merge_command_buffers()
+    {
+        for (auto& draws : m_pass_draws) {
+            draws.clear();
+        }
+        for (auto& draws : m_pass_indirect_draws) {
+            draws.clear();
+        }
+        for (auto& dispatches : m_pass_dispatches) {
+            dispatches.clear();
+        }
+        for (const auto& p : m_passes) {
+            if (!p.active()) {
+                continue;
+            }
+            if (p.index() >= m_pass_draws.size()) {
+                m_pass_draws.resize(p.index() + 1);
+            }
+            merge_draws(p.index(), false);
+            merge_draws(p.index(), true);
+            merge_indirect_draws(p.index());
+            merge_dispatches(p.index());
+        }
+    }
+
+    void render_context::merge_indirect_draws(uint32_t pass_index)
+    {
+        // like dispatches, indirect draws keep their recording order
+        for (const auto& slot : m_command_buffers) {
+            auto list = slot.buffer->indirect_draws(pass_index);
+            if (list.empty()) {
+                continue;
+            }
+            if (pass_index >= m_pass_indirect_draws.size()) {
+                m_pass_indirect_draws.resize(pass_index + 1);
+            }
+            for (uint32_t index : list) {
+                m_pass_indirect_draws[pass_index].push_back(
+                    {slot.buffer.get(), index});
+            }
+        }
+    }
+
+    size_t render_context::pack_draws(const std::vector<merged_draw>& draws,
+                                      size_t                          begin)
+    {
+        m_packed_commands.clear();
+        const merged_draw& first = draws[begin];
+        size_t             end = begin;
+        do {
+            m_packed_commands.push_back(
+                draws[end].buffer->indirect_command(draws[end].index));
+            ++end;
+        } while (end < draws.size() &&
+                 first.buffer->packable(first.index,
+                                        *draws[end].buffer,
+                                        draws[end].index));
+        return end;
+    }
+
+    void render_context::resolve_packed_index_counts(
+        const index_buffer_handle& indices)
+    {
+        for (auto& cmd : m_packed_commands) {
+            if (cmd.index_count == 0) {
+                cmd.index_count =
+                    static_cast<uint32_t>(indices->element_count());
+            }
+        }
+    }
+
+    void render_context::merge_dispatches(uint32_t pass_index)
+    {
+        // dispatches are not reordered, each thread's dispatches run
+        // in recording order, threads in registration order
+        for (const auto& slot : m_command_buffers) {
+            auto list = slot.buffer->dispatches(pass_index);
+            if (list.empty()) {
+                continue;
+            }
+            if (pass_index >= m_pass_dispatches.size()) {
+                m_pass_dispatches.resize(pass_index + 1);
+            }
+            for (uint32_t index : list) {
+                m_pass_dispatches[pass_index].push_back(
+                    {slot.buffer.get(), index});
+            }
+        }
+    }
+
+    void render_context::merge_draws(uint32_t pass_index, bool translucent)
+    {
+        auto&  draws = m_pass_draws[pass_index];
+        size_t first = draws.size();
+        size_t sources = 0;
+        for (const auto& slot : m_command_buffers) {
+            auto list = translucent ? slot.buffer->translucent_draws(pass_index)
+                                    : slot.buffer->opaque_draws(pass_index);
+            if (list.empty()) {
+                continue;
+            }
+            ++sources;
+            for (uint32_t index : list) {
+                draws.push_back({slot.buffer.get(), index});
+            }
+        }
+        // each list is already sorted, only interleave across threads
+        if (sources < 2) {
+            return;
+        }
+        size_t count = draws.size() - first;
+        m_merge_keys.resize(count);
+        m_merge_order.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const auto& d = draws[first + i];
+            m_merge_keys[i] = d.buffer->draw_sort_key(d.index);
+            m_merge_order[i] = static_cast<uint32_t>(i);
+        }
+        // stable, so equal keys stay in thread registration order
+        radix_sort(m_merge_keys, m_merge_order);
+        m_merge_scratch.assign(draws.begin() + first, draws.end());
+        for (size_t i = 0; i < count; ++i) {
+            draws[first + i] = m_merge_scratch[m_merge_order[i]];
+        }
+    }
+
+    size_t render_context::prewarm_pipelines(const pipeline_manifest& manifest)
+    {
+        std::unordered_map<uint64_t, program*> programs;
+        for (auto* p : m_programs) {
+            if (p && !p->needs_link() && p->source_hash() != 0) {
+                programs.emplace(p->source_hash(), p);
+            }
+        }
+
+        std::vector<std::pair<program*, const pipeline_manifest::entry*>>
+            work;
+        for (const auto& e : manifest) {
+            auto it = programs.find(e.program);
+            if (it != programs.end()) {
+                work.emplace_back(it->second, &e);
+            }
+        }
+        if (work.empty()) {
+            return 0;
+        }
+
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> created{0};
+        auto                worker = [&] {
+            for (size_t i = next++; i < work.size(); i = next++) {
+                try {
+                    if (on_prewarm_pipeline(*work[i].first, *work[i].second)) {
+                        ++created;
+                    }
+                } catch (const std::exception& e) {
+                    MGE_WARNING_TRACE(GRAPHICS,
+                                      "Failed to prewarm pipeline: {}",
+                                      e.what());
+                }
+            }
+        };
+
+        uint32_t thread_count =
+            std::min({mge::thread::hardware_concurrency(),
+                      MAX_PREWARM_THREADS,
+                      static_cast<uint32_t>(work.size())});
+        std::vector<std::unique_ptr<mge::thread>> threads;
+        for (uint32_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(
+                std::make_unique<mge::thread>("prewarm_pipelines"));
+            threads.back()->start(worker);
+        }
+        worker();
+        for (auto& t : threads) {
+            t->join();
+        }
+        MGE_DEBUG_TRACE(GRAPHICS,
+                        "Prewarmed {} of {} pipelines",
+                        created.load(),
+                        manifest.size());
+        return created;
+    }
+
+    size_t render_context::prewarm_pipelines()
+    {
+        return prewarm_pipelines(load_pipeline_manifest());
+    }
+
+    pipeline_manifest render_context::load_pipeline_manifest()
+    {
+        const auto& manifest_file =
+            MGE_PARAMETER(graphics, pipeline_manifest).get();
+        if (manifest_file.empty()) {
+            return {};
+        }
+        std::ifstream input(std::filesystem::path(manifest_file),
+                            std::ios::binary);
+        if (!input) {
+            MGE_DEBUG_TRACE(GRAPHICS,
+                            "No pipeline manifest {}",
+                            manifest_file);
+            return {};
+        }
+        try {
+            return pipeline_manifest::load(input);
+        } catch (const mge::illegal_argument& e) {
+            MGE_WARNING_TRACE(GRAPHICS,
+                              "Ignoring pipeline manifest {}: {}",
+                              manifest_file,
+                              e.what());
+            return {};
+        }
+    }
+
+    void render_context::prewarm_linked_pipelines()
+    {
+        if (!m_pending_prewarm_loaded) {
+            m_pending_prewarm_loaded = true;
+            m_pending_prewarm = load_pipeline_manifest();
+        }
+        if (m_pending_prewarm.empty()) {
+            return;
+        }
+
+        std::unordered_set<uint64_t> linked;
+        for (auto* p : m_programs) {
+            if (p && !p->needs_link() && p->source_hash() != 0) {
+                linked.insert(p->source_hash());
+            }
+        }
+        pipeline_manifest ready;
+        pipeline_manifest pending;
+        for (const auto& e : m_pending_prewarm) {
+            if (linked.contains(e.program)) {
+                ready.add(e);
+            } else {
+                pending.add(e);
+            }
+        }
+        m_pending_prewarm = std::move(pending);
+        if (!ready.empty()) {
+            prewarm_pipelines(ready);
+        }
+    }
+
+    pipeline_manifest render_context::recorded_pipelines() const
+    {
+        std::lock_guard<mge::mutex> lock(m_pipeline_manifest_lock);
+        return m_pipeline_manifest;
+    }
+
+    bool render_context::on_prewarm_pipeline(program&,
+                                             const pipeline_manifest::entry&)
+    {
+        return false;
+    }
+
+    void render_context::record_pipeline(const pipeline_manifest::entry& entry)
+    {
+        std::lock_guard<mge::mutex> lock(m_pipeline_manifest_lock);
+        m_pipeline_manifest.add(entry);
     }
 
     mge::viewport render_context::default_viewport() const
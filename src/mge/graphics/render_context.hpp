@@ -14,20 +14,25 @@
 #include "mge/graphics/image_format.hpp"
 #include "mge/graphics/index_buffer_handle.hpp"
 #include "mge/graphics/pass.hpp"
+#include "mge/graphics/pipeline_manifest.hpp"
 #include "mge/graphics/program_handle.hpp"
 #include "mge/graphics/shader_handle.hpp"
 #include "mge/graphics/shader_type.hpp"
+#include "mge/graphics/storage_buffer_handle.hpp"
 #include "mge/graphics/texture_type.hpp"
 #include "mge/graphics/vertex_buffer_handle.hpp"
 #include "mge/graphics/vertex_layout.hpp"
 
+#include "mge/core/frame_arena.hpp"
+#include "mge/core/memory_resource.hpp"
+#include "mge/core/mutex.hpp"
 #include "mge/core/noncopyable.hpp"
-
-#include <boost/unordered/concurrent_flat_map.hpp>
+#include "mge/core/slot_vector.hpp"
 
 #include <memory>
 #include <memory_resource>
 #include <thread>
+#include <type_traits>
 
 namespace mge {
 
@@ -148,6 +153,43 @@ namespace mge {
         vertex_buffer_handle create_vertex_buffer(const vertex_layout& layout,
                                                   size_t data_size);
 
+    protected:
+        /**
+         * @brief Create a storage buffer object.
+         *
+         * The default implementation throws, for backends without
+         * compute support.
+         *
+         * @param data_size size in bytes
+         * @return created storage buffer
+         */
+        virtual storage_buffer* on_create_storage_buffer(size_t data_size);
+
+        /**
+         * @brief Destroy a storage buffer.
+         * @param sb storage buffer to destroy
+         */
+        virtual void on_destroy_storage_buffer(storage_buffer* sb);
+
+    public:
+        /**
+         * @brief Create a storage buffer with initial data.
+         * @param data_size size in bytes
+         * @param data      initial data
+         * @return created storage buffer handle
+         */
+        storage_buffer_handle create_storage_buffer(size_t            data_size,
+                                                    const buffer_ref& data);
+
+        /**
+         * @brief Create a storage buffer.
+         * Its content is undefined until written by set_data() or a
+         * compute shader.
+         * @param data_size size in bytes
+         * @return created storage buffer handle
+         */
+        storage_buffer_handle create_storage_buffer(size_t data_size);
+
     protected:
         /**
          * @brief Create a shader object.
@@ -302,6 +344,14 @@ namespace mge {
 
         /**
          * @brief Get the current command buffer.
+         *
+         * Each thread records into its own command buffer. After the
+         * first call on a thread the buffer is found through a
+         * thread-local cache, so recording takes no lock. Commands are
+         * stored in a per-thread frame arena that is recycled by
+         * @c frame(), the memory use is reported as the @c
+         * command_buffers memory statistics.
+         *
          * @param clear if true, the command buffer is cleared before returning
          * @return command buffer
          */
@@ -312,13 +362,77 @@ namespace mge {
          *
          * This method does the following to process a frame:
          * - Calls all registered prepare frame actions.
+         * - Sorts the recorded draw commands by their sort key.
+         * - Merges identical draws of passes with automatic instancing.
+         * - Merges the draws of all thread command buffers per pass.
          * - Draws all active passes in order.
+         * - Moves the command buffers to the next buffer of their
+         *   frame arena, dropping the recorded commands.
          * - If any pass was active, presents the swap chain.
          *
          */
         void frame();
 
+        /**
+         * @brief Create pipelines ahead of their first use.
+         *
+         * Each manifest entry is matched to a linked program of this
+         * context by its source hash; entries without matching program
+         * are skipped. The pipelines are created on worker threads, the
+         * call returns when all are done.
+         *
+         * The entries of the manifest file configured by the
+         * @c graphics.pipeline_manifest parameter are prewarmed by
+         * @c frame() as soon as their programs are linked, so this only
+         * needs to be called for other manifests.
+         *
+         * @param manifest pipelines to create
+         * @return number of pipelines created
+         */
+        size_t prewarm_pipelines(const pipeline_manifest& manifest);
+
+        /**
+         * @brief Create the pipelines of the manifest file configured by
+         * the @c graphics.pipeline_manifest parameter.
+         *
+         * @return number of pipelines created, 0 if no manifest exists
+         */
+        size_t prewarm_pipelines();
+
+        /**
+         * @brief Keys of all pipelines created so far.
+         *
+         * If the @c graphics.pipeline_manifest parameter is set, the
+         * manifest is written to that file when the context is destroyed.
+         *
+         * @return manifest of created pipelines
+         */
+        pipeline_manifest recorded_pipelines() const;
+
     protected:
+        /**
+         * @brief Create the pipeline of a manifest entry.
+         *
+         * Called concurrently from the worker threads of
+         * @c prewarm_pipelines. The default implementation does nothing,
+         * for backends without explicit pipeline objects.
+         *
+         * @param prog  program of the entry
+         * @param entry pipeline key
+         * @return @c true if a pipeline was created
+         */
+        virtual bool on_prewarm_pipeline(program&                        prog,
+                                         const pipeline_manifest::entry& entry);
+
+        /**
+         * @brief Record the key of a created pipeline.
+         *
+         * Thread-safe, called by backends whenever they create a pipeline.
+         *
+         * @param entry pipeline key
+         */
+        void record_pipeline(const pipeline_manifest::entry& entry);
+
         /**
          * @brief Called when a frame is being presented.
          */
@@ -336,7 +450,12 @@ namespace mge {
          *
          * Calls @c f for each draw command whose pass index matches @p
          * pass_index, with the same arguments as
-         * @c command_buffer::for_each.
+         * @c command_buffer::for_each. The draws of all command buffers
+         * are merged in @c frame(): opaque draws are visited before any
+         * translucent draw, each group ordered by sort key. Draws with
+         * equal keys keep the order of the threads' first recording
+         * and then their recording order, so the result does not depend
+         * on thread scheduling within the frame.
          *
          * @tparam F callable type
          * @param pass_index pass to iterate
@@ -345,12 +464,131 @@ namespace mge {
         template <typename F>
         void for_each_draw_in_pass(uint32_t pass_index, F&& f)
         {
-            m_command_buffers.visit_all([&](auto& entry) {
-                if (entry.second) {
-                    entry.second->for_each_in_pass(pass_index,
-                                                   std::forward<F>(f));
-                }
-            });
+            if (pass_index >= m_pass_draws.size()) {
+                return;
+            }
+            for (const auto& d : m_pass_draws[pass_index]) {
+                d.buffer->visit(d.index, f);
+            }
+        }
+
+        /**
+         * @brief Iterate over the draw commands of a pass, packing runs
+         * of compatible draws.
+         *
+         * Visits the draws in the same order as
+         * @c for_each_draw_in_pass, but consecutive draws that are
+         * @c command_buffer::packable are passed in one call. @c f is
+         * called with the program, vertex buffer, index buffer, pipeline
+         * state, uniform block, uniform data, texture bindings, scissor
+         * and instance buffer of the run and a span with one indexed
+         * indirect command per draw, in which an index count of 0 is
+         * already resolved to the whole index buffer.
+         *
+         * @tparam F callable type
+         * @param pass_index pass to iterate
+         * @param f callable invoked per run of packable draws
+         */
+        template <typename F>
+        void for_each_packed_draw_in_pass(uint32_t pass_index, F&& f)
+        {
+            if (pass_index >= m_pass_draws.size()) {
+                return;
+            }
+            const auto& draws = m_pass_draws[pass_index];
+            size_t      begin = 0;
+            while (begin < draws.size()) {
+                size_t end = pack_draws(draws, begin);
+                draws[begin].buffer->visit(
+                    draws[begin].index,
+                    [&](const program_handle&            program,
+                        const vertex_buffer_handle&      vertices,
+                        const index_buffer_handle&       indices,
+                        const mge::pipeline_state&       state,
+                        mge::uniform_block*              ub,
+                        std::span<const std::byte>       uniform_data,
+                        const mge::texture_binding_list& textures,
+                        uint32_t /*index_count*/,
+                        uint32_t /*index_offset*/,
+                        const mge::rectangle&       scissor,
+                        const vertex_buffer_handle& instances,
+                        uint32_t /*instance_count*/) {
+                        resolve_packed_index_counts(indices);
+                        const std::span<const draw_indexed_indirect_command>
+                            commands(m_packed_commands);
+                        f(program,
+                          vertices,
+                          indices,
+                          state,
+                          ub,
+                          uniform_data,
+                          textures,
+                          scissor,
+                          instances,
+                          commands);
+                    });
+                begin = end;
+            }
+        }
+
+        /**
+         * @brief Iterate over all indirect draw commands targeting a
+         * pass across all thread command buffers.
+         *
+         * Calls @c f with the same arguments as
+         * @c command_buffer::for_each_indirect_draw_in_pass. The indirect
+         * draws of each thread are visited in recording order, threads
+         * in the order of their first recording.
+         *
+         * @tparam F callable type
+         * @param pass_index pass to iterate
+         * @param f callable invoked per matching indirect draw command
+         */
+        template <typename F>
+        void for_each_indirect_draw_in_pass(uint32_t pass_index, F&& f)
+        {
+            if (pass_index >= m_pass_indirect_draws.size()) {
+                return;
+            }
+            for (const auto& d : m_pass_indirect_draws[pass_index]) {
+                d.buffer->visit_indirect_draw(d.index, f);
+            }
+        }
+
+        /**
+         * @brief Iterate over all dispatch commands targeting a pass
+         * across all thread command buffers.
+         *
+         * Calls @c f with the same arguments as
+         * @c command_buffer::for_each_dispatch_in_pass. The dispatches
+         * of each thread are visited in recording order, threads in the
+         * order of their first recording.
+         *
+         * @tparam F callable type
+         * @param pass_index pass to iterate
+         * @param f callable invoked per matching dispatch command
+         */
+        template <typename F>
+        void for_each_dispatch_in_pass(uint32_t pass_index, F&& f)
+        {
+            if (pass_index >= m_pass_dispatches.size()) {
+                return;
+            }
+            for (const auto& d : m_pass_dispatches[pass_index]) {
+                d.buffer->visit_dispatch(d.index, f);
+            }
+        }
+
+        /**
+         * @brief Whether a pass has dispatch commands in this frame.
+         *
+         * @param pass_index pass index
+         * @return @c true if the pass has at least one dispatch
+         */
+        bool has_dispatches(uint32_t pass_index) const noexcept
+        {
+            return pass_index < m_pass_dispatches.size() &&
+                   !m_pass_dispatches[pass_index].empty();
         }
 
     public:
@@ -386,78 +624,53 @@ namespace mge {
         /**
          * @brief Get an object by its handle.
          *
+         * Handles store the generation of their object's slot in the
+         * flags, a handle to a destroyed object whose slot was reused
+         * does not find the new object.
+         *
          * @tparam T object type
          * @param index context index
-         * @param flags object flags
+         * @param flags object slot generation
          * @param object_index object index
          * @return object pointer or nullptr if not found
          */
         template <typename T>
         T* object(uint16_t index, uint16_t flags, uint32_t object_index)
         {
-            if constexpr (std::is_same_v<T, shader>) {
-                if (object_index < m_shaders.size()) {
-                    return m_shaders[object_index];
-                }
-            } else if constexpr (std::is_same_v<T, program>) {
-                if (object_index < m_programs.size()) {
-                    return m_programs[object_index];
-                }
-            } else if constexpr (std::is_same_v<T, index_buffer>) {
-                if (object_index < m_index_buffers.size()) {
-                    return m_index_buffers[object_index];
-                }
-            } else if constexpr (std::is_same_v<T, vertex_buffer>) {
-                if (object_index < m_vertex_buffers.size()) {
-                    return static_cast<vertex_buffer*>(
-                        m_vertex_buffers[object_index]);
-                }
-            } else if constexpr (std::is_same_v<T, frame_buffer>) {
-                if (object_index < m_frame_buffers.size()) {
-                    return m_frame_buffers[object_index];
-                }
-            }
-            return nullptr;
+            return objects<T>().get(object_index, flags);
         }
 
         /**
          * @brief Destroy a context object by type and index.
          *
+         * The object's slot is reused by objects created later. Handles
+         * to objects that are already destroyed are ignored.
+         *
          * @tparam T object type (shader, program, etc.)
          * @param index object type index
-         * @param flags object flags
+         * @param flags object slot generation
          * @param object_index index into the object storage
          */
         template <typename T>
         void
         destroy_object(uint16_t index, uint16_t flags, uint32_t object_index)
         {
+            T* obj = objects<T>().erase(object_index, flags);
+            if (!obj) {
+                return;
+            }
             if constexpr (std::is_same_v<T, shader>) {
-                if (object_index < m_shaders.size()) {
-                    on_destroy_shader(m_shaders[object_index]);
-                    m_shaders[object_index] = nullptr;
-                }
+                on_destroy_shader(obj);
             } else if constexpr (std::is_same_v<T, program>) {
-                if (object_index < m_programs.size()) {
-                    on_destroy_program(m_programs[object_index]);
-                    m_programs[object_index] = nullptr;
-                }
+                on_destroy_program(obj);
             } else if constexpr (std::is_same_v<T, index_buffer>) {
-                if (object_index < m_index_buffers.size()) {
-                    on_destroy_index_buffer(m_index_buffers[object_index]);
-                    m_index_buffers[object_index] = nullptr;
-                }
+                on_destroy_index_buffer(obj);
             } else if constexpr (std::is_same_v<T, vertex_buffer>) {
-                if (object_index < m_vertex_buffers.size()) {
-                    on_destroy_vertex_buffer(static_cast<vertex_buffer*>(
-                        m_vertex_buffers[object_index]));
-                    m_vertex_buffers[object_index] = nullptr;
-                }
+                on_destroy_vertex_buffer(obj);
+            } else if constexpr (std::is_same_v<T, storage_buffer>) {
+                on_destroy_storage_buffer(obj);
             } else if constexpr (std::is_same_v<T, frame_buffer>) {
-                if (object_index < m_frame_buffers.size()) {
-                    on_destroy_frame_buffer(m_frame_buffers[object_index]);
-                    m_frame_buffers[object_index] = nullptr;
-                }
+                on_destroy_frame_buffer(obj);
             }
         }
 
@@ -480,15 +693,37 @@ namespace mge {
         mge::extent         m_window_extent;
         uint16_t            m_index{0xFFFF}; //!< index in registry
 
-        std::vector<shader*>        m_shaders;
-        std::vector<program*>       m_programs;
-        std::vector<index_buffer*>  m_index_buffers;
-        std::vector<vertex_buffer*> m_vertex_buffers;
-        std::vector<frame_buffer*>  m_frame_buffers;
+        mge::slot_vector<shader>        m_shaders;
+        mge::slot_vector<program>       m_programs;
+        mge::slot_vector<index_buffer>  m_index_buffers;
+        mge::slot_vector<vertex_buffer>  m_vertex_buffers;
+        mge::slot_vector<storage_buffer> m_storage_buffers;
+        mge::slot_vector<frame_buffer>   m_frame_buffers;
+
+        template <typename T> mge::slot_vector<T>& objects() noexcept
+        {
+            if constexpr (std::is_same_v<T, shader>) {
+                return m_shaders;
+            } else if constexpr (std::is_same_v<T, program>) {
+                return m_programs;
+            } else if constexpr (std::is_same_v<T, index_buffer>) {
+                return m_index_buffers;
+            } else if constexpr (std::is_same_v<T, vertex_buffer>) {
+                return m_vertex_buffers;
+            } else if constexpr (std::is_same_v<T, storage_buffer>) {
+                return m_storage_buffers;
+            } else {
+                static_assert(std::is_same_v<T, frame_buffer>,
+                              "Unsupported context object type");
+                return m_frame_buffers;
+            }
+        }
 
         using prepare_frame_action = std::function<void()>;
 
         void reset_prepare_frame_actions();
+        void prewarm_linked_pipelines();
+        static pipeline_manifest load_pipeline_manifest();
 
         std::array<std::byte, 65536>           m_prepare_frame_memory;
         std::pmr::monotonic_buffer_resource    m_prepare_frame_resource;
@@ -496,10 +731,40 @@ namespace mge {
 
         std::vector<mge::pass> m_passes;
 
-        boost::concurrent_flat_map<std::thread::id,
-                                   std::unique_ptr<mge::command_buffer>,
-                                   std::hash<std::thread::id>>
-            m_command_buffers;
+        /// Command buffer recorded by one thread.
+        struct command_buffer_slot
+        {
+            std::thread::id                      thread;
+            std::unique_ptr<mge::frame_arena>    arena;
+            std::unique_ptr<mge::command_buffer> buffer;
+        };
+
+        /// Draw command of a merged pass draw list.
+        struct merged_draw
+        {
+            const mge::command_buffer* buffer;
+            uint32_t                   index;
+        };
+
+        mge::named_memory_resource            m_command_buffer_memory;
+        mge::mutex                            m_command_buffers_lock;
+        std::vector<command_buffer_slot>      m_command_buffers;
+        uint64_t                              m_serial{0}; //!< unique per context
+        std::vector<std::vector<merged_draw>> m_pass_draws;
+        std::vector<std::vector<merged_draw>> m_pass_indirect_draws;
+        std::vector<std::vector<merged_draw>> m_pass_dispatches;
+        std::vector<uint64_t>                 m_merge_keys;
+        std::vector<uint32_t>                 m_merge_order;
+        std::vector<merged_draw>              m_merge_scratch;
+
+        /// Commands of the current run of packed draws.
+        std::vector<draw_indexed_indirect_command> m_packed_commands;
+
+        mutable mge::mutex     m_pipeline_manifest_lock;
+        mge::pipeline_manifest m_pipeline_manifest;
+        /// Entries of the manifest file whose programs are not linked yet.
+        mge::pipeline_manifest m_pending_prewarm;
+        bool                   m_pending_prewarm_loaded{false};
 
         bool     m_record_frames{false};
         bool     m_first_frame{true};
@@ -510,6 +775,14 @@ namespace mge {
 
     private:
         void save_screenshot(const image_ref& img, uint64_t frame);
+        mge::command_buffer* thread_command_buffer();
+        void                 merge_command_buffers();
+        void merge_draws(uint32_t pass_index, bool translucent);
+        void merge_dispatches(uint32_t pass_index);
+        void merge_indirect_draws(uint32_t pass_index);
+        size_t pack_draws(const std::vector<merged_draw>& draws,
+                          size_t                          begin);
+        void   resolve_packed_index_counts(const index_buffer_handle& indices);
     };
 
 } // namespace mge
\ No newline at end of file
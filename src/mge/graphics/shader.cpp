@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/graphics/shader.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/graphics/render_context.hpp"
 
 namespace mge {
@@ -15,6 +16,7 @@ namespace mge {
     void shader::compile(std::string_view source)
     {
         m_initialized = false;
+        m_source_hash = mge::fnv1a(source, type_seed());
         auto src = std::make_shared<std::string>(source);
         context().prepare_frame([this, src]() {
             this->on_compile(*src);
@@ -26,6 +28,7 @@ namespace mge {
     void shader::set_code(const mge::buffer& code)
     {
         m_initialized = false;
+        m_source_hash = mge::fnv1a(code.data(), code.size(), type_seed());
         auto c = std::make_shared<mge::buffer>(code);
         context().prepare_frame([this, c]() {
             this->on_set_code(*c);
@@ -34,6 +37,12 @@ namespace mge {
         });
     }
 
+    uint64_t shader::type_seed() const noexcept
+    {
+        auto t = static_cast<uint32_t>(m_type);
+        return mge::fnv1a(&t, sizeof(t));
+    }
+
     shader_type shader::type() const
     {
         return m_type;
@@ -55,6 +55,19 @@ namespace mge {
          */
         bool initialized() const;
 
+        /**
+         * @brief Hash of the source or code the shader was created from.
+         *
+         * The hash is stable across runs and identifies the shader in
+         * persisted data, e.g. pipeline manifests.
+         *
+         * @return source hash, 0 if neither compiled nor set
+         */
+        uint64_t source_hash() const noexcept
+        {
+            return m_source_hash;
+        }
+
         /**
          * @brief Destructor.
          */
@@ -64,7 +77,10 @@ namespace mge {
         virtual void on_compile(std::string_view source) = 0;
         virtual void on_set_code(const mge::buffer& code) = 0;
 
+        uint64_t type_seed() const noexcept;
+
         shader_type m_type;
         bool        m_initialized;
+        uint64_t    m_source_hash{0};
     };
 } // namespace mge
\ No newline at end of file
@@ -0,0 +1,23 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/graphics/shader_cache.hpp"
+#include "mge/core/parameter.hpp"
+
+namespace mge {
+
+    MGE_DEFINE_PARAMETER_WITH_DEFAULT(
+        std::string,
+        graphics,
+        shader_cache,
+        "Directory to store compiled shaders in, empty to disable",
+        "");
+
+    content_cache& shader_cache()
+    {
+        static content_cache cache(
+            std::filesystem::path(MGE_PARAMETER(graphics, shader_cache).get()));
+        return cache;
+    }
+
+} // namespace mge
@@ -0,0 +1,24 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/content_cache.hpp"
+#include "mge/graphics/dllexport.hpp"
+
+namespace mge {
+
+    /**
+     * @brief Process-wide cache of compiled shader code.
+     *
+     * Shader compilers store their output keyed by a hash of source,
+     * target, options and compiler version. The OpenGL backend also
+     * stores linked program binaries, keyed by the program sources and
+     * the driver. Entries are stored in the
+     * directory given by the @c graphics.shader_cache parameter, if it is
+     * set, so that later runs skip compilation.
+     *
+     * @return shader cache
+     */
+    MGEGRAPHICS_EXPORT content_cache& shader_cache();
+
+} // namespace mge
@@ -0,0 +1,30 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/graphics/storage_buffer.hpp"
+#include "mge/core/buffer.hpp"
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/render_context.hpp"
+
+namespace mge {
+    storage_buffer::storage_buffer(render_context& context, size_t data_size)
+        : hardware_buffer(context, buffer_type::STORAGE, data_size)
+    {}
+
+    storage_buffer::~storage_buffer() {}
+
+    void storage_buffer::set_data(const buffer_ref& data)
+    {
+        if (!data || data->empty()) {
+            return;
+        }
+        if (data->size() > size()) {
+            MGE_THROW(illegal_state) << "Data size " << data->size()
+                                     << " exceeds buffer size " << size();
+        }
+        auto self = this;
+        context().prepare_frame(
+            [self, data]() { self->on_set_data(data->data(), data->size()); });
+    }
+
+} // namespace mge
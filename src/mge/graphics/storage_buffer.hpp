@@ -0,0 +1,39 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/buffer.hpp"
+#include "mge/graphics/hardware_buffer.hpp"
+
+namespace mge {
+
+    /**
+     * @brief A storage buffer.
+     *
+     * A storage buffer holds unstructured data that shaders read and
+     * write, e.g. particle state written by a compute shader. Its layout
+     * is defined by the shaders using it.
+     */
+    class MGEGRAPHICS_EXPORT storage_buffer : public hardware_buffer
+    {
+    protected:
+        /**
+         * @brief Constructor.
+         *
+         * @param context   render context
+         * @param data_size size in bytes
+         */
+        storage_buffer(render_context& context, size_t data_size);
+
+    public:
+        ~storage_buffer();
+
+        /**
+         * @brief Set the data of the storage buffer.
+         * The actual data transfer will be deferred to prepare frame time.
+         *
+         * @param data Buffer containing the data to set
+         */
+        void set_data(const buffer_ref& data);
+    };
+} // namespace mge
@@ -0,0 +1,14 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/handle.hpp"
+#include "mge/graphics/dllexport.hpp"
+#include "mge/graphics/graphics_fwd.hpp"
+
+namespace mge {
+
+    using storage_buffer_handle =
+        mge::handle<mge::storage_buffer, mge::render_context>;
+
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "test/benchmark.hpp"
+#include "test/googletest.hpp"
+
+#include "mge/graphics/command_buffer.hpp"
+#include "mge/graphics/pass.hpp"
+
+#include <vector>
+
+namespace {
+    constexpr uint32_t draw_count = 100000;
+    constexpr uint32_t pass_count = 16;
+} // namespace
+
+TEST(benchmark, command_buffer_record_100k_draws_16_passes)
+{
+    std::vector<mge::pass> passes;
+    for (uint32_t i = 0; i < pass_count; ++i) {
+        passes.emplace_back(i);
+    }
+    mge::command_buffer       cb;
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    mge::benchmark().run("command_buffer_record", [&]() {
+        cb.clear();
+        for (uint32_t i = 0; i < draw_count; ++i) {
+            cb.draw(passes[i % pass_count],
+                    mge::program_handle(0, 0, i % 64),
+                    vb,
+                    ib);
+        }
+    });
+}
+
+TEST(benchmark, command_buffer_iterate_100k_draws_16_passes)
+{
+    std::vector<mge::pass> passes;
+    for (uint32_t i = 0; i < pass_count; ++i) {
+        passes.emplace_back(i);
+    }
+    mge::command_buffer       cb;
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+    for (uint32_t i = 0; i < draw_count; ++i) {
+        cb.draw(passes[i % pass_count],
+                mge::program_handle(0, 0, i % 64),
+                vb,
+                ib);
+    }
+
+    mge::benchmark().run("command_buffer_sort", [&]() { cb.sort(); });
+
+    mge::benchmark().run("command_buffer_iterate_passes", [&]() {
+        uint64_t sum = 0;
+        for (uint32_t p = 0; p < pass_count; ++p) {
+            cb.for_each_in_pass(
+                p,
+                [&](const mge::program_handle& prog,
+                    const mge::vertex_buffer_handle& /*v*/,
+                    const mge::index_buffer_handle& /*i*/,
+                    const mge::pipeline_state& /*state*/,
+                    mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
+                    const mge::texture_binding_list& /*textures*/,
+                    uint32_t /*index_count*/,
+                    uint32_t /*index_offset*/,
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
+                    sum += prog.object_index();
+                });
+        }
+        mge::do_not_optimize_away(sum);
+    });
+}
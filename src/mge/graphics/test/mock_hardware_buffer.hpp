@@ -19,4 +19,10 @@ public:
     MOCK_METHOD(void*, on_map, (), ());
     MOCK_METHOD(void, on_unmap, (), ());
     MOCK_METHOD(void, on_set_data, (void* data, size_t data_size), ());
+    MOCK_METHOD(void*, on_map_range, (size_t offset, size_t size), (override));
+    MOCK_METHOD(void, on_flush_range, (size_t offset, size_t size), (override));
+    MOCK_METHOD(void,
+                on_update,
+                (size_t offset, const void* data, size_t size),
+                (override));
 };
@@ -0,0 +1,78 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/block_compression.hpp"
+#include "mge/graphics/memory_image.hpp"
+#include "mge/graphics/mipmap.hpp"
+#include "test/googletest.hpp"
+
+#include <cstring>
+
+using namespace testing;
+
+TEST(block_compression, bc1_solid_color)
+{
+    uint8_t block[64];
+    for (size_t i = 0; i < 16; ++i) {
+        block[4 * i] = 255;
+        block[4 * i + 1] = 0;
+        block[4 * i + 2] = 0;
+        block[4 * i + 3] = 255;
+    }
+    uint8_t out[8];
+    mge::encode_bc1_block(block, out);
+    uint8_t expected[8] = {0x00, 0xF8, 0x00, 0xF8, 0, 0, 0, 0};
+    EXPECT_EQ(0, std::memcmp(expected, out, sizeof(expected)));
+}
+
+TEST(block_compression, bc4_two_values)
+{
+    uint8_t values[16];
+    for (size_t i = 0; i < 16; ++i) {
+        values[i] = i < 8 ? 10 : 200;
+    }
+    uint8_t out[8];
+    mge::encode_bc4_block(values, out);
+    EXPECT_EQ(200, out[0]);
+    EXPECT_EQ(10, out[1]);
+    // first 8 values use the second endpoint (index 1), the others the
+    // first one (index 0)
+    uint8_t expected_indices[6] = {0x49, 0x92, 0x24, 0, 0, 0};
+    EXPECT_EQ(0, std::memcmp(expected_indices, out + 2, 6));
+}
+
+TEST(block_compression, compress_image_with_mip_levels)
+{
+    mge::image_format rgba8(mge::image_format::data_format::RGBA,
+                            mge::data_type::UINT8);
+    auto img = mge::memory_image::create_mip_chain(rgba8,
+                                                   mge::extent(8, 6),
+                                                   4);
+    std::memset(img->data(), 128, img->binary_size());
+
+    auto compressed =
+        mge::compress_image(*img, mge::image_format::data_format::BC3);
+    EXPECT_EQ(mge::image_format(mge::image_format::data_format::BC3,
+                                mge::data_type::UINT8),
+              compressed->format());
+    EXPECT_EQ(4u, compressed->mip_levels());
+    // 8x6 is 2x2 blocks, 4x3 and 2x1 and 1x1 are one block each
+    EXPECT_EQ(7u * 16u, compressed->binary_size());
+}
+
+TEST(block_compression, unsupported_formats)
+{
+    mge::memory_image img(
+        mge::image_format(mge::image_format::data_format::RGBA,
+                          mge::data_type::FLOAT),
+        mge::extent(4, 4));
+    EXPECT_THROW(mge::compress_image(img, mge::image_format::data_format::BC1),
+                 mge::illegal_argument);
+    mge::memory_image img8(
+        mge::image_format(mge::image_format::data_format::RGBA,
+                          mge::data_type::UINT8),
+        mge::extent(4, 4));
+    EXPECT_THROW(mge::compress_image(img8, mge::image_format::data_format::BC7),
+                 mge::illegal_argument);
+}
@@ -4,10 +4,13 @@
 #include "mge/graphics/command_buffer.hpp"
 #include "mge/graphics/pass.hpp"
 #include "mge/graphics/rectangle.hpp"
+#include "mge/graphics/uniform_block.hpp"
 #include "mock_render_context.hpp"
 #include "test/googletest.hpp"
 
+#include <cstring>
 #include <memory_resource>
+#include <thread>
 
 namespace {
     class counting_resource : public std::pmr::memory_resource
@@ -105,10 +108,13 @@ TEST(command_buffer, for_each_verifies_single_draw)
                     const mge::index_buffer_handle&  i,
                     const mge::pipeline_state&       state,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& /*scissor*/) {
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         EXPECT_EQ(p, prog);
         EXPECT_EQ(v, vb);
         EXPECT_EQ(i, ib);
@@ -138,10 +144,13 @@ TEST(command_buffer, for_each_verifies_multiple_draws)
                     const mge::index_buffer_handle&  i,
                     const mge::pipeline_state&       state,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& /*scissor*/) {
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         ++count;
         if (count == 1) {
             EXPECT_EQ(p, prog1);
@@ -184,10 +193,13 @@ TEST(command_buffer, for_each_verifies_blend_states)
                     const mge::index_buffer_handle&  i,
                     const mge::pipeline_state&       state,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& /*scissor*/) {
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         ++count;
         if (count == 1) {
             EXPECT_EQ(state.color_blend_operation(),
@@ -234,10 +246,13 @@ TEST(command_buffer, depth_write_state)
                     const mge::index_buffer_handle&  i,
                     const mge::pipeline_state&       state,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& /*scissor*/) {
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         ++count;
         if (count == 1) {
             EXPECT_TRUE(state.depth_write());
@@ -275,10 +290,13 @@ TEST(command_buffer, depth_test_function_state)
                     const mge::index_buffer_handle&  i,
                     const mge::pipeline_state&       state,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& /*scissor*/) {
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         ++count;
         if (count == 1) {
             EXPECT_EQ(state.depth_test_function(), mge::test::LESS);
@@ -309,10 +327,13 @@ TEST(command_buffer, scissor_default_is_zero_area)
             const mge::index_buffer_handle& /*i*/,
             const mge::pipeline_state& /*state*/,
             mge::uniform_block* /*ub*/,
+            std::span<const std::byte> /*uniform_data*/,
             const mge::texture_binding_list& /*textures*/,
             uint32_t /*index_count*/,
             uint32_t /*index_offset*/,
-            const mge::rectangle& scissor) { EXPECT_EQ(scissor.area(), 0u); });
+            const mge::rectangle& scissor,
+            const mge::vertex_buffer_handle& /*instances*/,
+            uint32_t /*instance_count*/) { EXPECT_EQ(scissor.area(), 0u); });
 }
 
 TEST(command_buffer, set_scissor_persists_across_draws)
@@ -334,10 +355,13 @@ TEST(command_buffer, set_scissor_persists_across_draws)
                     const mge::index_buffer_handle& /*i*/,
                     const mge::pipeline_state& /*state*/,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& scissor) {
+                    const mge::rectangle& scissor,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         EXPECT_EQ(scissor, sr);
         ++count;
     });
@@ -364,10 +388,13 @@ TEST(command_buffer, clear_scissor_resets)
                     const mge::index_buffer_handle& /*i*/,
                     const mge::pipeline_state& /*state*/,
                     mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
                     const mge::texture_binding_list& /*textures*/,
                     uint32_t /*index_count*/,
                     uint32_t /*index_offset*/,
-                    const mge::rectangle& scissor) {
+                    const mge::rectangle& scissor,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
         ++count;
         if (count == 1) {
             EXPECT_EQ(scissor, sr);
@@ -377,3 +404,671 @@ TEST(command_buffer, clear_scissor_resets)
     });
     EXPECT_EQ(count, 2u);
 }
+
+namespace {
+    std::vector<uint32_t> programs_in_pass(const mge::command_buffer& cb,
+                                           uint32_t                   pass)
+    {
+        std::vector<uint32_t> result;
+        cb.for_each_in_pass(
+            pass,
+            [&](const mge::program_handle& p,
+                const mge::vertex_buffer_handle& /*v*/,
+                const mge::index_buffer_handle& /*i*/,
+                const mge::pipeline_state& /*state*/,
+                mge::uniform_block* /*ub*/,
+                std::span<const std::byte> /*uniform_data*/,
+                const mge::texture_binding_list& /*textures*/,
+                uint32_t /*index_count*/,
+                uint32_t /*index_offset*/,
+                const mge::rectangle& /*scissor*/,
+                const mge::vertex_buffer_handle& /*instances*/,
+                uint32_t /*instance_count*/) {
+                result.push_back(p.object_index());
+            });
+        return result;
+    }
+} // namespace
+
+TEST(command_buffer, sort_orders_by_user_key)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 0, 0, 3);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib, 0, 0, 1);
+    cb.draw(p, mge::program_handle(0, 0, 3), vb, ib, 0, 0, 2);
+    EXPECT_FALSE(cb.sorted());
+
+    cb.sort();
+    EXPECT_TRUE(cb.sorted());
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{2, 3, 1}));
+}
+
+TEST(command_buffer, sort_groups_opaque_draws_by_program)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+
+    cb.sort();
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{1, 1, 2, 2}));
+}
+
+TEST(command_buffer, sort_keeps_blended_draw_order)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.blend_equation(mge::blend_operation::ADD);
+    cb.draw(p, mge::program_handle(0, 0, 3), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib);
+
+    cb.sort();
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{3, 1, 2}));
+}
+
+TEST(command_buffer, draw_after_sort_invalidates_order)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib);
+    cb.sort();
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    EXPECT_FALSE(cb.sorted());
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{2, 1}));
+}
+
+TEST(command_buffer, for_each_in_pass_visits_only_pass_draws)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p0(0);
+    mge::pass                 p3(3);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p3, mge::program_handle(0, 0, 1), vb, ib);
+    cb.draw(p0, mge::program_handle(0, 0, 2), vb, ib);
+    cb.draw(p3, mge::program_handle(0, 0, 3), vb, ib);
+
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{2}));
+    EXPECT_EQ(programs_in_pass(cb, 3), (std::vector<uint32_t>{1, 3}));
+    EXPECT_TRUE(programs_in_pass(cb, 1).empty());
+    EXPECT_TRUE(programs_in_pass(cb, 7).empty());
+
+    cb.clear();
+    EXPECT_TRUE(programs_in_pass(cb, 3).empty());
+}
+
+TEST(command_buffer, opaque_draws_precede_translucent_draws)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.blend_equation(mge::blend_operation::ADD);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    cb.blend_opaque();
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib);
+    cb.blend_equation(mge::blend_operation::ADD);
+    cb.draw(p, mge::program_handle(0, 0, 3), vb, ib);
+    cb.blend_opaque();
+    cb.draw(p, mge::program_handle(0, 0, 4), vb, ib);
+
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{2, 4, 1, 3}));
+}
+
+TEST(command_buffer, sort_orders_translucent_draws_back_to_front)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.blend_equation(mge::blend_operation::ADD);
+    cb.draw(p,
+            mge::program_handle(0, 0, 1),
+            vb,
+            ib,
+            0,
+            0,
+            mge::command_buffer::make_sort_key(0, 10));
+    cb.draw(p,
+            mge::program_handle(0, 0, 2),
+            vb,
+            ib,
+            0,
+            0,
+            mge::command_buffer::make_sort_key(0, 30));
+    cb.draw(p,
+            mge::program_handle(0, 0, 3),
+            vb,
+            ib,
+            0,
+            0,
+            mge::command_buffer::make_sort_key(1, 50));
+    cb.draw(p,
+            mge::program_handle(0, 0, 4),
+            vb,
+            ib,
+            0,
+            0,
+            mge::command_buffer::make_sort_key(0, 20));
+
+    cb.sort();
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{2, 4, 1, 3}));
+}
+
+TEST(command_buffer, make_sort_key_clamps_depth)
+{
+    EXPECT_EQ(mge::command_buffer::make_sort_key(1, 5), 0x01000005u);
+    EXPECT_EQ(mge::command_buffer::make_sort_key(2, 0xFFFFFFFF), 0x02FFFFFFu);
+}
+
+namespace {
+    std::vector<uint32_t> instance_counts_in_pass(const mge::command_buffer& cb,
+                                                  uint32_t                   pass)
+    {
+        std::vector<uint32_t> result;
+        cb.for_each_in_pass(
+            pass,
+            [&](const mge::program_handle& /*p*/,
+                const mge::vertex_buffer_handle& /*v*/,
+                const mge::index_buffer_handle& /*i*/,
+                const mge::pipeline_state& /*state*/,
+                mge::uniform_block* /*ub*/,
+                std::span<const std::byte> /*uniform_data*/,
+                const mge::texture_binding_list& /*textures*/,
+                uint32_t /*index_count*/,
+                uint32_t /*index_offset*/,
+                const mge::rectangle& /*scissor*/,
+                const mge::vertex_buffer_handle& /*instances*/,
+                uint32_t instance_count) { result.push_back(instance_count); });
+        return result;
+    }
+} // namespace
+
+TEST(command_buffer, draw_instanced_records_instances)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::vertex_buffer_handle instances(0, 0, 7);
+    mge::index_buffer_handle  ib;
+
+    cb.draw_instanced(p, mge::program_handle(0, 0, 1), vb, instances, ib, 42);
+
+    size_t count = 0;
+    cb.for_each([&](const mge::program_handle& /*p*/,
+                    const mge::vertex_buffer_handle& /*v*/,
+                    const mge::index_buffer_handle& /*i*/,
+                    const mge::pipeline_state& /*state*/,
+                    mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
+                    const mge::texture_binding_list& /*textures*/,
+                    uint32_t /*index_count*/,
+                    uint32_t /*index_offset*/,
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& inst,
+                    uint32_t                         instance_count) {
+        EXPECT_EQ(inst.object_index(), 7u);
+        EXPECT_EQ(instance_count, 42u);
+        ++count;
+    });
+    EXPECT_EQ(count, 1u);
+}
+
+TEST(command_buffer, draw_instanced_without_instances_records_nothing)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw_instanced(p, mge::program_handle(0, 0, 1), vb, vb, ib, 0);
+    EXPECT_TRUE(cb.empty());
+    EXPECT_TRUE(p.active());
+}
+
+TEST(command_buffer, merge_instances_collapses_identical_draws)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib, 6);
+
+    cb.sort();
+    cb.merge_instances(0);
+    EXPECT_EQ(programs_in_pass(cb, 0), (std::vector<uint32_t>{1, 2, 2}));
+    EXPECT_EQ(instance_counts_in_pass(cb, 0),
+              (std::vector<uint32_t>{3, 1, 1}));
+}
+
+TEST(command_buffer, merge_instances_skips_instanced_draws)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::vertex_buffer_handle instances(0, 0, 3);
+    mge::index_buffer_handle  ib;
+
+    cb.draw_instanced(p, mge::program_handle(0, 0, 1), vb, instances, ib, 4);
+    cb.draw_instanced(p, mge::program_handle(0, 0, 1), vb, instances, ib, 4);
+
+    cb.sort();
+    cb.merge_instances(0);
+    EXPECT_EQ(instance_counts_in_pass(cb, 0), (std::vector<uint32_t>{4, 4}));
+}
+
+TEST(command_buffer, draws_keep_their_uniform_block_data)
+{
+    mge::program::uniform_block_metadata ub_info;
+    ub_info.name = "ObjectBlock";
+    ub_info.uniforms.push_back(
+        {"brightness", mge::uniform_data_type::FLOAT, 1, 0});
+    mge::uniform_block block(ub_info);
+
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::program_handle       prog(0, 0, 1);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    block.set<float>("brightness", 1.0f);
+    cb.bind_uniform_block(&block);
+    cb.draw(p, prog, vb, ib);
+    block.set<float>("brightness", 2.0f);
+    cb.bind_uniform_block(&block);
+    cb.draw(p, prog, vb, ib);
+    cb.bind_uniform_block(&block);
+    cb.draw(p, prog, vb, ib);
+    block.set<float>("brightness", 3.0f);
+
+    std::vector<float>       values;
+    std::vector<const void*> copies;
+    cb.for_each([&](const mge::program_handle& /*p*/,
+                    const mge::vertex_buffer_handle& /*v*/,
+                    const mge::index_buffer_handle& /*i*/,
+                    const mge::pipeline_state& /*state*/,
+                    mge::uniform_block*              ub,
+                    std::span<const std::byte>       uniform_data,
+                    const mge::texture_binding_list& /*textures*/,
+                    uint32_t /*index_count*/,
+                    uint32_t /*index_offset*/,
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
+        EXPECT_EQ(ub, &block);
+        ASSERT_EQ(uniform_data.size(), block.data_size());
+        float value = 0.0f;
+        std::memcpy(&value, uniform_data.data(), sizeof(value));
+        values.push_back(value);
+        copies.push_back(uniform_data.data());
+    });
+    EXPECT_EQ(values, (std::vector<float>{1.0f, 2.0f, 2.0f}));
+    // an unchanged block is copied once
+    ASSERT_EQ(copies.size(), 3u);
+    EXPECT_NE(copies[0], copies[1]);
+    EXPECT_EQ(copies[1], copies[2]);
+
+    // draws with different block data are not instances of one draw
+    cb.sort();
+    cb.merge_instances(0);
+    EXPECT_EQ(instance_counts_in_pass(cb, 0), (std::vector<uint32_t>{1, 2}));
+}
+
+TEST(command_buffer, visit_calls_single_draw)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 0, 0, 2);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib, 0, 0, 1);
+    cb.sort();
+
+    auto draws = cb.opaque_draws(0);
+    ASSERT_EQ(draws.size(), 2u);
+    EXPECT_TRUE(cb.translucent_draws(0).empty());
+    EXPECT_TRUE(cb.opaque_draws(5).empty());
+    EXPECT_LT(cb.draw_sort_key(draws[0]), cb.draw_sort_key(draws[1]));
+
+    uint32_t program = 0;
+    cb.visit(draws[0],
+             [&](const mge::program_handle& prog,
+                 const mge::vertex_buffer_handle& /*v*/,
+                 const mge::index_buffer_handle& /*i*/,
+                 const mge::pipeline_state& /*state*/,
+                 mge::uniform_block* /*ub*/,
+                 std::span<const std::byte> /*uniform_data*/,
+                 const mge::texture_binding_list& /*textures*/,
+                 uint32_t /*index_count*/,
+                 uint32_t /*index_offset*/,
+                 const mge::rectangle& /*scissor*/,
+                 const mge::vertex_buffer_handle& /*instances*/,
+                 uint32_t /*instance_count*/) {
+                 program = prog.object_index();
+             });
+    EXPECT_EQ(program, 2u);
+}
+
+namespace {
+    class recording_render_context : public MOCK_render_context
+    {
+    public:
+        using MOCK_render_context::MOCK_render_context;
+
+        std::vector<uint32_t> rendered;
+
+    protected:
+        void render(const mge::pass& p) override
+        {
+            for_each_draw_in_pass(
+                p.index(),
+                [&](const mge::program_handle& prog,
+                    const mge::vertex_buffer_handle& /*v*/,
+                    const mge::index_buffer_handle& /*i*/,
+                    const mge::pipeline_state& /*state*/,
+                    mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
+                    const mge::texture_binding_list& /*textures*/,
+                    uint32_t /*index_count*/,
+                    uint32_t /*index_offset*/,
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    uint32_t /*instance_count*/) {
+                    rendered.push_back(prog.object_index());
+                });
+        }
+    };
+} // namespace
+
+TEST(command_buffer, frame_merges_thread_command_buffers)
+{
+    MOCK_render_system        rs;
+    recording_render_context  ctx(rs);
+    auto&                     p = ctx.pass(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    auto& main_buffer = ctx.command_buffer();
+    EXPECT_EQ(&main_buffer, &ctx.command_buffer());
+    main_buffer.draw(p, mge::program_handle(0, 0, 1), vb, ib, 0, 0, 3);
+
+    std::thread worker([&] {
+        auto& cb = ctx.command_buffer();
+        EXPECT_NE(&cb, &main_buffer);
+        cb.draw(p, mge::program_handle(0, 0, 2), vb, ib, 0, 0, 1);
+        cb.draw(p, mge::program_handle(0, 0, 3), vb, ib, 0, 0, 2);
+        cb.blend_equation(mge::blend_operation::ADD);
+        cb.draw(p, mge::program_handle(0, 0, 6), vb, ib);
+    });
+    worker.join();
+
+    main_buffer.draw(p, mge::program_handle(0, 0, 4), vb, ib, 0, 0, 4);
+    // equal translucent keys keep the order of the first recording thread
+    main_buffer.blend_equation(mge::blend_operation::ADD);
+    main_buffer.draw(p, mge::program_handle(0, 0, 5), vb, ib);
+
+    EXPECT_CALL(ctx, on_frame_present()).Times(1);
+    ctx.frame();
+    EXPECT_EQ(ctx.rendered, (std::vector<uint32_t>{2, 3, 1, 4, 5, 6}));
+    EXPECT_TRUE(ctx.command_buffer().empty());
+}
+
+TEST(command_buffer, bind_texture_beyond_capacity_throws)
+{
+    mge::command_buffer cb;
+    for (uint32_t i = 0; i < mge::texture_binding_list::MAX_TEXTURE_BINDINGS;
+         ++i) {
+        cb.bind_texture(i, nullptr);
+    }
+    // rebinding a used slot does not take space
+    EXPECT_NO_THROW(cb.bind_texture(0, nullptr));
+    EXPECT_THROW(
+        cb.bind_texture(mge::texture_binding_list::MAX_TEXTURE_BINDINGS,
+                        nullptr),
+        mge::illegal_state);
+}
+
+TEST(command_buffer, dispatch_records_per_pass_in_order)
+{
+    mge::command_buffer cb;
+    mge::pass           p0(0);
+    mge::pass           p2(2);
+
+    cb.dispatch(p2, mge::program_handle(0, 0, 1), 4);
+    cb.dispatch(p0, mge::program_handle(0, 0, 2), 1, 2, 3);
+    cb.dispatch(p2, mge::program_handle(0, 0, 3), 8, 8);
+    EXPECT_FALSE(cb.empty());
+
+    std::vector<uint32_t> programs;
+    std::vector<uint32_t> groups;
+    cb.for_each_dispatch_in_pass(
+        2,
+        [&](const mge::program_handle& p,
+            mge::uniform_block* /*ub*/,
+            std::span<const std::byte> /*uniform_data*/,
+            const mge::storage_buffer_binding_list& /*storage_buffers*/,
+            uint32_t x,
+            uint32_t y,
+            uint32_t z) {
+            programs.push_back(p.object_index());
+            groups.insert(groups.end(), {x, y, z});
+        });
+    EXPECT_EQ(programs, (std::vector<uint32_t>{1, 3}));
+    EXPECT_EQ(groups, (std::vector<uint32_t>{4, 1, 1, 8, 8, 1}));
+    EXPECT_EQ(cb.dispatches(0).size(), 1u);
+    EXPECT_TRUE(cb.dispatches(1).empty());
+    // dispatches are not draws
+    EXPECT_TRUE(programs_in_pass(cb, 2).empty());
+
+    cb.clear();
+    EXPECT_TRUE(cb.empty());
+    EXPECT_TRUE(cb.dispatches(2).empty());
+}
+
+TEST(command_buffer, dispatch_without_work_groups_records_nothing)
+{
+    mge::command_buffer cb;
+    mge::pass           p(0);
+
+    cb.dispatch(p, mge::program_handle(0, 0, 1), 0);
+    cb.dispatch(p, mge::program_handle(0, 0, 1), 4, 0);
+    EXPECT_TRUE(cb.empty());
+}
+
+TEST(command_buffer, dispatch_consumes_storage_buffer_bindings)
+{
+    mge::command_buffer cb;
+    mge::pass           p(0);
+    auto*               a = reinterpret_cast<mge::hardware_buffer*>(0x10);
+    auto*               b = reinterpret_cast<mge::hardware_buffer*>(0x20);
+
+    cb.bind_storage_buffer(0, a);
+    cb.bind_storage_buffer(1, a);
+    // rebinding a slot replaces the buffer
+    cb.bind_storage_buffer(1, b);
+    cb.dispatch(p, mge::program_handle(0, 0, 1), 1);
+    cb.dispatch(p, mge::program_handle(0, 0, 2), 1);
+
+    std::vector<size_t> counts;
+    cb.for_each_dispatch_in_pass(
+        0,
+        [&](const mge::program_handle& /*p*/,
+            mge::uniform_block* /*ub*/,
+            std::span<const std::byte> /*uniform_data*/,
+            const mge::storage_buffer_binding_list& storage_buffers,
+            uint32_t /*x*/,
+            uint32_t /*y*/,
+            uint32_t /*z*/) {
+            counts.push_back(storage_buffers.size());
+            if (storage_buffers.size() == 2) {
+                EXPECT_EQ(storage_buffers[0].buffer, a);
+                EXPECT_EQ(storage_buffers[1].slot, 1u);
+                EXPECT_EQ(storage_buffers[1].buffer, b);
+            }
+        });
+    EXPECT_EQ(counts, (std::vector<size_t>{2, 0}));
+}
+
+TEST(command_buffer, bind_storage_buffer_beyond_capacity_throws)
+{
+    mge::command_buffer cb;
+    constexpr uint32_t  max_bindings =
+        mge::storage_buffer_binding_list::MAX_STORAGE_BUFFER_BINDINGS;
+    for (uint32_t i = 0; i < max_bindings; ++i) {
+        cb.bind_storage_buffer(i, nullptr);
+    }
+    EXPECT_NO_THROW(cb.bind_storage_buffer(0, nullptr));
+    EXPECT_THROW(cb.bind_storage_buffer(max_bindings, nullptr),
+                 mge::illegal_state);
+}
+
+TEST(command_buffer, draw_indirect_records_per_pass_in_order)
+{
+    mge::command_buffer        cb;
+    mge::pass                  p(1);
+    mge::vertex_buffer_handle  vb;
+    mge::index_buffer_handle   ib;
+    mge::storage_buffer_handle commands(0, 0, 7);
+
+    cb.bind_texture(nullptr);
+    cb.draw_indirect(p, mge::program_handle(0, 0, 1), vb, ib, commands, 16);
+    cb.draw_indirect(p, mge::program_handle(0, 0, 2), vb, ib, commands, 0);
+    cb.draw_indirect(p, mge::program_handle(0, 0, 3), vb, ib, commands, 4, 16);
+    EXPECT_FALSE(cb.empty());
+    // indirect draws are not draws
+    EXPECT_TRUE(programs_in_pass(cb, 1).empty());
+
+    std::vector<uint32_t> programs;
+    std::vector<uint32_t> ranges;
+    std::vector<size_t>   textures;
+    cb.for_each_indirect_draw_in_pass(
+        1,
+        [&](const mge::program_handle& prog,
+            const mge::vertex_buffer_handle& /*v*/,
+            const mge::index_buffer_handle& /*i*/,
+            const mge::pipeline_state& /*state*/,
+            mge::uniform_block* /*ub*/,
+            std::span<const std::byte> /*uniform_data*/,
+            const mge::texture_binding_list& tex,
+            const mge::rectangle& /*scissor*/,
+            const mge::storage_buffer_handle& cmds,
+            uint32_t                          first_command,
+            uint32_t                          draw_count) {
+            programs.push_back(prog.object_index());
+            ranges.insert(ranges.end(), {first_command, draw_count});
+            textures.push_back(tex.size());
+            EXPECT_EQ(cmds, commands);
+        });
+    EXPECT_EQ(programs, (std::vector<uint32_t>{1, 3}));
+    EXPECT_EQ(ranges, (std::vector<uint32_t>{0, 16, 16, 4}));
+    // bindings are consumed like by draw()
+    EXPECT_EQ(textures, (std::vector<size_t>{1, 0}));
+
+    cb.clear();
+    EXPECT_TRUE(cb.empty());
+    EXPECT_TRUE(cb.indirect_draws(1).empty());
+}
+
+TEST(command_buffer, packable_draws_differ_in_index_range_only)
+{
+    mge::command_buffer       cb;
+    mge::pass                 p(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 6, 0);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 12, 6);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib, 6, 0);
+    cb.cull_face(mge::cull_mode::CLOCKWISE);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 6, 0);
+
+    EXPECT_TRUE(cb.packable(0, cb, 1));
+    EXPECT_FALSE(cb.packable(0, cb, 2));
+    EXPECT_FALSE(cb.packable(0, cb, 3));
+
+    auto cmd = cb.indirect_command(1);
+    EXPECT_EQ(cmd.index_count, 12u);
+    EXPECT_EQ(cmd.instance_count, 1u);
+    EXPECT_EQ(cmd.first_index, 6u);
+    EXPECT_EQ(cmd.vertex_offset, 0);
+}
+
+namespace {
+    class packing_render_context : public MOCK_render_context
+    {
+    public:
+        using MOCK_render_context::MOCK_render_context;
+
+        std::vector<std::vector<mge::draw_indexed_indirect_command>> runs;
+
+    protected:
+        void render(const mge::pass& p) override
+        {
+            for_each_packed_draw_in_pass(
+                p.index(),
+                [&](const mge::program_handle& /*prog*/,
+                    const mge::vertex_buffer_handle& /*v*/,
+                    const mge::index_buffer_handle& /*i*/,
+                    const mge::pipeline_state& /*state*/,
+                    mge::uniform_block* /*ub*/,
+                    std::span<const std::byte> /*uniform_data*/,
+                    const mge::texture_binding_list& /*textures*/,
+                    const mge::rectangle& /*scissor*/,
+                    const mge::vertex_buffer_handle& /*instances*/,
+                    std::span<const mge::draw_indexed_indirect_command>
+                        commands) {
+                    runs.emplace_back(commands.begin(), commands.end());
+                });
+        }
+    };
+} // namespace
+
+TEST(command_buffer, frame_packs_consecutive_compatible_draws)
+{
+    MOCK_render_system        rs;
+    packing_render_context    ctx(rs);
+    auto&                     p = ctx.pass(0);
+    mge::vertex_buffer_handle vb;
+    mge::index_buffer_handle  ib;
+
+    p.set_draw_packing(true);
+    auto& cb = ctx.command_buffer();
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 6, 0, 1);
+    cb.draw(p, mge::program_handle(0, 0, 1), vb, ib, 3, 6, 2);
+    cb.draw(p, mge::program_handle(0, 0, 2), vb, ib, 9, 0, 3);
+
+    EXPECT_CALL(ctx, on_frame_present()).Times(1);
+    ctx.frame();
+    ASSERT_EQ(ctx.runs.size(), 2u);
+    ASSERT_EQ(ctx.runs[0].size(), 2u);
+    EXPECT_EQ(ctx.runs[0][0].first_index, 0u);
+    EXPECT_EQ(ctx.runs[0][1].index_count, 3u);
+    EXPECT_EQ(ctx.runs[0][1].first_index, 6u);
+    ASSERT_EQ(ctx.runs[1].size(), 1u);
+    EXPECT_EQ(ctx.runs[1][0].index_count, 9u);
+}
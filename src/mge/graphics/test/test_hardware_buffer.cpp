@@ -4,8 +4,11 @@
 #include "mock_hardware_buffer.hpp"
 #include "mock_render_context.hpp"
 #include "mock_render_system.hpp"
+#include "mge/core/stdexceptions.hpp"
 #include "test/googletest.hpp"
 
+#include <vector>
+
 using namespace testing;
 
 TEST(hardware_buffer, construct)
@@ -16,4 +19,49 @@ TEST(hardware_buffer, construct)
     MOCK_hardware_buffer buffer(*ctx, mge::buffer_type::INDEX, 1024);
     EXPECT_EQ(buffer.type(), mge::buffer_type::INDEX);
     EXPECT_EQ(buffer.size(), 1024);
-}
\ No newline at end of file
+}
+TEST(hardware_buffer, update_writes_mapped_range)
+{
+    auto rs = std::make_shared<MOCK_render_system>();
+    auto ctx = std::make_shared<MOCK_render_context>(*rs);
+
+    MOCK_hardware_buffer   buffer(*ctx, mge::buffer_type::VERTEX, 64);
+    std::vector<std::byte> memory(64);
+    EXPECT_CALL(buffer, on_map_range(16, 8))
+        .WillOnce(Return(memory.data() + 16));
+    EXPECT_CALL(buffer, on_flush_range(16, 8)).Times(1);
+    EXPECT_CALL(buffer, on_update(_, _, _)).Times(0);
+
+    std::vector<std::byte> data(8, std::byte{0x2a});
+    buffer.update(16, data);
+    EXPECT_EQ(std::byte{0}, memory[15]);
+    EXPECT_EQ(std::byte{0x2a}, memory[16]);
+    EXPECT_EQ(std::byte{0x2a}, memory[23]);
+    EXPECT_EQ(std::byte{0}, memory[24]);
+}
+
+TEST(hardware_buffer, update_without_mapping)
+{
+    auto rs = std::make_shared<MOCK_render_system>();
+    auto ctx = std::make_shared<MOCK_render_context>(*rs);
+
+    MOCK_hardware_buffer buffer(*ctx, mge::buffer_type::INDEX, 64);
+    EXPECT_CALL(buffer, on_map_range(_, _)).WillRepeatedly(Return(nullptr));
+    EXPECT_CALL(buffer, on_update(32, _, 4)).Times(1);
+
+    std::vector<std::byte> data(4);
+    buffer.update(32, data);
+    EXPECT_TRUE(buffer.map_range(0, 64).empty());
+}
+
+TEST(hardware_buffer, range_outside_buffer_throws)
+{
+    auto rs = std::make_shared<MOCK_render_system>();
+    auto ctx = std::make_shared<MOCK_render_context>(*rs);
+
+    MOCK_hardware_buffer   buffer(*ctx, mge::buffer_type::VERTEX, 64);
+    std::vector<std::byte> data(8);
+    EXPECT_THROW(buffer.update(60, data), mge::out_of_range);
+    EXPECT_THROW(buffer.map_range(65, 0), mge::out_of_range);
+    EXPECT_THROW(buffer.flush_range(0, 65), mge::out_of_range);
+}
@@ -22,4 +22,25 @@ TEST(image_format, name)
                         mge::data_type::FLOAT);
     auto              s = fmt::format("{}", f);
     EXPECT_STREQ("RGB_FLOAT", s.c_str());
-}
\ No newline at end of file
+}
+TEST(image_format, compressed_size)
+{
+    mge::image_format bc1(mge::image_format::data_format::BC1,
+                          mge::data_type::UINT8);
+    EXPECT_TRUE(bc1.compressed());
+    EXPECT_EQ(8u, bc1.block_size());
+    EXPECT_EQ(0u, bc1.binary_size());
+    EXPECT_EQ(8u, bc1.binary_size(1, 1));
+    EXPECT_EQ(4u * 8u, bc1.binary_size(5, 8));
+
+    mge::image_format bc7(mge::image_format::data_format::BC7,
+                          mge::data_type::UINT8);
+    EXPECT_EQ(16u, bc7.block_size());
+    EXPECT_EQ(16u * 16u * 16u, bc7.binary_size(64, 64));
+
+    mge::image_format rgba(mge::image_format::data_format::RGBA,
+                           mge::data_type::UINT8);
+    EXPECT_FALSE(rgba.compressed());
+    EXPECT_EQ(0u, rgba.block_size());
+    EXPECT_EQ(64u, rgba.binary_size(4, 4));
+}
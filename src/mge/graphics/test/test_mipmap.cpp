@@ -0,0 +1,102 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/image.hpp"
+#include "mge/graphics/memory_image.hpp"
+#include "mge/graphics/mipmap.hpp"
+#include "test/googletest.hpp"
+
+#include <cstring>
+
+using namespace testing;
+
+namespace {
+    mge::image_format rgba8()
+    {
+        return mge::image_format(mge::image_format::data_format::RGBA,
+                                 mge::data_type::UINT8);
+    }
+} // namespace
+
+TEST(mipmap, level_count)
+{
+    EXPECT_EQ(0u, mge::mip_level_count(mge::extent(0, 0)));
+    EXPECT_EQ(1u, mge::mip_level_count(mge::extent(1, 1)));
+    EXPECT_EQ(2u, mge::mip_level_count(mge::extent(2, 1)));
+    EXPECT_EQ(9u, mge::mip_level_count(mge::extent(256, 256)));
+    EXPECT_EQ(9u, mge::mip_level_count(mge::extent(300, 20)));
+}
+
+TEST(mipmap, level_extent)
+{
+    mge::extent e(300, 20);
+    EXPECT_EQ(mge::extent(300, 20), mge::mip_level_extent(e, 0));
+    EXPECT_EQ(mge::extent(150, 10), mge::mip_level_extent(e, 1));
+    EXPECT_EQ(mge::extent(37, 2), mge::mip_level_extent(e, 3));
+    EXPECT_EQ(mge::extent(18, 1), mge::mip_level_extent(e, 4));
+    EXPECT_EQ(mge::extent(1, 1), mge::mip_level_extent(e, 8));
+}
+
+TEST(mipmap, level_offset)
+{
+    mge::extent e(4, 2);
+    EXPECT_EQ(0u, mge::mip_level_offset(rgba8(), e, 0));
+    EXPECT_EQ(32u, mge::mip_level_offset(rgba8(), e, 1));
+    EXPECT_EQ(40u, mge::mip_level_offset(rgba8(), e, 2));
+    EXPECT_EQ(44u, mge::mip_level_offset(rgba8(), e, 3));
+}
+
+TEST(mipmap, downsample_box)
+{
+    // clang-format off
+    uint8_t src[] = {
+        0,   0,   0,   0,    4,   8,  12,  16,
+        8,  16,  24,  32,   12,  24,  36,  48,
+    };
+    // clang-format on
+    uint8_t dst[4] = {};
+    mge::downsample_box(rgba8(), mge::extent(2, 2), src, dst);
+    EXPECT_EQ(6, dst[0]);
+    EXPECT_EQ(12, dst[1]);
+    EXPECT_EQ(18, dst[2]);
+    EXPECT_EQ(24, dst[3]);
+}
+
+TEST(mipmap, downsample_box_odd_extent)
+{
+    mge::image_format f(mge::image_format::data_format::RGB,
+                        mge::data_type::FLOAT);
+    float             src[] = {1.0f, 1.0f, 1.0f, 3.0f, 3.0f, 3.0f,
+                               5.0f, 5.0f, 5.0f};
+    float             dst[3] = {};
+    mge::downsample_box(f, mge::extent(3, 1), src, dst);
+    EXPECT_FLOAT_EQ(2.0f, dst[0]);
+    EXPECT_FLOAT_EQ(2.0f, dst[1]);
+    EXPECT_FLOAT_EQ(2.0f, dst[2]);
+}
+
+TEST(mipmap, downsample_box_unsupported_format)
+{
+    mge::image_format f(mge::image_format::data_format::DEPTH,
+                        mge::data_type::FLOAT);
+    float             src[4] = {};
+    float             dst[1] = {};
+    EXPECT_THROW(mge::downsample_box(f, mge::extent(2, 2), src, dst),
+                 mge::illegal_argument);
+}
+
+TEST(mipmap, generate_mip_chain)
+{
+    mge::memory_image img(rgba8(), mge::extent(4, 4));
+    std::memset(img.data(), 200, img.binary_size());
+    auto chain = mge::generate_mip_chain(img);
+    EXPECT_EQ(3u, chain->mip_levels());
+    EXPECT_EQ(img.extent(), chain->extent());
+    EXPECT_EQ(mge::mip_level_offset(rgba8(), img.extent(), 3),
+              chain->binary_size());
+    auto data = chain->data_span();
+    for (auto b : data) {
+        EXPECT_EQ(200, b);
+    }
+}
@@ -0,0 +1,166 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/configuration.hpp"
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/pipeline_manifest.hpp"
+#include "mock_program.hpp"
+#include "mock_render_context.hpp"
+#include "test/googletest.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace {
+    mge::pipeline_manifest::entry sample_entry()
+    {
+        mge::pipeline_manifest::entry e;
+        e.program = 0x1234567890abcdefull;
+        e.vertices.push_back(mge::vertex_format(mge::data_type::FLOAT, 3),
+                             mge::attribute_semantic::POSITION);
+        e.vertices.push_back(mge::vertex_format(mge::data_type::FLOAT, 2),
+                             mge::attribute_semantic::TEXCOORD);
+        e.state.set_cull_mode(mge::cull_mode::CLOCKWISE);
+        return e;
+    }
+} // namespace
+
+TEST(pipeline_manifest, add_ignores_duplicates)
+{
+    mge::pipeline_manifest m;
+    EXPECT_TRUE(m.empty());
+    EXPECT_TRUE(m.add(sample_entry()));
+    EXPECT_FALSE(m.add(sample_entry()));
+    auto e = sample_entry();
+    e.render_target = mge::pipeline_manifest::target::FRAME_BUFFER;
+    EXPECT_TRUE(m.add(e));
+    EXPECT_EQ(2u, m.size());
+}
+
+TEST(pipeline_manifest, save_and_load)
+{
+    mge::pipeline_manifest m;
+    m.add(sample_entry());
+    auto instanced = sample_entry();
+    instanced.instances.push_back(
+        mge::vertex_format(mge::data_type::FLOAT, 4, 1),
+        mge::attribute_semantic::COLOR);
+    m.add(instanced);
+
+    std::stringstream ss;
+    m.save(ss);
+    auto loaded = mge::pipeline_manifest::load(ss);
+    ASSERT_EQ(2u, loaded.size());
+    auto it = loaded.begin();
+    EXPECT_EQ(sample_entry(), *it++);
+    EXPECT_EQ(instanced, *it);
+}
+
+TEST(pipeline_manifest, load_rejects_invalid_data)
+{
+    std::stringstream ss("not a manifest");
+    EXPECT_THROW(mge::pipeline_manifest::load(ss), mge::illegal_argument);
+}
+
+namespace {
+    class hashed_program : public MOCK_program
+    {
+    public:
+        hashed_program(mge::render_context& context, uint64_t hash)
+            : MOCK_program(context)
+        {
+            m_source_hash = hash;
+        }
+    };
+
+    class prewarm_render_context : public MOCK_render_context
+    {
+    public:
+        using MOCK_render_context::MOCK_render_context;
+
+        std::mutex                                        lock;
+        std::vector<std::pair<uint64_t, std::thread::id>> prewarmed;
+
+    protected:
+        bool on_prewarm_pipeline(
+            mge::program& /*prog*/,
+            const mge::pipeline_manifest::entry& e) override
+        {
+            // keep the calling thread busy so other workers take entries
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            std::lock_guard<std::mutex> guard(lock);
+            prewarmed.emplace_back(e.program, std::this_thread::get_id());
+            return true;
+        }
+    };
+} // namespace
+
+TEST(pipeline_manifest, frame_prewarms_linked_programs_of_manifest_file)
+{
+    const auto path = std::filesystem::temp_directory_path() /
+                      "mge_test_pipeline_manifest.bin";
+    mge::pipeline_manifest m;
+    for (uint64_t hash = 1; hash <= 5; ++hash) {
+        auto e = sample_entry();
+        e.program = hash;
+        m.add(e);
+    }
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        m.save(output);
+    }
+    auto& manifest_parameter =
+        mge::configuration::find_parameter("graphics", "pipeline_manifest");
+    manifest_parameter.set_value(path.string());
+
+    {
+        MOCK_render_system     rs;
+        prewarm_render_context ctx(rs);
+        uint64_t               next_hash = 1;
+        EXPECT_CALL(ctx, on_create_program())
+            .Times(4)
+            .WillRepeatedly([&]() -> mge::program* {
+                return new testing::NiceMock<hashed_program>(ctx,
+                                                             next_hash++);
+            });
+        EXPECT_CALL(ctx, on_destroy_program(testing::_))
+            .Times(4)
+            .WillRepeatedly([](mge::program* p) { delete p; });
+
+        // the program of the fifth entry is never created
+        std::vector<mge::program_handle> programs;
+        for (int i = 0; i < 4; ++i) {
+            programs.push_back(ctx.create_program());
+            programs.back()->link();
+        }
+        ctx.frame();
+
+        std::set<uint64_t>        hashes;
+        std::set<std::thread::id> threads;
+        for (const auto& [hash, thread] : ctx.prewarmed) {
+            hashes.insert(hash);
+            threads.insert(thread);
+        }
+        EXPECT_EQ(ctx.prewarmed.size(), 4u);
+        EXPECT_EQ(hashes, (std::set<uint64_t>{1, 2, 3, 4}));
+        if (std::thread::hardware_concurrency() > 1) {
+            EXPECT_GT(threads.size(), 1u);
+        }
+
+        // entries are prewarmed only once
+        ctx.frame();
+        EXPECT_EQ(ctx.prewarmed.size(), 4u);
+
+        for (auto& p : programs) {
+            p.destroy();
+        }
+    }
+
+    manifest_parameter.set_value(std::string());
+    std::filesystem::remove(path);
+}
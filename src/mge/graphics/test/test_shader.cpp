@@ -18,4 +18,34 @@ TEST(shader, shader_handle_lifecycle)
         .WillOnce(Return(new MOCK_shader(*ctx, mge::shader_type::VERTEX)));
     auto sh = ctx->create_shader(mge::shader_type::VERTEX);
     EXPECT_TRUE(sh);
-}
\ No newline at end of file
+}
+TEST(shader, destroyed_shader_slot_is_reused)
+{
+    auto rs = std::make_shared<MOCK_render_system>();
+    auto ctx = std::make_shared<MOCK_render_context>(*rs);
+    EXPECT_CALL(*ctx, on_create_shader(mge::shader_type::VERTEX))
+        .Times(2)
+        .WillRepeatedly(Invoke([&](mge::shader_type t) {
+            return new MOCK_shader(*ctx, t);
+        }));
+    EXPECT_CALL(*ctx, on_destroy_shader(_))
+        .Times(2)
+        .WillRepeatedly(Invoke([](mge::shader* s) { delete s; }));
+
+    auto first = ctx->create_shader(mge::shader_type::VERTEX);
+    auto stale = first;
+    first.destroy();
+    EXPECT_FALSE(stale);
+
+    auto second = ctx->create_shader(mge::shader_type::VERTEX);
+    EXPECT_TRUE(second);
+    EXPECT_EQ(stale.object_index(), second.object_index());
+    EXPECT_FALSE(stale);
+    EXPECT_EQ(nullptr, stale.get());
+    EXPECT_FALSE(stale == second);
+
+    // destroying through the stale handle must not destroy the new shader
+    stale.destroy();
+    EXPECT_TRUE(second);
+    second.destroy();
+}
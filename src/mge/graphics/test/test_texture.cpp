@@ -28,4 +28,18 @@ TEST(texture, set_data)
                          img.binary_size()))
         .Times(1);
     tex.set_data(img);
-}
\ No newline at end of file
+}
+TEST(texture, set_data_mip_chain_uploads_base_level_by_default)
+{
+    auto              rs = std::make_shared<MOCK_render_system>();
+    auto              ctx = std::make_shared<MOCK_render_context>(*rs);
+    MOCK_texture      tex(*ctx, mge::texture_type::TYPE_2D);
+    mge::image_format format(mge::image_format::data_format::RGBA,
+                             mge::data_type::UINT8);
+    mge::extent       ext(16, 16);
+    auto img = mge::memory_image::create_mip_chain(format, ext, 5);
+    EXPECT_EQ(5u, img->mip_levels());
+    EXPECT_CALL(tex, set_data(format, ext, img->data(), 16 * 16 * 4))
+        .Times(1);
+    tex.set_data(*img);
+}
@@ -234,3 +234,69 @@ TEST(uniform_block, move_construct)
     const float* data = reinterpret_cast<const float*>(block2.data());
     EXPECT_FLOAT_EQ(*data, 3.14f);
 }
+
+TEST(uniform_block, set_by_member_id)
+{
+    mge::program::uniform_block_metadata ub_info;
+    ub_info.name = "IdBlock";
+    ub_info.uniforms.push_back(
+        {"brightness", mge::uniform_data_type::FLOAT, 1, 0});
+    ub_info.uniforms.push_back(
+        {"position", mge::uniform_data_type::FLOAT_VEC3, 1, 0});
+
+    mge::uniform_block block(ub_info);
+    auto               id = block.member("position");
+    EXPECT_TRUE(id.valid());
+    EXPECT_FALSE(mge::uniform_block::member_id().valid());
+    EXPECT_THROW(block.member("nonexistent"), mge::no_such_element);
+
+    float pos[3] = {1.0f, 2.0f, 3.0f};
+    block.set(id, pos);
+    EXPECT_EQ(block.version(), 1u);
+    const float* data = reinterpret_cast<const float*>(
+        static_cast<const char*>(block.data()) + block.members()[1].offset);
+    EXPECT_FLOAT_EQ(data[2], 3.0f);
+
+    double too_large[4] = {};
+    EXPECT_THROW(block.set(block.member("brightness"), too_large),
+                 mge::out_of_range);
+}
+
+TEST(uniform_block, dirty_range)
+{
+    mge::program::uniform_block_metadata ub_info;
+    ub_info.name = "DirtyBlock";
+    ub_info.uniforms.push_back(
+        {"brightness", mge::uniform_data_type::FLOAT, 1, 0});
+    ub_info.uniforms.push_back(
+        {"position", mge::uniform_data_type::FLOAT_VEC3, 1, 0});
+    ub_info.uniforms.push_back(
+        {"transform", mge::uniform_data_type::FLOAT_MAT4, 1, 0});
+
+    mge::uniform_block block(ub_info);
+    auto               r = block.dirty_range(0);
+    EXPECT_EQ(0u, r.offset);
+    EXPECT_EQ(block.data_size(), r.size);
+
+    block.clear_dirty_range();
+    uint64_t uploaded = block.version();
+    EXPECT_EQ(0u, block.dirty_range(uploaded).size);
+
+    float pos[3] = {1.0f, 2.0f, 3.0f};
+    block.set(block.member("position"), pos);
+    r = block.dirty_range(uploaded);
+    EXPECT_EQ(16u, r.offset);
+    EXPECT_EQ(12u, r.size);
+
+    block.set<float>("brightness", 0.5f);
+    r = block.dirty_range(uploaded);
+    EXPECT_EQ(0u, r.offset);
+    EXPECT_EQ(28u, r.size);
+
+    // a copy older than the tracked range needs the whole block
+    block.clear_dirty_range();
+    block.set<float>("brightness", 0.25f);
+    r = block.dirty_range(uploaded);
+    EXPECT_EQ(0u, r.offset);
+    EXPECT_EQ(block.data_size(), r.size);
+}
@@ -16,3 +16,28 @@ TEST(vertex_format, parse)
     mge::vertex_format f(mge::data_type::FLOAT, 3);
     EXPECT_EQ(f, mge::parse_vertex_format("FLOAT[3]"));
 }
+
+TEST(vertex_format, instance_step_rate)
+{
+    mge::vertex_format f(mge::data_type::FLOAT, 4, 1);
+    EXPECT_EQ(1u, f.instance_step_rate());
+    EXPECT_TRUE(f.per_instance());
+    EXPECT_FALSE(mge::vertex_format(mge::data_type::FLOAT, 4).per_instance());
+    EXPECT_NE(f, mge::vertex_format(mge::data_type::FLOAT, 4));
+}
+
+TEST(vertex_format, output_instance_step_rate)
+{
+    mge::vertex_format f(mge::data_type::FLOAT, 4, 2);
+    mge::test_stream_output(f, "FLOAT[4]@2");
+}
+
+TEST(vertex_format, parse_instance_step_rate)
+{
+    mge::vertex_format f(mge::data_type::FLOAT, 4, 2);
+    EXPECT_EQ(f, mge::parse_vertex_format("FLOAT[4]@2"));
+    EXPECT_THROW(mge::parse_vertex_format("FLOAT[4]@"),
+                 mge::illegal_argument);
+    EXPECT_THROW(mge::parse_vertex_format("FLOAT[4]@0"),
+                 mge::illegal_argument);
+}
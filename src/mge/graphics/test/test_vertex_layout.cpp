@@ -150,3 +150,20 @@ TEST(vertex_layout, at_bounds_check)
     EXPECT_NO_THROW(l.at(0));
     EXPECT_THROW(l.at(5), std::out_of_range);
 }
+
+TEST(vertex_layout, per_instance)
+{
+    mge::vertex_layout l{mge::vertex_format(mge::data_type::FLOAT, 4, 1),
+                         mge::vertex_format(mge::data_type::FLOAT, 4, 1)};
+    EXPECT_TRUE(l.per_instance());
+    EXPECT_EQ(1u, l.instance_step_rate());
+    EXPECT_FALSE(mge::vertex_layout().per_instance());
+}
+
+TEST(vertex_layout, mixed_step_rate_throws)
+{
+    mge::vertex_layout l;
+    l.push_back(mge::vertex_format(mge::data_type::FLOAT, 3));
+    EXPECT_THROW(l.push_back(mge::vertex_format(mge::data_type::FLOAT, 4, 1)),
+                 mge::illegal_argument);
+}
@@ -2,6 +2,8 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "texture.hpp"
+#include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/mipmap.hpp"
 
 namespace mge {
 
@@ -16,9 +18,35 @@ namespace mge {
         return m_type;
     }
 
+    void texture::set_mip_data(const image_format& format,
+                               const mge::extent&  extent,
+                               const void*         data,
+                               size_t              size,
+                               uint32_t            levels)
+    {
+        size_t base_size = mip_level_offset(format, extent, 1);
+        if (levels == 0 || size < base_size) {
+            MGE_THROW(illegal_argument)
+                << "Invalid mip chain of " << levels << " levels and "
+                << size << " bytes for extent " << extent;
+        }
+        set_data(format, extent, data, base_size);
+    }
+
     void texture::set_data(const image& img)
     {
-        set_data(img.format(), img.extent(), img.data(), img.binary_size());
+        if (img.mip_levels() > 1) {
+            set_mip_data(img.format(),
+                         img.extent(),
+                         img.data(),
+                         img.binary_size(),
+                         img.mip_levels());
+        } else {
+            set_data(img.format(),
+                     img.extent(),
+                     img.data(),
+                     img.binary_size());
+        }
     }
 
 } // namespace mge
\ No newline at end of file
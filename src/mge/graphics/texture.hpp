@@ -67,9 +67,32 @@ namespace mge {
                               const mge::extent&  extent,
                               const void*         data,
                               size_t              size) = 0;
+
+        /**
+         * @brief Set data of the texture including precomputed mip levels.
+         *
+         * The levels are stored tightly packed, starting with the base
+         * level (see @c mip_level_offset). The default implementation only
+         * uploads the base level.
+         *
+         * @param format image format
+         * @param extent extent of the base level
+         * @param data   mip chain data
+         * @param size   size of data
+         * @param levels number of mip levels in @c data
+         */
+        virtual void set_mip_data(const image_format& format,
+                                  const mge::extent&  extent,
+                                  const void*         data,
+                                  size_t              size,
+                                  uint32_t            levels);
+
         /**
          * @brief Set data of texture.
          *
+         * Images with mip levels are uploaded with @c set_mip_data,
+         * otherwise the render system generates the mip levels.
+         *
          * @param img image
          */
         void set_data(const image& img);
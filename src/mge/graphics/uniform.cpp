@@ -7,6 +7,7 @@
 #include "mge/core/stdexceptions.hpp"
 #include "mge/core/string_pool.hpp"
 
+#include <atomic>
 #include <unordered_map>
 
 namespace mge {
@@ -29,7 +30,7 @@ namespace mge {
                     << "An uniform with the name '" << pooled_name
                     << "' is already registered.";
             }
-            ++m_generation;
+            m_generation.fetch_add(1, std::memory_order_release);
             return pooled_name;
         }
 
@@ -37,7 +38,7 @@ namespace mge {
         {
             std::lock_guard<mge::mutex> lock(m_mutex);
             m_uniforms.erase(name);
-            ++m_generation;
+            m_generation.fetch_add(1, std::memory_order_release);
         }
 
         uniform_base* find(const std::string_view& name) const
@@ -50,10 +51,10 @@ namespace mge {
             return it->second;
         }
 
-        uint64_t generation() const
+        // read on every uniform block bind, registrations are rare
+        uint64_t generation() const noexcept
         {
-            std::lock_guard<mge::mutex> lock(m_mutex);
-            return m_generation;
+            return m_generation.load(std::memory_order_acquire);
         }
 
     private:
@@ -62,8 +63,8 @@ namespace mge {
         std::unordered_map<std::string_view,
                            uniform_base*,
                            std::hash<std::string_view>>
-                 m_uniforms;
-        uint64_t m_generation{0};
+                              m_uniforms;
+        std::atomic<uint64_t> m_generation{0};
     };
 
     mge::singleton<uniform_registry> s_uniform_registry;
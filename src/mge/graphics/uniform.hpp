@@ -72,6 +72,7 @@ namespace mge {
          *
          * The generation is incremented each time a uniform is registered
          * or unregistered, allowing consumers to detect registry changes.
+         * Reading the generation takes no lock.
          *
          * @return the current registry generation number
          */
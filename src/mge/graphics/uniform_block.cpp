@@ -20,6 +20,8 @@ namespace mge {
         compute_layout(buffer_info);
         m_data = ::mge::malloc(m_data_size);
         std::memset(m_data, 0, m_data_size);
+        // new data has never been uploaded
+        m_dirty_end = m_data_size;
     }
 
     uniform_block::~uniform_block()
@@ -36,6 +38,9 @@ namespace mge {
         , m_data(other.m_data)
         , m_data_size(other.m_data_size)
         , m_version(other.m_version)
+        , m_dirty_begin(other.m_dirty_begin)
+        , m_dirty_end(other.m_dirty_end)
+        , m_clean_version(other.m_clean_version)
         , m_uniform_cache(std::move(other.m_uniform_cache))
         , m_cache_registry_generation(other.m_cache_registry_generation)
     {
@@ -54,6 +59,9 @@ namespace mge {
             m_data = other.m_data;
             m_data_size = other.m_data_size;
             m_version = other.m_version;
+            m_dirty_begin = other.m_dirty_begin;
+            m_dirty_end = other.m_dirty_end;
+            m_clean_version = other.m_clean_version;
             m_uniform_cache = std::move(other.m_uniform_cache);
             m_cache_registry_generation = other.m_cache_registry_generation;
             other.m_data = nullptr;
@@ -93,9 +101,8 @@ namespace mge {
         m_data_size = std140_align(offset, 16);
     }
 
-    void uniform_block::set_data(const std::string& member_name,
-                                 const void*        data,
-                                 size_t             size)
+    uniform_block::member_id
+    uniform_block::member(std::string_view member_name) const
     {
         auto it = std::find_if(
             m_members.begin(),
@@ -107,14 +114,32 @@ namespace mge {
                 << "Uniform block '" << m_name << "' has no member named '"
                 << member_name << "'";
         }
+        return member_id(static_cast<uint32_t>(it - m_members.begin()));
+    }
 
-        if (size > it->size) {
+    void uniform_block::set_data(const std::string& member_name,
+                                 const void*        data,
+                                 size_t             size)
+    {
+        set_data(member(member_name), data, size);
+    }
+
+    void
+    uniform_block::set_data(member_id id, const void* data, size_t size)
+    {
+        if (id.m_index >= m_members.size()) {
+            MGE_THROW(mge::out_of_range)
+                << "Invalid member id for uniform block '" << m_name << "'";
+        }
+        const auto& m = m_members[id.m_index];
+        if (size > m.size) {
             MGE_THROW(mge::out_of_range)
-                << "Data size " << size << " exceeds member '" << member_name
-                << "' size " << it->size;
+                << "Data size " << size << " exceeds member '" << m.name
+                << "' size " << m.size;
         }
 
-        std::memcpy(static_cast<char*>(m_data) + it->offset, data, size);
+        std::memcpy(static_cast<char*>(m_data) + m.offset, data, size);
+        mark_dirty(m.offset, size);
         ++m_version;
     }
 
@@ -201,6 +226,7 @@ namespace mge {
             std::memcpy(static_cast<char*>(m_data) + member.offset,
                         cache.data,
                         cache.data_size);
+            mark_dirty(member.offset, cache.data_size);
             cache.last_version = current_version;
             changed = true;
         }
@@ -8,8 +8,10 @@
 #include "mge/graphics/std140.hpp"
 #include "mge/graphics/uniform_data_type.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace mge {
@@ -37,6 +39,47 @@ namespace mge {
             size_t            size;       //!< total byte size of this member
         };
 
+        /**
+         * @brief Resolved reference to a member of a uniform block.
+         *
+         * Obtained once by name through @c member(), it allows setting
+         * the member without a lookup. A member id is valid for all blocks
+         * created from the same program metadata.
+         */
+        class member_id
+        {
+        public:
+            member_id() = default;
+
+            /**
+             * @brief Whether the id refers to a member.
+             */
+            bool valid() const noexcept
+            {
+                return m_index != 0xFFFFFFFF;
+            }
+
+            bool operator==(const member_id&) const noexcept = default;
+
+        private:
+            friend class uniform_block;
+
+            explicit member_id(uint32_t index) noexcept
+                : m_index(index)
+            {}
+
+            uint32_t m_index{0xFFFFFFFF};
+        };
+
+        /**
+         * @brief Byte range of the block data.
+         */
+        struct range
+        {
+            size_t offset{0}; //!< first byte
+            size_t size{0};   //!< number of bytes, 0 if empty
+        };
+
         /**
          * @brief Create a uniform block from program uniform buffer metadata.
          *
@@ -92,6 +135,15 @@ namespace mge {
             return m_members;
         }
 
+        /**
+         * @brief Resolve a member by name.
+         *
+         * @param member_name name of the member
+         * @return id of the member
+         * @throws no_such_element if the block has no such member
+         */
+        member_id member(std::string_view member_name) const;
+
         /**
          * @brief Write raw bytes to a member by name.
          *
@@ -102,6 +154,15 @@ namespace mge {
         void
         set_data(const std::string& member_name, const void* data, size_t size);
 
+        /**
+         * @brief Write raw bytes to a resolved member.
+         *
+         * @param id   member id
+         * @param data pointer to the source data
+         * @param size size of the source data in bytes
+         */
+        void set_data(member_id id, const void* data, size_t size);
+
         /**
          * @brief Write a typed value to a member by name.
          *
@@ -115,6 +176,53 @@ namespace mge {
             set_data(member_name, &value, sizeof(T));
         }
 
+        /**
+         * @brief Write a typed value to a resolved member.
+         *
+         * @tparam T value type (must match the member's uniform_data_type)
+         * @param id    member id
+         * @param value the value to write
+         */
+        template <typename T> void set(member_id id, const T& value)
+        {
+            set_data(id, &value, sizeof(T));
+        }
+
+        /**
+         * @brief Bytes written since a version of the block.
+         *
+         * The block tracks the range written since @c clear_dirty_range()
+         * was last called. The range spans all writes, so it may include
+         * unchanged bytes between them. A backend that keeps a copy of
+         * the block uploads the returned range, calls
+         * @c clear_dirty_range() and remembers @c version().
+         *
+         * @param since_version version of the block the caller's copy
+         *  holds, 0 if it holds nothing
+         * @return bytes to upload, the whole block if the writes since
+         *  @c since_version are not tracked
+         */
+        range dirty_range(uint64_t since_version) const noexcept
+        {
+            if (since_version != m_clean_version) {
+                return {0, m_data_size};
+            }
+            if (m_dirty_end <= m_dirty_begin) {
+                return {};
+            }
+            return {m_dirty_begin, m_dirty_end - m_dirty_begin};
+        }
+
+        /**
+         * @brief Start tracking writes from the current version.
+         */
+        void clear_dirty_range() noexcept
+        {
+            m_dirty_begin = m_data_size;
+            m_dirty_end = 0;
+            m_clean_version = m_version;
+        }
+
         /**
          * @brief Synchronize values from global uniforms.
          *
@@ -138,6 +246,13 @@ namespace mge {
         };
 
         void compute_layout(const program::uniform_block_metadata& buffer_info);
+
+        void mark_dirty(size_t offset, size_t size) noexcept
+        {
+            m_dirty_begin = std::min(m_dirty_begin, offset);
+            m_dirty_end = std::max(m_dirty_end, offset + size);
+        }
+
         void ensure_uniform_cache();
         void update_uniform_cache();
 
@@ -146,6 +261,9 @@ namespace mge {
         void*                      m_data{nullptr};
         size_t                     m_data_size{0};
         uint64_t                   m_version{0};
+        size_t                     m_dirty_begin{0};
+        size_t                     m_dirty_end{0};
+        uint64_t                   m_clean_version{0};
         std::vector<uniform_cache> m_uniform_cache; //!< cached uniform lookups
         uint64_t m_cache_registry_generation{0}; //!< registry generation when
                                                  //!< cache was built
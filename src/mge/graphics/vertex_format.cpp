@@ -2,21 +2,30 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/graphics/vertex_format.hpp"
+#include <charconv>
 #include <iostream>
 
 namespace mge {
     vertex_format::vertex_format()
         : m_type(data_type::UNKNOWN)
         , m_size(0u)
+        , m_instance_step_rate(0u)
     {}
 
-    vertex_format::vertex_format(data_type t, size_t s)
+    vertex_format::vertex_format(data_type t,
+                                 size_t    s,
+                                 uint32_t  instance_step_rate)
         : m_type(t)
         , m_size(static_cast<uint8_t>(s))
+        , m_instance_step_rate(static_cast<uint8_t>(instance_step_rate))
     {
         if (s > 255u) {
             MGE_THROW(illegal_argument) << "Unsupported size " << s;
         }
+        if (instance_step_rate > 255u) {
+            MGE_THROW(illegal_argument)
+                << "Unsupported instance step rate " << instance_step_rate;
+        }
     }
 
     size_t vertex_format::binary_size() const
@@ -26,6 +35,21 @@ namespace mge {
 
     vertex_format parse_vertex_format(std::string_view sv)
     {
+        auto apos = sv.find('@');
+        if (apos != std::string_view::npos) {
+            auto     rate_sv = sv.substr(apos + 1);
+            uint32_t rate = 0;
+            auto [ptr, ec] = std::from_chars(rate_sv.data(),
+                                             rate_sv.data() + rate_sv.size(),
+                                             rate);
+            if (rate_sv.empty() || ec != std::errc() ||
+                ptr != rate_sv.data() + rate_sv.size() || rate == 0 ||
+                rate > 255) {
+                MGE_THROW(illegal_argument) << "Invalid vertex format: " << sv;
+            }
+            auto f = parse_vertex_format(sv.substr(0, apos));
+            return vertex_format(f.type(), f.size(), rate);
+        }
         auto bpos = sv.find('[');
         if (bpos == std::string_view::npos) {
             auto dt = mge::enum_cast<data_type>(sv);
@@ -27,8 +27,13 @@ namespace mge {
          *
          * @param type data type
          * @param size number of elements, default 1
+         * @param instance_step_rate number of instances drawn before
+         *   advancing to the next element, 0 (default) to advance per
+         *   vertex
          */
-        vertex_format(data_type type, size_t size = 1);
+        vertex_format(data_type type,
+                      size_t    size = 1,
+                      uint32_t  instance_step_rate = 0);
 
         /**
          * @brief Copy constructor.
@@ -80,6 +85,29 @@ namespace mge {
             return m_size;
         }
 
+        /**
+         * @brief Instance step rate.
+         *
+         * Number of instances drawn with the same element before advancing
+         * to the next one, 0 if the element advances per vertex.
+         *
+         * @return instance step rate
+         */
+        uint8_t instance_step_rate() const noexcept
+        {
+            return m_instance_step_rate;
+        }
+
+        /**
+         * @brief Whether the element advances per instance.
+         *
+         * @return @c true if the instance step rate is not 0
+         */
+        bool per_instance() const noexcept
+        {
+            return m_instance_step_rate != 0;
+        }
+
         /**
          * @brief Binary size of vertex (number of bytes)
          *
@@ -95,9 +123,13 @@ namespace mge {
          */
         inline bool operator<(const vertex_format& f) const noexcept
         {
-            return m_type < f.m_type    ? true
-                   : m_type == f.m_type ? m_size < f.m_size
-                                        : false;
+            if (m_type != f.m_type) {
+                return m_type < f.m_type;
+            }
+            if (m_size != f.m_size) {
+                return m_size < f.m_size;
+            }
+            return m_instance_step_rate < f.m_instance_step_rate;
         }
 
         /**
@@ -108,17 +140,22 @@ namespace mge {
          */
         inline bool operator==(const vertex_format& f) const noexcept
         {
-            return m_type == f.m_type && m_size == f.m_size;
+            return m_type == f.m_type && m_size == f.m_size &&
+                   m_instance_step_rate == f.m_instance_step_rate;
         }
 
     private:
         data_type m_type;
         uint8_t   m_size;
+        uint8_t   m_instance_step_rate;
     };
 
     /**
      * @brief Parse a vertex format.
      *
+     * Formats are written as @c type or @c type[size], an optional
+     * @c @@rate suffix sets the instance step rate, e.g. @c float[4]@1.
+     *
      * @param sv source string view
      * @return parsed format
      */
@@ -131,7 +168,8 @@ template <> struct std::hash<mge::vertex_format>
     size_t operator()(const mge::vertex_format& fmt) const noexcept
     {
         return static_cast<size_t>(fmt.type()) ^
-               static_cast<size_t>(fmt.size());
+               (static_cast<size_t>(fmt.size()) << 8) ^
+               (static_cast<size_t>(fmt.instance_step_rate()) << 16);
     }
 };
 
@@ -147,6 +185,9 @@ struct fmt::formatter<mge::vertex_format>
         } else {
             fmt::format_to(ctx.out(), "{}[{}]", f.type(), f.size());
         }
+        if (f.per_instance()) {
+            fmt::format_to(ctx.out(), "@{}", f.instance_step_rate());
+        }
         return ctx.out();
     }
 };
@@ -16,6 +16,7 @@ namespace mge {
         m_formats.reserve(l.size());
         m_semantics.reserve(l.size());
         for (const auto f : l) {
+            check_step_rate(f);
             m_formats.push_back(f);
             m_semantics.push_back(mge::attribute_semantic::ANY);
         }
@@ -48,14 +49,27 @@ namespace mge {
                                });
     }
 
+    void vertex_layout::check_step_rate(const vertex_format& f) const
+    {
+        if (!m_formats.empty() &&
+            m_formats[0].instance_step_rate() != f.instance_step_rate()) {
+            MGE_THROW(illegal_argument)
+                << "Format " << f << " does not match instance step rate "
+                << static_cast<uint32_t>(m_formats[0].instance_step_rate())
+                << " of vertex layout";
+        }
+    }
+
     void vertex_layout::push_back(const vertex_format& f)
     {
+        check_step_rate(f);
         m_formats.push_back(f);
         m_semantics.push_back(mge::attribute_semantic::ANY);
     }
 
     void vertex_layout::push_back(const vertex_format& f, attribute_semantic s)
     {
+        check_step_rate(f);
         m_formats.push_back(f);
         m_semantics.push_back(s);
     }
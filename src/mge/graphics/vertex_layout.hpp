@@ -16,6 +16,10 @@ namespace mge {
     /**
      * A vertex layout defines the layout of some vertex buffer, and such
      * is a list of vertex formats.
+     *
+     * All formats of a layout share the same instance step rate, as the
+     * layout describes a single buffer which is either advanced per vertex
+     * or per instance.
      */
     class MGEGRAPHICS_EXPORT vertex_layout
     {
@@ -237,6 +241,27 @@ namespace mge {
          */
         void push_back(const vertex_format& f, attribute_semantic s);
 
+        /**
+         * @brief Instance step rate of the layout.
+         *
+         * @return instance step rate of the formats, 0 if the layout is
+         *  advanced per vertex or empty
+         */
+        uint8_t instance_step_rate() const noexcept
+        {
+            return m_formats.empty() ? 0 : m_formats[0].instance_step_rate();
+        }
+
+        /**
+         * @brief Whether the layout describes per-instance data.
+         *
+         * @return @c true if the instance step rate is not 0
+         */
+        bool per_instance() const noexcept
+        {
+            return instance_step_rate() != 0;
+        }
+
         /**
          * @brief Formats of vertex layout.
          *
@@ -370,6 +395,8 @@ namespace mge {
         }
 
     private:
+        void check_step_rate(const vertex_format& f) const;
+
         mge::small_vector<vertex_format, 3>      m_formats;
         mge::small_vector<attribute_semantic, 3> m_semantics;
     };
@@ -386,7 +413,7 @@ template <> struct std::hash<mge::vertex_layout>
         size_t h = 0;
         for (size_t i = 0; i < l.size(); ++i) {
             auto entry = l[i];
-            h = std::hash<mge::vertex_format>{}(entry.format);
+            h = h * 31 + std::hash<mge::vertex_format>{}(entry.format);
             h = h * 31 + std::hash<mge::attribute_semantic>{}(entry.semantic);
         }
         return h;
@@ -2,12 +2,16 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "slang_compiler.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/core/stdexceptions.hpp"
 #include "mge/core/trace.hpp"
+#include "mge/graphics/shader_cache.hpp"
 
 #include <slang-com-ptr.h>
 #include <slang.h>
 
+#include <cstring>
+
 namespace mge {
     MGE_DEFINE_TRACE(SLANG);
 }
@@ -449,6 +453,20 @@ namespace mge {
                                         "binding {}",
                                         param_name ? param_name : "(null)",
                                         binding);
+                    } else if (binding_type ==
+                                   slang::BindingType::MutableRawBuffer ||
+                               binding_type ==
+                                   slang::BindingType::MutableTypedBuffer ||
+                               binding_type == slang::BindingType::RawBuffer ||
+                               binding_type ==
+                                   slang::BindingType::TypedBuffer) {
+                        unsigned binding = param->getBindingIndex();
+                        result.storage_buffers.push_back(
+                            {param_name ? param_name : "", binding});
+                        MGE_DEBUG_TRACE(SLANG,
+                                        "  Storage buffer '{}' at binding {}",
+                                        param_name ? param_name : "(null)",
+                                        binding);
                     } else {
                         MGE_DEBUG_TRACE(SLANG,
                                         "  Unhandled descriptor table slot "
@@ -598,6 +616,187 @@ namespace mge {
         }
     }
 
+    static void write_u32(mge::buffer& data, uint32_t value)
+    {
+        auto p = reinterpret_cast<const std::byte*>(&value);
+        data.insert(data.end(), p, p + sizeof(value));
+    }
+
+    static void write_bytes(mge::buffer& data, const void* p, size_t size)
+    {
+        write_u32(data, static_cast<uint32_t>(size));
+        auto bytes = static_cast<const std::byte*>(p);
+        data.insert(data.end(), bytes, bytes + size);
+    }
+
+    static void write_string(mge::buffer& data, std::string_view s)
+    {
+        write_bytes(data, s.data(), s.size());
+    }
+
+    /**
+     * Reads data written by the write functions, throws if the data
+     * ends prematurely.
+     */
+    class cache_reader
+    {
+    public:
+        explicit cache_reader(const mge::buffer& data)
+            : m_data(data)
+        {}
+
+        uint32_t u32()
+        {
+            uint32_t value;
+            std::memcpy(&value, take(sizeof(value)), sizeof(value));
+            return value;
+        }
+
+        std::string string()
+        {
+            size_t size = u32();
+            return std::string(reinterpret_cast<const char*>(take(size)),
+                               size);
+        }
+
+        mge::buffer bytes()
+        {
+            size_t      size = u32();
+            const auto* p = take(size);
+            return mge::buffer(p, p + size);
+        }
+
+    private:
+        const std::byte* take(size_t size)
+        {
+            if (size > m_data.size() - m_pos) {
+                MGE_THROW(mge::runtime_exception)
+                    << "Truncated shader cache entry";
+            }
+            const std::byte* p = m_data.data() + m_pos;
+            m_pos += size;
+            return p;
+        }
+
+        const mge::buffer& m_data;
+        size_t             m_pos{0};
+    };
+
+    static void write_uniforms(mge::buffer&                      data,
+                               const mge::program::uniform_list& uniforms)
+    {
+        write_u32(data, static_cast<uint32_t>(uniforms.size()));
+        for (const auto& u : uniforms) {
+            write_string(data, u.name);
+            write_u32(data, static_cast<uint32_t>(u.type));
+            write_u32(data, u.array_size);
+            write_u32(data, u.location);
+        }
+    }
+
+    static mge::program::uniform_list read_uniforms(cache_reader& r)
+    {
+        mge::program::uniform_list uniforms;
+        uint32_t                   count = r.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            mge::program::uniform u;
+            u.name = r.string();
+            u.type = static_cast<mge::uniform_data_type>(r.u32());
+            u.array_size = r.u32();
+            u.location = r.u32();
+            uniforms.push_back(std::move(u));
+        }
+        return uniforms;
+    }
+
+    static mge::buffer serialize(const slang_compile_result& result)
+    {
+        mge::buffer data;
+        write_u32(data, static_cast<uint32_t>(result.shader_code.size()));
+        for (const auto& [type, code] : result.shader_code) {
+            write_u32(data, static_cast<uint32_t>(type));
+            write_bytes(data, code.binary_code.data(), code.binary_code.size());
+            write_string(data, code.text_code);
+            write_string(data, code.entry_point_name);
+        }
+        write_u32(data, static_cast<uint32_t>(result.attributes.size()));
+        for (const auto& a : result.attributes) {
+            write_string(data, a.name);
+            write_u32(data, static_cast<uint32_t>(a.type));
+            write_u32(data, a.size);
+        }
+        write_uniforms(data, result.uniforms);
+        write_u32(data, static_cast<uint32_t>(result.uniform_buffers.size()));
+        for (const auto& ub : result.uniform_buffers) {
+            write_string(data, ub.name);
+            write_uniforms(data, ub.uniforms);
+            write_u32(data, ub.location);
+        }
+        write_u32(data, static_cast<uint32_t>(result.sampler_bindings.size()));
+        for (const auto& sb : result.sampler_bindings) {
+            write_string(data, sb.name);
+            write_u32(data, sb.binding);
+        }
+        write_u32(data, static_cast<uint32_t>(result.storage_buffers.size()));
+        for (const auto& sb : result.storage_buffers) {
+            write_string(data, sb.name);
+            write_u32(data, sb.binding);
+        }
+        return data;
+    }
+
+    static slang_compile_result deserialize(const mge::buffer& data)
+    {
+        cache_reader         r(data);
+        slang_compile_result result;
+        uint32_t             count = r.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            slang_shader_code code;
+            code.type = static_cast<mge::shader_type>(r.u32());
+            code.binary_code = r.bytes();
+            code.text_code = r.string();
+            code.entry_point_name = r.string();
+            result.shader_code[code.type] = std::move(code);
+        }
+        count = r.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            mge::program::attribute a;
+            a.name = r.string();
+            a.type = static_cast<mge::data_type>(r.u32());
+            a.size = static_cast<uint8_t>(r.u32());
+            result.attributes.push_back(std::move(a));
+        }
+        result.uniforms = read_uniforms(r);
+        count = r.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            mge::program::uniform_block_metadata ub;
+            ub.name = r.string();
+            ub.uniforms = read_uniforms(r);
+            ub.location = r.u32();
+            result.uniform_buffers.push_back(std::move(ub));
+        }
+        count = r.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            mge::program::sampler_binding sb;
+            sb.name = r.string();
+            sb.binding = r.u32();
+            result.sampler_bindings.push_back(std::move(sb));
+        }
+        count = r.u32();
+        for (uint32_t i = 0; i < count; ++i) {
+            mge::program::storage_buffer_metadata sb;
+            sb.name = r.string();
+            sb.binding = r.u32();
+            result.storage_buffers.push_back(std::move(sb));
+        }
+        return result;
+    }
+
+    static slang_compile_result compile(slang_target       target,
+                                        SlangCompileTarget slang_format,
+                                        const char*        profile_name,
+                                        std::string_view   source);
+
     slang_compile_result slang_compile(slang_target     target,
                                        std::string_view source)
     {
@@ -622,6 +821,42 @@ namespace mge {
                 << "Unsupported Slang target: " << (int)target;
         }
 
+        // the key covers everything that determines the result, bump
+        // CACHE_FORMAT_VERSION when the session options or the entry
+        // format change
+        constexpr uint32_t CACHE_FORMAT_VERSION = 2;
+        uint64_t           key = mge::fnv1a(spGetBuildTagString());
+        key = mge::fnv1a(&CACHE_FORMAT_VERSION,
+                         sizeof(CACHE_FORMAT_VERSION),
+                         key);
+        key = mge::fnv1a(&slang_format, sizeof(slang_format), key);
+        key = mge::fnv1a(profile_name, key);
+        key = mge::fnv1a(source, key);
+
+        auto& cache = mge::shader_cache();
+        if (auto cached = cache.get(key)) {
+            try {
+                MGE_DEBUG_TRACE(SLANG, "Using cached shader {:016x}", key);
+                return deserialize(*cached);
+            } catch (const mge::exception& e) {
+                MGE_WARNING_TRACE(SLANG,
+                                  "Ignoring shader cache entry {:016x}: {}",
+                                  key,
+                                  e.what());
+            }
+        }
+
+        auto result = compile(target, slang_format, profile_name, source);
+        auto data = serialize(result);
+        cache.put(key, data);
+        return result;
+    }
+
+    static slang_compile_result compile(slang_target       target,
+                                        SlangCompileTarget slang_format,
+                                        const char*        profile_name,
+                                        std::string_view   source)
+    {
         Slang::ComPtr<slang::IGlobalSession> global_session;
         auto rc = slang::createGlobalSession(global_session.writeRef());
         if (SLANG_FAILED(rc)) {
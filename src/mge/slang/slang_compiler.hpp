@@ -31,10 +31,11 @@ namespace mge {
     {
         std::map<mge::shader_type, slang_shader_code> shader_code;
 
-        program::attribute_list              attributes;
-        program::uniform_list                uniforms;
-        program::uniform_block_metadata_list uniform_buffers;
-        program::sampler_binding_list        sampler_bindings;
+        program::attribute_list               attributes;
+        program::uniform_list                 uniforms;
+        program::uniform_block_metadata_list  uniform_buffers;
+        program::sampler_binding_list         sampler_bindings;
+        program::storage_buffer_metadata_list storage_buffers;
     };
 
     slang_compile_result slang_compile(slang_target     target,
@@ -19,6 +19,9 @@
 #include <assimp/Logger.hpp>        // Logger interface
 #include <assimp/postprocess.h>     // Post processing flags
 #include <assimp/scene.h>           // Output data structure
+
+#include <memory>
+#include <string>
 namespace mge {
 
     MGE_DEFINE_TRACE(ASSIMP);
@@ -231,22 +234,38 @@ namespace mge {
     {
         MGE_DEBUG_TRACE(ASSIMP, "Loading asset: {}", a.path().string());
 
-        assimp_logger         logger;
-        mge::input_stream_ref stream = a.data();
-        assimp_iosystem       iosystem(stream);
-        Assimp::Importer      importer;
-        importer.SetIOHandler(&iosystem);
+        constexpr unsigned int import_flags =
+            aiProcess_Triangulate              // Ensure all faces are triangles
+            | aiProcess_GenSmoothNormals       // Generate smooth normals
+            | aiProcess_JoinIdenticalVertices  // Optimize vertex data
+            | aiProcess_ImproveCacheLocality   // Improve cache locality
+            | aiProcess_ValidateDataStructure  // Validate data structure
+            | aiProcess_FixInfacingNormals     // Fix infacing normals
+            | aiProcess_FindInvalidData;       // Find invalid data
+
+        assimp_logger                    logger;
+        mge::mapped_region_ref           region = a.map();
+        std::unique_ptr<assimp_iosystem> iosystem;
+        Assimp::Importer                 importer;
+        if (!region) {
+            iosystem = std::make_unique<assimp_iosystem>(a.data());
+            importer.SetIOHandler(iosystem.get());
+        }
         try {
-            importer.ReadFile(
-                a.path().string(),
-                aiProcess_Triangulate // Ensure all faces are triangles
-                    | aiProcess_GenSmoothNormals      // Generate smooth normals
-                    | aiProcess_JoinIdenticalVertices // Optimize vertex data
-                    | aiProcess_ImproveCacheLocality  // Improve cache locality
-                    | aiProcess_ValidateDataStructure // Validate data structure
-                    | aiProcess_FixInfacingNormals    // Fix infacing normals
-                    | aiProcess_FindInvalidData       // Find invalid data
-            );
+            if (region) {
+                // parse the mapped file in place, the extension tells
+                // assimp the format
+                std::string hint = a.path().extension().string();
+                if (!hint.empty() && hint[0] == '.') {
+                    hint.erase(0, 1);
+                }
+                importer.ReadFileFromMemory(region->data(),
+                                            region->size(),
+                                            import_flags,
+                                            hint.c_str());
+            } else {
+                importer.ReadFile(a.path().string(), import_flags);
+            }
 
             auto scene = importer.GetScene();
             if (!scene) {
@@ -59,9 +59,14 @@ namespace mge::dx11 {
                 << size();
         }
 
+        on_update(0, data, data_size);
+    }
+
+    void index_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
         D3D11_BOX dest_box;
-        dest_box.left = 0;
-        dest_box.right = mge::checked_cast<UINT>(data_size);
+        dest_box.left = mge::checked_cast<UINT>(offset);
+        dest_box.right = mge::checked_cast<UINT>(offset + size);
         dest_box.top = 0;
         dest_box.bottom = 1;
         dest_box.front = 0;
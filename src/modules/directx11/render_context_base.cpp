@@ -316,116 +316,73 @@ namespace mge::dx11 {
                 dsv, D3D11_CLEAR_DEPTH, p.clear_depth_value(), 0);
         }
 
-        bool           blend_pass_needed = false;
-        mge::rectangle current_scissor   = p.scissor();
+        // opaque draws are visited first, followed by translucent draws
+        // in back to front order
+        bool           blending        = false;
+        mge::rectangle current_scissor = p.scissor();
 
         for_each_draw_in_pass(
             p.index(),
             [this,
-             &blend_pass_needed,
+             &blending,
              &current_scissor,
              &p](program_handle                   prog,
                  vertex_buffer_handle             vertices,
                  index_buffer_handle              indices,
                  const mge::pipeline_state&       state,
                  mge::uniform_block*              ub,
+                 std::span<const std::byte> /*uniform_data*/,
                  const mge::texture_binding_list& textures,
                  uint32_t                         index_count,
                  uint32_t                         index_offset,
-                 const mge::rectangle&            cmd_scissor) {
-                blend_operation op = state.color_blend_operation();
-                if (op == blend_operation::NONE) {
-                    const auto& effective =
-                        cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                    if (effective != current_scissor) {
-                        D3D11_RECT sr = {
-                            .left   = static_cast<LONG>(effective.left),
-                            .top    = static_cast<LONG>(effective.top),
-                            .right  = static_cast<LONG>(effective.right),
-                            .bottom = static_cast<LONG>(effective.bottom)};
-                        m_device_context->RSSetScissorRects(1, &sr);
-                        current_scissor = effective;
-                    }
-                    ID3D11RasterizerState* rs_state = this->rasterizer_state(state);
-                    m_device_context->RSSetState(rs_state);
-                    if (!state.depth_write()) {
-                        ID3D11DepthStencilState* ds_state =
-                            this->depth_stencil_state(state);
-                        m_device_context->OMSetDepthStencilState(ds_state, 1);
-                    }
-                    draw_geometry(prog.get(),
-                                  vertices.get(),
-                                  indices.get(),
-                                  ub,
-                                  textures,
-                                  index_count,
-                                  index_offset);
-                    if (!state.depth_write()) {
-                        m_device_context->OMSetDepthStencilState(
-                            m_depth_stencil_state.get(), 1);
-                    }
-                } else {
-                    blend_pass_needed = true;
+                 const mge::rectangle&            cmd_scissor,
+                 vertex_buffer_handle             instances,
+                 uint32_t                         instance_count) {
+                const auto& effective =
+                    cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
+                if (effective != current_scissor) {
+                    D3D11_RECT sr = {
+                        .left   = static_cast<LONG>(effective.left),
+                        .top    = static_cast<LONG>(effective.top),
+                        .right  = static_cast<LONG>(effective.right),
+                        .bottom = static_cast<LONG>(effective.bottom)};
+                    m_device_context->RSSetScissorRects(1, &sr);
+                    current_scissor = effective;
+                }
+                ID3D11RasterizerState* rs_state = this->rasterizer_state(state);
+                m_device_context->RSSetState(rs_state);
+
+                if (state.color_blend_operation() != blend_operation::NONE) {
+                    ID3D11BlendState* blend_state_obj =
+                        this->blend_state(state);
+                    float blend_factor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                    m_device_context->OMSetBlendState(blend_state_obj,
+                                                      blend_factor,
+                                                      0xffffffff);
+                    blending = true;
+                }
+
+                if (!state.depth_write()) {
+                    ID3D11DepthStencilState* ds_state =
+                        this->depth_stencil_state(state);
+                    m_device_context->OMSetDepthStencilState(ds_state, 1);
+                }
+                draw_geometry(prog.get(),
+                              vertices.get(),
+                              indices.get(),
+                              ub,
+                              textures,
+                              index_count,
+                              index_offset,
+                              instances.get(),
+                              instance_count);
+                if (!state.depth_write()) {
+                    m_device_context->OMSetDepthStencilState(
+                        m_depth_stencil_state.get(), 1);
                 }
             });
 
-        if (blend_pass_needed) {
-            for_each_draw_in_pass(
-                p.index(),
-                [this,
-                 &current_scissor,
-                 &p](program_handle                   prog,
-                     vertex_buffer_handle             vertices,
-                     index_buffer_handle              indices,
-                     const mge::pipeline_state&       state,
-                     mge::uniform_block*              ub,
-                     const mge::texture_binding_list& textures,
-                     uint32_t                         index_count,
-                     uint32_t                         index_offset,
-                     const mge::rectangle&            cmd_scissor) {
-                    blend_operation op = state.color_blend_operation();
-                    if (op != blend_operation::NONE) {
-                        const auto& effective =
-                            cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                        if (effective != current_scissor) {
-                            D3D11_RECT sr = {
-                                .left   = static_cast<LONG>(effective.left),
-                                .top    = static_cast<LONG>(effective.top),
-                                .right  = static_cast<LONG>(effective.right),
-                                .bottom = static_cast<LONG>(effective.bottom)};
-                            m_device_context->RSSetScissorRects(1, &sr);
-                            current_scissor = effective;
-                        }
-                        ID3D11RasterizerState* rs_state =
-                            this->rasterizer_state(state);
-                        m_device_context->RSSetState(rs_state);
-
-                        ID3D11BlendState* blend_state_obj =
-                            this->blend_state(state);
-                        float blend_factor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-                        m_device_context->OMSetBlendState(blend_state_obj,
-                                                          blend_factor,
-                                                          0xffffffff);
-
-                        if (!state.depth_write()) {
-                            ID3D11DepthStencilState* ds_state =
-                                this->depth_stencil_state(state);
-                            m_device_context->OMSetDepthStencilState(ds_state,
-                                                                      1);
-                        }
-                        draw_geometry(prog.get(),
-                                      vertices.get(),
-                                      indices.get(),
-                                      ub,
-                                      textures,
-                                      index_count,
-                                      index_offset);
-                        if (!state.depth_write()) {
-                            m_device_context->OMSetDepthStencilState(
-                                m_depth_stencil_state.get(), 1);
-                        }
-                    }
-                });
+        if (blending) {
             m_device_context->OMSetBlendState(nullptr, nullptr, 0xffffffff);
         }
     }
@@ -437,11 +394,17 @@ namespace mge::dx11 {
         mge::uniform_block*              ub,
         const mge::texture_binding_list& textures,
         uint32_t                         index_count,
-        uint32_t                         index_offset)
+        uint32_t                         index_offset,
+        mge::vertex_buffer*              instances,
+        uint32_t                         instance_count)
     {
         if (!prog) {
             MGE_THROW(illegal_state) << "Draw command has no program assigned";
         }
+        if (instances) {
+            MGE_THROW_NOT_IMPLEMENTED
+                << "Per-instance vertex buffers in DirectX 11 render context";
+        }
         dx11::program& dx11_prog = static_cast<dx11::program&>(*prog);
 
         if (ub) {
@@ -523,7 +486,15 @@ namespace mge::dx11 {
             index_count > 0
                 ? index_count
                 : static_cast<UINT>(dx11_ib->element_count());
-        m_device_context->DrawIndexed(element_count, index_offset, 0);
+        if (instance_count > 1) {
+            m_device_context->DrawIndexedInstanced(element_count,
+                                                   instance_count,
+                                                   index_offset,
+                                                   0,
+                                                   0);
+        } else {
+            m_device_context->DrawIndexed(element_count, index_offset, 0);
+        }
 
         for (const auto& binding : textures) {
             if (binding.texture) {
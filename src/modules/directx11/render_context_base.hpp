@@ -86,7 +86,9 @@ namespace mge::dx11 {
                            mge::uniform_block*              ub,
                            const mge::texture_binding_list& textures,
                            uint32_t                         index_count  = 0,
-                           uint32_t                         index_offset = 0);
+                           uint32_t                         index_offset = 0,
+                           mge::vertex_buffer*              instances = nullptr,
+                           uint32_t                         instance_count = 1);
 
         void bind_uniform_block(mge::dx11::program& dx11_program,
                                 mge::uniform_block& ub);
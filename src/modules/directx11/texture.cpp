@@ -169,6 +169,20 @@ namespace mge::dx11 {
     DXGI_FORMAT texture::texture_format(const mge::image_format& format) const
     {
         switch (format.format()) {
+        case mge::image_format::data_format::BC1:
+            return DXGI_FORMAT_BC1_UNORM;
+        case mge::image_format::data_format::BC2:
+            return DXGI_FORMAT_BC2_UNORM;
+        case mge::image_format::data_format::BC3:
+            return DXGI_FORMAT_BC3_UNORM;
+        case mge::image_format::data_format::BC4:
+            return DXGI_FORMAT_BC4_UNORM;
+        case mge::image_format::data_format::BC5:
+            return DXGI_FORMAT_BC5_UNORM;
+        case mge::image_format::data_format::BC6H:
+            return DXGI_FORMAT_BC6H_UF16;
+        case mge::image_format::data_format::BC7:
+            return DXGI_FORMAT_BC7_UNORM;
         case mge::image_format::data_format::RGB:
             switch (format.type()) {
             case mge::data_type::FLOAT:
@@ -217,8 +231,11 @@ namespace mge::dx11 {
         D3D11_SUBRESOURCE_DATA subresource_data;
         mge::zero_memory(subresource_data);
         subresource_data.pSysMem = data;
+        // the pitch of block compressed data is one row of blocks
         subresource_data.SysMemPitch =
-            static_cast<UINT>(extent.width * format.binary_size());
+            format.compressed()
+                ? static_cast<UINT>(format.binary_size(extent.width, 1))
+                : static_cast<UINT>(extent.width * format.binary_size());
         subresource_data.SysMemSlicePitch = 0;
 
         ID3D11Texture2D* texture = nullptr;
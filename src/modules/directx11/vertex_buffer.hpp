@@ -24,6 +24,9 @@ namespace mge::dx11 {
 
         void on_set_data(void* data, size_t data_size) override;
 
+    protected:
+        void on_update(size_t offset, const void* data, size_t size) override;
+
     private:
         void create_buffer();
 
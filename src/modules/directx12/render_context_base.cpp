@@ -837,8 +837,9 @@ namespace mge::dx12 {
                                                      nullptr);
         }
 
-        bool           blend_pass_needed = false;
-        mge::rectangle current_scissor   = p.scissor();
+        // opaque draws are visited first, followed by translucent draws
+        // in back to front order
+        mge::rectangle current_scissor = p.scissor();
         for_each_draw_in_pass(
             p.index(),
             [&](const mge::program_handle&       program,
@@ -846,10 +847,13 @@ namespace mge::dx12 {
                 const mge::index_buffer_handle&  indices,
                 const mge::pipeline_state&       state,
                 mge::uniform_block*              ub,
+                std::span<const std::byte> /*uniform_data*/,
                 const mge::texture_binding_list& textures,
                 uint32_t                         index_count,
                 uint32_t                         index_offset,
-                const mge::rectangle&            cmd_scissor) {
+                const mge::rectangle&            cmd_scissor,
+                const mge::vertex_buffer_handle& instances,
+                uint32_t                         instance_count) {
                 const auto& effective =
                     cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
                 if (effective != current_scissor) {
@@ -860,59 +864,20 @@ namespace mge::dx12 {
                     pass_command_list->RSSetScissorRects(1, &sr);
                     current_scissor = effective;
                 }
-                auto blend_op = state.color_blend_operation();
-                if (blend_op == blend_operation::NONE) {
-                    draw_geometry(pass_command_list,
-                                  program.get(),
-                                  vertices.get(),
-                                  indices.get(),
-                                  state,
-                                  ub,
-                                  textures,
-                                  pass_rtv_format,
-                                  pass_dsv_format,
-                                  index_count,
-                                  index_offset);
-                } else {
-                    blend_pass_needed = true;
-                }
+                draw_geometry(pass_command_list,
+                              program.get(),
+                              vertices.get(),
+                              indices.get(),
+                              state,
+                              ub,
+                              textures,
+                              pass_rtv_format,
+                              pass_dsv_format,
+                              index_count,
+                              index_offset,
+                              instances.get(),
+                              instance_count);
             });
-
-        if (blend_pass_needed) {
-            for_each_draw_in_pass(
-                p.index(),
-                [&](const mge::program_handle&       program,
-                    const mge::vertex_buffer_handle& vertices,
-                    const mge::index_buffer_handle&  indices,
-                    const mge::pipeline_state&       state,
-                    mge::uniform_block*              ub,
-                    const mge::texture_binding_list& textures,
-                    uint32_t                         index_count,
-                    uint32_t                         index_offset,
-                    const mge::rectangle&            cmd_scissor) {
-                    const auto& effective =
-                        cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                    if (effective != current_scissor) {
-                        D3D12_RECT sr = {static_cast<LONG>(effective.left),
-                                         static_cast<LONG>(effective.top),
-                                         static_cast<LONG>(effective.right),
-                                         static_cast<LONG>(effective.bottom)};
-                        pass_command_list->RSSetScissorRects(1, &sr);
-                        current_scissor = effective;
-                    }
-                    draw_geometry(pass_command_list,
-                                  program.get(),
-                                  vertices.get(),
-                                  indices.get(),
-                                  state,
-                                  ub,
-                                  textures,
-                                  pass_rtv_format,
-                                  pass_dsv_format,
-                                  index_count,
-                                  index_offset);
-                });
-        }
     }
 
     void render_context_base::draw_geometry(
@@ -926,13 +891,19 @@ namespace mge::dx12 {
         DXGI_FORMAT                      rtv_format,
         DXGI_FORMAT                      dsv_format,
         uint32_t                         index_count,
-        uint32_t                         index_offset)
+        uint32_t                         index_offset,
+        mge::vertex_buffer*              instances,
+        uint32_t                         instance_count)
     {
         auto dx12_prog = static_cast<dx12::program*>(program);
         if (!dx12_prog) {
             MGE_THROW(mge::illegal_state)
                 << "Draw command has no program assigned";
         }
+        if (instances) {
+            MGE_THROW_NOT_IMPLEMENTED
+                << "Per-instance vertex buffers in DirectX 12 render context";
+        }
 
         if (!vb) {
             MGE_THROW(illegal_state)
@@ -980,7 +951,11 @@ namespace mge::dx12 {
         UINT count = index_count > 0
                          ? index_count
                          : static_cast<UINT>(dx12_indices->element_count());
-        command_list->DrawIndexedInstanced(count, 1, index_offset, 0, 0);
+        command_list->DrawIndexedInstanced(count,
+                                           instance_count,
+                                           index_offset,
+                                           0,
+                                           0);
     }
 
     void render_context_base::bind_uniform_block(
@@ -1031,11 +1006,20 @@ namespace mge::dx12 {
 
         auto& cached_version = m_constant_buffer_versions[&ub];
         if (cached_version != ub.version()) {
-            void*   mapped_data = nullptr;
-            HRESULT rc          = cbuffer->Map(0, nullptr, &mapped_data);
+            // only the bytes written since the cached version are copied,
+            // the written range is passed on to Unmap
+            const auto  dirty       = ub.dirty_range(cached_version);
+            D3D12_RANGE read_range  = {0, 0};
+            void*       mapped_data = nullptr;
+            HRESULT     rc = cbuffer->Map(0, &read_range, &mapped_data);
             CHECK_HRESULT(rc, ID3D12Resource, Map);
-            memcpy(mapped_data, ub.data(), ub.data_size());
-            cbuffer->Unmap(0, nullptr);
+            memcpy(static_cast<uint8_t*>(mapped_data) + dirty.offset,
+                   static_cast<const uint8_t*>(ub.data()) + dirty.offset,
+                   dirty.size);
+            D3D12_RANGE written_range = {dirty.offset,
+                                         dirty.offset + dirty.size};
+            cbuffer->Unmap(0, &written_range);
+            ub.clear_dirty_range();
             cached_version = ub.version();
         }
 
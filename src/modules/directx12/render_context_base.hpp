@@ -153,7 +153,9 @@ namespace mge::dx12 {
                            DXGI_FORMAT                      rtv_format,
                            DXGI_FORMAT                      dsv_format,
                            uint32_t                         index_count  = 0,
-                           uint32_t                         index_offset = 0);
+                           uint32_t                         index_offset = 0,
+                           mge::vertex_buffer*              instances = nullptr,
+                           uint32_t                         instance_count = 1);
 
         const std::vector<D3D12_INPUT_ELEMENT_DESC>&
         input_layout_from_vertex_buffer(mge::vertex_buffer* vb);
@@ -0,0 +1,564 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/asset/asset.hpp"
+#include "mge/asset/asset_corrupted.hpp"
+#include "mge/asset/asset_handler.hpp"
+#include "mge/asset/asset_type.hpp"
+#include "mge/core/checked_cast.hpp"
+#include "mge/core/trace.hpp"
+#include "mge/graphics/graphics_fwd.hpp"
+#include "mge/graphics/image.hpp"
+#include "mge/graphics/memory_image.hpp"
+#include "mge/graphics/mipmap.hpp"
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace mge {
+    MGE_DEFINE_TRACE(KTX_DDS);
+}
+
+namespace mge {
+
+    namespace {
+
+        constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB,
+                                                 0x4B,
+                                                 0x54,
+                                                 0x58,
+                                                 0x20,
+                                                 0x32,
+                                                 0x30,
+                                                 0xBB,
+                                                 0x0D,
+                                                 0x0A,
+                                                 0x1A,
+                                                 0x0A};
+        constexpr size_t  KTX2_HEADER_SIZE = 80;
+        constexpr size_t  KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+
+        constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+        constexpr size_t   DDS_HEADER_SIZE = 124;
+        constexpr size_t   DDS_DX10_HEADER_SIZE = 20;
+        constexpr uint32_t DDSD_CAPS = 0x1;
+        constexpr uint32_t DDSD_HEIGHT = 0x2;
+        constexpr uint32_t DDSD_WIDTH = 0x4;
+        constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+        constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+        constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+        constexpr uint32_t DDPF_ALPHAPIXELS = 0x1;
+        constexpr uint32_t DDPF_FOURCC = 0x4;
+        constexpr uint32_t DDPF_RGB = 0x40;
+        constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+        constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+        constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+        constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+        constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+        constexpr uint32_t DDS_RESOURCE_DIMENSION_TEXTURE2D = 3;
+        constexpr uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+        constexpr uint32_t fourcc(char a, char b, char c, char d)
+        {
+            return static_cast<uint32_t>(a) |
+                   (static_cast<uint32_t>(b) << 8) |
+                   (static_cast<uint32_t>(c) << 16) |
+                   (static_cast<uint32_t>(d) << 24);
+        }
+
+        uint32_t read_u32(std::span<const uint8_t> data, size_t offset)
+        {
+            if (offset + 4 > data.size()) {
+                MGE_THROW(mge::asset_corrupted) << "Unexpected end of data";
+            }
+            uint32_t value = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                value |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+            }
+            return value;
+        }
+
+        uint64_t read_u64(std::span<const uint8_t> data, size_t offset)
+        {
+            return static_cast<uint64_t>(read_u32(data, offset)) |
+                   (static_cast<uint64_t>(read_u32(data, offset + 4)) << 32);
+        }
+
+        void write_u32(std::vector<uint8_t>& data, size_t offset, uint32_t v)
+        {
+            for (size_t i = 0; i < 4; ++i) {
+                data[offset + i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+        }
+
+        std::vector<uint8_t> read_all(const mge::asset& a)
+        {
+            std::vector<uint8_t> data(a.size());
+            auto                 stream = a.data();
+            size_t               pos = 0;
+            while (pos < data.size()) {
+                auto rc = stream->read(
+                    data.data() + pos,
+                    static_cast<mge::input_stream::streamsize_type>(
+                        data.size() - pos));
+                if (rc <= 0) {
+                    MGE_THROW(mge::asset_corrupted)
+                        << "Unexpected end of asset " << a.path().string();
+                }
+                pos += static_cast<size_t>(rc);
+            }
+            return data;
+        }
+
+        image_format rgba8()
+        {
+            return image_format(image_format::data_format::RGBA,
+                                data_type::UINT8);
+        }
+
+        image_format compressed(image_format::data_format f,
+                                data_type t = data_type::UINT8)
+        {
+            return image_format(f, t);
+        }
+
+        std::optional<image_format> ktx2_format(uint32_t vk_format)
+        {
+            using df = image_format::data_format;
+            switch (vk_format) {
+            case 37: // VK_FORMAT_R8G8B8A8_UNORM
+            case 43: // VK_FORMAT_R8G8B8A8_SRGB
+                return rgba8();
+            case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+            case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+            case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+                return compressed(df::BC1);
+            case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+            case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+                return compressed(df::BC2);
+            case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+            case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+                return compressed(df::BC3);
+            case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+                return compressed(df::BC4);
+            case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+                return compressed(df::BC5);
+            case 143: // VK_FORMAT_BC6H_UFLOAT_BLOCK
+                return compressed(df::BC6H, data_type::HALF);
+            case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+            case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+                return compressed(df::BC7);
+            case 147: // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+            case 148: // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+                return compressed(df::ETC2_RGB);
+            case 151: // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+            case 152: // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+                return compressed(df::ETC2_RGBA);
+            case 157: // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+            case 158: // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+                return compressed(df::ASTC_4x4);
+            default:
+                return std::nullopt;
+            }
+        }
+
+        std::optional<image_format> dxgi_format(uint32_t dxgi)
+        {
+            using df = image_format::data_format;
+            switch (dxgi) {
+            case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+            case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+                return rgba8();
+            case 71: // DXGI_FORMAT_BC1_UNORM
+            case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+                return compressed(df::BC1);
+            case 74: // DXGI_FORMAT_BC2_UNORM
+            case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+                return compressed(df::BC2);
+            case 77: // DXGI_FORMAT_BC3_UNORM
+            case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+                return compressed(df::BC3);
+            case 80: // DXGI_FORMAT_BC4_UNORM
+                return compressed(df::BC4);
+            case 83: // DXGI_FORMAT_BC5_UNORM
+                return compressed(df::BC5);
+            case 95: // DXGI_FORMAT_BC6H_UF16
+                return compressed(df::BC6H, data_type::HALF);
+            case 98: // DXGI_FORMAT_BC7_UNORM
+            case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+                return compressed(df::BC7);
+            default:
+                return std::nullopt;
+            }
+        }
+
+        uint32_t to_dxgi_format(const image_format& format)
+        {
+            using df = image_format::data_format;
+            if (format == rgba8()) {
+                return 28;
+            }
+            switch (format.format()) {
+            case df::BC1:
+                return 71;
+            case df::BC2:
+                return 74;
+            case df::BC3:
+                return 77;
+            case df::BC4:
+                return 80;
+            case df::BC5:
+                return 83;
+            case df::BC6H:
+                return 95;
+            case df::BC7:
+                return 98;
+            default:
+                MGE_THROW(mge::illegal_argument)
+                    << "Image format " << format
+                    << " cannot be stored as DDS";
+            }
+        }
+
+        std::optional<image_format> dds_fourcc_format(uint32_t code)
+        {
+            using df = image_format::data_format;
+            switch (code) {
+            case fourcc('D', 'X', 'T', '1'):
+                return compressed(df::BC1);
+            case fourcc('D', 'X', 'T', '2'):
+            case fourcc('D', 'X', 'T', '3'):
+                return compressed(df::BC2);
+            case fourcc('D', 'X', 'T', '4'):
+            case fourcc('D', 'X', 'T', '5'):
+                return compressed(df::BC3);
+            case fourcc('A', 'T', 'I', '1'):
+            case fourcc('B', 'C', '4', 'U'):
+                return compressed(df::BC4);
+            case fourcc('A', 'T', 'I', '2'):
+            case fourcc('B', 'C', '5', 'U'):
+                return compressed(df::BC5);
+            default:
+                return std::nullopt;
+            }
+        }
+
+        /**
+         * Create the image of a texture file. The header is checked
+         * against the size of the pixel data before anything is
+         * allocated, so a corrupt header cannot request a huge image.
+         *
+         * @param available bytes of pixel data in the file
+         */
+        mge::image_ref create_image(const mge::asset&   a,
+                                    const image_format& format,
+                                    const mge::extent&  extent,
+                                    uint32_t            levels,
+                                    size_t              available)
+        {
+            if (extent.width == 0 || extent.height == 0 ||
+                levels > mip_level_count(extent)) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Invalid extent " << extent << " or mip level count "
+                    << levels << " in " << a.path().string();
+            }
+            // all supported formats take at least half a byte per pixel,
+            // which also keeps the chain size below from overflowing
+            const uint64_t pixels = static_cast<uint64_t>(extent.width) *
+                                    static_cast<uint64_t>(extent.height);
+            if (pixels / 2 > available ||
+                mip_level_offset(format, extent, levels) > available) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Image data of " << extent << " with " << levels
+                    << " mip levels exceeds the " << available
+                    << " bytes in " << a.path().string();
+            }
+            return memory_image::create_mip_chain(format, extent, levels);
+        }
+
+    } // namespace
+
+    class ktx_dds_handler : public asset_handler
+    {
+    public:
+        ktx_dds_handler() = default;
+        ~ktx_dds_handler() = default;
+
+        std::any load(const mge::asset& a) override
+        {
+            // parse a mapped asset in place, otherwise read it
+            std::vector<uint8_t>     buffer;
+            std::span<const uint8_t> data;
+            auto                     region = a.map();
+            if (region) {
+                data = region->bytes();
+            } else {
+                buffer = read_all(a);
+                data = buffer;
+            }
+            if (data.size() >= sizeof(KTX2_IDENTIFIER) &&
+                std::memcmp(data.data(),
+                            KTX2_IDENTIFIER,
+                            sizeof(KTX2_IDENTIFIER)) == 0) {
+                return load_ktx2(a, data);
+            } else if (data.size() >= 4 && read_u32(data, 0) == DDS_MAGIC) {
+                return load_dds(a, data);
+            }
+            MGE_THROW(mge::asset_corrupted)
+                << "Asset " << a.path().string()
+                << " is neither a KTX2 nor a DDS file";
+        }
+
+        void store(const mge::asset&      a,
+                   const mge::asset_type& type,
+                   const std::any&        data) override
+        {
+            using namespace mge::literals;
+            if (type != "image/vnd-ms.dds"_at) {
+                MGE_THROW(mge::illegal_argument)
+                    << "Only DDS format is supported for storing, got: "
+                    << type;
+            }
+            auto img = std::any_cast<mge::image_ref>(data);
+            auto format = img->format();
+            auto extent = img->extent();
+
+            std::vector<uint8_t> header(4 + DDS_HEADER_SIZE +
+                                        DDS_DX10_HEADER_SIZE);
+            uint32_t             flags =
+                DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
+            uint32_t caps = DDSCAPS_TEXTURE;
+            if (img->mip_levels() > 1) {
+                flags |= DDSD_MIPMAPCOUNT;
+                caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+            }
+            if (format.compressed()) {
+                flags |= DDSD_LINEARSIZE;
+            }
+            write_u32(header, 0, DDS_MAGIC);
+            write_u32(header, 4, static_cast<uint32_t>(DDS_HEADER_SIZE));
+            write_u32(header, 8, flags);
+            write_u32(header, 12, extent.height);
+            write_u32(header, 16, extent.width);
+            write_u32(header,
+                      20,
+                      checked_cast<uint32_t>(
+                          format.compressed()
+                              ? format.binary_size(extent.width, extent.height)
+                              : extent.width * format.binary_size()));
+            write_u32(header, 28, img->mip_levels());
+            write_u32(header, 76, 32); // pixel format size
+            write_u32(header, 80, DDPF_FOURCC);
+            write_u32(header, 84, fourcc('D', 'X', '1', '0'));
+            write_u32(header, 108, caps);
+            write_u32(header, 128, to_dxgi_format(format));
+            write_u32(header, 132, DDS_RESOURCE_DIMENSION_TEXTURE2D);
+            write_u32(header, 140, 1); // array size
+
+            auto stream = a.output_stream();
+            stream->write(header.data(), header.size());
+            stream->write(img->data(), img->binary_size());
+            stream->flush();
+        }
+
+        std::span<mge::asset_type>
+        handled_types(asset_handler::operation_type t) const override
+        {
+            using namespace mge::literals;
+            static asset_type supported_load[] = {"image/ktx2"_at,
+                                                  "image/vnd-ms.dds"_at};
+            static asset_type supported_store[] = {"image/vnd-ms.dds"_at};
+            if (t == asset_handler::operation_type::LOAD) {
+                return supported_load;
+            } else {
+                return supported_store;
+            }
+        }
+
+        bool can_improve(const mge::asset&      asset,
+                         const mge::asset_type& type) const override
+        {
+            return type == mge::asset_type("application", "octet-stream");
+        }
+
+        mge::asset_type improve(const mge::asset&      asset,
+                                const mge::asset_type& type) const override
+        {
+            if (type == mge::asset_type("application", "octet-stream")) {
+                if (asset.path().extension() == ".ktx2") {
+                    return mge::asset_type("image", "ktx2");
+                } else if (asset.path().extension() == ".dds") {
+                    return mge::asset_type("image", "vnd-ms.dds");
+                }
+            }
+            return asset_type::UNKNOWN;
+        }
+
+    private:
+        std::any load_ktx2(const mge::asset&        a,
+                           std::span<const uint8_t> data)
+        {
+            if (data.size() < KTX2_HEADER_SIZE) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "KTX2 header truncated in " << a.path().string();
+            }
+            uint32_t vk_format = read_u32(data, 12);
+            uint32_t width = read_u32(data, 20);
+            uint32_t height = std::max(read_u32(data, 24), 1u);
+            uint32_t depth = read_u32(data, 28);
+            uint32_t layers = read_u32(data, 32);
+            uint32_t faces = read_u32(data, 36);
+            uint32_t levels = std::max(read_u32(data, 40), 1u);
+            uint32_t supercompression = read_u32(data, 44);
+
+            if (depth > 1 || layers > 1 || faces != 1) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Only 2D KTX2 textures are supported, "
+                    << a.path().string() << " has depth " << depth << ", "
+                    << layers << " layers and " << faces << " faces";
+            }
+            if (supercompression != 0) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Unsupported KTX2 supercompression scheme "
+                    << supercompression << " in " << a.path().string();
+            }
+            auto format = ktx2_format(vk_format);
+            if (!format) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Unsupported KTX2 format " << vk_format << " in "
+                    << a.path().string();
+            }
+
+            // levels are stored after the level index
+            const size_t index_size =
+                static_cast<size_t>(levels) * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+            if (index_size > data.size() - KTX2_HEADER_SIZE) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "KTX2 level index truncated in " << a.path().string();
+            }
+            mge::extent extent(width, height);
+            auto        img = create_image(
+                a,
+                *format,
+                extent,
+                levels,
+                data.size() - KTX2_HEADER_SIZE - index_size);
+            auto* dst = static_cast<uint8_t*>(img->data());
+            for (uint32_t level = 0; level < levels; ++level) {
+                size_t   entry = KTX2_HEADER_SIZE +
+                               level * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+                uint64_t offset = read_u64(data, entry);
+                uint64_t length = read_u64(data, entry + 8);
+                size_t   level_offset =
+                    mip_level_offset(*format, extent, level);
+                size_t expected =
+                    mip_level_offset(*format, extent, level + 1) - level_offset;
+                if (length != expected || offset > data.size() ||
+                    length > data.size() - offset) {
+                    MGE_THROW(mge::asset_corrupted)
+                        << "Invalid KTX2 mip level " << level << " in "
+                        << a.path().string();
+                }
+                std::memcpy(dst + level_offset,
+                            data.data() + offset,
+                            expected);
+            }
+            MGE_DEBUG_TRACE(KTX_DDS,
+                            "Loaded KTX2 {}: {}x{}, {}, {} levels",
+                            a.path().string(),
+                            width,
+                            height,
+                            *format,
+                            levels);
+            return img;
+        }
+
+        std::any load_dds(const mge::asset&        a,
+                          std::span<const uint8_t> data)
+        {
+            if (data.size() < 4 + DDS_HEADER_SIZE ||
+                read_u32(data, 4) != DDS_HEADER_SIZE) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "DDS header truncated in " << a.path().string();
+            }
+            uint32_t flags = read_u32(data, 8);
+            uint32_t height = read_u32(data, 12);
+            uint32_t width = read_u32(data, 16);
+            uint32_t levels = (flags & DDSD_MIPMAPCOUNT)
+                                  ? std::max(read_u32(data, 28), 1u)
+                                  : 1u;
+            uint32_t pf_flags = read_u32(data, 80);
+            uint32_t pf_fourcc = read_u32(data, 84);
+            uint32_t caps2 = read_u32(data, 112);
+            if (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Only 2D DDS textures are supported: "
+                    << a.path().string();
+            }
+
+            size_t                      data_offset = 4 + DDS_HEADER_SIZE;
+            std::optional<image_format> format;
+            if ((pf_flags & DDPF_FOURCC) &&
+                pf_fourcc == fourcc('D', 'X', '1', '0')) {
+                data_offset += DDS_DX10_HEADER_SIZE;
+                uint32_t dimension = read_u32(data, 132);
+                uint32_t misc = read_u32(data, 136);
+                uint32_t array_size = read_u32(data, 140);
+                if (dimension != DDS_RESOURCE_DIMENSION_TEXTURE2D ||
+                    (misc & DDS_RESOURCE_MISC_TEXTURECUBE) ||
+                    array_size > 1) {
+                    MGE_THROW(mge::asset_corrupted)
+                        << "Only 2D DDS textures are supported: "
+                        << a.path().string();
+                }
+                format = dxgi_format(read_u32(data, 128));
+            } else if (pf_flags & DDPF_FOURCC) {
+                format = dds_fourcc_format(pf_fourcc);
+            } else if ((pf_flags & (DDPF_RGB | DDPF_ALPHAPIXELS)) ==
+                           (DDPF_RGB | DDPF_ALPHAPIXELS) &&
+                       read_u32(data, 88) == 32 &&
+                       read_u32(data, 92) == 0x000000FF &&
+                       read_u32(data, 96) == 0x0000FF00 &&
+                       read_u32(data, 100) == 0x00FF0000 &&
+                       read_u32(data, 104) == 0xFF000000) {
+                format = rgba8();
+            }
+            if (!format) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "Unsupported DDS pixel format in "
+                    << a.path().string();
+            }
+
+            if (data.size() < data_offset) {
+                MGE_THROW(mge::asset_corrupted)
+                    << "DDS header truncated in " << a.path().string();
+            }
+            mge::extent extent(width, height);
+            auto        img = create_image(a,
+                                    *format,
+                                    extent,
+                                    levels,
+                                    data.size() - data_offset);
+            // levels are stored tightly packed, like in a mip chain image
+            std::memcpy(img->data(),
+                        data.data() + data_offset,
+                        img->binary_size());
+            MGE_DEBUG_TRACE(KTX_DDS,
+                            "Loaded DDS {}: {}x{}, {}, {} levels",
+                            a.path().string(),
+                            width,
+                            height,
+                            *format,
+                            levels);
+            return img;
+        }
+    };
+
+    MGE_REGISTER_IMPLEMENTATION(ktx_dds_handler,
+                                mge::asset_handler,
+                                ktx2,
+                                dds);
+} // namespace mge
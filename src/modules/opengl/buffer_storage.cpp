@@ -0,0 +1,96 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "buffer_storage.hpp"
+#include "error.hpp"
+#include "mge/core/checked_cast.hpp"
+
+#include <cstring>
+
+namespace mge::opengl {
+
+    // GL_COPY_WRITE_BUFFER is used as target as it is not part of the
+    // vertex array state, binding an element buffer would change the
+    // bound vertex array
+
+    namespace {
+        bool buffer_storage_supported()
+        {
+            static const bool supported = [] {
+                GLint major = 0;
+                GLint minor = 0;
+                glGetIntegerv(GL_MAJOR_VERSION, &major);
+                glGetIntegerv(GL_MINOR_VERSION, &minor);
+                return glBufferStorage != nullptr &&
+                       (major > 4 || (major == 4 && minor >= 4));
+            }();
+            return supported;
+        }
+    } // namespace
+
+    GLuint create_buffer_storage(size_t size, std::byte** mapped)
+    {
+        *mapped = nullptr;
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        CHECK_OPENGL_ERROR(glGenBuffers);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        CHECK_OPENGL_ERROR(glBindBuffer);
+        if (size > 0 && buffer_storage_supported()) {
+            glBufferStorage(GL_COPY_WRITE_BUFFER,
+                            mge::checked_cast<GLsizeiptr>(size),
+                            nullptr,
+                            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                                GL_DYNAMIC_STORAGE_BIT);
+            CHECK_OPENGL_ERROR(glBufferStorage);
+            *mapped = static_cast<std::byte*>(
+                glMapBufferRange(GL_COPY_WRITE_BUFFER,
+                                 0,
+                                 mge::checked_cast<GLsizeiptr>(size),
+                                 GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                                     GL_MAP_FLUSH_EXPLICIT_BIT));
+            CHECK_OPENGL_ERROR(glMapBufferRange);
+        } else {
+            glBufferData(GL_COPY_WRITE_BUFFER,
+                         mge::checked_cast<GLsizeiptr>(size),
+                         nullptr,
+                         GL_DYNAMIC_DRAW);
+            CHECK_OPENGL_ERROR(glBufferData);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return buffer;
+    }
+
+    void write_buffer(GLuint      buffer,
+                      std::byte*  mapped,
+                      size_t      offset,
+                      const void* data,
+                      size_t      size)
+    {
+        if (mapped) {
+            std::memcpy(mapped + offset, data, size);
+            flush_buffer(buffer, offset, size);
+            return;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        CHECK_OPENGL_ERROR(glBindBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER,
+                        mge::checked_cast<GLintptr>(offset),
+                        mge::checked_cast<GLsizeiptr>(size),
+                        data);
+        CHECK_OPENGL_ERROR(glBufferSubData);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void flush_buffer(GLuint buffer, size_t offset, size_t size)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        CHECK_OPENGL_ERROR(glBindBuffer);
+        glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER,
+                                 mge::checked_cast<GLintptr>(offset),
+                                 mge::checked_cast<GLsizeiptr>(size));
+        CHECK_OPENGL_ERROR(glFlushMappedBufferRange);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+} // namespace mge::opengl
@@ -0,0 +1,47 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "opengl.hpp"
+
+#include <cstddef>
+
+namespace mge::opengl {
+
+    /**
+     * @brief Create a buffer and allocate its storage.
+     *
+     * If the context supports buffer storage (OpenGL 4.4), the storage is
+     * immutable and persistently mapped for writing with explicit flushes.
+     *
+     * @param size   storage size in bytes
+     * @param mapped set to the mapped storage, @c nullptr if not mapped
+     * @return buffer name
+     */
+    GLuint create_buffer_storage(size_t size, std::byte** mapped);
+
+    /**
+     * @brief Write a range of a buffer.
+     *
+     * @param buffer buffer name
+     * @param mapped mapped storage of the buffer, @c nullptr if not mapped
+     * @param offset offset in bytes
+     * @param data   data to write
+     * @param size   data size in bytes
+     */
+    void write_buffer(GLuint      buffer,
+                      std::byte*  mapped,
+                      size_t      offset,
+                      const void* data,
+                      size_t      size);
+
+    /**
+     * @brief Flush a range of a persistently mapped buffer.
+     *
+     * @param buffer buffer name
+     * @param offset offset in bytes
+     * @param size   size of the range in bytes
+     */
+    void flush_buffer(GLuint buffer, size_t offset, size_t size);
+
+} // namespace mge::opengl
@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "index_buffer.hpp"
+#include "buffer_storage.hpp"
 #include "error.hpp"
 #include "mge/core/checked_cast.hpp"
 #include "render_context_base.hpp"
@@ -14,8 +15,9 @@ namespace mge::opengl {
         , m_buffer(0)
     {
         context.prepare_frame([this]() {
-            glGenBuffers(1, &this->m_buffer);
-            CHECK_OPENGL_ERROR(glGenBuffers);
+            if (!m_buffer) {
+                create_buffer();
+            }
             set_ready(true);
         });
     }
@@ -25,22 +27,47 @@ namespace mge::opengl {
         if (m_buffer) {
             set_ready(false);
             GLuint buffer_to_del = m_buffer;
-            context().prepare_frame([buffer_to_del]() {
+            auto&  ctx = static_cast<render_context_base&>(context());
+            ctx.prepare_frame([&ctx, buffer_to_del]() {
+                ctx.forget_buffer(buffer_to_del);
                 glDeleteBuffers(1, &buffer_to_del);
                 TRACE_OPENGL_ERROR(glDeleteBuffers);
             });
         }
     }
+    void index_buffer::create_buffer()
+    {
+        m_buffer = create_buffer_storage(size(), &m_mapped_data);
+    }
+
     void index_buffer::on_set_data(void* data, size_t size)
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_buffer);
-        CHECK_OPENGL_ERROR(glBindBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     mge::checked_cast<GLsizeiptr>(size),
-                     data,
-                     GL_DYNAMIC_DRAW);
-        CHECK_OPENGL_ERROR(glBufferData);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        if (!m_buffer) {
+            create_buffer();
+        }
+        write_buffer(m_buffer, m_mapped_data, 0, data, size);
+        set_ready(true);
+    }
+
+    void* index_buffer::on_map_range(size_t offset, size_t)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        return m_mapped_data ? m_mapped_data + offset : nullptr;
+    }
+
+    void index_buffer::on_flush_range(size_t offset, size_t size)
+    {
+        flush_buffer(m_buffer, offset, size);
+    }
+
+    void index_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        write_buffer(m_buffer, m_mapped_data, offset, data, size);
         set_ready(true);
     }
 
@@ -24,8 +24,16 @@ namespace mge::opengl {
 
         void on_set_data(void* data, size_t size) override;
 
+    protected:
+        void* on_map_range(size_t offset, size_t size) override;
+        void  on_flush_range(size_t offset, size_t size) override;
+        void  on_update(size_t offset, const void* data, size_t size) override;
+
     private:
-        GLuint m_buffer;
+        void create_buffer();
+
+        GLuint     m_buffer;
+        std::byte* m_mapped_data{nullptr};
     };
 
     inline GLuint gl_index_buffer(const mge::index_buffer& buf)
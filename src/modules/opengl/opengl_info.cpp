@@ -4,6 +4,7 @@
 #include "opengl_info.hpp"
 #include "boost/boost_algorithm_string.hpp"
 #include "error.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/core/semantic_version.hpp"
 #include "mge/core/trace.hpp"
 #include "opengl.hpp"
@@ -22,6 +23,7 @@ namespace mge::opengl {
     opengl_info::opengl_info()
         : major_version(0)
         , minor_version(0)
+        , program_binary_supported(false)
     {
 
         glGetIntegerv(GL_MAJOR_VERSION, &major_version);
@@ -30,6 +32,15 @@ namespace mge::opengl {
         MGE_TRACE_OBJECT(OPENGL, INFO)
             << "OpenGL version " << major_version << "." << minor_version;
 
+        if (auto s = glGetString(GL_RENDERER)) {
+            renderer = reinterpret_cast<const char*>(s);
+        }
+        if (auto s = glGetString(GL_VERSION)) {
+            version_str = reinterpret_cast<const char*>(s);
+        }
+        MGE_TRACE_OBJECT(OPENGL, INFO)
+            << "OpenGL renderer " << renderer << ", " << version_str;
+
         glsl_version_str =
             (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
 
@@ -70,6 +81,15 @@ namespace mge::opengl {
             }
         }
 
+        int num_program_formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_program_formats);
+        program_binary_supported = num_program_formats > 0 &&
+                                   glProgramBinary && glGetProgramBinary &&
+                                   glProgramParameteri;
+        MGE_TRACE_OBJECT(OPENGL, INFO)
+            << "System supports " << num_program_formats
+            << " binary program formats";
+
         // In OpenGL 3.0+ core profile, use glGetStringi instead of glGetString(GL_EXTENSIONS)
         GLint num_extensions = 0;
         glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
@@ -89,6 +109,13 @@ namespace mge::opengl {
         }
     }
 
+    uint64_t opengl_info::cache_seed() const noexcept
+    {
+        // hash the terminator to separate renderer and version
+        return mge::fnv1a(version_str,
+                          mge::fnv1a(renderer.c_str(), renderer.size() + 1));
+    }
+
     static const char* source_name(GLenum source)
     {
         switch (source) {
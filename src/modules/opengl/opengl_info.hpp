@@ -5,6 +5,7 @@
 #include "mge/graphics/shader_format.hpp"
 #include "mge/graphics/shader_language.hpp"
 #include "opengl.hpp"
+#include <cstdint>
 #include <set>
 #include <string>
 #include <vector>
@@ -23,6 +24,19 @@ namespace mge::opengl {
         std::string                     glsl_version_str;
         std::set<std::string>           extensions;
         std::vector<mge::shader_format> shader_formats;
+        std::string                     renderer;
+        std::string                     version_str;
+        bool                            program_binary_supported;
+
+        /**
+         * @brief Seed for keys of cached driver output.
+         *
+         * Covers renderer and driver version, so output of another
+         * driver is never used.
+         *
+         * @return hash of @c renderer and @c version_str
+         */
+        uint64_t cache_seed() const noexcept;
 
     private:
         void install_debug_callback();
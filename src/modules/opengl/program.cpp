@@ -3,10 +3,17 @@
 // All rights reserved.
 #include "program.hpp"
 #include "error.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/graphics/data_type.hpp" // Include data_type.hpp
+#include "mge/graphics/shader_cache.hpp"
 #include "render_context_base.hpp"
 #include "shader.hpp"
 
+#include <istream>
+#include <ostream>
+#include <span>
+#include <sstream>
+
 namespace mge {
     MGE_USE_TRACE(OPENGL);
 }
@@ -227,6 +234,72 @@ static mge::data_type attribute_type_from_gl(GLenum t)
 }
 
 namespace mge::opengl {
+
+    namespace {
+        constexpr uint32_t PROGRAM_BINARY_MAGIC = 0x4d475042; // 'MGPB'
+        constexpr uint32_t PROGRAM_BINARY_VERSION = 1;
+        constexpr uint32_t MAX_NAME_LENGTH = 4096;
+
+        template <typename T> void write_value(std::ostream& os, T value)
+        {
+            os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void write_string(std::ostream& os, const std::string& s)
+        {
+            write_value(os, static_cast<uint32_t>(s.size()));
+            os.write(s.data(), static_cast<std::streamsize>(s.size()));
+        }
+
+        void write_uniforms(std::ostream& os, const program::uniform_list& l)
+        {
+            write_value(os, static_cast<uint32_t>(l.size()));
+            for (const auto& u : l) {
+                write_string(os, u.name);
+                write_value(os, static_cast<uint32_t>(u.type));
+                write_value(os, u.array_size);
+                write_value(os, u.location);
+            }
+        }
+
+        // readers leave the stream failed on truncated or corrupt data
+
+        template <typename T> T read_value(std::istream& is)
+        {
+            T value{};
+            is.read(reinterpret_cast<char*>(&value), sizeof(value));
+            return value;
+        }
+
+        std::string read_string(std::istream& is)
+        {
+            auto size = read_value<uint32_t>(is);
+            if (!is || size > MAX_NAME_LENGTH) {
+                is.setstate(std::ios::failbit);
+                return {};
+            }
+            std::string s(size, '\0');
+            is.read(s.data(), static_cast<std::streamsize>(size));
+            return s;
+        }
+
+        program::uniform_list read_uniforms(std::istream& is)
+        {
+            program::uniform_list l;
+            auto                  count = read_value<uint32_t>(is);
+            for (uint32_t i = 0; i < count && is; ++i) {
+                program::uniform u;
+                u.name = read_string(is);
+                u.type =
+                    static_cast<uniform_data_type>(read_value<uint32_t>(is));
+                u.array_size = read_value<uint32_t>(is);
+                u.location = read_value<uint32_t>(is);
+                l.push_back(std::move(u));
+            }
+            return l;
+        }
+    } // namespace
+
     program::program(render_context_base& context)
         : mge::program(context)
         , m_program(0)
@@ -253,6 +326,28 @@ namespace mge::opengl {
 
     void program::on_link()
     {
+        // binaries are keyed by the sources and the driver that built them
+        const auto& info =
+            static_cast<render_context_base&>(context()).gl_info();
+        const bool use_cache =
+            info.program_binary_supported && m_source_hash != 0;
+        const uint64_t key =
+            mge::fnv1a(&m_source_hash,
+                       sizeof(m_source_hash),
+                       mge::fnv1a("program", info.cache_seed()));
+        if (use_cache && load_binary(key)) {
+            // uniform block bindings are not part of the binary
+            assign_block_bindings();
+            return;
+        }
+
+        compile_attached_shaders();
+        if (use_cache) {
+            glProgramParameteri(m_program,
+                                GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                GL_TRUE);
+            CHECK_OPENGL_ERROR(glProgramParameteri);
+        }
         glLinkProgram(m_program);
         CHECK_OPENGL_ERROR(glLinkProgram);
         GLint link_status = GL_FALSE;
@@ -264,6 +359,179 @@ namespace mge::opengl {
         collect_attributes();
         collect_uniforms();
         collect_uniform_buffers();
+        collect_storage_buffers();
+        if (use_cache) {
+            store_binary(key);
+        }
+    }
+
+    void program::compile_attached_shaders()
+    {
+        // shaders known to compile may have deferred compilation
+        GLint count = 0;
+        glGetProgramiv(m_program, GL_ATTACHED_SHADERS, &count);
+        CHECK_OPENGL_ERROR(glGetProgramiv(GL_ATTACHED_SHADERS));
+        std::vector<GLuint> shaders(static_cast<size_t>(count));
+        glGetAttachedShaders(m_program, count, nullptr, shaders.data());
+        CHECK_OPENGL_ERROR(glGetAttachedShaders);
+        for (GLuint s : shaders) {
+            GLint compiled = GL_FALSE;
+            glGetShaderiv(s, GL_COMPILE_STATUS, &compiled);
+            CHECK_OPENGL_ERROR(glGetShaderiv(GL_COMPILE_STATUS));
+            if (compiled == GL_FALSE) {
+                compile_shader(s);
+            }
+        }
+    }
+
+    bool program::load_binary(uint64_t key)
+    {
+        auto data = mge::shader_cache().get(key);
+        if (!data) {
+            return false;
+        }
+        std::istringstream is(
+            std::string(reinterpret_cast<const char*>(data->data()),
+                        data->size()));
+        if (read_value<uint32_t>(is) != PROGRAM_BINARY_MAGIC ||
+            read_value<uint32_t>(is) != PROGRAM_BINARY_VERSION) {
+            return false;
+        }
+        auto format = read_value<GLenum>(is);
+        auto size = read_value<uint32_t>(is);
+        if (!is || size > data->size()) {
+            return false;
+        }
+        std::vector<char> binary(size);
+        is.read(binary.data(), static_cast<std::streamsize>(size));
+
+        attribute_list attributes;
+        auto           count = read_value<uint32_t>(is);
+        for (uint32_t i = 0; i < count && is; ++i) {
+            attribute a;
+            a.name = read_string(is);
+            a.type = static_cast<mge::data_type>(read_value<uint32_t>(is));
+            a.size = read_value<uint8_t>(is);
+            attributes.push_back(std::move(a));
+        }
+        uniform_list                uniforms = read_uniforms(is);
+        uniform_block_metadata_list blocks;
+        count = read_value<uint32_t>(is);
+        for (uint32_t i = 0; i < count && is; ++i) {
+            uniform_block_metadata b;
+            b.name = read_string(is);
+            b.location = read_value<uint32_t>(is);
+            b.uniforms = read_uniforms(is);
+            blocks.push_back(std::move(b));
+        }
+        sampler_binding_list samplers;
+        count = read_value<uint32_t>(is);
+        for (uint32_t i = 0; i < count && is; ++i) {
+            sampler_binding s;
+            s.name = read_string(is);
+            s.binding = read_value<uint32_t>(is);
+            samplers.push_back(std::move(s));
+        }
+        storage_buffer_metadata_list storage_buffers;
+        count = read_value<uint32_t>(is);
+        for (uint32_t i = 0; i < count && is; ++i) {
+            storage_buffer_metadata sb;
+            sb.name = read_string(is);
+            sb.binding = read_value<uint32_t>(is);
+            storage_buffers.push_back(std::move(sb));
+        }
+        std::map<std::string, GLuint> block_indices;
+        count = read_value<uint32_t>(is);
+        for (uint32_t i = 0; i < count && is; ++i) {
+            std::string name = read_string(is);
+            block_indices[std::move(name)] = read_value<GLuint>(is);
+        }
+        if (!is) {
+            MGE_WARNING_TRACE(OPENGL,
+                              "Ignoring corrupt program binary {:016x}",
+                              key);
+            return false;
+        }
+
+        glProgramBinary(m_program,
+                        format,
+                        binary.data(),
+                        static_cast<GLsizei>(binary.size()));
+        TRACE_OPENGL_ERROR(glProgramBinary);
+        GLint link_status = GL_FALSE;
+        glGetProgramiv(m_program, GL_LINK_STATUS, &link_status);
+        if (!link_status) {
+            MGE_DEBUG_TRACE(OPENGL,
+                            "Program binary {:016x} rejected by driver",
+                            key);
+            return false;
+        }
+        MGE_DEBUG_TRACE(OPENGL, "Using cached program binary {:016x}", key);
+        m_attributes = std::move(attributes);
+        m_uniforms = std::move(uniforms);
+        m_uniform_block_metadata = std::move(blocks);
+        m_sampler_bindings = std::move(samplers);
+        m_storage_buffers = std::move(storage_buffers);
+        m_block_indices = std::move(block_indices);
+        return true;
+    }
+
+    void program::store_binary(uint64_t key)
+    {
+        GLint length = 0;
+        glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+        CHECK_OPENGL_ERROR(glGetProgramiv(GL_PROGRAM_BINARY_LENGTH));
+        if (length <= 0) {
+            return;
+        }
+        std::vector<char> binary(static_cast<size_t>(length));
+        GLenum            format = 0;
+        glGetProgramBinary(m_program, length, &length, &format, binary.data());
+        CHECK_OPENGL_ERROR(glGetProgramBinary);
+
+        std::ostringstream os;
+        write_value(os, PROGRAM_BINARY_MAGIC);
+        write_value(os, PROGRAM_BINARY_VERSION);
+        write_value(os, format);
+        write_value(os, static_cast<uint32_t>(length));
+        os.write(binary.data(), length);
+        write_value(os, static_cast<uint32_t>(m_attributes.size()));
+        for (const auto& a : m_attributes) {
+            write_string(os, a.name);
+            write_value(os, static_cast<uint32_t>(a.type));
+            write_value(os, a.size);
+        }
+        write_uniforms(os, m_uniforms);
+        write_value(os, static_cast<uint32_t>(m_uniform_block_metadata.size()));
+        for (const auto& b : m_uniform_block_metadata) {
+            write_string(os, b.name);
+            write_value(os, b.location);
+            write_uniforms(os, b.uniforms);
+        }
+        write_value(os, static_cast<uint32_t>(m_sampler_bindings.size()));
+        for (const auto& s : m_sampler_bindings) {
+            write_string(os, s.name);
+            write_value(os, s.binding);
+        }
+        write_value(os, static_cast<uint32_t>(m_storage_buffers.size()));
+        for (const auto& sb : m_storage_buffers) {
+            write_string(os, sb.name);
+            write_value(os, sb.binding);
+        }
+        write_value(os, static_cast<uint32_t>(m_block_indices.size()));
+        for (const auto& [name, index] : m_block_indices) {
+            write_string(os, name);
+            write_value(os, index);
+        }
+
+        const std::string entry = os.str();
+        mge::shader_cache().put(key,
+                                std::as_bytes(std::span(entry.data(),
+                                                        entry.size())));
+        MGE_DEBUG_TRACE(OPENGL,
+                        "Stored program binary {:016x}, {} bytes",
+                        key,
+                        length);
     }
 
     void program::dump_info_log()
@@ -296,6 +564,9 @@ namespace mge::opengl {
             static_cast<const mge::opengl::shader*>(s);
         glAttachShader(m_program, opengl_shader->gl_shader());
         CHECK_OPENGL_ERROR(glAttachShader);
+        if (s->type() == mge::shader_type::COMPUTE) {
+            m_compute = true;
+        }
     }
 
     void program::collect_uniforms()
@@ -475,9 +746,72 @@ namespace mge::opengl {
         } else {
             collect_uniform_buffers_31();
         }
+        assign_block_bindings();
         cache_block_indices();
     }
 
+    void program::collect_storage_buffers()
+    {
+        m_storage_buffers.clear();
+
+        // shader storage blocks need OpenGL 4.3
+        auto& ctx  = static_cast<render_context_base&>(context());
+        auto& info = ctx.gl_info();
+        if (info.major_version < 4 ||
+            (info.major_version == 4 && info.minor_version < 3)) {
+            return;
+        }
+
+        GLint num_blocks = 0;
+        glGetProgramInterfaceiv(m_program,
+                                GL_SHADER_STORAGE_BLOCK,
+                                GL_ACTIVE_RESOURCES,
+                                &num_blocks);
+        CHECK_OPENGL_ERROR(glGetProgramInterfaceiv(GL_ACTIVE_RESOURCES));
+        if (num_blocks == 0) {
+            return;
+        }
+
+        GLint max_name_length = 0;
+        glGetProgramInterfaceiv(m_program,
+                                GL_SHADER_STORAGE_BLOCK,
+                                GL_MAX_NAME_LENGTH,
+                                &max_name_length);
+        CHECK_OPENGL_ERROR(glGetProgramInterfaceiv(GL_MAX_NAME_LENGTH));
+
+        std::vector<char> name_buffer(max_name_length);
+        const GLenum      properties[] = {GL_BUFFER_BINDING};
+
+        for (GLint i = 0; i < num_blocks; ++i) {
+            GLint binding = 0;
+            glGetProgramResourceiv(m_program,
+                                   GL_SHADER_STORAGE_BLOCK,
+                                   i,
+                                   1,
+                                   properties,
+                                   1,
+                                   nullptr,
+                                   &binding);
+            CHECK_OPENGL_ERROR(glGetProgramResourceiv);
+            GLsizei name_length = 0;
+            glGetProgramResourceName(m_program,
+                                     GL_SHADER_STORAGE_BLOCK,
+                                     i,
+                                     static_cast<GLsizei>(name_buffer.size()),
+                                     &name_length,
+                                     name_buffer.data());
+            CHECK_OPENGL_ERROR(glGetProgramResourceName);
+
+            std::string name(name_buffer.data(), name_length);
+            MGE_DEBUG_TRACE(OPENGL,
+                            "Storage block: '{}', binding: {}",
+                            name,
+                            binding);
+            m_storage_buffers.push_back(
+                {std::move(name), static_cast<uint32_t>(binding)});
+        }
+    }
+
     void program::collect_uniform_buffers_43()
     {
         GLint num_uniform_blocks = 0;
@@ -815,6 +1149,29 @@ namespace mge::opengl {
         }
     }
 
+    void program::assign_block_bindings()
+    {
+        GLint num_blocks = 0;
+        glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_BLOCKS, &num_blocks);
+        CHECK_OPENGL_ERROR(glGetProgramiv);
+        GLint max_bindings = 0;
+        glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &max_bindings);
+        CHECK_OPENGL_ERROR(glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS));
+        if (num_blocks > max_bindings) {
+            MGE_THROW(error) << "Program uses " << num_blocks
+                             << " uniform blocks, only " << max_bindings
+                             << " binding points are available";
+        }
+        // binding points never change after link, draws only bind the
+        // buffer range of each block
+        for (GLint i = 0; i < num_blocks; ++i) {
+            glUniformBlockBinding(m_program,
+                                  static_cast<GLuint>(i),
+                                  static_cast<GLuint>(i));
+            CHECK_OPENGL_ERROR(glUniformBlockBinding);
+        }
+    }
+
     void program::cache_block_indices()
     {
         GLint num_blocks = 0;
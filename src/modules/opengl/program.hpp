@@ -6,6 +6,7 @@
 #include "mge/graphics/shader_handle.hpp"
 #include "opengl.hpp"
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -28,19 +29,45 @@ namespace mge::opengl {
             return m_program;
         }
 
+        /**
+         * @brief Index of a uniform block.
+         *
+         * Each uniform block uses the binding point of its index, which
+         * is assigned once when the program is linked.
+         *
+         * @param name block name
+         * @return block index, @c GL_INVALID_INDEX if there is no such
+         *  block
+         */
         GLuint block_index(const std::string& name) const;
 
+        /**
+         * @brief Whether a compute shader is attached.
+         *
+         * @return @c true for compute programs
+         */
+        bool compute() const noexcept
+        {
+            return m_compute;
+        }
+
     private:
+        void compile_attached_shaders();
+        bool load_binary(uint64_t key);
+        void store_binary(uint64_t key);
         void dump_info_log();
         void collect_uniforms();
         void collect_uniform_buffers();
         void collect_uniform_buffers_43();
         void collect_uniform_buffers_31();
+        void assign_block_bindings();
         void cache_block_indices();
         void collect_attributes();
+        void collect_storage_buffers();
 
         GLuint                        m_program;
         std::map<std::string, GLuint> m_block_indices;
+        bool                          m_compute{false};
     };
 
     inline GLuint gl_program(const mge::program& p)
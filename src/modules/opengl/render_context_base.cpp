@@ -12,9 +12,13 @@
 #include "program.hpp"
 #include "render_system.hpp"
 #include "shader.hpp"
+#include "storage_buffer.hpp"
 #include "texture.hpp"
+#include "uniform_ring.hpp"
 #include "vertex_buffer.hpp"
 
+#include <algorithm>
+
 namespace mge {
     MGE_USE_TRACE(OPENGL);
 }
@@ -218,6 +222,13 @@ namespace mge::opengl {
         };
 
         m_capabilities = std::make_unique<capabilities>();
+
+        // separate attribute formats and buffer bindings, OpenGL 4.3 or
+        // ARB_vertex_attrib_binding
+        m_vertex_attrib_binding_supported =
+            glVertexAttribFormat && glVertexAttribBinding &&
+            glVertexBindingDivisor && glBindVertexBuffer;
+        m_uniform_ring = std::make_unique<uniform_ring>();
     }
 
     mge::index_buffer*
@@ -234,6 +245,12 @@ namespace mge::opengl {
         return new mge::opengl::vertex_buffer(*this, layout, data_size);
     }
 
+    mge::storage_buffer*
+    render_context_base::on_create_storage_buffer(size_t data_size)
+    {
+        return new mge::opengl::storage_buffer(*this, data_size);
+    }
+
     mge::shader* render_context_base::on_create_shader(mge::shader_type t)
     {
         return new shader(*this, t);
@@ -304,9 +321,130 @@ namespace mge::opengl {
         mge::vertex_buffer*              vb,
         mge::index_buffer*               ib,
         mge::uniform_block*              ub,
+        std::span<const std::byte>       uniform_data,
         const mge::texture_binding_list& textures,
         uint32_t                         index_count,
-        uint32_t                         index_offset)
+        uint32_t                         index_offset,
+        mge::vertex_buffer*              instances,
+        uint32_t                         instance_count)
+    {
+        GLenum index_type = bind_geometry(program,
+                                          vb,
+                                          ib,
+                                          ub,
+                                          uniform_data,
+                                          textures,
+                                          instances);
+        GLsizei count = index_count > 0
+                            ? static_cast<GLsizei>(index_count)
+                            : static_cast<GLsizei>(ib->element_count());
+        size_t index_size = index_type == GL_UNSIGNED_SHORT
+                                ? sizeof(uint16_t)
+                                : sizeof(uint32_t);
+
+        const void* offset_ptr =
+            reinterpret_cast<const void*>(index_offset * index_size);
+        if (instance_count > 1 || instances) {
+            glDrawElementsInstanced(GL_TRIANGLES,
+                                    count,
+                                    index_type,
+                                    offset_ptr,
+                                    static_cast<GLsizei>(instance_count));
+            CHECK_OPENGL_ERROR(glDrawElementsInstanced);
+        } else {
+            glDrawElements(GL_TRIANGLES, count, index_type, offset_ptr);
+            CHECK_OPENGL_ERROR(glDrawElements);
+        }
+    }
+
+    void render_context_base::draw_geometry_indirect(
+        mge::program*                    program,
+        mge::vertex_buffer*              vb,
+        mge::index_buffer*               ib,
+        mge::uniform_block*              ub,
+        std::span<const std::byte>       uniform_data,
+        const mge::texture_binding_list& textures,
+        GLuint                           commands,
+        size_t                           offset,
+        uint32_t                         draw_count,
+        mge::vertex_buffer*              instances)
+    {
+        if (!glDrawElementsIndirect) {
+            MGE_THROW(illegal_state) << "Indirect draws require OpenGL 4.0";
+        }
+        GLenum index_type = bind_geometry(program,
+                                          vb,
+                                          ib,
+                                          ub,
+                                          uniform_data,
+                                          textures,
+                                          instances);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+        CHECK_OPENGL_ERROR(glBindBuffer);
+        if (glMultiDrawElementsIndirect) {
+            glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                        index_type,
+                                        reinterpret_cast<const void*>(offset),
+                                        static_cast<GLsizei>(draw_count),
+                                        0);
+            CHECK_OPENGL_ERROR(glMultiDrawElementsIndirect);
+        } else {
+            // multi draw indirect needs OpenGL 4.3
+            for (uint32_t i = 0; i < draw_count; ++i) {
+                glDrawElementsIndirect(
+                    GL_TRIANGLES,
+                    index_type,
+                    reinterpret_cast<const void*>(
+                        offset +
+                        i * sizeof(mge::draw_indexed_indirect_command)));
+                CHECK_OPENGL_ERROR(glDrawElementsIndirect);
+            }
+        }
+    }
+
+    size_t render_context_base::upload_indirect_commands(
+        std::span<const mge::draw_indexed_indirect_command> commands)
+    {
+        const size_t size = commands.size_bytes();
+        if (m_indirect_offset + size > m_indirect_capacity) {
+            // orphan the storage, draws still reading it keep their copy
+            if (!m_indirect_buffer) {
+                glGenBuffers(1, &m_indirect_buffer);
+                CHECK_OPENGL_ERROR(glGenBuffers);
+            }
+            m_indirect_capacity = std::max({size,
+                                            2 * m_indirect_capacity,
+                                            INDIRECT_BUFFER_MIN_SIZE});
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer);
+            CHECK_OPENGL_ERROR(glBindBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER,
+                         static_cast<GLsizeiptr>(m_indirect_capacity),
+                         nullptr,
+                         GL_STREAM_DRAW);
+            CHECK_OPENGL_ERROR(glBufferData);
+            m_indirect_offset = 0;
+        } else {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect_buffer);
+            CHECK_OPENGL_ERROR(glBindBuffer);
+        }
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER,
+                        static_cast<GLintptr>(m_indirect_offset),
+                        static_cast<GLsizeiptr>(size),
+                        commands.data());
+        CHECK_OPENGL_ERROR(glBufferSubData);
+        size_t offset = m_indirect_offset;
+        m_indirect_offset += size;
+        return offset;
+    }
+
+    GLenum render_context_base::bind_geometry(
+        mge::program*                    program,
+        mge::vertex_buffer*              vb,
+        mge::index_buffer*               ib,
+        mge::uniform_block*              ub,
+        std::span<const std::byte>       uniform_data,
+        const mge::texture_binding_list& textures,
+        mge::vertex_buffer*              instances)
     {
         if (!program) {
             MGE_THROW(illegal_state) << "Draw command has no program assigned";
@@ -318,28 +456,27 @@ namespace mge::opengl {
 
         mge::opengl::program& gl_program =
             static_cast<opengl::program&>(*program);
-        glUseProgram(gl_program.program_name());
-        CHECK_OPENGL_ERROR(glUseProgram);
+        // sampler uniforms are program state, only set them when
+        // switching to the program
+        if (m_state_cache.use_program(gl_program.program_name())) {
+            for (const auto& sampler : gl_program.sampler_bindings()) {
+                glUniform1i(static_cast<GLint>(sampler.binding),
+                            static_cast<GLint>(sampler.binding));
+                CHECK_OPENGL_ERROR(glUniform1i);
+            }
+        }
 
         if (ub) {
-            bind_uniform_block(gl_program, *ub);
+            bind_uniform_block(gl_program, *ub, uniform_data);
         }
 
         for (const auto& binding : textures) {
             if (binding.texture) {
                 mge::opengl::texture& gl_tex =
                     static_cast<opengl::texture&>(*binding.texture);
-                glActiveTexture(GL_TEXTURE0 + binding.slot);
-                CHECK_OPENGL_ERROR(glActiveTexture);
-                glBindTexture(GL_TEXTURE_2D, gl_tex.texture_name());
-                CHECK_OPENGL_ERROR(glBindTexture);
+                m_state_cache.bind_texture(binding.slot, gl_tex.texture_name());
             }
         }
-        for (const auto& sampler : gl_program.sampler_bindings()) {
-            glUniform1i(static_cast<GLint>(sampler.binding),
-                        static_cast<GLint>(sampler.binding));
-            CHECK_OPENGL_ERROR(glUniform1i);
-        }
 
         if (!vb) {
             MGE_THROW(illegal_state)
@@ -354,106 +491,166 @@ namespace mge::opengl {
         mge::opengl::index_buffer& gl_ib =
             static_cast<opengl::index_buffer&>(*ib);
 
-        vao_key key = std::make_tuple(gl_vb.buffer_name(), gl_ib.buffer_name());
-        GLuint  vao = 0;
-        auto    it  = m_vaos.find(key);
-        if (it != m_vaos.end()) {
-            vao = it->second;
-        } else {
-            vao = create_vao(&gl_vb, &gl_ib);
-        }
-        glBindVertexArray(vao);
-        CHECK_OPENGL_ERROR(glBindVertexArray);
-        GLsizei count = index_count > 0
-                            ? static_cast<GLsizei>(index_count)
-                            : static_cast<GLsizei>(gl_ib.element_count());
+        mge::opengl::vertex_buffer* gl_instances =
+            static_cast<opengl::vertex_buffer*>(instances);
+
+        static const mge::vertex_layout no_instances;
+        vertex_array&                   va = get_vertex_array(
+            gl_vb.layout(),
+            gl_instances ? gl_instances->layout() : no_instances);
+        bind_vertex_buffers(va, gl_vb, gl_instances, gl_ib);
 
-        GLenum index_type;
-        size_t index_size;
         switch (gl_ib.element_type()) {
         case mge::data_type::UINT16:
-            index_type = GL_UNSIGNED_SHORT;
-            index_size = sizeof(uint16_t);
-            break;
+            return GL_UNSIGNED_SHORT;
         case mge::data_type::INT32:
         case mge::data_type::UINT32:
-            index_type = GL_UNSIGNED_INT;
-            index_size = sizeof(uint32_t);
-            break;
+            return GL_UNSIGNED_INT;
         default:
             MGE_THROW(mge::illegal_state)
                 << "Unsupported index buffer type: "
                 << static_cast<int>(gl_ib.element_type());
         }
-
-        const void* offset_ptr =
-            reinterpret_cast<const void*>(index_offset * index_size);
-        glDrawElements(GL_TRIANGLES, count, index_type, offset_ptr);
-        CHECK_OPENGL_ERROR(glDrawElements);
-        glBindVertexArray(0);
-        CHECK_OPENGL_ERROR(glBindVertexArray(0));
-        for (const auto& binding : textures) {
-            if (binding.texture) {
-                glActiveTexture(GL_TEXTURE0 + binding.slot);
-                glBindTexture(GL_TEXTURE_2D, 0);
-            }
-        }
-        glUseProgram(0);
-        CHECK_OPENGL_ERROR(glUseProgram(0));
     }
 
-    void render_context_base::bind_uniform_block(mge::opengl::program& gl_program,
-                                                 mge::uniform_block&   ub)
+    void render_context_base::bind_uniform_block(
+        mge::opengl::program&      gl_program,
+        const mge::uniform_block&  ub,
+        std::span<const std::byte> uniform_data)
     {
-        ub.sync_from_globals();
-
         GLuint block_index = gl_program.block_index(ub.name());
         if (block_index == GL_INVALID_INDEX) {
             MGE_THROW(mge::no_such_element)
                 << "Program has no uniform block named '" << ub.name() << "'";
         }
 
-        GLuint ubo = 0;
-        auto   it  = m_ubos.find(&ub);
-        if (it != m_ubos.end()) {
-            ubo = it->second;
-        } else {
-            glGenBuffers(1, &ubo);
-            CHECK_OPENGL_ERROR(glGenBuffers);
-            glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-            CHECK_OPENGL_ERROR(glBindBuffer);
-            glBufferData(GL_UNIFORM_BUFFER,
-                         static_cast<GLsizeiptr>(ub.data_size()),
-                         nullptr,
-                         GL_DYNAMIC_DRAW);
-            CHECK_OPENGL_ERROR(glBufferData);
-            m_ubos[&ub]         = ubo;
-            m_ubo_versions[&ub] = 0;
+        // the block data recorded with the draw is pushed once per pass,
+        // draws sharing the recorded copy bind the same range
+        auto& upload = m_uniform_uploads[uniform_data.data()];
+        if (!m_uniform_ring->contains(upload)) {
+            upload =
+                m_uniform_ring->push(uniform_data.data(), uniform_data.size());
         }
 
-        auto& cached_version = m_ubo_versions[&ub];
-        if (cached_version != ub.version()) {
-            glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-            CHECK_OPENGL_ERROR(glBindBuffer);
-            glBufferSubData(GL_UNIFORM_BUFFER,
-                            0,
-                            static_cast<GLsizeiptr>(ub.data_size()),
-                            ub.data());
-            CHECK_OPENGL_ERROR(glBufferSubData);
-            cached_version = ub.version();
+        // the binding point equals the block index, see program
+        m_state_cache.bind_uniform_buffer_range(
+            block_index,
+            upload.buffer,
+            static_cast<GLintptr>(upload.offset),
+            static_cast<GLsizeiptr>(upload.size));
+    }
+
+    static GLuint storage_gl_buffer(mge::hardware_buffer& buffer)
+    {
+        switch (buffer.type()) {
+        case mge::buffer_type::VERTEX:
+            return static_cast<vertex_buffer&>(buffer).buffer_name();
+        case mge::buffer_type::INDEX:
+            return static_cast<index_buffer&>(buffer).buffer_name();
+        case mge::buffer_type::STORAGE:
+            return static_cast<storage_buffer&>(buffer).buffer_name();
+        default:
+            break;
         }
+        MGE_THROW(illegal_argument)
+            << "Cannot bind buffer of type " << buffer.type()
+            << " as storage buffer";
+    }
 
-        GLuint binding_point = 0;
-        glUniformBlockBinding(gl_program.program_name(),
-                              block_index,
-                              binding_point);
-        CHECK_OPENGL_ERROR(glUniformBlockBinding);
-        glBindBufferBase(GL_UNIFORM_BUFFER, binding_point, ubo);
-        CHECK_OPENGL_ERROR(glBindBufferBase);
+    void render_context_base::dispatch(
+        mge::program*                           program,
+        mge::uniform_block*                     ub,
+        std::span<const std::byte>              uniform_data,
+        const mge::storage_buffer_binding_list& storage_buffers,
+        uint32_t                                groups_x,
+        uint32_t                                groups_y,
+        uint32_t                                groups_z)
+    {
+        if (!program) {
+            MGE_THROW(illegal_state)
+                << "Dispatch command has no program assigned";
+        }
+        if (program->needs_link()) {
+            MGE_THROW(illegal_state) << "Dispatch command has unlinked program "
+                                     << (void*)program << " assigned";
+        }
+        auto& gl_program = static_cast<opengl::program&>(*program);
+        if (!gl_program.compute()) {
+            MGE_THROW(illegal_state)
+                << "Dispatch command has program without compute shader";
+        }
+
+        m_state_cache.use_program(gl_program.program_name());
+        if (ub) {
+            bind_uniform_block(gl_program, *ub, uniform_data);
+        }
+        // storage blocks are bound by the binding declared in the shader,
+        // unbound slots are skipped like in the other backends
+        for (const auto& binding : storage_buffers) {
+            if (!binding.buffer) {
+                continue;
+            }
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER,
+                             binding.slot,
+                             storage_gl_buffer(*binding.buffer));
+            CHECK_OPENGL_ERROR(glBindBufferBase);
+        }
+        glDispatchCompute(groups_x, groups_y, groups_z);
+        CHECK_OPENGL_ERROR(glDispatchCompute);
+    }
+
+    void render_context_base::run_dispatches(const mge::pass& p)
+    {
+        if (!has_dispatches(p.index())) {
+            return;
+        }
+        if (!glDispatchCompute) {
+            MGE_THROW(illegal_state) << "Compute dispatch requires OpenGL 4.3";
+        }
+
+        bool first = true;
+        for_each_dispatch_in_pass(
+            p.index(),
+            [&](const program_handle&                  prog,
+                mge::uniform_block*                     ub,
+                std::span<const std::byte>              uniform_data,
+                const mge::storage_buffer_binding_list& storage_buffers,
+                uint32_t                                groups_x,
+                uint32_t                                groups_y,
+                uint32_t                                groups_z) {
+                if (!first) {
+                    // each dispatch sees the writes of the previous ones
+                    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                    CHECK_OPENGL_ERROR(glMemoryBarrier);
+                }
+                first = false;
+                dispatch(prog.get(),
+                         ub,
+                         uniform_data,
+                         storage_buffers,
+                         groups_x,
+                         groups_y,
+                         groups_z);
+            });
+
+        // the draws of the pass consume the written buffers as vertices,
+        // indices, indirect arguments or shader data
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT |
+                        GL_ELEMENT_ARRAY_BARRIER_BIT |
+                        GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        CHECK_OPENGL_ERROR(glMemoryBarrier);
     }
 
     void render_context_base::render(const mge::pass& p)
     {
+        // state may have been changed outside of pass rendering
+        m_state_cache.invalidate();
+        // recorded block data is released with the frame
+        m_uniform_uploads.clear();
+
+        // dispatches run before the draws of the pass
+        run_dispatches(p);
+
         GLuint fb = 0;
         if (p.frame_buffer()) {
             auto* fbo =
@@ -491,228 +688,200 @@ namespace mge::opengl {
         }
 
         if (p.clear_depth_enabled()) {
+            m_state_cache.depth_mask(true);
             glClearDepthf(static_cast<GLfloat>(p.clear_depth_value()));
             CHECK_OPENGL_ERROR(glClearDepthf);
             glClear(GL_DEPTH_BUFFER_BIT);
             CHECK_OPENGL_ERROR(glClear);
         }
 
-        glEnable(GL_DEPTH_TEST);
-        CHECK_OPENGL_ERROR(glEnable);
-
-        glEnable(GL_SCISSOR_TEST);
-        CHECK_OPENGL_ERROR(glEnable);
+        m_state_cache.enable(state_cache::capability::DEPTH_TEST, true);
+        m_state_cache.enable(state_cache::capability::SCISSOR_TEST, true);
 
-#ifndef GL_CONSERVATIVE_RASTERIZATION_NV
-#    define GL_CONSERVATIVE_RASTERIZATION_NV 0x9346
-#endif
-#ifndef GL_CONSERVATIVE_RASTERIZATION_INTEL
-#    define GL_CONSERVATIVE_RASTERIZATION_INTEL 0x9346
-#endif
+        mge::rectangle current_scissor = p.scissor();
+        auto           apply_scissor = [&](const mge::rectangle& cmd_scissor) {
+            const auto& effective =
+                cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
+            if (effective != current_scissor) {
+                glScissor(static_cast<const GLint>(effective.left),
+                          wh - static_cast<const GLint>(effective.bottom),
+                          static_cast<const GLsizei>(effective.width()),
+                          static_cast<const GLsizei>(effective.height()));
+                CHECK_OPENGL_ERROR(glScissor);
+                current_scissor = effective;
+            }
+        };
 
-        bool           blend_pass_needed = false;
-        mge::rectangle current_scissor   = p.scissor();
-        for_each_draw_in_pass(
+        // indirect draws run after the dispatches that may write their
+        // arguments and before the sorted draws
+        for_each_indirect_draw_in_pass(
             p.index(),
-            [this, wh, &blend_pass_needed, &current_scissor, &p](
-                const program_handle&            program,
+            [&](const program_handle&            program,
                 const vertex_buffer_handle&      vertices,
                 const index_buffer_handle&       indices,
                 const mge::pipeline_state&       state,
                 mge::uniform_block*              ub,
+                std::span<const std::byte>       uniform_data,
                 const mge::texture_binding_list& textures,
-                uint32_t                         index_count,
-                uint32_t                         index_offset,
-                const mge::rectangle&            cmd_scissor) {
-                blend_operation op = state.color_blend_operation();
-                if (op == blend_operation::NONE) {
-                    const auto& effective =
-                        cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                    if (effective != current_scissor) {
-                        glScissor(
-                            static_cast<const GLint>(effective.left),
-                            wh - static_cast<const GLint>(effective.bottom),
-                            static_cast<const GLsizei>(effective.width()),
-                            static_cast<const GLsizei>(effective.height()));
-                        current_scissor = effective;
-                    }
-                    mge::cull_mode cull = state.cull_mode();
-                    if (cull != mge::cull_mode::NONE) {
-                        glEnable(GL_CULL_FACE);
-                        CHECK_OPENGL_ERROR(glEnable);
-                        if (cull == mge::cull_mode::CLOCKWISE) {
-                            glCullFace(GL_FRONT);
-                        } else {
-                            glCullFace(GL_BACK);
-                        }
-                        CHECK_OPENGL_ERROR(glCullFace);
-                    }
-                    glDepthFunc(depth_test_to_gl(state.depth_test_function()));
-                    CHECK_OPENGL_ERROR(glDepthFunc);
-                    if (!state.depth_write()) {
-                        glDepthMask(GL_FALSE);
-                        CHECK_OPENGL_ERROR(glDepthMask);
-                    }
-                    bool conservative_raster_enabled =
-                        m_conservative_rasterization_supported &&
-                        state.test(pipeline_state::CONSERVATIVE_RASTERIZATION);
-                    if (conservative_raster_enabled) {
-                        glEnable(GL_CONSERVATIVE_RASTERIZATION_NV);
-                        CHECK_OPENGL_ERROR(glEnable);
-                    }
-                    draw_geometry(program.get(),
-                                  vertices.get(),
-                                  indices.get(),
-                                  ub,
-                                  textures,
-                                  index_count,
-                                  index_offset);
-                    if (conservative_raster_enabled) {
-                        glDisable(GL_CONSERVATIVE_RASTERIZATION_NV);
-                        CHECK_OPENGL_ERROR(glDisable);
-                    }
-                    if (!state.depth_write()) {
-                        glDepthMask(GL_TRUE);
-                        CHECK_OPENGL_ERROR(glDepthMask);
-                    }
-                    if (cull != mge::cull_mode::NONE) {
-                        glDisable(GL_CULL_FACE);
-                        CHECK_OPENGL_ERROR(glDisable);
-                    }
-                } else {
-                    blend_pass_needed = true;
+                const mge::rectangle&            cmd_scissor,
+                const storage_buffer_handle&     commands,
+                uint32_t                         first_command,
+                uint32_t                         draw_count) {
+                auto* gl_commands =
+                    static_cast<opengl::storage_buffer*>(commands.get());
+                if (!gl_commands) {
+                    MGE_THROW(illegal_state)
+                        << "Indirect draw command has no command buffer";
                 }
+                apply_scissor(cmd_scissor);
+                apply_pipeline_state(state);
+                draw_geometry_indirect(
+                    program.get(),
+                    vertices.get(),
+                    indices.get(),
+                    ub,
+                    uniform_data,
+                    textures,
+                    gl_commands->buffer_name(),
+                    first_command *
+                        sizeof(mge::draw_indexed_indirect_command),
+                    draw_count);
             });
 
-        if (blend_pass_needed) {
-            glEnable(GL_BLEND);
-            CHECK_OPENGL_ERROR(glEnable);
-            for_each_draw_in_pass(
+        if (p.draw_packing() && glDrawElementsIndirect) {
+            // runs of compatible draws become one indirect draw
+            for_each_packed_draw_in_pass(
                 p.index(),
-                [this, wh, &current_scissor, &p](
-                    const program_handle&            program,
+                [&](const program_handle&            program,
                     const vertex_buffer_handle&      vertices,
                     const index_buffer_handle&       indices,
                     const mge::pipeline_state&       state,
                     mge::uniform_block*              ub,
+                    std::span<const std::byte>       uniform_data,
                     const mge::texture_binding_list& textures,
-                    uint32_t                         index_count,
-                    uint32_t                         index_offset,
-                    const mge::rectangle&            cmd_scissor) {
-                    blend_operation color_op  = state.color_blend_operation();
-                    blend_operation alpha_op  = state.alpha_blend_operation();
-                    blend_factor    color_src = state.color_blend_factor_src();
-                    blend_factor    color_dst = state.color_blend_factor_dst();
-                    blend_factor    alpha_src = state.alpha_blend_factor_src();
-                    blend_factor    alpha_dst = state.alpha_blend_factor_dst();
-                    if (color_op != blend_operation::NONE) {
-                        const auto& effective =
-                            cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                        if (effective != current_scissor) {
-                            glScissor(
-                                static_cast<const GLint>(effective.left),
-                                wh - static_cast<const GLint>(effective.bottom),
-                                static_cast<const GLsizei>(effective.width()),
-                                static_cast<const GLsizei>(effective.height()));
-                            current_scissor = effective;
-                        }
-                        mge::cull_mode cull = state.cull_mode();
-                        if (cull != mge::cull_mode::NONE) {
-                            glEnable(GL_CULL_FACE);
-                            CHECK_OPENGL_ERROR(glEnable);
-                            if (cull == mge::cull_mode::CLOCKWISE) {
-                                glCullFace(GL_FRONT);
-                            } else {
-                                glCullFace(GL_BACK);
-                            }
-                            CHECK_OPENGL_ERROR(glCullFace);
-                        }
-                        glDepthFunc(
-                            depth_test_to_gl(state.depth_test_function()));
-                        CHECK_OPENGL_ERROR(glDepthFunc);
-                        if (color_op == alpha_op && color_src == alpha_src &&
-                            color_dst == alpha_dst) {
-                            glBlendFunc(blend_factor_to_gl(color_src),
-                                        blend_factor_to_gl(color_dst));
-                            CHECK_OPENGL_ERROR(glBlendFunc);
-                            glBlendEquation(blend_operation_to_gl(color_op));
-                            CHECK_OPENGL_ERROR(glBlendEquation);
-                        } else {
-                            glBlendFuncSeparate(blend_factor_to_gl(color_src),
-                                                blend_factor_to_gl(color_dst),
-                                                blend_factor_to_gl(alpha_src),
-                                                blend_factor_to_gl(alpha_dst));
-                            CHECK_OPENGL_ERROR(glBlendFuncSeparate);
-                            glBlendEquationSeparate(
-                                blend_operation_to_gl(color_op),
-                                blend_operation_to_gl(alpha_op));
-                            CHECK_OPENGL_ERROR(glBlendEquationSeparate);
-                        }
-                        if (!state.depth_write()) {
-                            glDepthMask(GL_FALSE);
-                            if (cull != mge::cull_mode::NONE) {
-                                glDisable(GL_CULL_FACE);
-                                CHECK_OPENGL_ERROR(glDisable);
-                            }
-                            CHECK_OPENGL_ERROR(glDepthMask);
-                        }
-                        bool conservative_raster_enabled =
-                            m_conservative_rasterization_supported &&
-                            state.test(
-                                pipeline_state::CONSERVATIVE_RASTERIZATION);
-                        if (conservative_raster_enabled) {
-                            glEnable(GL_CONSERVATIVE_RASTERIZATION_NV);
-                            CHECK_OPENGL_ERROR(glEnable);
-                        }
+                    const mge::rectangle&            cmd_scissor,
+                    const vertex_buffer_handle&      instances,
+                    std::span<const draw_indexed_indirect_command> commands) {
+                    apply_scissor(cmd_scissor);
+                    apply_pipeline_state(state);
+                    if (commands.size() == 1) {
                         draw_geometry(program.get(),
                                       vertices.get(),
                                       indices.get(),
                                       ub,
+                                      uniform_data,
                                       textures,
-                                      index_count,
-                                      index_offset);
-                        if (conservative_raster_enabled) {
-                            glDisable(GL_CONSERVATIVE_RASTERIZATION_NV);
-                            CHECK_OPENGL_ERROR(glDisable);
-                        }
-                        if (!state.depth_write()) {
-                            glDepthMask(GL_TRUE);
-                            CHECK_OPENGL_ERROR(glDepthMask);
-                        }
+                                      commands[0].index_count,
+                                      commands[0].first_index,
+                                      instances.get(),
+                                      commands[0].instance_count);
+                        return;
                     }
+                    size_t offset = upload_indirect_commands(commands);
+                    draw_geometry_indirect(
+                        program.get(),
+                        vertices.get(),
+                        indices.get(),
+                        ub,
+                        uniform_data,
+                        textures,
+                        m_indirect_buffer,
+                        offset,
+                        static_cast<uint32_t>(commands.size()),
+                        instances.get());
+                });
+        } else {
+            // opaque draws are visited first, followed by translucent
+            // draws in back to front order
+            for_each_draw_in_pass(
+                p.index(),
+                [&](const program_handle&            program,
+                    const vertex_buffer_handle&      vertices,
+                    const index_buffer_handle&       indices,
+                    const mge::pipeline_state&       state,
+                    mge::uniform_block*              ub,
+                    std::span<const std::byte>       uniform_data,
+                    const mge::texture_binding_list& textures,
+                    uint32_t                         index_count,
+                    uint32_t                         index_offset,
+                    const mge::rectangle&            cmd_scissor,
+                    const vertex_buffer_handle&      instances,
+                    uint32_t                         instance_count) {
+                    apply_scissor(cmd_scissor);
+                    apply_pipeline_state(state);
+                    draw_geometry(program.get(),
+                                  vertices.get(),
+                                  indices.get(),
+                                  ub,
+                                  uniform_data,
+                                  textures,
+                                  index_count,
+                                  index_offset,
+                                  instances.get(),
+                                  instance_count);
                 });
-            glDisable(GL_BLEND);
-            CHECK_OPENGL_ERROR(glDisable);
         }
 
-        glDisable(GL_SCISSOR_TEST);
-        CHECK_OPENGL_ERROR(glDisable);
+        // index buffer uploads bind GL_ELEMENT_ARRAY_BUFFER, which must
+        // not modify a vertex array left bound
+        m_state_cache.bind_vertex_array(0);
+        m_state_cache.depth_mask(true);
+        m_state_cache.enable(state_cache::capability::BLEND, false);
+        m_state_cache.enable(state_cache::capability::CULL_FACE, false);
+        if (m_conservative_rasterization_supported) {
+            m_state_cache.enable(
+                state_cache::capability::CONSERVATIVE_RASTERIZATION,
+                false);
+        }
+        m_state_cache.enable(state_cache::capability::SCISSOR_TEST, false);
+        m_state_cache.enable(state_cache::capability::DEPTH_TEST, false);
+    }
 
-        glDisable(GL_DEPTH_TEST);
-        CHECK_OPENGL_ERROR(glDisable);
+    void
+    render_context_base::apply_pipeline_state(const mge::pipeline_state& state)
+    {
+        mge::cull_mode cull = state.cull_mode();
+        m_state_cache.enable(state_cache::capability::CULL_FACE,
+                             cull != mge::cull_mode::NONE);
+        if (cull != mge::cull_mode::NONE) {
+            m_state_cache.cull_face(
+                cull == mge::cull_mode::CLOCKWISE ? GL_FRONT : GL_BACK);
+        }
+        m_state_cache.depth_func(depth_test_to_gl(state.depth_test_function()));
+        m_state_cache.depth_mask(state.depth_write());
+
+        blend_operation color_op = state.color_blend_operation();
+        m_state_cache.enable(state_cache::capability::BLEND,
+                             color_op != blend_operation::NONE);
+        if (color_op != blend_operation::NONE) {
+            m_state_cache.blend_func(
+                blend_factor_to_gl(state.color_blend_factor_src()),
+                blend_factor_to_gl(state.color_blend_factor_dst()),
+                blend_factor_to_gl(state.alpha_blend_factor_src()),
+                blend_factor_to_gl(state.alpha_blend_factor_dst()));
+            m_state_cache.blend_equation(
+                blend_operation_to_gl(color_op),
+                blend_operation_to_gl(state.alpha_blend_operation()));
+        }
+
+        if (m_conservative_rasterization_supported) {
+            m_state_cache.enable(
+                state_cache::capability::CONSERVATIVE_RASTERIZATION,
+                state.test(pipeline_state::CONSERVATIVE_RASTERIZATION));
+        }
     }
 
-    GLuint render_context_base::create_vao(mge::opengl::vertex_buffer* vb,
-                                           mge::opengl::index_buffer*  ib)
+    static void setup_vertex_attributes(const mge::vertex_layout& layout,
+                                        uint32_t                  first_index)
     {
-        vao_key key = std::make_tuple(vb->buffer_name(), ib->buffer_name());
-        GLuint  vao = 0;
-        glGenVertexArrays(1, &vao);
-        CHECK_OPENGL_ERROR(glGenVertexArrays);
-        glBindVertexArray(vao);
-        CHECK_OPENGL_ERROR(glBindVertexArray);
-        glBindBuffer(GL_ARRAY_BUFFER, vb->buffer_name());
-        CHECK_OPENGL_ERROR(glBindBuffer(GL_ARRAY_BUFFER));
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib->buffer_name());
-        CHECK_OPENGL_ERROR(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER));
-
-        const auto& layout = vb->layout();
-        GLsizei     stride = static_cast<GLsizei>(layout.stride());
-        uint32_t    index  = 0;
-        for (const auto& f : layout.formats()) {
+        GLsizei  stride = static_cast<GLsizei>(layout.stride());
+        GLuint   divisor = layout.instance_step_rate();
+        uint32_t index = first_index;
+        for (size_t i = 0; i < layout.size(); ++i) {
+            const auto& f = layout.formats()[i];
             glEnableVertexAttribArray(index);
             CHECK_OPENGL_ERROR(glEnableVertexAttribArray);
-            auto offset = reinterpret_cast<const void*>(layout.offset(index));
+            auto offset = reinterpret_cast<const void*>(layout.offset(i));
             switch (f.type()) {
             case mge::data_type::FLOAT:
                 glVertexAttribPointer(index,
@@ -736,12 +905,222 @@ namespace mge::opengl {
                 MGE_THROW(opengl::error)
                     << "Unsupported vertex array element type " << f.type();
             }
+            if (divisor != 0) {
+                glVertexAttribDivisor(index, divisor);
+                CHECK_OPENGL_ERROR(glVertexAttribDivisor);
+            }
             ++index;
         }
-        glBindVertexArray(0);
-        CHECK_OPENGL_ERROR(glBindVertexArray(0));
+    }
 
-        return m_vaos[key] = vao;
+    static void setup_vertex_formats(const mge::vertex_layout& layout,
+                                     uint32_t                  first_index,
+                                     GLuint                    binding)
+    {
+        uint32_t index = first_index;
+        for (size_t i = 0; i < layout.size(); ++i) {
+            const auto& f = layout.formats()[i];
+            glEnableVertexAttribArray(index);
+            CHECK_OPENGL_ERROR(glEnableVertexAttribArray);
+            auto offset = static_cast<GLuint>(layout.offset(i));
+            switch (f.type()) {
+            case mge::data_type::FLOAT:
+                glVertexAttribFormat(index,
+                                     f.size(),
+                                     GL_FLOAT,
+                                     GL_FALSE,
+                                     offset);
+                break;
+            case mge::data_type::UINT8:
+                glVertexAttribFormat(index,
+                                     f.size(),
+                                     GL_UNSIGNED_BYTE,
+                                     GL_TRUE,
+                                     offset);
+                break;
+            default:
+                MGE_THROW(opengl::error)
+                    << "Unsupported vertex array element type " << f.type();
+            }
+            CHECK_OPENGL_ERROR(glVertexAttribFormat);
+            glVertexAttribBinding(index, binding);
+            CHECK_OPENGL_ERROR(glVertexAttribBinding);
+            ++index;
+        }
+        glVertexBindingDivisor(binding, layout.instance_step_rate());
+        CHECK_OPENGL_ERROR(glVertexBindingDivisor);
+    }
+
+    render_context_base::vertex_array&
+    render_context_base::get_vertex_array(const mge::vertex_layout& layout,
+                                          const mge::vertex_layout& instances)
+    {
+        // look up with the borrowed layouts, only a new vertex array
+        // copies them into the key
+        auto it = m_vaos.find(vao_key_ref(layout, instances));
+        if (it != m_vaos.end()) {
+            return it->second;
+        }
+        vertex_array va;
+        va.vao = create_vao(layout, instances);
+        it = m_vaos.emplace(vao_key(layout, instances), va).first;
+        it->second.key = &it->first;
+        return it->second;
+    }
+
+    GLuint render_context_base::create_vao(const mge::vertex_layout& layout,
+                                           const mge::vertex_layout& instances)
+    {
+        if (!instances.empty() && !instances.per_instance()) {
+            MGE_THROW(mge::illegal_argument)
+                << "Instance buffer layout " << instances
+                << " has no instance step rate";
+        }
+        GLuint vao = 0;
+        glGenVertexArrays(1, &vao);
+        CHECK_OPENGL_ERROR(glGenVertexArrays);
+        MGE_DEBUG_TRACE(OPENGL,
+                        "Create vertex array {} for layout {}",
+                        vao,
+                        layout);
+        // without attribute bindings the formats are specified together
+        // with the buffer in bind_vertex_buffers
+        if (m_vertex_attrib_binding_supported) {
+            m_state_cache.bind_vertex_array(vao);
+            setup_vertex_formats(layout, 0, 0);
+            if (!instances.empty()) {
+                setup_vertex_formats(instances,
+                                     static_cast<uint32_t>(layout.size()),
+                                     1);
+            }
+        }
+        return vao;
+    }
+
+    void render_context_base::bind_vertex_buffers(
+        vertex_array&               va,
+        mge::opengl::vertex_buffer& vb,
+        mge::opengl::vertex_buffer* instances,
+        mge::opengl::index_buffer&  ib)
+    {
+        m_state_cache.bind_vertex_array(va.vao);
+        // the element array binding is vertex array state
+        if (va.index_buffer != ib.buffer_name()) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib.buffer_name());
+            CHECK_OPENGL_ERROR(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER));
+            attach_buffer(va, va.index_buffer, ib.buffer_name());
+        }
+        if (va.vertex_buffer != vb.buffer_name()) {
+            if (m_vertex_attrib_binding_supported) {
+                glBindVertexBuffer(
+                    0,
+                    vb.buffer_name(),
+                    0,
+                    static_cast<GLsizei>(vb.layout().stride()));
+                CHECK_OPENGL_ERROR(glBindVertexBuffer);
+            } else {
+                glBindBuffer(GL_ARRAY_BUFFER, vb.buffer_name());
+                CHECK_OPENGL_ERROR(glBindBuffer(GL_ARRAY_BUFFER));
+                setup_vertex_attributes(vb.layout(), 0);
+            }
+            attach_buffer(va, va.vertex_buffer, vb.buffer_name());
+        }
+        if (instances && va.instance_buffer != instances->buffer_name()) {
+            if (m_vertex_attrib_binding_supported) {
+                glBindVertexBuffer(
+                    1,
+                    instances->buffer_name(),
+                    0,
+                    static_cast<GLsizei>(instances->layout().stride()));
+                CHECK_OPENGL_ERROR(glBindVertexBuffer);
+            } else {
+                glBindBuffer(GL_ARRAY_BUFFER, instances->buffer_name());
+                CHECK_OPENGL_ERROR(glBindBuffer(GL_ARRAY_BUFFER));
+                setup_vertex_attributes(
+                    instances->layout(),
+                    static_cast<uint32_t>(vb.layout().size()));
+            }
+            attach_buffer(va, va.instance_buffer, instances->buffer_name());
+        }
+    }
+
+    void render_context_base::attach_buffer(vertex_array& va,
+                                            GLuint&       attachment,
+                                            GLuint        buffer)
+    {
+        GLuint previous = attachment;
+        attachment = buffer;
+        if (previous != 0 && !va.attached(previous)) {
+            release_buffer_reference(&va, previous);
+        }
+        if (buffer != 0) {
+            auto& vaos = m_buffer_vaos[buffer];
+            if (std::find(vaos.begin(), vaos.end(), &va) == vaos.end()) {
+                vaos.push_back(&va);
+            }
+        }
+    }
+
+    void render_context_base::release_buffer_reference(vertex_array* va,
+                                                       GLuint        buffer)
+    {
+        auto it = m_buffer_vaos.find(buffer);
+        if (it == m_buffer_vaos.end()) {
+            return;
+        }
+        std::erase(it->second, va);
+        if (it->second.empty()) {
+            m_buffer_vaos.erase(it);
+        }
+    }
+
+    void render_context_base::forget_buffer(GLuint buffer)
+    {
+        if (buffer == 0) {
+            return;
+        }
+        auto it = m_buffer_vaos.find(buffer);
+        if (it == m_buffer_vaos.end()) {
+            return;
+        }
+        std::vector<vertex_array*> vaos = std::move(it->second);
+        m_buffer_vaos.erase(it);
+
+        m_state_cache.bind_vertex_array(0);
+        for (vertex_array* va : vaos) {
+            if (!m_vertex_attrib_binding_supported) {
+                // attribute pointers reference the buffer, drop the
+                // vertex array instead of specifying them again
+                glDeleteVertexArrays(1, &va->vao);
+                CHECK_OPENGL_ERROR(glDeleteVertexArrays);
+                for (GLuint other : {va->vertex_buffer,
+                                     va->instance_buffer,
+                                     va->index_buffer}) {
+                    if (other != 0 && other != buffer) {
+                        release_buffer_reference(va, other);
+                    }
+                }
+                m_vaos.erase(m_vaos.find(*va->key));
+                continue;
+            }
+            m_state_cache.bind_vertex_array(va->vao);
+            if (va->index_buffer == buffer) {
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                CHECK_OPENGL_ERROR(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER));
+                va->index_buffer = 0;
+            }
+            if (va->vertex_buffer == buffer) {
+                glBindVertexBuffer(0, 0, 0, 0);
+                CHECK_OPENGL_ERROR(glBindVertexBuffer);
+                va->vertex_buffer = 0;
+            }
+            if (va->instance_buffer == buffer) {
+                glBindVertexBuffer(1, 0, 0, 0);
+                CHECK_OPENGL_ERROR(glBindVertexBuffer);
+                va->instance_buffer = 0;
+            }
+        }
+        m_state_cache.bind_vertex_array(0);
     }
 
 } // namespace mge::opengl
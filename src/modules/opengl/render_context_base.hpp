@@ -9,9 +9,16 @@
 #include "mge/graphics/uniform_block.hpp"
 #include "opengl.hpp"
 #include "opengl_info.hpp"
+#include "state_cache.hpp"
+#include "uniform_ring.hpp"
 
-#include <map>
-#include <tuple>
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_node_map.hpp>
+
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
 
 namespace mge::opengl {
     class render_system;
@@ -32,6 +39,9 @@ namespace mge::opengl {
         on_create_vertex_buffer(const mge::vertex_layout& layout,
                                 size_t                    data_size) override;
 
+        mge::storage_buffer*
+        on_create_storage_buffer(size_t data_size) override;
+
         mge::shader*       on_create_shader(shader_type t) override;
         mge::program*      on_create_program() override;
         mge::frame_buffer* on_create_frame_buffer(
@@ -53,6 +63,18 @@ namespace mge::opengl {
         mge::rectangle default_scissor() const;
         uint32_t       window_height() const;
 
+        /**
+         * @brief Detach a buffer that is about to be deleted from all
+         * vertex arrays.
+         *
+         * Deleting a buffer only detaches it from the bound vertex
+         * array, other vertex arrays would keep its storage alive and
+         * a buffer created later could reuse its name.
+         *
+         * @param buffer buffer name
+         */
+        void forget_buffer(GLuint buffer);
+
     protected:
         render_context_base(mge::opengl::render_system& render_system_,
                             const mge::extent&          ext);
@@ -61,19 +83,101 @@ namespace mge::opengl {
         void collect_opengl_info();
         void init_capabilities();
 
-        GLuint create_vao(mge::opengl::vertex_buffer* vb,
-                          mge::opengl::index_buffer*  ib);
+        /// Vertex layout and instance layout, empty without instances.
+        using vao_key = std::pair<mge::vertex_layout, mge::vertex_layout>;
+        /// Borrowed vertex and instance layout to look up a vertex array.
+        using vao_key_ref =
+            std::pair<const mge::vertex_layout&, const mge::vertex_layout&>;
+
+        /// Vertex array of a vertex and instance layout.
+        struct vertex_array
+        {
+            GLuint vao{0};
+            /// Buffers currently attached to the vertex array.
+            GLuint vertex_buffer{0};
+            GLuint instance_buffer{0};
+            GLuint index_buffer{0};
+            /// Key of the vertex array in @c m_vaos.
+            const vao_key* key{nullptr};
+
+            bool attached(GLuint buffer) const noexcept
+            {
+                return vertex_buffer == buffer || instance_buffer == buffer ||
+                       index_buffer == buffer;
+            }
+        };
+
+        vertex_array& get_vertex_array(const mge::vertex_layout& layout,
+                                       const mge::vertex_layout& instances);
+        GLuint        create_vao(const mge::vertex_layout& layout,
+                                 const mge::vertex_layout& instances);
+        void          bind_vertex_buffers(vertex_array&               va,
+                                          mge::opengl::vertex_buffer& vb,
+                                          mge::opengl::vertex_buffer* instances,
+                                          mge::opengl::index_buffer&  ib);
+        void          attach_buffer(vertex_array& va,
+                                    GLuint&       attachment,
+                                    GLuint        buffer);
+        void          release_buffer_reference(vertex_array* va, GLuint buffer);
 
         void draw_geometry(mge::program*                    program,
                            mge::vertex_buffer*              vb,
                            mge::index_buffer*               ib,
                            mge::uniform_block*              ub,
+                           std::span<const std::byte>       uniform_data,
                            const mge::texture_binding_list& textures,
                            uint32_t                         index_count  = 0,
-                           uint32_t                         index_offset = 0);
+                           uint32_t                         index_offset = 0,
+                           mge::vertex_buffer*              instances = nullptr,
+                           uint32_t                         instance_count = 1);
 
-        void bind_uniform_block(mge::opengl::program& gl_program,
-                                mge::uniform_block&   ub);
+        void draw_geometry_indirect(
+            mge::program*                    program,
+            mge::vertex_buffer*              vb,
+            mge::index_buffer*               ib,
+            mge::uniform_block*              ub,
+            std::span<const std::byte>       uniform_data,
+            const mge::texture_binding_list& textures,
+            GLuint                           commands,
+            size_t                           offset,
+            uint32_t                         draw_count,
+            mge::vertex_buffer*              instances = nullptr);
+
+        GLenum bind_geometry(mge::program*                    program,
+                             mge::vertex_buffer*              vb,
+                             mge::index_buffer*               ib,
+                             mge::uniform_block*              ub,
+                             std::span<const std::byte>       uniform_data,
+                             const mge::texture_binding_list& textures,
+                             mge::vertex_buffer*              instances);
+
+        /**
+         * @brief Copy packed draw commands into the indirect buffer.
+         *
+         * The indirect buffer is written front to back and orphaned
+         * when full, so commands of earlier draws are not overwritten.
+         *
+         * @param commands commands to copy
+         * @return byte offset of the commands in @c m_indirect_buffer
+         */
+        size_t upload_indirect_commands(
+            std::span<const mge::draw_indexed_indirect_command> commands);
+
+        void bind_uniform_block(mge::opengl::program&      gl_program,
+                                const mge::uniform_block&  ub,
+                                std::span<const std::byte> uniform_data);
+
+        void dispatch(mge::program*                           program,
+                      mge::uniform_block*                     ub,
+                      std::span<const std::byte>              uniform_data,
+                      const mge::storage_buffer_binding_list& storage_buffers,
+                      uint32_t                                groups_x,
+                      uint32_t                                groups_y,
+                      uint32_t                                groups_z);
+
+        void run_dispatches(const mge::pass& p);
+
+        void apply_pipeline_state(const mge::pipeline_state& state);
 
         mge::opengl::render_system& m_render_system;
 
@@ -81,11 +185,75 @@ namespace mge::opengl {
         static bool                   s_gl3w_initialized;
 
         bool m_conservative_rasterization_supported{false};
+        bool m_vertex_attrib_binding_supported{false};
+
+        state_cache m_state_cache;
+
+        struct vao_key_hash
+        {
+            using is_transparent = void;
+
+            size_t operator()(const vao_key& key) const noexcept
+            {
+                return hash(key.first, key.second);
+            }
+
+            size_t operator()(const vao_key_ref& key) const noexcept
+            {
+                return hash(key.first, key.second);
+            }
+
+            static size_t hash(const mge::vertex_layout& layout,
+                               const mge::vertex_layout& instances) noexcept
+            {
+                std::hash<mge::vertex_layout> h;
+                return h(layout) * 31 + h(instances);
+            }
+        };
+
+        struct vao_key_equal
+        {
+            using is_transparent = void;
+
+            bool operator()(const vao_key& lhs,
+                            const vao_key& rhs) const noexcept
+            {
+                return lhs == rhs;
+            }
+
+            bool operator()(const vao_key_ref& lhs,
+                            const vao_key&     rhs) const noexcept
+            {
+                return lhs.first == rhs.first && lhs.second == rhs.second;
+            }
+
+            bool operator()(const vao_key&     lhs,
+                            const vao_key_ref& rhs) const noexcept
+            {
+                return (*this)(rhs, lhs);
+            }
+        };
+
+        /// Node based, @c m_buffer_vaos points into the vertex arrays.
+        boost::unordered_node_map<vao_key,
+                                  vertex_array,
+                                  vao_key_hash,
+                                  vao_key_equal>
+            m_vaos;
+        /// Vertex arrays a buffer is attached to, by buffer name.
+        boost::unordered_flat_map<GLuint, std::vector<vertex_array*>>
+            m_buffer_vaos;
+
+        std::unique_ptr<uniform_ring> m_uniform_ring;
+        /// Ring ranges of the recorded uniform block data, by its address.
+        boost::unordered_flat_map<const std::byte*, uniform_ring::allocation>
+            m_uniform_uploads;
+
+        static constexpr size_t INDIRECT_BUFFER_MIN_SIZE = 64 * 1024;
 
-        using vao_key = std::tuple<GLuint, GLuint>;
-        std::map<vao_key, GLuint>               m_vaos;
-        std::map<mge::uniform_block*, GLuint>   m_ubos;
-        std::map<mge::uniform_block*, uint64_t> m_ubo_versions;
+        GLuint m_indirect_buffer{0};
+        size_t m_indirect_capacity{0};
+        size_t m_indirect_offset{0};
     };
 
 } // namespace mge::opengl
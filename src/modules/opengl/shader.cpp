@@ -3,7 +3,9 @@
 // All rights reserved.
 #include "shader.hpp"
 #include "error.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/core/trace.hpp"
+#include "mge/graphics/shader_cache.hpp"
 #include "render_context_base.hpp"
 
 namespace mge {
@@ -47,24 +49,46 @@ namespace mge::opengl {
         glShaderSource(m_shader, 1, &src_ptr, &src_length);
         CHECK_OPENGL_ERROR(glShaderSource);
 
-        glCompileShader(m_shader);
-        CHECK_OPENGL_ERROR(glCompileShader);
-        GLint success = GL_FALSE;
-        glGetShaderiv(m_shader, GL_COMPILE_STATUS, &success);
-        if (success == GL_FALSE) {
-            throw_compilation_error();
+        // a source that compiled before with this driver is only compiled
+        // if a program using it misses the program binary cache
+        auto&          ctx = static_cast<render_context_base&>(context());
+        const auto&    info = ctx.gl_info();
+        const uint32_t type = static_cast<uint32_t>(m_type);
+        const uint64_t key = mge::fnv1a(
+            source,
+            mge::fnv1a(&type,
+                       sizeof(type),
+                       mge::fnv1a("shader", info.cache_seed())));
+        if (info.program_binary_supported && mge::shader_cache().get(key)) {
+            MGE_DEBUG_TRACE(OPENGL,
+                            "Deferring compilation of shader {:016x}",
+                            key);
+            return;
+        }
+        compile_shader(m_shader);
+        if (info.program_binary_supported) {
+            mge::shader_cache().put(key, {});
         }
     }
 
-    void shader::throw_compilation_error()
+    void compile_shader(GLuint shader)
     {
-        GLint log_length = 0;
-        glGetShaderiv(m_shader, GL_INFO_LOG_LENGTH, &log_length);
+        glCompileShader(shader);
+        CHECK_OPENGL_ERROR(glCompileShader);
+        GLint success = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success == GL_FALSE) {
+            GLint log_length = 0;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
 
-        std::vector<GLchar> log((size_t)log_length + 1);
-        glGetShaderInfoLog(m_shader, log_length, &log_length, &log[0]);
-        MGE_ERROR_TRACE(OPENGL, "Shader compilation failed: {}", &(log[0]));
-        MGE_THROW(opengl::error) << "Shader compilation failed: " << &(log[0]);
+            std::vector<GLchar> log((size_t)log_length + 1);
+            glGetShaderInfoLog(shader, log_length, &log_length, &log[0]);
+            MGE_ERROR_TRACE(OPENGL,
+                            "Shader compilation failed: {}",
+                            &(log[0]));
+            MGE_THROW(opengl::error)
+                << "Shader compilation failed: " << &(log[0]);
+        }
     }
 
     void shader::create_shader()
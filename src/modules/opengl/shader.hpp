@@ -26,9 +26,17 @@ namespace mge::opengl {
 
     private:
         void create_shader();
-        void throw_compilation_error();
 
         GLenum gl_shader_type() const;
         GLuint m_shader;
     };
+
+    /**
+     * @brief Compile a shader whose source is set.
+     *
+     * @param shader shader name
+     * @throws opengl::error if compilation fails
+     */
+    void compile_shader(GLuint shader);
+
 } // namespace mge::opengl
\ No newline at end of file
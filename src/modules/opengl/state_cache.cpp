@@ -0,0 +1,213 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "state_cache.hpp"
+#include "error.hpp"
+#include "mge/core/stdexceptions.hpp"
+
+using namespace std::string_view_literals;
+
+#ifndef GL_CONSERVATIVE_RASTERIZATION_NV
+#    define GL_CONSERVATIVE_RASTERIZATION_NV 0x9346
+#endif
+
+namespace mge::opengl {
+
+    static inline GLenum capability_to_gl(state_cache::capability cap)
+    {
+        switch (cap) {
+        case state_cache::capability::BLEND:
+            return GL_BLEND;
+        case state_cache::capability::CULL_FACE:
+            return GL_CULL_FACE;
+        case state_cache::capability::DEPTH_TEST:
+            return GL_DEPTH_TEST;
+        case state_cache::capability::SCISSOR_TEST:
+            return GL_SCISSOR_TEST;
+        case state_cache::capability::CONSERVATIVE_RASTERIZATION:
+            return GL_CONSERVATIVE_RASTERIZATION_NV;
+        default:
+            MGE_THROW(mge::illegal_argument)
+                << "Unknown capability: " << static_cast<int>(cap);
+        }
+    }
+
+    state_cache::cache_statistics::cache_statistics()
+        : mge::statistics(mge::statistics::root(), "opengl_state"sv)
+    {
+        issued_calls = 0;
+        skipped_calls = 0;
+    }
+
+    state_cache::cache_statistics::~cache_statistics()
+    {
+        release();
+    }
+
+    const mge::statistics::description&
+    state_cache::cache_statistics::describe() const
+    {
+        static statistics::description desc(
+            "opengl_state"sv,
+            "OpenGL state change statistics"sv,
+            {statistics::description::field("issued_calls"sv,
+                                            &cache_statistics::issued_calls),
+             statistics::description::field(
+                 "skipped_calls"sv,
+                 &cache_statistics::skipped_calls)});
+        return desc;
+    }
+
+    state_cache::cache_statistics& state_cache::process_statistics()
+    {
+        static cache_statistics s_statistics;
+        return s_statistics;
+    }
+
+    state_cache::state_cache()
+        : m_statistics(process_statistics())
+    {
+        invalidate();
+    }
+
+    state_cache::~state_cache() {}
+
+    void state_cache::invalidate() noexcept
+    {
+        m_program = UNKNOWN_NAME;
+        m_vertex_array = UNKNOWN_NAME;
+        m_active_texture = UNKNOWN_NAME;
+        m_textures.fill(UNKNOWN_NAME);
+        m_uniform_buffers.fill(buffer_range{UNKNOWN_NAME, 0, 0});
+        m_capabilities.fill(UNKNOWN_FLAG);
+        m_cull_face = UNKNOWN_ENUM;
+        m_depth_func = UNKNOWN_ENUM;
+        m_depth_mask = UNKNOWN_FLAG;
+        m_blend_func.fill(UNKNOWN_ENUM);
+        m_blend_equation.fill(UNKNOWN_ENUM);
+    }
+
+    bool state_cache::use_program(GLuint program)
+    {
+        if (!update(m_program, program)) {
+            return false;
+        }
+        glUseProgram(program);
+        CHECK_OPENGL_ERROR(glUseProgram);
+        return true;
+    }
+
+    void state_cache::bind_vertex_array(GLuint vao)
+    {
+        if (update(m_vertex_array, vao)) {
+            glBindVertexArray(vao);
+            CHECK_OPENGL_ERROR(glBindVertexArray);
+        }
+    }
+
+    void state_cache::vertex_array_bound(GLuint vao) noexcept
+    {
+        m_vertex_array = vao;
+    }
+
+    void state_cache::bind_texture(uint32_t unit, GLuint texture)
+    {
+        if (unit < MAX_TEXTURE_UNITS &&
+            !update(m_textures[unit], texture)) {
+            return;
+        }
+        if (update(m_active_texture, unit)) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            CHECK_OPENGL_ERROR(glActiveTexture);
+        }
+        glBindTexture(GL_TEXTURE_2D, texture);
+        CHECK_OPENGL_ERROR(glBindTexture);
+    }
+
+    void state_cache::bind_uniform_buffer(uint32_t binding, GLuint buffer)
+    {
+        if (binding < MAX_UNIFORM_BUFFER_BINDINGS &&
+            !update(m_uniform_buffers[binding], buffer_range{buffer, 0, 0})) {
+            return;
+        }
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+        CHECK_OPENGL_ERROR(glBindBufferBase);
+    }
+
+    void state_cache::bind_uniform_buffer_range(uint32_t   binding,
+                                                GLuint     buffer,
+                                                GLintptr   offset,
+                                                GLsizeiptr size)
+    {
+        if (binding < MAX_UNIFORM_BUFFER_BINDINGS &&
+            !update(m_uniform_buffers[binding],
+                    buffer_range{buffer, offset, size})) {
+            return;
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+        CHECK_OPENGL_ERROR(glBindBufferRange);
+    }
+
+    void state_cache::enable(capability cap, bool enabled)
+    {
+        auto& cached = m_capabilities[static_cast<size_t>(cap)];
+        if (!update(cached, static_cast<int8_t>(enabled ? 1 : 0))) {
+            return;
+        }
+        if (enabled) {
+            glEnable(capability_to_gl(cap));
+            CHECK_OPENGL_ERROR(glEnable);
+        } else {
+            glDisable(capability_to_gl(cap));
+            CHECK_OPENGL_ERROR(glDisable);
+        }
+    }
+
+    void state_cache::cull_face(GLenum mode)
+    {
+        if (update(m_cull_face, mode)) {
+            glCullFace(mode);
+            CHECK_OPENGL_ERROR(glCullFace);
+        }
+    }
+
+    void state_cache::depth_func(GLenum func)
+    {
+        if (update(m_depth_func, func)) {
+            glDepthFunc(func);
+            CHECK_OPENGL_ERROR(glDepthFunc);
+        }
+    }
+
+    void state_cache::depth_mask(bool enabled)
+    {
+        if (update(m_depth_mask, static_cast<int8_t>(enabled ? 1 : 0))) {
+            glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+            CHECK_OPENGL_ERROR(glDepthMask);
+        }
+    }
+
+    void state_cache::blend_func(GLenum src_rgb,
+                                 GLenum dst_rgb,
+                                 GLenum src_alpha,
+                                 GLenum dst_alpha)
+    {
+        if (update(m_blend_func,
+                   std::array<GLenum, 4>{src_rgb,
+                                         dst_rgb,
+                                         src_alpha,
+                                         dst_alpha})) {
+            glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+            CHECK_OPENGL_ERROR(glBlendFuncSeparate);
+        }
+    }
+
+    void state_cache::blend_equation(GLenum rgb, GLenum alpha)
+    {
+        if (update(m_blend_equation, std::array<GLenum, 2>{rgb, alpha})) {
+            glBlendEquationSeparate(rgb, alpha);
+            CHECK_OPENGL_ERROR(glBlendEquationSeparate);
+        }
+    }
+
+} // namespace mge::opengl
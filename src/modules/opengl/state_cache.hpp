@@ -0,0 +1,243 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/statistics.hpp"
+#include "opengl.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace mge::opengl {
+
+    /**
+     * @brief Shadow copy of the OpenGL state changed during draw submission.
+     *
+     * Each setter compares the requested value with the value last set
+     * through the cache and only calls into OpenGL if it differs. The
+     * cache does not know about state changed behind its back, so
+     * @c invalidate must be called whenever OpenGL state may have been
+     * changed by other code, e.g. at the start of each pass.
+     */
+    class state_cache
+    {
+    public:
+        /**
+         * @brief Capabilities switched by @c enable.
+         */
+        enum class capability : uint8_t
+        {
+            BLEND,
+            CULL_FACE,
+            DEPTH_TEST,
+            SCISSOR_TEST,
+            CONSERVATIVE_RASTERIZATION,
+            MAX
+        };
+
+        /**
+         * @brief Number of texture units tracked. Bindings to higher units
+         * are always forwarded to OpenGL.
+         */
+        static constexpr uint32_t MAX_TEXTURE_UNITS = 32;
+
+        /**
+         * @brief Number of uniform buffer binding points tracked. Bindings
+         * to higher binding points are always forwarded to OpenGL.
+         */
+        static constexpr uint32_t MAX_UNIFORM_BUFFER_BINDINGS = 16;
+
+        state_cache();
+        ~state_cache();
+
+        state_cache(const state_cache&) = delete;
+        state_cache& operator=(const state_cache&) = delete;
+
+        /**
+         * @brief Forget all tracked state, the next call of every setter
+         * is forwarded to OpenGL.
+         */
+        void invalidate() noexcept;
+
+        /**
+         * @brief Set current program (@c glUseProgram).
+         * @param program program name
+         * @return @c true if the program was changed
+         */
+        bool use_program(GLuint program);
+
+        /**
+         * @brief Bind vertex array object (@c glBindVertexArray).
+         * @param vao vertex array name
+         */
+        void bind_vertex_array(GLuint vao);
+
+        /**
+         * @brief Notify the cache that a vertex array was bound
+         * directly, e.g. while creating it.
+         * @param vao vertex array name now bound
+         */
+        void vertex_array_bound(GLuint vao) noexcept;
+
+        /**
+         * @brief Bind 2D texture to texture unit.
+         * @param unit    texture unit index
+         * @param texture texture name
+         */
+        void bind_texture(uint32_t unit, GLuint texture);
+
+        /**
+         * @brief Bind uniform buffer to indexed binding point
+         * (@c glBindBufferBase).
+         * @param binding binding point
+         * @param buffer  buffer name
+         */
+        void bind_uniform_buffer(uint32_t binding, GLuint buffer);
+
+        /**
+         * @brief Bind range of uniform buffer to indexed binding point
+         * (@c glBindBufferRange).
+         * @param binding binding point
+         * @param buffer  buffer name
+         * @param offset  range offset in bytes
+         * @param size    range size in bytes
+         */
+        void bind_uniform_buffer_range(uint32_t   binding,
+                                       GLuint     buffer,
+                                       GLintptr   offset,
+                                       GLsizeiptr size);
+
+        /**
+         * @brief Enable or disable a capability.
+         * @param cap     capability
+         * @param enabled whether to enable
+         */
+        void enable(capability cap, bool enabled);
+
+        /**
+         * @brief Set faces culled (@c glCullFace).
+         * @param mode @c GL_FRONT or @c GL_BACK
+         */
+        void cull_face(GLenum mode);
+
+        /**
+         * @brief Set depth test function (@c glDepthFunc).
+         * @param func depth function
+         */
+        void depth_func(GLenum func);
+
+        /**
+         * @brief Enable or disable depth writes (@c glDepthMask).
+         * @param enabled whether depth is written
+         */
+        void depth_mask(bool enabled);
+
+        /**
+         * @brief Set blend factors (@c glBlendFuncSeparate).
+         * @param src_rgb   color source factor
+         * @param dst_rgb   color destination factor
+         * @param src_alpha alpha source factor
+         * @param dst_alpha alpha destination factor
+         */
+        void blend_func(GLenum src_rgb,
+                        GLenum dst_rgb,
+                        GLenum src_alpha,
+                        GLenum dst_alpha);
+
+        /**
+         * @brief Set blend equations (@c glBlendEquationSeparate).
+         * @param rgb   color blend equation
+         * @param alpha alpha blend equation
+         */
+        void blend_equation(GLenum rgb, GLenum alpha);
+
+        /**
+         * @brief Number of state changes forwarded to OpenGL.
+         * @return issued call count of this cache
+         */
+        uint64_t issued_calls() const noexcept
+        {
+            return m_issued_calls;
+        }
+
+        /**
+         * @brief Number of state changes filtered as redundant.
+         * @return skipped call count of this cache
+         */
+        uint64_t skipped_calls() const noexcept
+        {
+            return m_skipped_calls;
+        }
+
+    private:
+        /**
+         * @brief Calls of all state caches, reported as the
+         * @c opengl_state statistics node.
+         *
+         * The node is process-wide, so render contexts can be created
+         * and destroyed without adding nodes to or leaving dangling
+         * nodes in the statistics tree.
+         */
+        class cache_statistics : public mge::statistics
+        {
+        public:
+            cache_statistics();
+            ~cache_statistics() override;
+
+            const description& describe() const override;
+
+            statistics::counter_type issued_calls;
+            statistics::counter_type skipped_calls;
+        };
+
+        static cache_statistics& process_statistics();
+
+        /// Updates @c cached, returns whether a call must be issued.
+        template <typename T> bool update(T& cached, T value) noexcept
+        {
+            if (cached == value) {
+                ++m_skipped_calls;
+                m_statistics.skipped_calls.fetch_add(
+                    1,
+                    std::memory_order_relaxed);
+                return false;
+            }
+            cached = value;
+            ++m_issued_calls;
+            m_statistics.issued_calls.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// Bound buffer range, a size of 0 binds the whole buffer.
+        struct buffer_range
+        {
+            GLuint     buffer;
+            GLintptr   offset;
+            GLsizeiptr size;
+
+            bool operator==(const buffer_range&) const = default;
+        };
+
+        static constexpr GLuint UNKNOWN_NAME = 0xFFFFFFFF;
+        static constexpr GLenum UNKNOWN_ENUM = 0;
+        static constexpr int8_t UNKNOWN_FLAG = -1;
+
+        GLuint                                            m_program;
+        GLuint                                            m_vertex_array;
+        GLuint                                            m_active_texture;
+        std::array<GLuint, MAX_TEXTURE_UNITS>             m_textures;
+        std::array<buffer_range,
+                   MAX_UNIFORM_BUFFER_BINDINGS>           m_uniform_buffers;
+        std::array<int8_t,
+                   static_cast<size_t>(capability::MAX)> m_capabilities;
+        GLenum                                            m_cull_face;
+        GLenum                                            m_depth_func;
+        int8_t                                            m_depth_mask;
+        std::array<GLenum, 4>                             m_blend_func;
+        std::array<GLenum, 2>                             m_blend_equation;
+        cache_statistics&                                 m_statistics;
+        uint64_t                                          m_issued_calls{0};
+        uint64_t                                          m_skipped_calls{0};
+    };
+
+} // namespace mge::opengl
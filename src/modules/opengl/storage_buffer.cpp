@@ -0,0 +1,73 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "storage_buffer.hpp"
+#include "buffer_storage.hpp"
+#include "error.hpp"
+#include "render_context_base.hpp"
+
+namespace mge::opengl {
+    storage_buffer::storage_buffer(render_context_base& context,
+                                   size_t               data_size)
+        : mge::storage_buffer(context, data_size)
+        , m_buffer(0)
+    {
+        context.prepare_frame([this]() {
+            if (!m_buffer) {
+                create_buffer();
+            }
+            set_ready(true);
+        });
+    }
+
+    storage_buffer::~storage_buffer()
+    {
+        if (m_buffer) {
+            set_ready(false);
+            GLuint buffer_to_delete = m_buffer;
+            m_context.prepare_frame([buffer_to_delete]() {
+                glDeleteBuffers(1, &buffer_to_delete);
+                TRACE_OPENGL_ERROR(glDeleteBuffers);
+            });
+            m_buffer = 0;
+        }
+    }
+
+    void storage_buffer::create_buffer()
+    {
+        m_buffer = create_buffer_storage(size(), &m_mapped_data);
+    }
+
+    void storage_buffer::on_set_data(void* data, size_t data_size)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        write_buffer(m_buffer, m_mapped_data, 0, data, data_size);
+        set_ready(true);
+    }
+
+    void* storage_buffer::on_map_range(size_t offset, size_t)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        return m_mapped_data ? m_mapped_data + offset : nullptr;
+    }
+
+    void storage_buffer::on_flush_range(size_t offset, size_t size)
+    {
+        flush_buffer(m_buffer, offset, size);
+    }
+
+    void
+    storage_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        write_buffer(m_buffer, m_mapped_data, offset, data, size);
+        set_ready(true);
+    }
+
+} // namespace mge::opengl
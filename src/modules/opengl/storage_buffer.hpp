@@ -0,0 +1,36 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/graphics/storage_buffer.hpp"
+#include "opengl.hpp"
+
+namespace mge::opengl {
+    class render_context_base;
+
+    class storage_buffer : public mge::storage_buffer
+    {
+    public:
+        storage_buffer(render_context_base& context, size_t data_size);
+        virtual ~storage_buffer();
+
+        GLuint buffer_name() const noexcept
+        {
+            return m_buffer;
+        }
+
+        void on_set_data(void* data, size_t data_size) override;
+
+    protected:
+        void* on_map_range(size_t offset, size_t size) override;
+        void  on_flush_range(size_t offset, size_t size) override;
+        void  on_update(size_t offset, const void* data, size_t size) override;
+
+    private:
+        void create_buffer();
+
+        GLuint     m_buffer;
+        std::byte* m_mapped_data{nullptr};
+    };
+
+} // namespace mge::opengl
@@ -5,8 +5,15 @@
 #include "mge/graphics/program.hpp"
 #include "mge/graphics/render_context.hpp"
 #include "mge/graphics/shader.hpp"
+#include "mge/graphics/shader_cache.hpp"
 #include "opengl_test.hpp"
 
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
 class program_test : public mge::opengl::opengltest
 {};
 
@@ -67,3 +74,207 @@ TEST_F(program_test, compile_and_link)
     EXPECT_EQ(mge::data_type::FLOAT_VEC3, program->attributes()[0].type);
     EXPECT_EQ(1u, program->attributes()[0].size);
 }
+
+TEST_F(program_test, link_with_multiple_uniform_blocks)
+{
+    const char* vertex_shader_glsl = R"shader(
+                    #version 330 core
+                    layout(location = 0) in vec3 vertexPosition;
+
+                    uniform Transform {
+                        mat4 model;
+                    } transform;
+
+                    void main() {
+                      gl_Position = transform.model * vec4(vertexPosition, 1.0);
+                    }
+                )shader";
+
+    const char* fragment_shader_glsl = R"shader(
+                    #version 330 core
+                    out vec3 color;
+
+                    uniform Material {
+                        vec3 diffuse;
+                    } material;
+
+                    void main() {
+                        color = material.diffuse;
+                    }
+                )shader";
+
+    auto pixel_shader =
+        m_window->render_context().create_shader(mge::shader_type::FRAGMENT);
+    pixel_shader->compile(fragment_shader_glsl);
+    auto vertex_shader =
+        m_window->render_context().create_shader(mge::shader_type::VERTEX);
+    vertex_shader->compile(vertex_shader_glsl);
+    auto program = m_window->render_context().create_program();
+    program->set_shader(pixel_shader);
+    program->set_shader(vertex_shader);
+    program->link();
+    m_window->render_context().frame();
+
+    // each block is bound to the binding point of its index
+    const auto& blocks = program->uniform_buffers();
+    ASSERT_EQ(2u, blocks.size());
+    EXPECT_NE(blocks[0].location, blocks[1].location);
+}
+
+class program_binary_test : public program_test
+{
+protected:
+    void SetUp() override
+    {
+        program_test::SetUp();
+        // start from an empty cache stored in a known directory
+        m_previous_directory = mge::shader_cache().directory();
+        m_directory =
+            std::filesystem::temp_directory_path() / "mge_test_program_binary";
+        std::filesystem::remove_all(m_directory);
+        mge::shader_cache().clear();
+        mge::shader_cache().set_directory(m_directory);
+    }
+
+    void TearDown() override
+    {
+        mge::shader_cache().clear();
+        mge::shader_cache().set_directory(m_previous_directory);
+        std::filesystem::remove_all(m_directory);
+        program_test::TearDown();
+    }
+
+    mge::program_handle link()
+    {
+        const char* vertex_shader_glsl = R"shader(
+                    #version 330 core
+                    layout(location = 0) in vec3 vertexPosition;
+                    layout(location = 1) in vec2 vertexUV;
+                    out vec2 uv;
+
+                    uniform Transform {
+                        mat4 model;
+                    } transform;
+
+                    void main() {
+                      uv = vertexUV;
+                      gl_Position = transform.model * vec4(vertexPosition, 1.0);
+                    }
+                )shader";
+
+        const char* fragment_shader_glsl = R"shader(
+                    #version 330 core
+                    in vec2 uv;
+                    out vec4 color;
+                    uniform sampler2D diffuse;
+
+                    void main() {
+                        color = texture(diffuse, uv);
+                    }
+                )shader";
+
+        auto& context = m_window->render_context();
+        auto  pixel_shader = context.create_shader(mge::shader_type::FRAGMENT);
+        pixel_shader->compile(fragment_shader_glsl);
+        auto vertex_shader = context.create_shader(mge::shader_type::VERTEX);
+        vertex_shader->compile(vertex_shader_glsl);
+        auto program = context.create_program();
+        program->set_shader(pixel_shader);
+        program->set_shader(vertex_shader);
+        program->link();
+        context.frame();
+        return program;
+    }
+
+    // shaders only store an empty marker entry, the program binary is
+    // the only entry with data
+    std::optional<uint64_t> program_binary_key()
+    {
+        if (!std::filesystem::exists(m_directory)) {
+            return std::nullopt;
+        }
+        for (const auto& entry :
+             std::filesystem::directory_iterator(m_directory)) {
+            uint64_t key = std::stoull(entry.path().stem().string(),
+                                       nullptr,
+                                       16);
+            auto     data = mge::shader_cache().get(key);
+            if (data && !data->empty()) {
+                return key;
+            }
+        }
+        return std::nullopt;
+    }
+
+    static void expect_same_reflection(const mge::program_handle& expected,
+                                       const mge::program_handle& actual)
+    {
+        EXPECT_EQ(expected->source_hash(), actual->source_hash());
+        ASSERT_EQ(expected->attributes().size(), actual->attributes().size());
+        for (size_t i = 0; i < expected->attributes().size(); ++i) {
+            EXPECT_EQ(expected->attributes()[i].name,
+                      actual->attributes()[i].name);
+            EXPECT_EQ(expected->attributes()[i].type,
+                      actual->attributes()[i].type);
+        }
+        ASSERT_EQ(1u, actual->uniform_buffers().size());
+        EXPECT_EQ("Transform", actual->uniform_buffers()[0].name);
+        EXPECT_EQ(expected->uniform_buffers()[0].uniforms.size(),
+                  actual->uniform_buffers()[0].uniforms.size());
+        ASSERT_EQ(1u, actual->sampler_bindings().size());
+        EXPECT_EQ(expected->sampler_bindings()[0].binding,
+                  actual->sampler_bindings()[0].binding);
+    }
+
+    std::filesystem::path m_directory;
+    std::filesystem::path m_previous_directory;
+};
+
+TEST_F(program_binary_test, same_sources_link_from_program_binary)
+{
+    auto first = link();
+    auto key = program_binary_key();
+    if (!key) {
+        GTEST_SKIP() << "Driver reports no program binary formats";
+    }
+
+    // two shader markers and the program binary are found
+    uint64_t hits = mge::shader_cache().hits();
+    auto     second = link();
+    EXPECT_EQ(hits + 3, mge::shader_cache().hits());
+
+    expect_same_reflection(first, second);
+}
+
+TEST_F(program_binary_test, rejected_program_binary_compiles_shaders)
+{
+    auto first = link();
+    auto key = program_binary_key();
+    if (!key) {
+        GTEST_SKIP() << "Driver reports no program binary formats";
+    }
+
+    // an unknown binary format makes the driver reject the binary, the
+    // deferred shaders are compiled and the program is linked again
+    auto                   data = mge::shader_cache().get(*key);
+    std::vector<std::byte> rejected(data->begin(), data->end());
+    const uint32_t         no_format = 0;
+    std::memcpy(rejected.data() + 2 * sizeof(uint32_t),
+                &no_format,
+                sizeof(no_format));
+    mge::shader_cache().put(*key, rejected);
+
+    auto second = link();
+    expect_same_reflection(first, second);
+    // the relinked program replaces the rejected binary
+    auto stored = mge::shader_cache().get(*key);
+    ASSERT_NE(stored, nullptr);
+    EXPECT_NE(rejected, *stored);
+
+    // a truncated entry is ignored the same way
+    rejected.resize(rejected.size() / 2);
+    mge::shader_cache().put(*key, rejected);
+
+    auto third = link();
+    expect_same_reflection(first, third);
+}
@@ -1,11 +1,39 @@
 // mge - Modern Game Engine
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
+#include "mge/core/statistics.hpp"
+#include "mge/graphics/data_type.hpp"
+#include "mge/graphics/index_buffer.hpp"
+#include "mge/graphics/program.hpp"
 #include "mge/graphics/render_context.hpp"
+#include "mge/graphics/shader.hpp"
+#include "mge/graphics/vertex_buffer.hpp"
 #include "opengl_test.hpp"
 
+#include <cstdint>
+#include <string_view>
+#include <variant>
+
+using namespace std::string_view_literals;
+
 class render_context_test : public mge::opengl::opengltest
-{};
+{
+protected:
+    static uint64_t state_statistics(std::string_view field)
+    {
+        auto* node = mge::statistics::root().child("opengl_state"sv);
+        if (!node) {
+            return 0;
+        }
+        const auto& desc = node->describe();
+        for (size_t i = 0; i < desc.size(); ++i) {
+            if (desc.at(i).name() == field) {
+                return std::get<uint64_t>(desc.at(i).get(*node));
+            }
+        }
+        return 0;
+    }
+};
 
 TEST_F(render_context_test, extent)
 {
@@ -13,3 +41,63 @@ TEST_F(render_context_test, extent)
     EXPECT_EQ(context.window_extent().width, 800u);
     EXPECT_EQ(context.window_extent().height, 600u);
 }
+
+TEST_F(render_context_test, same_material_skips_state_calls)
+{
+    const char* vertex_shader_glsl = R"shader(
+                    #version 330 core
+                    layout(location = 0) in vec3 vertexPosition;
+                    void main() {
+                      gl_Position = vec4(vertexPosition, 1.0);
+                    }
+                )shader";
+
+    const char* fragment_shader_glsl = R"shader(
+                    #version 330 core
+                    out vec4 color;
+                    void main() {
+                        color = vec4(1.0, 0.0, 0.0, 1.0);
+                    }
+                )shader";
+
+    auto& context = m_window->render_context();
+    auto  pixel_shader = context.create_shader(mge::shader_type::FRAGMENT);
+    pixel_shader->compile(fragment_shader_glsl);
+    auto vertex_shader = context.create_shader(mge::shader_type::VERTEX);
+    vertex_shader->compile(vertex_shader_glsl);
+    auto program = context.create_program();
+    program->set_shader(pixel_shader);
+    program->set_shader(vertex_shader);
+    program->link();
+
+    float triangle_coords[] = {
+        0.0f, 0.5f, 0.0f, 0.45f, -0.5f, 0.0f, -0.45f, -0.5f, 0.0f};
+    uint32_t           triangle_indices[] = {0, 1, 2};
+    mge::vertex_layout layout;
+    layout.push_back(mge::vertex_format(mge::data_type::FLOAT, 3));
+    auto vertices = context.create_vertex_buffer(
+        layout,
+        sizeof(triangle_coords),
+        mge::make_buffer(triangle_coords));
+    auto indices = context.create_index_buffer(
+        mge::data_type::UINT32,
+        sizeof(triangle_indices),
+        mge::make_buffer(triangle_indices));
+    context.frame();
+
+    // the second draw uses the program and vertex array of the first
+    auto& pass = context.pass(0);
+    auto& cb = context.command_buffer(true);
+    cb.draw(pass, program, vertices, indices);
+    cb.draw(pass, program, vertices, indices);
+
+    uint64_t skipped = state_statistics("skipped_calls"sv);
+    uint64_t issued = state_statistics("issued_calls"sv);
+    context.frame();
+    EXPECT_GT(state_statistics("skipped_calls"sv), skipped);
+    EXPECT_GT(state_statistics("issued_calls"sv), issued);
+
+    vertices.destroy();
+    indices.destroy();
+    program.destroy();
+}
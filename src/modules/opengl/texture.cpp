@@ -4,6 +4,7 @@
 #include "texture.hpp"
 #include "error.hpp"
 #include "mge/core/stdexceptions.hpp"
+#include "mge/graphics/mipmap.hpp"
 #include "render_context_base.hpp"
 
 namespace mge::opengl {
@@ -64,6 +65,26 @@ namespace mge::opengl {
     GLint texture::internal_format(const mge::image_format& format) const
     {
         switch (format.format()) {
+        case mge::image_format::data_format::BC1:
+            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        case mge::image_format::data_format::BC2:
+            return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+        case mge::image_format::data_format::BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case mge::image_format::data_format::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        case mge::image_format::data_format::BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+        case mge::image_format::data_format::BC6H:
+            return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+        case mge::image_format::data_format::BC7:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case mge::image_format::data_format::ETC2_RGB:
+            return GL_COMPRESSED_RGB8_ETC2;
+        case mge::image_format::data_format::ETC2_RGBA:
+            return GL_COMPRESSED_RGBA8_ETC2_EAC;
+        case mge::image_format::data_format::ASTC_4x4:
+            return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
         case mge::image_format::data_format::RGB:
             return GL_RGB;
         case mge::image_format::data_format::RGBA:
@@ -135,6 +156,56 @@ namespace mge::opengl {
         }
     }
 
+    void texture::upload_level(const mge::image_format& format,
+                               const mge::extent&       extent,
+                               uint32_t                 level,
+                               const void*              data)
+    {
+        if (format.compressed()) {
+            // blocks are uploaded as they are, the driver does not decode
+            glCompressedTexImage2D(
+                GL_TEXTURE_2D,
+                static_cast<GLint>(level),
+                static_cast<GLenum>(internal_format(format)),
+                static_cast<GLsizei>(extent.width),
+                static_cast<GLsizei>(extent.height),
+                0,
+                static_cast<GLsizei>(
+                    format.binary_size(extent.width, extent.height)),
+                data);
+            CHECK_OPENGL_ERROR(glCompressedTexImage2D);
+            return;
+        }
+        glTexImage2D(GL_TEXTURE_2D,
+                     static_cast<GLint>(level),
+                     internal_format(format),
+                     static_cast<GLsizei>(extent.width),
+                     static_cast<GLsizei>(extent.height),
+                     0,
+                     pixel_format(format),
+                     pixel_type(format),
+                     data);
+        CHECK_OPENGL_ERROR(glTexImage2D);
+    }
+
+    void texture::set_sampling(uint32_t levels)
+    {
+        // Trilinear filtering if there are mip levels.
+        GLint min_filter = levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+        CHECK_OPENGL_ERROR(glTexParameteri);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        CHECK_OPENGL_ERROR(glTexParameteri);
+        glTexParameteri(GL_TEXTURE_2D,
+                        GL_TEXTURE_MAX_LEVEL,
+                        static_cast<GLint>(levels - 1));
+        CHECK_OPENGL_ERROR(glTexParameteri);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        CHECK_OPENGL_ERROR(glTexParameteri);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        CHECK_OPENGL_ERROR(glTexParameteri);
+    }
+
     void texture::set_data(const mge::image_format& format,
                            const mge::extent&       extent,
                            const void*              data,
@@ -146,24 +217,16 @@ namespace mge::opengl {
             // so V=0 maps to image top, matching DX/Vulkan convention.
             glBindTexture(GL_TEXTURE_2D, m_texture);
             CHECK_OPENGL_ERROR(glBindTexture);
-            glTexImage2D(GL_TEXTURE_2D,
-                         0,
-                         internal_format(format),
-                         extent.width,
-                         extent.height,
-                         0,
-                         pixel_format(format),
-                         pixel_type(format),
-                         data);
-            CHECK_OPENGL_ERROR(glTexImage2D);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            CHECK_OPENGL_ERROR(glTexParameteri);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            CHECK_OPENGL_ERROR(glTexParameteri);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            CHECK_OPENGL_ERROR(glTexParameteri);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            CHECK_OPENGL_ERROR(glTexParameteri);
+            upload_level(format, extent, 0, data);
+            bool is_color =
+                format.format() == mge::image_format::data_format::RGB ||
+                format.format() == mge::image_format::data_format::RGBA;
+            uint32_t levels = is_color ? mip_level_count(extent) : 1;
+            if (levels > 1) {
+                glGenerateMipmap(GL_TEXTURE_2D);
+                CHECK_OPENGL_ERROR(glGenerateMipmap);
+            }
+            set_sampling(levels);
             glBindTexture(GL_TEXTURE_2D, 0);
             CHECK_OPENGL_ERROR(glBindTexture(0));
         } else {
@@ -171,4 +234,34 @@ namespace mge::opengl {
                 << "Texture type " << type() << " not implemented";
         }
     }
-} // namespace mge::opengl
\ No newline at end of file
+
+    void texture::set_mip_data(const mge::image_format& format,
+                               const mge::extent&       extent,
+                               const void*              data,
+                               size_t                   size,
+                               uint32_t                 levels)
+    {
+        if (type() != mge::texture_type::TYPE_2D) {
+            MGE_THROW(mge::not_yet_implemented)
+                << "Texture type " << type() << " not implemented";
+        }
+        if (levels == 0 || levels > mip_level_count(extent) ||
+            size < mip_level_offset(format, extent, levels)) {
+            MGE_THROW(mge::illegal_argument)
+                << "Invalid mip chain of " << levels << " levels and "
+                << size << " bytes for extent " << extent;
+        }
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        CHECK_OPENGL_ERROR(glBindTexture);
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (uint32_t level = 0; level < levels; ++level) {
+            upload_level(format,
+                         mip_level_extent(extent, level),
+                         level,
+                         bytes + mip_level_offset(format, extent, level));
+        }
+        set_sampling(levels);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        CHECK_OPENGL_ERROR(glBindTexture(0));
+    }
+} // namespace mge::opengl
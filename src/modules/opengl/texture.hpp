@@ -24,6 +24,12 @@ namespace mge::opengl {
                       const void*              data,
                       size_t                   size) override;
 
+        void set_mip_data(const mge::image_format& format,
+                          const mge::extent&       extent,
+                          const void*              data,
+                          size_t                   size,
+                          uint32_t                 levels) override;
+
         GLuint texture_name() const noexcept
         {
             return m_texture;
@@ -39,6 +45,11 @@ namespace mge::opengl {
         GLint  internal_format(const mge::image_format& format) const;
         GLenum pixel_format(const mge::image_format& format) const;
         GLenum pixel_type(const mge::image_format& format) const;
+        void   upload_level(const mge::image_format& format,
+                            const mge::extent&       extent,
+                            uint32_t                 level,
+                            const void*              data);
+        void   set_sampling(uint32_t levels);
 
         GLuint            m_texture;
         mge::image_format m_image_format;
@@ -0,0 +1,114 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "uniform_ring.hpp"
+#include "buffer_storage.hpp"
+#include "error.hpp"
+#include "mge/core/stdexceptions.hpp"
+#include "mge/core/trace.hpp"
+
+#include <algorithm>
+
+namespace mge {
+    MGE_USE_TRACE(OPENGL);
+}
+
+namespace mge::opengl {
+
+    static constexpr size_t   UNIFORM_RING_REGION_SIZE = 1024 * 1024;
+    static constexpr GLuint64 UNIFORM_RING_WAIT_TIMEOUT = 1000000000;
+
+    uniform_ring::uniform_ring(uint32_t region_count)
+        : m_fences(std::max<uint32_t>(region_count, 1), nullptr)
+    {
+        GLint v = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &v);
+        CHECK_OPENGL_ERROR(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT));
+        m_alignment = static_cast<size_t>(std::max(v, 1));
+        glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &v);
+        CHECK_OPENGL_ERROR(glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE));
+        // regions start aligned and hold the largest possible block
+        size_t region_size =
+            std::max(UNIFORM_RING_REGION_SIZE, static_cast<size_t>(v));
+        m_region_size =
+            (region_size + m_alignment - 1) / m_alignment * m_alignment;
+        m_buffer = create_buffer_storage(m_region_size * m_fences.size(),
+                                         &m_mapped_data);
+        MGE_DEBUG_TRACE(OPENGL,
+                        "Created uniform ring of {} regions of {} bytes, {}",
+                        m_fences.size(),
+                        m_region_size,
+                        m_mapped_data ? "mapped" : "not mapped");
+    }
+
+    uniform_ring::~uniform_ring()
+    {
+        for (auto& fence : m_fences) {
+            if (fence) {
+                glDeleteSync(fence);
+                TRACE_OPENGL_ERROR(glDeleteSync);
+            }
+        }
+        if (m_buffer) {
+            glDeleteBuffers(1, &m_buffer);
+            TRACE_OPENGL_ERROR(glDeleteBuffers);
+        }
+    }
+
+    uniform_ring::allocation uniform_ring::push(const void* data, size_t size)
+    {
+        if (size > m_region_size) {
+            MGE_THROW(mge::illegal_argument)
+                << "Uniform data of " << size
+                << " bytes exceeds uniform ring region size of "
+                << m_region_size << " bytes";
+        }
+        size_t offset = (m_used + m_alignment - 1) / m_alignment * m_alignment;
+        if (offset + size > m_region_size) {
+            next_region();
+            offset = 0;
+        }
+        size_t buffer_offset =
+            (m_region % m_fences.size()) * m_region_size + offset;
+        write_buffer(m_buffer, m_mapped_data, buffer_offset, data, size);
+        m_used = offset + size;
+        return {m_buffer,
+                static_cast<uint32_t>(buffer_offset),
+                static_cast<uint32_t>(size),
+                m_region};
+    }
+
+    void uniform_ring::next_region()
+    {
+        // fence the draws of the full region, they are all issued
+        GLsync& issued = m_fences[m_region % m_fences.size()];
+        issued = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        CHECK_OPENGL_ERROR(glFenceSync);
+        ++m_region;
+        m_used = 0;
+
+        GLsync& pending = m_fences[m_region % m_fences.size()];
+        if (!pending) {
+            return;
+        }
+        GLenum result =
+            glClientWaitSync(pending, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            MGE_DEBUG_TRACE(OPENGL,
+                            "Waiting for uniform ring region {}",
+                            m_region % m_fences.size());
+            do {
+                result = glClientWaitSync(pending,
+                                          GL_SYNC_FLUSH_COMMANDS_BIT,
+                                          UNIFORM_RING_WAIT_TIMEOUT);
+            } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        if (result == GL_WAIT_FAILED) {
+            MGE_THROW(error) << "glClientWaitSync failed";
+        }
+        glDeleteSync(pending);
+        CHECK_OPENGL_ERROR(glDeleteSync);
+        pending = nullptr;
+    }
+
+} // namespace mge::opengl
@@ -0,0 +1,81 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/noncopyable.hpp"
+#include "opengl.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mge::opengl {
+
+    /**
+     * @brief Streaming buffer for uniform data.
+     *
+     * The ring is a single persistently mapped buffer split into regions.
+     * Uniform data is appended to the current region and bound with
+     * @c glBindBufferRange. When a region is full, a fence is placed
+     * behind the draws reading it and writing continues in the next
+     * region once the fence guarding that region has signaled. Draws
+     * thus never wait for the driver to finish reading a buffer that is
+     * updated.
+     *
+     * Without buffer storage (OpenGL 4.4) the data is written with
+     * @c glBufferSubData instead of through the mapping.
+     */
+    class uniform_ring : public mge::noncopyable
+    {
+    public:
+        /// Location of data pushed into the ring.
+        struct allocation
+        {
+            GLuint   buffer{0};
+            uint32_t offset{0};
+            uint32_t size{0};
+            uint64_t region{0}; //!< sequence number of the region
+        };
+
+        /**
+         * @brief Create the ring buffer, requires a current context.
+         *
+         * @param region_count number of fence guarded regions
+         */
+        explicit uniform_ring(uint32_t region_count = 3);
+        ~uniform_ring();
+
+        /**
+         * @brief Copy data into the ring.
+         *
+         * @param data data to copy
+         * @param size data size in bytes
+         * @return buffer range of the copy
+         */
+        allocation push(const void* data, size_t size);
+
+        /**
+         * @brief Whether data pushed before has not been overwritten.
+         *
+         * @param a allocation returned by @c push
+         * @return @c true if the allocation can still be bound
+         */
+        bool contains(const allocation& a) const noexcept
+        {
+            return a.buffer == m_buffer && a.buffer != 0 &&
+                   m_region < a.region + m_fences.size();
+        }
+
+    private:
+        void next_region();
+
+        GLuint              m_buffer{0};
+        std::byte*          m_mapped_data{nullptr};
+        size_t              m_region_size{0};
+        size_t              m_alignment{1};
+        std::vector<GLsync> m_fences;
+        size_t              m_used{0};
+        uint64_t            m_region{0};
+    };
+
+} // namespace mge::opengl
@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "vertex_buffer.hpp"
+#include "buffer_storage.hpp"
 #include "error.hpp"
 #include "mge/core/buffer.hpp"
 #include "mge/core/checked_cast.hpp"
@@ -15,8 +16,9 @@ namespace mge::opengl {
         , m_buffer(0)
     {
         context.prepare_frame([this]() {
-            glGenBuffers(1, &m_buffer);
-            CHECK_OPENGL_ERROR(glGenBuffers);
+            if (!m_buffer) {
+                create_buffer();
+            }
             set_ready(true);
         });
     }
@@ -26,7 +28,9 @@ namespace mge::opengl {
         if (m_buffer) {
             set_ready(false);
             GLuint buffer_to_delete = m_buffer;
-            m_context.prepare_frame([buffer_to_delete]() {
+            auto&  ctx = static_cast<render_context_base&>(m_context);
+            m_context.prepare_frame([&ctx, buffer_to_delete]() {
+                ctx.forget_buffer(buffer_to_delete);
                 glDeleteBuffers(1, &buffer_to_delete);
                 TRACE_OPENGL_ERROR(glDeleteBuffers);
             });
@@ -34,16 +38,40 @@ namespace mge::opengl {
         }
     }
 
+    void vertex_buffer::create_buffer()
+    {
+        m_buffer = create_buffer_storage(size(), &m_mapped_data);
+    }
+
     void vertex_buffer::on_set_data(void* data, size_t data_size)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, m_buffer);
-        CHECK_OPENGL_ERROR(glBindBuffer);
-        glBufferData(GL_ARRAY_BUFFER,
-                     mge::checked_cast<GLsizeiptr>(data_size),
-                     data,
-                     GL_DYNAMIC_DRAW);
-        CHECK_OPENGL_ERROR(glBufferData);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        if (!m_buffer) {
+            create_buffer();
+        }
+        write_buffer(m_buffer, m_mapped_data, 0, data, data_size);
+        set_ready(true);
+    }
+
+    void* vertex_buffer::on_map_range(size_t offset, size_t)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        return m_mapped_data ? m_mapped_data + offset : nullptr;
+    }
+
+    void vertex_buffer::on_flush_range(size_t offset, size_t size)
+    {
+        flush_buffer(m_buffer, offset, size);
+    }
+
+    void
+    vertex_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
+        if (!m_buffer) {
+            create_buffer();
+        }
+        write_buffer(m_buffer, m_mapped_data, offset, data, size);
         set_ready(true);
     }
 
@@ -2,6 +2,7 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #include "mge/asset/asset.hpp"
+#include "mge/asset/asset_corrupted.hpp"
 #include "mge/asset/asset_handler.hpp"
 #include "mge/asset/asset_type.hpp"
 #include "mge/core/checked_cast.hpp"
@@ -154,15 +155,33 @@ namespace mge {
 
     std::any stb_image_handler::load(const mge::asset& a)
     {
-        int  x = 0;
-        int  y = 0;
-        int  components = STBI_rgb_alpha;
-        auto loaded = stbi_load_from_callbacks(&s_callbacks,
-                                               a.data().get(),
-                                               &x,
-                                               &y,
-                                               &components,
-                                               STBI_rgb_alpha);
+        int               x = 0;
+        int               y = 0;
+        int               components = STBI_rgb_alpha;
+        stbi_uc*          loaded = nullptr;
+        mapped_region_ref region = a.map();
+        if (region) {
+            // decode in place instead of pulling the data through
+            // the stream callbacks
+            loaded = stbi_load_from_memory(region->data(),
+                                           checked_cast<int>(region->size()),
+                                           &x,
+                                           &y,
+                                           &components,
+                                           STBI_rgb_alpha);
+        } else {
+            loaded = stbi_load_from_callbacks(&s_callbacks,
+                                              a.data().get(),
+                                              &x,
+                                              &y,
+                                              &components,
+                                              STBI_rgb_alpha);
+        }
+        if (!loaded) {
+            MGE_THROW(mge::asset_corrupted)
+                << "Cannot decode image " << a.path().string() << ": "
+                << stbi_failure_reason();
+        }
         try {
             mge::image_ref result = std::make_shared<mge::memory_image>(
                 mge::image_format(mge::image_format::data_format::RGBA,
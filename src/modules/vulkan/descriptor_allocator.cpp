@@ -0,0 +1,156 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "descriptor_allocator.hpp"
+#include "error.hpp"
+#include "render_context_base.hpp"
+
+#include "mge/core/fnv1a.hpp"
+#include "mge/core/trace.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace mge {
+    MGE_USE_TRACE(VULKAN);
+}
+
+namespace mge::vulkan {
+
+    static constexpr uint32_t DESCRIPTOR_POOL_SETS = 256;
+
+    size_t descriptor_allocator::key_hash::operator()(
+        const key& k) const noexcept
+    {
+        // unused image entries are zero, hash only the used prefix
+        size_t size =
+            offsetof(key, images) +
+            static_cast<size_t>(k.image_count) * sizeof(image_binding);
+        return static_cast<size_t>(mge::fnv1a(&k, size));
+    }
+
+    descriptor_allocator::descriptor_allocator(render_context_base& context,
+                                               uint32_t frame_count)
+        : m_context(context)
+        , m_frames(std::max<uint32_t>(frame_count, 1))
+    {}
+
+    descriptor_allocator::~descriptor_allocator()
+    {
+        for (auto& f : m_frames) {
+            for (auto pool : f.pools) {
+                m_context.vkDestroyDescriptorPool(m_context.device(),
+                                                  pool,
+                                                  nullptr);
+            }
+        }
+    }
+
+    void descriptor_allocator::begin_frame(uint32_t frame_index)
+    {
+        m_current_frame = frame_index % static_cast<uint32_t>(m_frames.size());
+        auto& f = m_frames[m_current_frame];
+        for (auto pool : f.pools) {
+            CHECK_VK_CALL(
+                m_context.vkResetDescriptorPool(m_context.device(), pool, 0));
+        }
+        f.current = 0;
+        f.sets.clear();
+    }
+
+    VkDescriptorSet descriptor_allocator::find(const key& k) const
+    {
+        const auto& sets = m_frames[m_current_frame].sets;
+        auto        it = sets.find(k);
+        return it != sets.end() ? it->second : VK_NULL_HANDLE;
+    }
+
+    VkDescriptorSet descriptor_allocator::allocate(const key& k)
+    {
+        auto& f = m_frames[m_current_frame];
+
+        VkDescriptorSetAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc_info.descriptorSetCount = 1;
+        alloc_info.pSetLayouts = &k.layout;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        while (true) {
+            if (f.current == f.pools.size()) {
+                MGE_DEBUG_TRACE(VULKAN,
+                                "Adding descriptor pool to frame {}",
+                                m_current_frame);
+                f.pools.push_back(create_pool());
+            }
+            alloc_info.descriptorPool = f.pools[f.current];
+            VkResult rc = m_context.vkAllocateDescriptorSets(m_context.device(),
+                                                             &alloc_info,
+                                                             &set);
+            if (rc == VK_SUCCESS) {
+                break;
+            }
+            if (rc != VK_ERROR_OUT_OF_POOL_MEMORY &&
+                rc != VK_ERROR_FRAGMENTED_POOL) {
+                CHECK_VKRESULT(rc, vkAllocateDescriptorSets);
+            }
+            ++f.current;
+        }
+        f.sets.emplace(k, set);
+        return set;
+    }
+
+    void descriptor_allocator::forget(VkImageView view)
+    {
+        for (auto& f : m_frames) {
+            boost::unordered::erase_if(f.sets, [view](const auto& entry) {
+                const auto& k = entry.first;
+                for (uint64_t i = 0; i < k.image_count; ++i) {
+                    if (k.images[i].view == view) {
+                        return true;
+                    }
+                }
+                return false;
+            });
+        }
+    }
+
+    void descriptor_allocator::forget(VkBuffer buffer)
+    {
+        for (auto& f : m_frames) {
+            boost::unordered::erase_if(f.sets, [buffer](const auto& entry) {
+                return std::ranges::any_of(
+                    entry.first.storage_buffers,
+                    [buffer](const auto& b) { return b.buffer == buffer; });
+            });
+        }
+    }
+
+    VkDescriptorPool descriptor_allocator::create_pool()
+    {
+        std::array<VkDescriptorPoolSize, 3> pool_sizes = {};
+        pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        pool_sizes[0].descriptorCount = DESCRIPTOR_POOL_SETS;
+        pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        pool_sizes[1].descriptorCount =
+            DESCRIPTOR_POOL_SETS *
+            mge::texture_binding_list::MAX_TEXTURE_BINDINGS;
+        pool_sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        pool_sizes[2].descriptorCount =
+            DESCRIPTOR_POOL_SETS *
+            mge::storage_buffer_binding_list::MAX_STORAGE_BUFFER_BINDINGS;
+
+        VkDescriptorPoolCreateInfo pool_info = {};
+        pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+        pool_info.pPoolSizes = pool_sizes.data();
+        pool_info.maxSets = DESCRIPTOR_POOL_SETS;
+
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        CHECK_VK_CALL(m_context.vkCreateDescriptorPool(m_context.device(),
+                                                       &pool_info,
+                                                       nullptr,
+                                                       &pool));
+        return pool;
+    }
+
+} // namespace mge::vulkan
@@ -0,0 +1,146 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/noncopyable.hpp"
+#include "mge/graphics/command_buffer.hpp"
+#include "vulkan.hpp"
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include <array>
+#include <type_traits>
+#include <vector>
+
+namespace mge::vulkan {
+
+    class render_context_base;
+
+    /**
+     * @brief Allocates descriptor sets for the frames in flight.
+     *
+     * Each frame in flight owns a list of descriptor pools and a cache of
+     * the sets allocated from them. A set is looked up by a packed key of
+     * everything written into it, so identical bindings share one set
+     * within a frame. When a frame starts again after its fence has
+     * signalled, its pools are reset and its cache is cleared. Pools are
+     * added when a frame needs more sets than before, so memory use is
+     * bounded by the peak use of a frame.
+     */
+    class descriptor_allocator : public mge::noncopyable
+    {
+    public:
+        /// Image bound in a descriptor set.
+        struct image_binding
+        {
+            uint64_t    slot{0};
+            VkImageView view{VK_NULL_HANDLE};
+            VkSampler   sampler{VK_NULL_HANDLE};
+
+            bool operator==(const image_binding&) const = default;
+        };
+
+        /// Storage buffer bound in a descriptor set.
+        struct buffer_binding
+        {
+            uint64_t slot{0};
+            VkBuffer buffer{VK_NULL_HANDLE};
+
+            bool operator==(const buffer_binding&) const = default;
+        };
+
+        /// Everything written into a descriptor set.
+        struct key
+        {
+            VkDescriptorSetLayout layout{VK_NULL_HANDLE};
+            VkBuffer              uniform_buffer{VK_NULL_HANDLE};
+            uint32_t              uniform_binding{0};
+            uint32_t              uniform_range{0};
+            std::array<buffer_binding,
+                       mge::storage_buffer_binding_list::
+                           MAX_STORAGE_BUFFER_BINDINGS>
+                     storage_buffers{};
+            uint64_t image_count{0};
+            std::array<image_binding,
+                       mge::texture_binding_list::MAX_TEXTURE_BINDINGS>
+                images{};
+
+            bool operator==(const key&) const = default;
+        };
+
+        static_assert(std::has_unique_object_representations_v<key>,
+                      "descriptor set key is hashed bytewise");
+
+        descriptor_allocator(render_context_base& context,
+                             uint32_t             frame_count);
+        ~descriptor_allocator();
+
+        /**
+         * @brief Start allocating for a frame, releasing all sets
+         * allocated when the frame was used before.
+         *
+         * The caller must ensure the GPU has finished the frame.
+         *
+         * @param frame_index index of frame in flight
+         */
+        void begin_frame(uint32_t frame_index);
+
+        /**
+         * @brief Look up the set of a key in the current frame.
+         *
+         * @param k key
+         * @return set, @c VK_NULL_HANDLE if not yet allocated
+         */
+        VkDescriptorSet find(const key& k) const;
+
+        /**
+         * @brief Allocate a set for a key in the current frame.
+         *
+         * The caller writes the set contents.
+         *
+         * @param k key, its layout is used for allocation
+         * @return allocated set
+         */
+        VkDescriptorSet allocate(const key& k);
+
+        /**
+         * @brief Forget all cached sets referencing an image view.
+         *
+         * Called when a texture is destroyed, so a later view with the
+         * same handle does not hit a set written for the old one.
+         *
+         * @param view destroyed image view
+         */
+        void forget(VkImageView view);
+
+        /**
+         * @brief Forget all cached sets referencing a storage buffer.
+         *
+         * @param buffer destroyed buffer
+         */
+        void forget(VkBuffer buffer);
+
+    private:
+        struct key_hash
+        {
+            size_t operator()(const key& k) const noexcept;
+        };
+
+        struct frame
+        {
+            using set_map =
+                boost::unordered_flat_map<key, VkDescriptorSet, key_hash>;
+
+            std::vector<VkDescriptorPool> pools;
+            size_t                        current{0};
+            set_map                       sets;
+        };
+
+        VkDescriptorPool create_pool();
+
+        render_context_base& m_context;
+        std::vector<frame>   m_frames;
+        uint32_t             m_current_frame{0};
+    };
+
+} // namespace mge::vulkan
@@ -8,6 +8,7 @@
 #endif
 
 #include <glslang/Include/glslang_c_interface.h>
+#include <glslang/build_info.h>
 #include <glslang/Public/resource_limits_c.h>
 #ifdef MGE_COMPILER_MSVC
 #    pragma warning(default : 4464)
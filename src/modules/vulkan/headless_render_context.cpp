@@ -25,13 +25,15 @@ namespace mge::vulkan {
             create_device();
             resolve_device_functions();
             create_allocator();
+            create_pipeline_cache();
             get_device_queue();
             init_capabilities();
             find_depth_format();
             create_graphics_command_pool();
-            create_command_buffer();
-            create_render_fence();
-            create_descriptor_pool();
+            create_upload_queue();
+            create_frame_resources();
+            create_command_buffers();
+            create_render_fences();
         } catch (...) {
             teardown();
             throw;
@@ -52,57 +54,83 @@ namespace mge::vulkan {
         return {};
     }
 
-    void headless_render_context::create_command_buffer()
+    void headless_render_context::create_command_buffers()
     {
-        MGE_DEBUG_TRACE(VULKAN, "Create headless command buffer");
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Create {} headless command buffers",
+                        m_frames_in_flight);
         VkCommandBufferAllocateInfo alloc_info = {};
         alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         alloc_info.commandPool = m_graphics_command_pool;
         alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        alloc_info.commandBufferCount = 1;
-        CHECK_VK_CALL(
-            vkAllocateCommandBuffers(m_device, &alloc_info, &m_command_buffer));
+        alloc_info.commandBufferCount = m_frames_in_flight;
+        m_command_buffers.resize(m_frames_in_flight);
+        CHECK_VK_CALL(vkAllocateCommandBuffers(m_device,
+                                               &alloc_info,
+                                               m_command_buffers.data()));
     }
 
-    void headless_render_context::create_render_fence()
+    void headless_render_context::create_render_fences()
     {
-        MGE_DEBUG_TRACE(VULKAN, "Create headless fence");
+        MGE_DEBUG_TRACE(VULKAN, "Create headless fences");
         VkFenceCreateInfo fence_info = {};
         fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
         fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        CHECK_VK_CALL(vkCreateFence(m_device, &fence_info, nullptr, &m_fence));
+        m_fences.resize(m_frames_in_flight, VK_NULL_HANDLE);
+        for (auto& f : m_fences) {
+            CHECK_VK_CALL(vkCreateFence(m_device, &fence_info, nullptr, &f));
+        }
+    }
+
+    void headless_render_context::wait_for_frames()
+    {
+        CHECK_VK_CALL(vkWaitForFences(m_device,
+                                      static_cast<uint32_t>(m_fences.size()),
+                                      m_fences.data(),
+                                      VK_TRUE,
+                                      std::numeric_limits<uint64_t>::max()));
     }
 
     void headless_render_context::teardown()
     {
-        if (m_fence != VK_NULL_HANDLE && vkDestroyFence) {
-            vkDestroyFence(m_device, m_fence, nullptr);
-            m_fence = VK_NULL_HANDLE;
+        if (vkDestroyFence) {
+            for (auto f : m_fences) {
+                if (f != VK_NULL_HANDLE) {
+                    vkDestroyFence(m_device, f, nullptr);
+                }
+            }
         }
-        if (m_command_buffer != VK_NULL_HANDLE && vkFreeCommandBuffers &&
+        m_fences.clear();
+        if (!m_command_buffers.empty() && vkFreeCommandBuffers &&
             m_graphics_command_pool != VK_NULL_HANDLE) {
-            vkFreeCommandBuffers(m_device,
-                                 m_graphics_command_pool,
-                                 1,
-                                 &m_command_buffer);
-            m_command_buffer = VK_NULL_HANDLE;
+            vkFreeCommandBuffers(
+                m_device,
+                m_graphics_command_pool,
+                static_cast<uint32_t>(m_command_buffers.size()),
+                m_command_buffers.data());
         }
+        m_command_buffers.clear();
         teardown_shared();
     }
 
     void headless_render_context::render(const mge::pass& p)
     {
+        VkCommandBuffer cmd = m_command_buffers[m_current_frame];
         if (m_frame_state == frame_state::BEFORE_DRAW) {
+            // wait only for the frame that used this slot before, later
+            // frames may still be rendered while this one is recorded
+            VkFence fence = m_fences[m_current_frame];
             CHECK_VK_CALL(vkWaitForFences(m_device,
                                           1,
-                                          &m_fence,
+                                          &fence,
                                           VK_TRUE,
                                           std::numeric_limits<uint64_t>::max()));
-            CHECK_VK_CALL(vkResetFences(m_device, 1, &m_fence));
-            CHECK_VK_CALL(vkResetCommandBuffer(m_command_buffer, 0));
+            CHECK_VK_CALL(vkResetFences(m_device, 1, &fence));
+            begin_frame_resources(m_current_frame);
+            CHECK_VK_CALL(vkResetCommandBuffer(cmd, 0));
             VkCommandBufferBeginInfo begin_info = {};
             begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            CHECK_VK_CALL(vkBeginCommandBuffer(m_command_buffer, &begin_info));
+            CHECK_VK_CALL(vkBeginCommandBuffer(cmd, &begin_info));
             m_frame_state = frame_state::DRAW;
         }
 
@@ -119,25 +147,45 @@ namespace mge::vulkan {
                            vk_fb->render_pass(),
                            vk_fb->vk_framebuffer(),
                            vk_fb->fbo_extent(),
-                           m_command_buffer);
+                           cmd);
     }
 
     void headless_render_context::on_frame_present()
     {
-        CHECK_VK_CALL(vkEndCommandBuffer(m_command_buffer));
+        VkCommandBuffer cmd = m_command_buffers[m_current_frame];
+        m_uniform_ring->flush();
+        CHECK_VK_CALL(vkEndCommandBuffer(cmd));
+
+        uint64_t upload_value = m_upload_queue->submit();
+
+        VkSemaphore          wait_semaphore = m_upload_queue->semaphore();
+        VkPipelineStageFlags wait_stage = UPLOAD_WAIT_STAGES;
+
+        VkTimelineSemaphoreSubmitInfo timeline_info = {};
+        timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.waitSemaphoreValueCount = 1;
+        timeline_info.pWaitSemaphoreValues = &upload_value;
 
         VkSubmitInfo submit_info = {};
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        if (upload_value != 0) {
+            submit_info.pNext = &timeline_info;
+            submit_info.waitSemaphoreCount = 1;
+            submit_info.pWaitSemaphores = &wait_semaphore;
+            submit_info.pWaitDstStageMask = &wait_stage;
+        }
         submit_info.commandBufferCount = 1;
-        submit_info.pCommandBuffers = &m_command_buffer;
+        submit_info.pCommandBuffers = &cmd;
 
-        CHECK_VK_CALL(vkQueueSubmit(m_queue, 1, &submit_info, m_fence));
-        CHECK_VK_CALL(vkWaitForFences(m_device,
-                                      1,
-                                      &m_fence,
-                                      VK_TRUE,
-                                      std::numeric_limits<uint64_t>::max()));
+        {
+            std::lock_guard<mge::mutex> lock(m_queue_lock);
+            CHECK_VK_CALL(vkQueueSubmit(m_queue,
+                                        1,
+                                        &submit_info,
+                                        m_fences[m_current_frame]));
+        }
         m_frame_state = frame_state::BEFORE_DRAW;
+        m_current_frame = (m_current_frame + 1) % m_frames_in_flight;
     }
 
     mge::image_ref headless_render_context::screenshot()
@@ -147,6 +195,9 @@ namespace mge::vulkan {
                 << "No frame buffer was rendered to";
         }
 
+        // frames are not waited for on present
+        wait_for_frames();
+
         auto* fb = static_cast<mge::vulkan::frame_buffer*>(m_last_frame_buffer);
         auto  color_ref = fb->color_attachment(0);
         if (!color_ref) {
@@ -270,7 +321,10 @@ namespace mge::vulkan {
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submit_info.commandBufferCount = 1;
         submit_info.pCommandBuffers = &cmd;
-        CHECK_VK_CALL(vkQueueSubmit(m_queue, 1, &submit_info, fence));
+        {
+            std::lock_guard<mge::mutex> lock(m_queue_lock);
+            CHECK_VK_CALL(vkQueueSubmit(m_queue, 1, &submit_info, fence));
+        }
         CHECK_VK_CALL(
             vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX));
 
@@ -22,8 +22,9 @@ namespace mge::vulkan {
         std::vector<const char*> get_device_extensions() const override;
 
     private:
-        void create_command_buffer();
-        void create_render_fence();
+        void create_command_buffers();
+        void create_render_fences();
+        void wait_for_frames();
         void teardown();
 
         enum class frame_state
@@ -32,10 +33,11 @@ namespace mge::vulkan {
             DRAW
         };
 
-        VkCommandBuffer    m_command_buffer{VK_NULL_HANDLE};
-        VkFence            m_fence{VK_NULL_HANDLE};
-        frame_state        m_frame_state{frame_state::BEFORE_DRAW};
-        mge::frame_buffer* m_last_frame_buffer{nullptr};
+        std::vector<VkCommandBuffer> m_command_buffers;
+        std::vector<VkFence>         m_fences;
+        uint32_t                     m_current_frame{0};
+        frame_state                  m_frame_state{frame_state::BEFORE_DRAW};
+        mge::frame_buffer*           m_last_frame_buffer{nullptr};
     };
 
 } // namespace mge::vulkan
@@ -5,6 +5,8 @@
 #include "error.hpp"
 #include "render_context_base.hpp"
 
+#include <cstring>
+
 namespace mge::vulkan {
 
     index_buffer::index_buffer(render_context_base& context,
@@ -23,25 +25,37 @@ namespace mge::vulkan {
         VkBufferCreateInfo buffer_info{};
         buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         buffer_info.size = size();
-        buffer_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        // compute shaders may write indices as storage buffer
+        buffer_info.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                            VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        m_vulkan_context.set_upload_sharing_mode(buffer_info);
 
+        // memory that is not host visible is written by the upload queue
         VmaAllocationCreateInfo alloc_info{};
         alloc_info.usage = VMA_MEMORY_USAGE_AUTO;
         alloc_info.flags =
-            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+            VMA_ALLOCATION_CREATE_MAPPED_BIT;
 
+        VmaAllocationInfo allocation_info{};
         CHECK_VK_CALL(vmaCreateBuffer(m_vulkan_context.allocator(),
                                       &buffer_info,
                                       &alloc_info,
                                       &m_buffer,
                                       &m_allocation,
-                                      nullptr));
+                                      &allocation_info));
+        m_mapped_data = static_cast<std::byte*>(allocation_info.pMappedData);
     }
 
     index_buffer::~index_buffer()
     {
+        if (m_upload_value != 0) {
+            m_vulkan_context.wait_for_upload(m_upload_value);
+        }
         if (m_buffer && m_allocation) {
+            m_vulkan_context.forget_descriptor_sets(m_buffer);
             vmaDestroyBuffer(m_vulkan_context.allocator(),
                              m_buffer,
                              m_allocation);
@@ -61,19 +75,37 @@ namespace mge::vulkan {
                                      << " exceeds buffer size " << size();
         }
 
-        void* mapped_data = nullptr;
-        CHECK_VK_CALL(vmaMapMemory(m_vulkan_context.allocator(),
-                                   m_allocation,
-                                   &mapped_data));
+        if (m_mapped_data) {
+            std::memcpy(m_mapped_data, data, data_size);
+            CHECK_VK_CALL(vmaFlushAllocation(m_vulkan_context.allocator(),
+                                             m_allocation,
+                                             0,
+                                             data_size));
+        } else {
+            m_upload_value =
+                m_vulkan_context.uploads().upload(m_buffer, 0, data, data_size);
+        }
+        set_ready(true);
+    }
 
-        memcpy(mapped_data, data, data_size);
+    void* index_buffer::on_map_range(size_t offset, size_t)
+    {
+        return m_mapped_data ? m_mapped_data + offset : nullptr;
+    }
 
+    void index_buffer::on_flush_range(size_t offset, size_t size)
+    {
         CHECK_VK_CALL(vmaFlushAllocation(m_vulkan_context.allocator(),
                                          m_allocation,
-                                         0,
-                                         data_size));
+                                         offset,
+                                         size));
+    }
+
+    void index_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
+        m_upload_value =
+            m_vulkan_context.uploads().upload(m_buffer, offset, data, size);
         set_ready(true);
-        vmaUnmapMemory(m_vulkan_context.allocator(), m_allocation);
     }
 
     VkIndexType index_buffer::vk_index_type() const
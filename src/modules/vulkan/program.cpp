@@ -43,6 +43,7 @@ namespace mge::vulkan {
         m_attributes.clear();
         m_uniforms.clear();
         m_sampler_bindings.clear();
+        m_storage_buffers.clear();
 
         std::vector<std::pair<std::string, uint32_t>> sampler_bindings_raw;
         for (const auto& shader : m_shaders) {
@@ -51,7 +52,8 @@ namespace mge::vulkan {
             shader->reflect(m_attributes,
                             m_uniforms,
                             m_uniform_block_metadata,
-                            sampler_bindings_raw);
+                            sampler_bindings_raw,
+                            m_storage_buffers);
         }
         for (const auto& [name, binding] : sampler_bindings_raw) {
             m_sampler_bindings.push_back({name, binding});
@@ -59,6 +61,13 @@ namespace mge::vulkan {
         create_pipeline_layout();
     }
 
+    bool program::compute() const noexcept
+    {
+        return m_shader_stage_create_infos.size() == 1 &&
+               m_shader_stage_create_infos[0].stage ==
+                   VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
     void program::on_set_shader(mge::shader* s)
     {
         auto vulkan_shader = static_cast<mge::vulkan::shader*>(s);
@@ -69,13 +78,29 @@ namespace mge::vulkan {
     {
         std::vector<VkDescriptorSetLayoutBinding> layout_bindings;
 
-        // Create descriptor set layout bindings for uniform buffers
+        const VkShaderStageFlags buffer_stages =
+            compute() ? VK_SHADER_STAGE_COMPUTE_BIT
+                      : VK_SHADER_STAGE_ALL_GRAPHICS;
+
+        // Create descriptor set layout bindings for uniform buffers, bound
+        // with dynamic offsets into the uniform ring
         for (const auto& ub : m_uniform_block_metadata) {
             VkDescriptorSetLayoutBinding binding = {};
             binding.binding = ub.location;
-            binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            binding.descriptorCount = 1;
+            binding.stageFlags = buffer_stages;
+            binding.pImmutableSamplers = nullptr;
+            layout_bindings.push_back(binding);
+        }
+
+        // Create descriptor set layout bindings for storage buffers
+        for (const auto& sb : m_storage_buffers) {
+            VkDescriptorSetLayoutBinding binding = {};
+            binding.binding = sb.binding;
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
             binding.descriptorCount = 1;
-            binding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
+            binding.stageFlags = buffer_stages;
             binding.pImmutableSamplers = nullptr;
             layout_bindings.push_back(binding);
         }
@@ -167,6 +192,7 @@ namespace mge::vulkan {
         m_uniforms = std::move(compile_result.uniforms);
         m_uniform_block_metadata = std::move(compile_result.uniform_buffers);
         m_sampler_bindings = std::move(compile_result.sampler_bindings);
+        m_storage_buffers = std::move(compile_result.storage_buffers);
 
         create_pipeline_layout();
     }
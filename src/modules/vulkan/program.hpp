@@ -31,6 +31,13 @@ namespace mge::vulkan {
             return m_descriptor_set_layout;
         }
 
+        /**
+         * @brief Whether the program consists of a compute shader.
+         *
+         * @return @c true for compute programs
+         */
+        bool compute() const noexcept;
+
     protected:
         virtual void on_link() override;
         virtual void on_set_shader(mge::shader* shader) override;
@@ -34,6 +34,7 @@ namespace mge::vulkan {
             create_device();
             resolve_device_functions();
             create_allocator();
+            create_pipeline_cache();
             get_device_queue();
             init_capabilities();
             fetch_surface_capabilities();
@@ -45,11 +46,12 @@ namespace mge::vulkan {
             create_depth_resources();
             create_render_pass();
             create_graphics_command_pool();
+            create_upload_queue();
+            create_frame_resources();
             create_primary_command_buffers();
             create_framebuffers();
             create_fence();
             create_semaphores();
-            create_descriptor_pool();
 
             auto fd = m_render_system->frame_debugger();
             if (fd) {
@@ -87,6 +89,11 @@ namespace mge::vulkan {
         return extensions;
     }
 
+    VkRenderPass render_context::default_render_pass() const noexcept
+    {
+        return m_render_pass;
+    }
+
     void render_context::create_surface()
     {
 #ifdef MGE_OS_WINDOWS
@@ -145,6 +152,7 @@ namespace mge::vulkan {
                 }
             }
             m_frame_finished_fences.clear();
+            m_images_in_flight.clear();
         }
 
         if (vkDestroyFramebuffer) {
@@ -520,14 +528,13 @@ namespace mge::vulkan {
     {
         MGE_DEBUG_TRACE(VULKAN,
                         "Create {} primary command buffers",
-                        m_swap_chain_images.size());
+                        m_frames_in_flight);
         VkCommandBufferAllocateInfo alloc_info = {};
         alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         alloc_info.commandPool = m_graphics_command_pool;
         alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        alloc_info.commandBufferCount =
-            mge::checked_cast<uint32_t>(m_swap_chain_images.size());
-        m_primary_command_buffers.resize(m_swap_chain_images.size());
+        alloc_info.commandBufferCount = m_frames_in_flight;
+        m_primary_command_buffers.resize(m_frames_in_flight);
         CHECK_VK_CALL(
             vkAllocateCommandBuffers(m_device,
                                      &alloc_info,
@@ -564,11 +571,13 @@ namespace mge::vulkan {
     void render_context::create_fence()
     {
         MGE_DEBUG_TRACE(VULKAN, "Create fences");
-        m_frame_finished_fences.resize(m_swap_chain_images.size());
+        m_frame_finished_fences.resize(m_frames_in_flight);
+        m_images_in_flight.assign(m_swap_chain_images.size(),
+                                  VK_NULL_HANDLE);
         VkFenceCreateInfo fence_info = {};
         fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
         fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        for (size_t i = 0; i < m_swap_chain_images.size(); ++i) {
+        for (size_t i = 0; i < m_frame_finished_fences.size(); ++i) {
             CHECK_VK_CALL(vkCreateFence(m_device,
                                         &fence_info,
                                         nullptr,
@@ -579,15 +588,19 @@ namespace mge::vulkan {
     void render_context::create_semaphores()
     {
         MGE_DEBUG_TRACE(VULKAN, "Create semaphores");
-        m_image_available_semaphores.resize(m_swap_chain_images.size());
+        // acquire is signalled per frame in flight, presentation waits
+        // per swap chain image as the image is not reused before present
+        m_image_available_semaphores.resize(m_frames_in_flight);
         m_render_finished_semaphores.resize(m_swap_chain_images.size());
         VkSemaphoreCreateInfo semaphore_info = {};
         semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-        for (size_t i = 0; i < m_swap_chain_images.size(); ++i) {
+        for (size_t i = 0; i < m_image_available_semaphores.size(); ++i) {
             CHECK_VK_CALL(vkCreateSemaphore(m_device,
                                             &semaphore_info,
                                             nullptr,
                                             &m_image_available_semaphores[i]));
+        }
+        for (size_t i = 0; i < m_render_finished_semaphores.size(); ++i) {
             CHECK_VK_CALL(vkCreateSemaphore(m_device,
                                             &semaphore_info,
                                             nullptr,
@@ -606,6 +619,7 @@ namespace mge::vulkan {
         CHECK_VK_CALL(vkResetFences(m_device,
                                     1,
                                     &m_frame_finished_fences[m_current_frame]));
+        begin_frame_resources(m_current_frame);
     }
 
     void render_context::acquire_next_image()
@@ -617,6 +631,19 @@ namespace mge::vulkan {
                                   m_image_available_semaphores[m_current_frame],
                                   VK_NULL_HANDLE,
                                   &m_current_image_index));
+        // with more images than frames in flight, the image may still be
+        // rendered by another frame slot
+        VkFence& image_fence = m_images_in_flight[m_current_image_index];
+        if (image_fence != VK_NULL_HANDLE &&
+            image_fence != m_frame_finished_fences[m_current_frame]) {
+            CHECK_VK_CALL(
+                vkWaitForFences(m_device,
+                                1,
+                                &image_fence,
+                                VK_TRUE,
+                                std::numeric_limits<uint64_t>::max()));
+        }
+        image_fence = m_frame_finished_fences[m_current_frame];
     }
 
     void render_context::render(const mge::pass& p)
@@ -659,17 +686,33 @@ namespace mge::vulkan {
 
     void render_context::on_frame_present()
     {
+        m_uniform_ring->flush();
         CHECK_VK_CALL(vkEndCommandBuffer(current_primary_command_buffer()));
+        uint64_t upload_value = m_upload_queue->submit();
+
         VkSubmitInfo submit_info{};
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         VkSemaphore wait_semaphores[] = {
-            m_image_available_semaphores[m_current_frame]};
+            m_image_available_semaphores[m_current_frame],
+            m_upload_queue->semaphore()};
+        uint64_t    wait_values[] = {0, upload_value};
         VkSemaphore signal_semaphores[] = {
-            m_render_finished_semaphores[m_current_frame]};
+            m_render_finished_semaphores[m_current_image_index]};
         VkCommandBuffer command_buffers[] = {current_primary_command_buffer()};
         VkPipelineStageFlags wait_stages[] = {
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submit_info.waitSemaphoreCount = 1;
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            UPLOAD_WAIT_STAGES};
+        uint64_t signal_values[] = {0};
+
+        VkTimelineSemaphoreSubmitInfo timeline_info{};
+        timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.waitSemaphoreValueCount = upload_value ? 2 : 1;
+        timeline_info.pWaitSemaphoreValues = wait_values;
+        timeline_info.signalSemaphoreValueCount = 1;
+        timeline_info.pSignalSemaphoreValues = signal_values;
+
+        submit_info.pNext = &timeline_info;
+        submit_info.waitSemaphoreCount = upload_value ? 2 : 1;
         submit_info.pWaitSemaphores = wait_semaphores;
         submit_info.pWaitDstStageMask = wait_stages;
         submit_info.signalSemaphoreCount = 1;
@@ -677,6 +720,7 @@ namespace mge::vulkan {
         submit_info.commandBufferCount = 1;
         submit_info.pCommandBuffers = command_buffers;
 
+        std::lock_guard<mge::mutex> lock(m_queue_lock);
         CHECK_VK_CALL(vkQueueSubmit(m_queue,
                                     1,
                                     &submit_info,
@@ -684,7 +728,7 @@ namespace mge::vulkan {
         m_current_frame_state = frame_state::DRAW_FINISHED;
 
         VkSemaphore present_wait_semaphores[] = {
-            m_render_finished_semaphores[m_current_frame]};
+            m_render_finished_semaphores[m_current_image_index]};
         VkPresentInfoKHR present_info = {};
         present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         present_info.waitSemaphoreCount = 1;
@@ -694,8 +738,7 @@ namespace mge::vulkan {
         present_info.pImageIndices = &m_current_image_index;
         CHECK_VK_CALL(vkQueuePresentKHR(m_queue, &present_info));
         m_current_frame_state = frame_state::BEFORE_DRAW;
-        m_current_frame = (m_current_frame + 1) %
-                          static_cast<uint32_t>(m_swap_chain_images.size());
+        m_current_frame = (m_current_frame + 1) % m_frames_in_flight;
     }
 
     mge::image_ref render_context::screenshot()
@@ -812,7 +855,10 @@ namespace mge::vulkan {
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submit_info.commandBufferCount = 1;
         submit_info.pCommandBuffers = &cmd;
-        CHECK_VK_CALL(vkQueueSubmit(m_queue, 1, &submit_info, fence));
+        {
+            std::lock_guard<mge::mutex> lock(m_queue_lock);
+            CHECK_VK_CALL(vkQueueSubmit(m_queue, 1, &submit_info, fence));
+        }
         CHECK_VK_CALL(
             vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX));
 
@@ -67,6 +67,7 @@ namespace mge::vulkan {
 
     protected:
         std::vector<const char*> get_device_extensions() const override;
+        VkRenderPass             default_render_pass() const noexcept override;
 
     private:
         void create_surface();
@@ -86,7 +87,7 @@ namespace mge::vulkan {
 
         VkCommandBuffer current_primary_command_buffer() const
         {
-            return m_primary_command_buffers[m_current_image_index];
+            return m_primary_command_buffers[m_current_frame];
         }
 
         enum class frame_state
@@ -102,6 +103,7 @@ namespace mge::vulkan {
         std::vector<VkSemaphore> m_image_available_semaphores;
         std::vector<VkSemaphore> m_render_finished_semaphores;
         std::vector<VkFence>     m_frame_finished_fences;
+        std::vector<VkFence>     m_images_in_flight;
         uint32_t                 m_current_frame{0};
 
         VkSurfaceFormatKHR              m_used_surface_format;
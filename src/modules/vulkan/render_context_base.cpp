@@ -9,15 +9,33 @@
 #include "program.hpp"
 #include "render_system.hpp"
 #include "shader.hpp"
+#include "storage_buffer.hpp"
 #include "texture.hpp"
 #include "vertex_buffer.hpp"
 
 #include "mge/core/checked_cast.hpp"
+#include "mge/core/parameter.hpp"
+#include "mge/core/small_vector.hpp"
 #include "mge/core/trace.hpp"
 
+#include <algorithm>
+#include <array>
+
 namespace mge {
     MGE_USE_TRACE(VULKAN);
-}
+    MGE_DEFINE_PARAMETER_WITH_DEFAULT(
+        uint32_t,
+        vulkan,
+        upload_ring_size,
+        "Size of the staging ring used for uploads in MiB",
+        32);
+    MGE_DEFINE_PARAMETER_WITH_DEFAULT(
+        uint32_t,
+        vulkan,
+        frames_in_flight,
+        "Number of frames recorded while the GPU renders previous ones (1-3)",
+        2);
+} // namespace mge
 
 namespace mge::vulkan {
 
@@ -118,6 +136,8 @@ namespace mge::vulkan {
                                              const mge::extent&          ext)
         : mge::render_context(rs, ext)
         , m_render_system(rs.shared_from_this())
+        , m_queue_lock("vulkan::render_context::queue")
+        , m_pipelines_lock("vulkan::render_context::pipelines")
     {}
 
     render_context_base::~render_context_base() {}
@@ -134,6 +154,12 @@ namespace mge::vulkan {
         return new mge::vulkan::vertex_buffer(*this, layout, data_size);
     }
 
+    mge::storage_buffer*
+    render_context_base::on_create_storage_buffer(size_t data_size)
+    {
+        return new mge::vulkan::storage_buffer(*this, data_size);
+    }
+
     mge::shader* render_context_base::on_create_shader(shader_type t)
     {
         return new shader(*this, t);
@@ -167,23 +193,52 @@ namespace mge::vulkan {
         return {};
     }
 
+    VkRenderPass render_context_base::default_render_pass() const noexcept
+    {
+        return VK_NULL_HANDLE;
+    }
+
     void render_context_base::create_device()
     {
         MGE_DEBUG_TRACE(VULKAN, "Create logical device");
-        VkDeviceQueueCreateInfo queue_create_info{};
-        queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queue_create_info.queueFamilyIndex =
-            m_render_system->graphics_queue_index();
-        queue_create_info.queueCount = 1;
-        float queue_priority = 1.0f;
-        queue_create_info.pQueuePriorities = &queue_priority;
+        m_queue_family_indices = {m_render_system->graphics_queue_index(),
+                                  m_render_system->transfer_queue_index()};
+
+        float                   queue_priority = 1.0f;
+        VkDeviceQueueCreateInfo queue_create_infos[2] = {};
+        for (uint32_t i = 0; i < 2; ++i) {
+            queue_create_infos[i].sType =
+                VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queue_create_infos[i].queueFamilyIndex = m_queue_family_indices[i];
+            queue_create_infos[i].queueCount = 1;
+            queue_create_infos[i].pQueuePriorities = &queue_priority;
+        }
 
         VkPhysicalDeviceFeatures device_features{};
+        // block compressed textures are uploaded as they are
+        const auto& supported = m_render_system->physical_device_features();
+        device_features.textureCompressionBC = supported.textureCompressionBC;
+        device_features.textureCompressionETC2 =
+            supported.textureCompressionETC2;
+        device_features.textureCompressionASTC_LDR =
+            supported.textureCompressionASTC_LDR;
+        // packed draws are submitted as one indirect draw if possible
+        device_features.multiDrawIndirect = supported.multiDrawIndirect;
+        m_multi_draw_indirect_supported =
+            supported.multiDrawIndirect == VK_TRUE;
+
+        // the upload queue signals a timeline semaphore
+        VkPhysicalDeviceVulkan12Features vulkan12_features{};
+        vulkan12_features.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        vulkan12_features.timelineSemaphore = VK_TRUE;
 
         VkDeviceCreateInfo device_create_info{};
         device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-        device_create_info.pQueueCreateInfos = &queue_create_info;
-        device_create_info.queueCreateInfoCount = 1;
+        device_create_info.pNext = &vulkan12_features;
+        device_create_info.pQueueCreateInfos = queue_create_infos;
+        device_create_info.queueCreateInfoCount =
+            m_queue_family_indices[0] != m_queue_family_indices[1] ? 2 : 1;
         device_create_info.pEnabledFeatures = &device_features;
 
         std::vector<const char*> device_extensions = get_device_extensions();
@@ -287,10 +342,11 @@ namespace mge::vulkan {
     void render_context_base::get_device_queue()
     {
         MGE_DEBUG_TRACE(VULKAN, "Get device queue");
+        vkGetDeviceQueue(m_device, m_queue_family_indices[0], 0, &m_queue);
         vkGetDeviceQueue(m_device,
-                         m_render_system->graphics_queue_index(),
+                         m_queue_family_indices[1],
                          0,
-                         &m_queue);
+                         &m_transfer_queue);
     }
 
     void render_context_base::create_allocator()
@@ -326,27 +382,109 @@ namespace mge::vulkan {
                                           &m_graphics_command_pool));
     }
 
-    void render_context_base::create_descriptor_pool()
+    void render_context_base::create_frame_resources()
     {
-        MGE_DEBUG_TRACE(VULKAN, "Create descriptor pool");
-
-        std::array<VkDescriptorPoolSize, 2> pool_sizes = {};
-        pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        pool_sizes[0].descriptorCount = 1000;
-        pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        pool_sizes[1].descriptorCount = 1000;
-
-        VkDescriptorPoolCreateInfo pool_info = {};
-        pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
-        pool_info.pPoolSizes = pool_sizes.data();
-        pool_info.maxSets = 1000;
-        pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-
-        CHECK_VK_CALL(vkCreateDescriptorPool(m_device,
-                                             &pool_info,
-                                             nullptr,
-                                             &m_descriptor_pool));
+        m_frames_in_flight =
+            std::clamp<uint32_t>(MGE_PARAMETER(vulkan, frames_in_flight).get(),
+                                 1,
+                                 MAX_FRAMES_IN_FLIGHT);
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Create resources for {} frames in flight",
+                        m_frames_in_flight);
+        const auto& limits =
+            m_render_system->physical_device_properties().limits;
+        m_uniform_ring = std::make_unique<uniform_ring>(
+            *this,
+            m_frames_in_flight,
+            limits.minUniformBufferOffsetAlignment);
+        m_descriptor_allocator =
+            std::make_unique<descriptor_allocator>(*this, m_frames_in_flight);
+    }
+
+    void render_context_base::begin_frame_resources(uint32_t frame_index)
+    {
+        m_uniform_ring->begin_frame(frame_index);
+        m_descriptor_allocator->begin_frame(frame_index);
+        m_upload_queue->collect();
+    }
+
+    void render_context_base::wait_for_upload(uint64_t value)
+    {
+        if (m_upload_queue) {
+            m_upload_queue->wait(value);
+        }
+    }
+
+    void render_context_base::create_upload_queue()
+    {
+        const auto& limits =
+            m_render_system->physical_device_properties().limits;
+        bool dedicated = m_transfer_queue != m_queue;
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Create upload queue on {} queue",
+                        dedicated ? "dedicated transfer" : "graphics");
+        m_upload_queue = std::make_unique<upload_queue>(
+            *this,
+            m_queue_family_indices[1],
+            m_transfer_queue,
+            dedicated ? nullptr : &m_queue_lock,
+            static_cast<VkDeviceSize>(
+                MGE_PARAMETER(vulkan, upload_ring_size).get()) *
+                1024 * 1024,
+            limits.optimalBufferCopyOffsetAlignment);
+    }
+
+    void render_context_base::create_pipeline_cache()
+    {
+        MGE_DEBUG_TRACE(VULKAN, "Create pipeline cache");
+        auto initial_data = m_render_system->load_pipeline_cache_data();
+
+        VkPipelineCacheCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        create_info.initialDataSize = initial_data.size();
+        create_info.pInitialData =
+            initial_data.empty() ? nullptr : initial_data.data();
+        VkResult rc = vkCreatePipelineCache(m_device,
+                                            &create_info,
+                                            nullptr,
+                                            &m_pipeline_cache);
+        if (rc != VK_SUCCESS && !initial_data.empty()) {
+            MGE_WARNING_TRACE(VULKAN,
+                              "Pipeline cache data rejected, starting "
+                              "with empty cache");
+            create_info.initialDataSize = 0;
+            create_info.pInitialData = nullptr;
+            rc = vkCreatePipelineCache(m_device,
+                                       &create_info,
+                                       nullptr,
+                                       &m_pipeline_cache);
+        }
+        CHECK_VKRESULT(rc, vkCreatePipelineCache);
+    }
+
+    void render_context_base::destroy_pipeline_cache()
+    {
+        if (m_pipeline_cache == VK_NULL_HANDLE || !vkDestroyPipelineCache) {
+            return;
+        }
+        size_t   data_size = 0;
+        VkResult rc = vkGetPipelineCacheData(m_device,
+                                             m_pipeline_cache,
+                                             &data_size,
+                                             nullptr);
+        if (rc == VK_SUCCESS && data_size > 0) {
+            std::vector<uint8_t> data(data_size);
+            rc = vkGetPipelineCacheData(m_device,
+                                        m_pipeline_cache,
+                                        &data_size,
+                                        data.data());
+            if (rc == VK_SUCCESS) {
+                data.resize(data_size);
+                m_render_system->store_pipeline_cache_data(data);
+            }
+        }
+        vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
+        m_pipeline_cache = VK_NULL_HANDLE;
     }
 
     void render_context_base::init_capabilities()
@@ -454,20 +592,39 @@ namespace mge::vulkan {
         MGE_THROW(mge::vulkan::error) << "No supported depth format found";
     }
 
+    bool render_context_base::format_supports(
+        VkFormat format, VkFormatFeatureFlags features) const
+    {
+        VkFormatProperties props;
+        m_render_system->vkGetPhysicalDeviceFormatProperties(
+            m_render_system->physical_device(),
+            format,
+            &props);
+        return (props.optimalTilingFeatures & features) == features;
+    }
+
     void render_context_base::teardown_shared()
     {
-        for (auto& [ub, data] : m_uniform_buffers) {
-            if (data.buffer != VK_NULL_HANDLE) {
-                vmaDestroyBuffer(m_allocator, data.buffer, data.allocation);
-            }
+        if (vkDestroySemaphore) {
+            m_upload_queue.reset();
         }
-        m_uniform_buffers.clear();
+        m_uniform_ring.reset();
 
-        if (vkDestroyDescriptorPool && m_descriptor_pool) {
-            vkDestroyDescriptorPool(m_device, m_descriptor_pool, nullptr);
-            m_descriptor_pool = VK_NULL_HANDLE;
+        if (vkDestroyDescriptorPool) {
+            m_descriptor_allocator.reset();
+        }
+
+        if (vkDestroyPipeline) {
+            for (auto& [key, pipeline] : m_pipelines) {
+                vkDestroyPipeline(m_device, pipeline, nullptr);
+            }
+            for (auto& [layout, pipeline] : m_compute_pipelines) {
+                vkDestroyPipeline(m_device, pipeline, nullptr);
+            }
         }
-        m_descriptor_sets.clear();
+        m_pipelines.clear();
+        m_compute_pipelines.clear();
+        destroy_pipeline_cache();
 
         if (vkDestroyCommandPool && m_graphics_command_pool) {
             vkDestroyCommandPool(m_device, m_graphics_command_pool, nullptr);
@@ -475,6 +632,7 @@ namespace mge::vulkan {
         }
 
         m_queue = VK_NULL_HANDLE;
+        m_transfer_queue = VK_NULL_HANDLE;
 
         if (m_allocator) {
             vmaDestroyAllocator(m_allocator);
@@ -495,6 +653,9 @@ namespace mge::vulkan {
                                                  VkExtent2D       pass_extent,
                                                  VkCommandBuffer  command_buffer)
     {
+        // compute work cannot be recorded inside a render pass
+        record_dispatches(p, command_buffer);
+
         VkRenderPassBeginInfo render_pass_info{};
         render_pass_info.sType      = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         render_pass_info.renderPass = render_pass;
@@ -563,393 +724,515 @@ namespace mge::vulkan {
                                   &clear_rect);
         }
 
-        bool           blend_pass_needed = false;
-        mge::rectangle current_scissor   = p.scissor();
-        for_each_draw_in_pass(
+        mge::rectangle current_scissor = p.scissor();
+        auto           apply_scissor = [&](const mge::rectangle& cmd_scissor) {
+            const auto& effective =
+                cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
+            if (effective != current_scissor) {
+                VkRect2D vk_scissor{};
+                vk_scissor.offset = {static_cast<int32_t>(effective.left),
+                                     static_cast<int32_t>(effective.top)};
+                vk_scissor.extent = {
+                    static_cast<uint32_t>(effective.right - effective.left),
+                    static_cast<uint32_t>(effective.bottom - effective.top)};
+                vkCmdSetScissor(command_buffer, 0, 1, &vk_scissor);
+                current_scissor = effective;
+            }
+        };
+
+        // indirect draws run after the dispatches that may write their
+        // arguments and before the sorted draws
+        for_each_indirect_draw_in_pass(
             p.index(),
-            [this,
-             command_buffer,
-             render_pass,
-             &blend_pass_needed,
-             &current_scissor,
-             &p](const program_handle&            prog,
-                 const vertex_buffer_handle&      vertex_buffer,
-                 const index_buffer_handle&       index_buffer,
-                 const mge::pipeline_state&       state,
-                 mge::uniform_block*              ub,
-                 const mge::texture_binding_list& textures,
-                 uint32_t                         index_count,
-                 uint32_t                         index_offset,
-                 const mge::rectangle&            cmd_scissor) {
-                const auto& effective =
-                    cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                if (effective != current_scissor) {
-                    VkRect2D vk_scissor{};
-                    vk_scissor.offset = {
-                        static_cast<int32_t>(effective.left),
-                        static_cast<int32_t>(effective.top)};
-                    vk_scissor.extent = {
-                        static_cast<uint32_t>(effective.right -
-                                              effective.left),
-                        static_cast<uint32_t>(effective.bottom -
-                                              effective.top)};
-                    vkCmdSetScissor(command_buffer, 0, 1, &vk_scissor);
-                    current_scissor = effective;
-                }
-                if (state.color_blend_operation() == mge::blend_operation::NONE) {
-                    draw_geometry(command_buffer,
-                                  prog.get(),
-                                  vertex_buffer.get(),
-                                  index_buffer.get(),
-                                  state,
-                                  ub,
-                                  textures,
-                                  render_pass,
-                                  index_count,
-                                  index_offset);
-                } else {
-                    blend_pass_needed = true;
+            [&](const program_handle&            prog,
+                const vertex_buffer_handle&      vertex_buffer,
+                const index_buffer_handle&       index_buffer,
+                const mge::pipeline_state&       state,
+                mge::uniform_block*              ub,
+                std::span<const std::byte>       uniform_data,
+                const mge::texture_binding_list& textures,
+                const mge::rectangle&            cmd_scissor,
+                const storage_buffer_handle&     commands,
+                uint32_t                         first_command,
+                uint32_t                         draw_count) {
+                auto* vk_commands =
+                    static_cast<mge::vulkan::storage_buffer*>(commands.get());
+                if (!vk_commands) {
+                    MGE_THROW(illegal_state)
+                        << "Indirect draw command has no command buffer";
                 }
+                apply_scissor(cmd_scissor);
+                draw_geometry_indirect(
+                    command_buffer,
+                    prog.get(),
+                    vertex_buffer.get(),
+                    index_buffer.get(),
+                    state,
+                    ub,
+                    uniform_data,
+                    textures,
+                    render_pass,
+                    vk_commands->vk_buffer(),
+                    first_command * sizeof(VkDrawIndexedIndirectCommand),
+                    draw_count);
             });
 
-        if (blend_pass_needed) {
-            for_each_draw_in_pass(
+        if (p.draw_packing()) {
+            // runs of compatible draws become one indirect draw with the
+            // commands taken from the uniform ring
+            for_each_packed_draw_in_pass(
                 p.index(),
-                [this,
-                 command_buffer,
-                 render_pass,
-                 &current_scissor,
-                 &p](const program_handle&            prog,
-                     const vertex_buffer_handle&      vertex_buffer,
-                     const index_buffer_handle&       index_buffer,
-                     const mge::pipeline_state&       state,
-                     mge::uniform_block*              ub,
-                     const mge::texture_binding_list& textures,
-                     uint32_t                         index_count,
-                     uint32_t                         index_offset,
-                     const mge::rectangle&            cmd_scissor) {
-                    const auto& effective =
-                        cmd_scissor.area() != 0 ? cmd_scissor : p.scissor();
-                    if (effective != current_scissor) {
-                        VkRect2D vk_scissor{};
-                        vk_scissor.offset = {
-                            static_cast<int32_t>(effective.left),
-                            static_cast<int32_t>(effective.top)};
-                        vk_scissor.extent = {
-                            static_cast<uint32_t>(effective.right -
-                                                  effective.left),
-                            static_cast<uint32_t>(effective.bottom -
-                                                  effective.top)};
-                        vkCmdSetScissor(command_buffer, 0, 1, &vk_scissor);
-                        current_scissor = effective;
+                [&](const program_handle&            prog,
+                    const vertex_buffer_handle&      vertex_buffer,
+                    const index_buffer_handle&       index_buffer,
+                    const mge::pipeline_state&       state,
+                    mge::uniform_block*              ub,
+                    std::span<const std::byte>       uniform_data,
+                    const mge::texture_binding_list& textures,
+                    const mge::rectangle&            cmd_scissor,
+                    const vertex_buffer_handle&      instances,
+                    std::span<const draw_indexed_indirect_command> commands) {
+                    apply_scissor(cmd_scissor);
+                    if (commands.size() == 1) {
+                        draw_geometry(command_buffer,
+                                      prog.get(),
+                                      vertex_buffer.get(),
+                                      index_buffer.get(),
+                                      state,
+                                      ub,
+                                      uniform_data,
+                                      textures,
+                                      render_pass,
+                                      commands[0].index_count,
+                                      commands[0].first_index,
+                                      instances.get(),
+                                      commands[0].instance_count);
+                        return;
                     }
+                    auto allocation =
+                        m_uniform_ring->push(commands.data(),
+                                             commands.size_bytes());
+                    draw_geometry_indirect(
+                        command_buffer,
+                        prog.get(),
+                        vertex_buffer.get(),
+                        index_buffer.get(),
+                        state,
+                        ub,
+                        uniform_data,
+                        textures,
+                        render_pass,
+                        allocation.buffer,
+                        allocation.offset,
+                        static_cast<uint32_t>(commands.size()),
+                        instances.get());
+                });
+        } else {
+            // opaque draws are visited first, followed by translucent
+            // draws in back to front order
+            for_each_draw_in_pass(
+                p.index(),
+                [&](const program_handle&            prog,
+                    const vertex_buffer_handle&      vertex_buffer,
+                    const index_buffer_handle&       index_buffer,
+                    const mge::pipeline_state&       state,
+                    mge::uniform_block*              ub,
+                    std::span<const std::byte>       uniform_data,
+                    const mge::texture_binding_list& textures,
+                    uint32_t                         index_count,
+                    uint32_t                         index_offset,
+                    const mge::rectangle&            cmd_scissor,
+                    const vertex_buffer_handle&      instances,
+                    uint32_t                         instance_count) {
+                    apply_scissor(cmd_scissor);
                     draw_geometry(command_buffer,
                                   prog.get(),
                                   vertex_buffer.get(),
                                   index_buffer.get(),
                                   state,
                                   ub,
+                                  uniform_data,
                                   textures,
                                   render_pass,
                                   index_count,
-                                  index_offset);
+                                  index_offset,
+                                  instances.get(),
+                                  instance_count);
                 });
         }
 
         vkCmdEndRenderPass(command_buffer);
     }
 
-    void render_context_base::bind_uniform_block(
-        VkCommandBuffer       command_buffer,
-        mge::vulkan::program& vk_program,
-        mge::uniform_block&   ub)
+    static uint32_t uniform_buffer_binding(const mge::vulkan::program& prog,
+                                           const mge::uniform_block&   ub)
     {
-        VkDescriptorSet descriptor_set = prepare_uniform_block(vk_program, ub);
-        if (descriptor_set != VK_NULL_HANDLE) {
-            vkCmdBindDescriptorSets(command_buffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    vk_program.pipeline_layout(),
-                                    0,
-                                    1,
-                                    &descriptor_set,
-                                    0,
-                                    nullptr);
+        for (const auto& ub_metadata : prog.uniform_buffers()) {
+            if (ub_metadata.name == ub.name()) {
+                return ub_metadata.location;
+            }
         }
+        return 0;
     }
 
-    VkDescriptorSet render_context_base::prepare_uniform_block(
-        mge::vulkan::program& vk_program, mge::uniform_block& ub)
+    static VkBuffer storage_vk_buffer(mge::hardware_buffer& buffer)
     {
-        ub.sync_from_globals();
-
-        auto                 it = m_uniform_buffers.find(&ub);
-        uniform_buffer_data* ub_data = nullptr;
-
-        if (it != m_uniform_buffers.end()) {
-            ub_data = &it->second;
-        } else {
-            size_t aligned_size = (ub.data_size() + 255) & ~255;
-
-            VkBufferCreateInfo buffer_info = {};
-            buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            buffer_info.size = aligned_size;
-            buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-            buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            VmaAllocationCreateInfo alloc_info = {};
-            alloc_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-            alloc_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
-
-            uniform_buffer_data new_data;
-            VmaAllocationInfo   allocation_info = {};
-
-            VkResult result = vmaCreateBuffer(m_allocator,
-                                              &buffer_info,
-                                              &alloc_info,
-                                              &new_data.buffer,
-                                              &new_data.allocation,
-                                              &allocation_info);
-            if (result != VK_SUCCESS) {
-                MGE_ERROR_TRACE(VULKAN, "Failed to create uniform buffer");
-                return VK_NULL_HANDLE;
-            }
-
-            new_data.mapped_data = allocation_info.pMappedData;
-            new_data.version = 0;
-
-            m_uniform_buffers[&ub] = new_data;
-            ub_data = &m_uniform_buffers[&ub];
+        switch (buffer.type()) {
+        case mge::buffer_type::VERTEX:
+            return static_cast<vertex_buffer&>(buffer).vk_buffer();
+        case mge::buffer_type::INDEX:
+            return static_cast<index_buffer&>(buffer).vk_buffer();
+        case mge::buffer_type::STORAGE:
+            return static_cast<storage_buffer&>(buffer).vk_buffer();
+        default:
+            break;
         }
+        MGE_THROW(mge::illegal_argument)
+            << "Buffer of type " << buffer.type()
+            << " cannot be bound as storage buffer";
+    }
 
-        if (ub_data->version != ub.version()) {
-            if (ub_data->mapped_data) {
-                memcpy(ub_data->mapped_data, ub.data(), ub.data_size());
-                CHECK_VK_CALL(vmaFlushAllocation(m_allocator,
-                                                 ub_data->allocation,
-                                                 0,
-                                                 ub.data_size()));
-            }
-            ub_data->version = ub.version();
+    VkDescriptorSet render_context_base::prepare_descriptor_set(
+        mge::vulkan::program&                   vk_program,
+        mge::uniform_block*                     ub,
+        VkBuffer                                uniform_buffer,
+        const mge::texture_binding_list&        textures,
+        const mge::storage_buffer_binding_list& storage_buffers)
+    {
+        VkDescriptorSetLayout layout = vk_program.descriptor_set_layout();
+        if (layout == VK_NULL_HANDLE) {
+            return VK_NULL_HANDLE;
         }
 
-        auto desc_key = std::make_tuple(&ub,
-                                        std::vector<mge::texture*>{},
-                                        vk_program.descriptor_set_layout());
-        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
-        auto            desc_it = m_descriptor_sets.find(desc_key);
+        const auto& sampler_bindings = vk_program.sampler_bindings();
 
-        if (desc_it != m_descriptor_sets.end()) {
-            descriptor_set = desc_it->second;
-        } else {
-            VkDescriptorSetLayout layout = vk_program.descriptor_set_layout();
-            if (layout == VK_NULL_HANDLE) {
-                return VK_NULL_HANDLE;
+        descriptor_allocator::key key;
+        key.layout = layout;
+        if (ub) {
+            key.uniform_buffer = uniform_buffer;
+            key.uniform_binding = uniform_buffer_binding(vk_program, *ub);
+            key.uniform_range = static_cast<uint32_t>(ub->data_size());
+        }
+        if (!sampler_bindings.empty()) {
+            for (const auto& b : textures) {
+                auto* vk_tex = static_cast<mge::vulkan::texture*>(b.texture);
+                key.images[key.image_count++] = {b.slot,
+                                                 vk_tex->image_view(),
+                                                 vk_tex->sampler()};
             }
-
-            VkDescriptorSetAllocateInfo alloc_info = {};
-            alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            alloc_info.descriptorPool = m_descriptor_pool;
-            alloc_info.descriptorSetCount = 1;
-            alloc_info.pSetLayouts = &layout;
-
-            VkResult result = vkAllocateDescriptorSets(m_device,
-                                                       &alloc_info,
-                                                       &descriptor_set);
-            if (result != VK_SUCCESS) {
-                return VK_NULL_HANDLE;
+        }
+        size_t storage_count = 0;
+        for (const auto& b : storage_buffers) {
+            if (b.buffer) {
+                key.storage_buffers[storage_count++] = {
+                    b.slot,
+                    storage_vk_buffer(*b.buffer)};
             }
+        }
+        if (!ub && key.image_count == 0 && storage_count == 0) {
+            return VK_NULL_HANDLE;
+        }
 
-            VkDescriptorBufferInfo buffer_info = {};
-            buffer_info.buffer = ub_data->buffer;
+        // the uniform buffer is bound with a dynamic offset, so the set
+        // only depends on the ring buffer the block data is in
+        VkDescriptorSet descriptor_set = m_descriptor_allocator->find(key);
+        if (descriptor_set != VK_NULL_HANDLE) {
+            return descriptor_set;
+        }
+        descriptor_set = m_descriptor_allocator->allocate(key);
+
+        constexpr size_t MAX_WRITES =
+            1 + mge::texture_binding_list::MAX_TEXTURE_BINDINGS +
+            mge::storage_buffer_binding_list::MAX_STORAGE_BUFFER_BINDINGS;
+        std::array<VkWriteDescriptorSet, MAX_WRITES>   writes{};
+        std::array<VkDescriptorImageInfo, MAX_WRITES>  image_infos{};
+        std::array<VkDescriptorBufferInfo, MAX_WRITES> storage_infos{};
+        VkDescriptorBufferInfo                         buffer_info{};
+        uint32_t                                       write_count = 0;
+
+        if (ub) {
+            buffer_info.buffer = uniform_buffer;
             buffer_info.offset = 0;
-            buffer_info.range = ub.data_size();
+            buffer_info.range = key.uniform_range;
+
+            auto& w = writes[write_count++];
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = descriptor_set;
+            w.dstBinding = key.uniform_binding;
+            w.dstArrayElement = 0;
+            w.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            w.descriptorCount = 1;
+            w.pBufferInfo = &buffer_info;
+        }
 
-            uint32_t binding_point = 0;
-            for (const auto& ub_metadata : vk_program.uniform_buffers()) {
-                if (ub_metadata.name == ub.name()) {
-                    binding_point = ub_metadata.location;
-                    break;
-                }
+        for (uint64_t i = 0; i < key.image_count; ++i) {
+            const auto& image = key.images[i];
+            bool        bound = std::ranges::any_of(
+                sampler_bindings,
+                [&](const auto& sb) { return sb.binding == image.slot; });
+            if (!bound) {
+                continue;
             }
 
-            VkWriteDescriptorSet descriptor_write = {};
-            descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptor_write.dstSet = descriptor_set;
-            descriptor_write.dstBinding = binding_point;
-            descriptor_write.dstArrayElement = 0;
-            descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptor_write.descriptorCount = 1;
-            descriptor_write.pBufferInfo = &buffer_info;
+            auto& info = image_infos[write_count];
+            info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            info.imageView = image.view;
+            info.sampler = image.sampler;
+
+            auto& w = writes[write_count++];
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = descriptor_set;
+            w.dstBinding = static_cast<uint32_t>(image.slot);
+            w.dstArrayElement = 0;
+            w.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            w.descriptorCount = 1;
+            w.pImageInfo = &info;
+        }
 
-            vkUpdateDescriptorSets(m_device, 1, &descriptor_write, 0, nullptr);
+        const auto& storage_metadata = vk_program.storage_buffers();
+        for (size_t i = 0; i < storage_count; ++i) {
+            const auto& storage = key.storage_buffers[i];
+            bool        bound = std::ranges::any_of(
+                storage_metadata,
+                [&](const auto& sb) { return sb.binding == storage.slot; });
+            if (!bound) {
+                continue;
+            }
 
-            m_descriptor_sets[desc_key] = descriptor_set;
+            auto& info = storage_infos[write_count];
+            info.buffer = storage.buffer;
+            info.offset = 0;
+            info.range = VK_WHOLE_SIZE;
+
+            auto& w = writes[write_count++];
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = descriptor_set;
+            w.dstBinding = static_cast<uint32_t>(storage.slot);
+            w.dstArrayElement = 0;
+            w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            w.descriptorCount = 1;
+            w.pBufferInfo = &info;
         }
 
+        vkUpdateDescriptorSets(m_device,
+                               write_count,
+                               writes.data(),
+                               0,
+                               nullptr);
         return descriptor_set;
     }
 
-    void render_context_base::bind_texture(VkCommandBuffer       command_buffer,
-                                           mge::vulkan::program& vk_program,
-                                           mge::texture*         tex,
-                                           mge::uniform_block*   ub)
+    void render_context_base::forget_descriptor_sets(VkImageView view)
     {
-        mge::texture_binding_list textures;
-        if (tex) {
-            textures.push_back({0, tex});
-        }
-        VkDescriptorSet descriptor_set =
-            prepare_texture(vk_program, textures, ub);
-        if (descriptor_set != VK_NULL_HANDLE) {
-            vkCmdBindDescriptorSets(command_buffer,
-                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                    vk_program.pipeline_layout(),
-                                    0,
-                                    1,
-                                    &descriptor_set,
-                                    0,
-                                    nullptr);
+        if (m_descriptor_allocator) {
+            m_descriptor_allocator->forget(view);
         }
     }
 
-    VkDescriptorSet render_context_base::prepare_texture(
-        mge::vulkan::program&            vk_program,
-        const mge::texture_binding_list& textures,
-        mge::uniform_block*              ub)
+    void render_context_base::forget_descriptor_sets(VkBuffer buffer)
     {
-        if (textures.empty()) {
-            return VK_NULL_HANDLE;
+        if (m_descriptor_allocator) {
+            m_descriptor_allocator->forget(buffer);
         }
+    }
 
-        const auto& sampler_bindings = vk_program.sampler_bindings();
-        if (sampler_bindings.empty()) {
-            return VK_NULL_HANDLE;
+    void render_context_base::bind_descriptor_set(
+        VkCommandBuffer                         command_buffer,
+        VkPipelineBindPoint                     bind_point,
+        mge::vulkan::program&                   vk_program,
+        mge::uniform_block*                     ub,
+        std::span<const std::byte>              uniform_data,
+        const mge::texture_binding_list&        textures,
+        const mge::storage_buffer_binding_list& storage_buffers)
+    {
+        uniform_ring::allocation uniform_allocation;
+        if (ub) {
+            // the block data recorded with the command, later updates
+            // of the block do not affect it
+            uniform_allocation =
+                m_uniform_ring->push(uniform_data.data(), uniform_data.size());
         }
-
-        VkDescriptorSetLayout layout = vk_program.descriptor_set_layout();
-        if (layout == VK_NULL_HANDLE) {
-            return VK_NULL_HANDLE;
+        VkDescriptorSet descriptor_set =
+            prepare_descriptor_set(vk_program,
+                                   ub,
+                                   uniform_allocation.buffer,
+                                   textures,
+                                   storage_buffers);
+        if (descriptor_set == VK_NULL_HANDLE) {
+            return;
         }
-
-        std::vector<mge::texture*> tex_ptrs;
-        tex_ptrs.reserve(textures.size());
-        for (const auto& b : textures) {
-            tex_ptrs.push_back(b.texture);
+        // one dynamic offset per uniform buffer binding of the
+        // layout, in binding order
+        const auto& ub_metadata = vk_program.uniform_buffers();
+        mge::small_vector<uint32_t, 4> dynamic_offsets;
+        dynamic_offsets.resize(ub_metadata.size(), 0);
+        if (ub) {
+            uint32_t binding = uniform_buffer_binding(vk_program, *ub);
+            size_t   index = 0;
+            for (const auto& m : ub_metadata) {
+                if (m.location < binding) {
+                    ++index;
+                }
+            }
+            if (index < dynamic_offsets.size()) {
+                dynamic_offsets[index] = uniform_allocation.offset;
+            }
         }
+        vkCmdBindDescriptorSets(command_buffer,
+                                bind_point,
+                                vk_program.pipeline_layout(),
+                                0,
+                                1,
+                                &descriptor_set,
+                                static_cast<uint32_t>(dynamic_offsets.size()),
+                                dynamic_offsets.data());
+    }
 
-        auto desc_key =
-            std::make_tuple(ub ? ub : static_cast<mge::uniform_block*>(nullptr),
-                            tex_ptrs,
-                            layout);
-
-        VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
-        auto            desc_it = m_descriptor_sets.find(desc_key);
+    void render_context_base::record_dispatches(const mge::pass& p,
+                                                VkCommandBuffer command_buffer)
+    {
+        if (!has_dispatches(p.index())) {
+            return;
+        }
 
-        if (desc_it != m_descriptor_sets.end()) {
-            descriptor_set = desc_it->second;
-        } else {
-            auto ub_only_key = std::make_tuple(
-                ub ? ub : static_cast<mge::uniform_block*>(nullptr),
-                std::vector<mge::texture*>{},
-                layout);
-            auto ub_it = m_descriptor_sets.find(ub_only_key);
-
-            if (ub && ub_it != m_descriptor_sets.end()) {
-                VkDescriptorSetAllocateInfo alloc_info = {};
-                alloc_info.sType =
-                    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-                alloc_info.descriptorPool = m_descriptor_pool;
-                alloc_info.descriptorSetCount = 1;
-                alloc_info.pSetLayouts = &layout;
-
-                VkResult result = vkAllocateDescriptorSets(m_device,
-                                                           &alloc_info,
-                                                           &descriptor_set);
-                if (result != VK_SUCCESS) {
-                    return VK_NULL_HANDLE;
+        // draws of earlier passes and frames may still read what the
+        // dispatches are going to write
+        vkCmdPipelineBarrier(command_buffer,
+                             DRAW_BUFFER_STAGES,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask =
+            VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        bool first = true;
+        for_each_dispatch_in_pass(
+            p.index(),
+            [&](const program_handle&                  prog,
+                mge::uniform_block*                     ub,
+                std::span<const std::byte>              uniform_data,
+                const mge::storage_buffer_binding_list& storage_buffers,
+                uint32_t                                groups_x,
+                uint32_t                                groups_y,
+                uint32_t                                groups_z) {
+                if (!first) {
+                    // each dispatch sees the writes of the previous ones
+                    vkCmdPipelineBarrier(command_buffer,
+                                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                         0,
+                                         1,
+                                         &barrier,
+                                         0,
+                                         nullptr,
+                                         0,
+                                         nullptr);
                 }
+                first = false;
+                dispatch(command_buffer,
+                         prog.get(),
+                         ub,
+                         uniform_data,
+                         storage_buffers,
+                         groups_x,
+                         groups_y,
+                         groups_z);
+            });
 
-                auto ub_buf_it = m_uniform_buffers.find(ub);
-                if (ub_buf_it != m_uniform_buffers.end()) {
-                    VkDescriptorBufferInfo buffer_info = {};
-                    buffer_info.buffer = ub_buf_it->second.buffer;
-                    buffer_info.offset = 0;
-                    buffer_info.range = ub->data_size();
-
-                    uint32_t binding_point = 0;
-                    for (const auto& ubm : vk_program.uniform_buffers()) {
-                        if (ubm.name == ub->name()) {
-                            binding_point = ubm.location;
-                            break;
-                        }
-                    }
-
-                    VkWriteDescriptorSet ubo_write = {};
-                    ubo_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                    ubo_write.dstSet = descriptor_set;
-                    ubo_write.dstBinding = binding_point;
-                    ubo_write.dstArrayElement = 0;
-                    ubo_write.descriptorType =
-                        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                    ubo_write.descriptorCount = 1;
-                    ubo_write.pBufferInfo = &buffer_info;
-
-                    vkUpdateDescriptorSets(m_device, 1, &ubo_write, 0, nullptr);
-                }
-            } else {
-                VkDescriptorSetAllocateInfo alloc_info = {};
-                alloc_info.sType =
-                    VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-                alloc_info.descriptorPool = m_descriptor_pool;
-                alloc_info.descriptorSetCount = 1;
-                alloc_info.pSetLayouts = &layout;
-
-                VkResult result = vkAllocateDescriptorSets(m_device,
-                                                           &alloc_info,
-                                                           &descriptor_set);
-                if (result != VK_SUCCESS) {
-                    return VK_NULL_HANDLE;
-                }
-            }
+        // the draws of the pass consume the written buffers as vertices,
+        // indices, indirect arguments or shader data
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                                VK_ACCESS_INDEX_READ_BIT |
+                                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                                VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             DRAW_BUFFER_STAGES,
+                             0,
+                             1,
+                             &barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+    }
 
-            for (const auto& sb : sampler_bindings) {
-                mge::texture* matched_tex = nullptr;
-                for (const auto& binding : textures) {
-                    if (binding.slot == sb.binding) {
-                        matched_tex = binding.texture;
-                        break;
-                    }
-                }
-                if (!matched_tex) {
-                    continue;
-                }
+    void render_context_base::dispatch(
+        VkCommandBuffer                         command_buffer,
+        mge::program*                           prog,
+        mge::uniform_block*                     ub,
+        std::span<const std::byte>              uniform_data,
+        const mge::storage_buffer_binding_list& storage_buffers,
+        uint32_t                                groups_x,
+        uint32_t                                groups_y,
+        uint32_t                                groups_z)
+    {
+        if (!prog) {
+            MGE_THROW(illegal_state)
+                << "Dispatch command has no program assigned";
+        }
+        auto* vk_program = static_cast<mge::vulkan::program*>(prog);
+        if (!vk_program->compute()) {
+            MGE_THROW(illegal_state)
+                << "Dispatch command has program without compute shader";
+        }
+        vkCmdBindPipeline(command_buffer,
+                          VK_PIPELINE_BIND_POINT_COMPUTE,
+                          compute_pipeline(*vk_program));
+        if (ub || !storage_buffers.empty()) {
+            bind_descriptor_set(command_buffer,
+                                VK_PIPELINE_BIND_POINT_COMPUTE,
+                                *vk_program,
+                                ub,
+                                uniform_data,
+                                {},
+                                storage_buffers);
+        }
+        vkCmdDispatch(command_buffer, groups_x, groups_y, groups_z);
+    }
 
-                auto* vk_tex = static_cast<mge::vulkan::texture*>(matched_tex);
-
-                VkDescriptorImageInfo image_info = {};
-                image_info.imageLayout =
-                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                image_info.imageView = vk_tex->image_view();
-                image_info.sampler = vk_tex->sampler();
-
-                VkWriteDescriptorSet descriptor_write = {};
-                descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-                descriptor_write.dstSet = descriptor_set;
-                descriptor_write.dstBinding = sb.binding;
-                descriptor_write.dstArrayElement = 0;
-                descriptor_write.descriptorType =
-                    VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                descriptor_write.descriptorCount = 1;
-                descriptor_write.pImageInfo = &image_info;
-
-                vkUpdateDescriptorSets(m_device, 1, &descriptor_write, 0,
-                                       nullptr);
+    VkPipeline render_context_base::compute_pipeline(const program& prog)
+    {
+        const VkPipelineLayout layout = prog.pipeline_layout();
+        {
+            std::lock_guard<mge::mutex> lock(m_pipelines_lock);
+            auto                        it = m_compute_pipelines.find(layout);
+            if (it != m_compute_pipelines.end()) {
+                return it->second;
             }
-
-            m_descriptor_sets[desc_key] = descriptor_set;
         }
 
-        return descriptor_set;
+        VkComputePipelineCreateInfo pipeline_create_info = {};
+        pipeline_create_info.sType =
+            VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_create_info.stage = prog.shader_stage_create_infos()[0];
+        pipeline_create_info.layout = layout;
+        pipeline_create_info.basePipelineHandle = VK_NULL_HANDLE;
+        pipeline_create_info.basePipelineIndex = -1;
+
+        VkPipeline new_pipeline{VK_NULL_HANDLE};
+        CHECK_VK_CALL(vkCreateComputePipelines(device(),
+                                               m_pipeline_cache,
+                                               1,
+                                               &pipeline_create_info,
+                                               nullptr,
+                                               &new_pipeline));
+        std::lock_guard<mge::mutex> lock(m_pipelines_lock);
+        auto [it, inserted] = m_compute_pipelines.try_emplace(layout,
+                                                              new_pipeline);
+        if (!inserted) {
+            // created concurrently by another thread
+            vkDestroyPipeline(m_device, new_pipeline, nullptr);
+        }
+        return it->second;
     }
 
     void render_context_base::draw_geometry(
@@ -959,10 +1242,92 @@ namespace mge::vulkan {
         mge::index_buffer*               ib,
         const mge::pipeline_state&       state,
         mge::uniform_block*              ub,
+        std::span<const std::byte>       uniform_data,
         const mge::texture_binding_list& textures,
         VkRenderPass                     render_pass,
         uint32_t                         index_count,
-        uint32_t                         index_offset)
+        uint32_t                         index_offset,
+        mge::vertex_buffer*              instances,
+        uint32_t                         instance_count)
+    {
+        bind_geometry(command_buffer,
+                      prog,
+                      vb,
+                      ib,
+                      state,
+                      ub,
+                      uniform_data,
+                      textures,
+                      render_pass,
+                      instances);
+        uint32_t count = index_count > 0
+                             ? index_count
+                             : static_cast<uint32_t>(ib->element_count());
+        vkCmdDrawIndexed(command_buffer,
+                         count,
+                         instance_count,
+                         index_offset,
+                         0,
+                         0);
+    }
+
+    void render_context_base::draw_geometry_indirect(
+        VkCommandBuffer                  command_buffer,
+        mge::program*                    prog,
+        mge::vertex_buffer*              vb,
+        mge::index_buffer*               ib,
+        const mge::pipeline_state&       state,
+        mge::uniform_block*              ub,
+        std::span<const std::byte>       uniform_data,
+        const mge::texture_binding_list& textures,
+        VkRenderPass                     render_pass,
+        VkBuffer                         commands,
+        VkDeviceSize                     offset,
+        uint32_t                         draw_count,
+        mge::vertex_buffer*              instances)
+    {
+        bind_geometry(command_buffer,
+                      prog,
+                      vb,
+                      ib,
+                      state,
+                      ub,
+                      uniform_data,
+                      textures,
+                      render_pass,
+                      instances);
+        constexpr uint32_t stride =
+            static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand));
+        static_assert(stride == sizeof(mge::draw_indexed_indirect_command));
+        if (m_multi_draw_indirect_supported) {
+            vkCmdDrawIndexedIndirect(command_buffer,
+                                     commands,
+                                     offset,
+                                     draw_count,
+                                     stride);
+        } else {
+            // without multiDrawIndirect the draw count must be 1
+            for (uint32_t i = 0; i < draw_count; ++i) {
+                vkCmdDrawIndexedIndirect(command_buffer,
+                                         commands,
+                                         offset + i * stride,
+                                         1,
+                                         stride);
+            }
+        }
+    }
+
+    void render_context_base::bind_geometry(
+        VkCommandBuffer                  command_buffer,
+        mge::program*                    prog,
+        mge::vertex_buffer*              vb,
+        mge::index_buffer*               ib,
+        const mge::pipeline_state&       state,
+        mge::uniform_block*              ub,
+        std::span<const std::byte>       uniform_data,
+        const mge::texture_binding_list& textures,
+        VkRenderPass                     render_pass,
+        mge::vertex_buffer*              instances)
     {
         mge::vulkan::program* vk_program =
             static_cast<mge::vulkan::program*>(prog);
@@ -970,83 +1335,133 @@ namespace mge::vulkan {
             static_cast<mge::vulkan::vertex_buffer*>(vb);
         mge::vulkan::index_buffer* vk_index_buffer =
             static_cast<mge::vulkan::index_buffer*>(ib);
-
-        VkPipeline p =
-            this->pipeline(*vk_vertex_buffer, *vk_program, state, render_pass);
+        mge::vulkan::vertex_buffer* vk_instance_buffer =
+            static_cast<mge::vulkan::vertex_buffer*>(instances);
+
+        static const mge::vertex_layout no_instances;
+        VkPipeline                      p =
+            this->pipeline(vk_vertex_buffer->layout(),
+                           vk_instance_buffer ? vk_instance_buffer->layout()
+                                              : no_instances,
+                           *vk_program,
+                           state,
+                           render_pass);
         vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, p);
 
         if (ub || !textures.empty()) {
-            VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
-            if (ub) {
-                descriptor_set = prepare_uniform_block(*vk_program, *ub);
-            }
-            if (!textures.empty()) {
-                descriptor_set = prepare_texture(*vk_program, textures, ub);
-            }
-            if (descriptor_set != VK_NULL_HANDLE) {
-                vkCmdBindDescriptorSets(command_buffer,
-                                        VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                        vk_program->pipeline_layout(),
-                                        0,
-                                        1,
-                                        &descriptor_set,
-                                        0,
-                                        nullptr);
-            }
+            bind_descriptor_set(command_buffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                *vk_program,
+                                ub,
+                                uniform_data,
+                                textures,
+                                {});
         }
 
-        VkDeviceSize offsets[1]{0};
-        VkBuffer     buffers[1]{vk_vertex_buffer->vk_buffer()};
-        vkCmdBindVertexBuffers(command_buffer, 0, 1, buffers, offsets);
+        VkDeviceSize offsets[2]{0, 0};
+        VkBuffer     buffers[2]{vk_vertex_buffer->vk_buffer(),
+                            vk_instance_buffer ? vk_instance_buffer->vk_buffer()
+                                                   : VK_NULL_HANDLE};
+        vkCmdBindVertexBuffers(command_buffer,
+                               0,
+                               vk_instance_buffer ? 2 : 1,
+                               buffers,
+                               offsets);
         vkCmdBindIndexBuffer(command_buffer,
                              vk_index_buffer->vk_buffer(),
                              0,
                              vk_index_buffer->vk_index_type());
-        uint32_t count =
-            index_count > 0
-                ? index_count
-                : static_cast<uint32_t>(vk_index_buffer->element_count());
-        vkCmdDrawIndexed(command_buffer, count, 1, index_offset, 0, 1);
     }
 
-    const std::vector<VkVertexInputAttributeDescription>&
-    render_context_base::vertex_input_attribute_descriptions(
-        const mge::vertex_layout& layout)
+    static std::vector<VkVertexInputAttributeDescription>
+    attribute_descriptions_of(const mge::vertex_layout& layout,
+                              uint32_t                  binding = 0,
+                              uint32_t                  first_location = 0)
     {
-        auto it = m_vertex_input_attribute_descriptions.find(layout);
-        if (it != m_vertex_input_attribute_descriptions.end()) {
-            return it->second;
-        }
         std::vector<VkVertexInputAttributeDescription> descriptions;
         uint32_t                                       offset = 0;
-        uint32_t                                       location = 0;
+        uint32_t location = first_location;
         for (const auto& el : layout) {
             VkVertexInputAttributeDescription desc;
-            desc.binding = 0;
+            desc.binding = binding;
             desc.location = location++;
             desc.format = vk_format(el.format);
             desc.offset = offset;
             descriptions.emplace_back(desc);
             offset += static_cast<uint32_t>(el.format.binary_size());
         }
+        return descriptions;
+    }
+
+    const std::vector<VkVertexInputAttributeDescription>&
+    render_context_base::vertex_input_attribute_descriptions(
+        const mge::vertex_layout& layout)
+    {
+        auto it = m_vertex_input_attribute_descriptions.find(layout);
+        if (it != m_vertex_input_attribute_descriptions.end()) {
+            return it->second;
+        }
         return m_vertex_input_attribute_descriptions[layout] =
-                   std::move(descriptions);
+                   attribute_descriptions_of(layout);
     }
 
-    VkPipeline render_context_base::pipeline(const vertex_buffer&       buffer,
-                                             const program&             prog,
-                                             const mge::pipeline_state& state,
-                                             VkRenderPass               render_pass)
+    VkPipeline
+    render_context_base::pipeline(const mge::vertex_layout&  layout,
+                                  const mge::vertex_layout&  instance_layout,
+                                  const program&             prog,
+                                  const mge::pipeline_state& state,
+                                  VkRenderPass               render_pass)
     {
-        pipeline_key_type key{buffer.vk_buffer(),
+        pipeline_key_type key{layout,
+                              instance_layout,
                               prog.pipeline_layout(),
                               state,
                               render_pass};
+        {
+            std::lock_guard<mge::mutex> lock(m_pipelines_lock);
+            auto                        it = m_pipelines.find(key);
+            if (it != m_pipelines.end()) {
+                return it->second;
+            }
+        }
+        return create_pipeline(key, prog);
+    }
 
-        auto it = m_pipelines.find(key);
-        if (it != m_pipelines.end()) {
-            return it->second;
+    bool render_context_base::on_prewarm_pipeline(
+        mge::program& prog, const mge::pipeline_manifest::entry& entry)
+    {
+        // frame buffer render passes are created with the frame buffer,
+        // only pipelines of the default render target can be prewarmed
+        VkRenderPass render_pass = default_render_pass();
+        if (entry.render_target != mge::pipeline_manifest::target::DEFAULT ||
+            render_pass == VK_NULL_HANDLE) {
+            return false;
         }
+        const auto&       vk_program = static_cast<const program&>(prog);
+        pipeline_key_type key{entry.vertices,
+                              entry.instances,
+                              vk_program.pipeline_layout(),
+                              entry.state,
+                              render_pass};
+        {
+            std::lock_guard<mge::mutex> lock(m_pipelines_lock);
+            if (m_pipelines.contains(key)) {
+                return false;
+            }
+        }
+        create_pipeline(key, vk_program);
+        return true;
+    }
+
+    VkPipeline
+    render_context_base::create_pipeline(const pipeline_key_type& key,
+                                         const program&           prog)
+    {
+        const auto& [layout,
+                     instance_layout,
+                     pipeline_layout,
+                     state,
+                     render_pass] = key;
 
         VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT,
                                            VK_DYNAMIC_STATE_SCISSOR};
@@ -1060,13 +1475,43 @@ namespace mge::vulkan {
             {};
         vertex_input_state_create_info.sType =
             VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertex_input_state_create_info.vertexBindingDescriptionCount = 1;
+        VkVertexInputBindingDescription binding_descriptions[2] = {};
+        binding_descriptions[0].binding = 0;
+        binding_descriptions[0].stride = static_cast<uint32_t>(layout.stride());
+        binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        std::vector<VkVertexInputAttributeDescription> attribute_descriptions =
+            attribute_descriptions_of(layout);
+        const bool instanced = instance_layout.size() != 0;
+        if (instanced) {
+            if (instance_layout.instance_step_rate() != 1) {
+                // step rates other than 1 need the vertex attribute
+                // divisor extension
+                MGE_THROW(mge::not_implemented)
+                    << "Unsupported instance step rate "
+                    << static_cast<uint32_t>(
+                           instance_layout.instance_step_rate())
+                    << " of instance buffer layout " << instance_layout;
+            }
+            binding_descriptions[1].binding = 1;
+            binding_descriptions[1].stride =
+                static_cast<uint32_t>(instance_layout.stride());
+            binding_descriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+            auto instance_descriptions = attribute_descriptions_of(
+                instance_layout,
+                1,
+                static_cast<uint32_t>(attribute_descriptions.size()));
+            attribute_descriptions.insert(attribute_descriptions.end(),
+                                          instance_descriptions.begin(),
+                                          instance_descriptions.end());
+        }
+        vertex_input_state_create_info.vertexBindingDescriptionCount =
+            instanced ? 2 : 1;
         vertex_input_state_create_info.pVertexBindingDescriptions =
-            &buffer.binding_description();
+            binding_descriptions;
         vertex_input_state_create_info.vertexAttributeDescriptionCount =
-            static_cast<uint32_t>(buffer.attribute_descriptions().size());
+            static_cast<uint32_t>(attribute_descriptions.size());
         vertex_input_state_create_info.pVertexAttributeDescriptions =
-            buffer.attribute_descriptions().data();
+            attribute_descriptions.data();
 
         VkPipelineInputAssemblyStateCreateInfo
             input_assembly_state_create_info = {};
@@ -1185,8 +1630,6 @@ namespace mge::vulkan {
         color_blend_state_create_info.blendConstants[2] = 0.0f;
         color_blend_state_create_info.blendConstants[3] = 0.0f;
 
-        VkPipelineLayout pipeline_layout{prog.pipeline_layout()};
-
         VkGraphicsPipelineCreateInfo pipeline_create_info = {};
         pipeline_create_info.sType =
             VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -1213,12 +1656,28 @@ namespace mge::vulkan {
 
         VkPipeline new_pipeline{VK_NULL_HANDLE};
         CHECK_VK_CALL(vkCreateGraphicsPipelines(device(),
-                                                VK_NULL_HANDLE,
+                                                m_pipeline_cache,
                                                 1,
                                                 &pipeline_create_info,
                                                 nullptr,
                                                 &new_pipeline));
-        return m_pipelines[key] = new_pipeline;
+        {
+            std::lock_guard<mge::mutex> lock(m_pipelines_lock);
+            auto [it, inserted] = m_pipelines.try_emplace(key, new_pipeline);
+            if (!inserted) {
+                // created concurrently by another thread
+                vkDestroyPipeline(m_device, new_pipeline, nullptr);
+                return it->second;
+            }
+        }
+        record_pipeline({prog.source_hash(),
+                         layout,
+                         instance_layout,
+                         state,
+                         render_pass == default_render_pass()
+                             ? mge::pipeline_manifest::target::DEFAULT
+                             : mge::pipeline_manifest::target::FRAME_BUFFER});
+        return new_pipeline;
     }
 
 } // namespace mge::vulkan
@@ -2,11 +2,18 @@
 // Copyright (c) 2017-2026 by Alexander Schroeder
 // All rights reserved.
 #pragma once
+#include "mge/core/mutex.hpp"
 #include "mge/core/tuple_hash.hpp"
 #include "mge/graphics/render_context.hpp"
 #include "mge/graphics/uniform_block.hpp"
+#include "descriptor_allocator.hpp"
+#include "uniform_ring.hpp"
+#include "upload_queue.hpp"
 #include "vulkan.hpp"
 
+#include <array>
+#include <memory>
+#include <span>
 #include <unordered_map>
 
 namespace mge::vulkan {
@@ -23,6 +30,8 @@ namespace mge::vulkan {
                                                    size_t    data_size) override;
         mge::vertex_buffer* on_create_vertex_buffer(const vertex_layout& layout,
                                                     size_t data_size) override;
+        mge::storage_buffer*
+        on_create_storage_buffer(size_t data_size) override;
         mge::shader*        on_create_shader(shader_type t) override;
         mge::program*       on_create_program() override;
         mge::texture_ref    create_texture(texture_type type) override;
@@ -66,15 +75,84 @@ namespace mge::vulkan {
             return m_graphics_command_pool;
         }
 
+        /**
+         * @brief Queue for copying data into buffers and images.
+         *
+         * @return upload queue
+         */
+        upload_queue& uploads() noexcept
+        {
+            return *m_upload_queue;
+        }
+
+        /**
+         * @brief Number of frames that can be in flight.
+         *
+         * The CPU records a frame while the GPU still executes up to
+         * this number of previous frames. All transient per-frame
+         * resources exist once per frame in flight.
+         *
+         * @return frames in flight, from the @c vulkan.frames_in_flight
+         *  parameter
+         */
+        uint32_t frames_in_flight() const noexcept
+        {
+            return m_frames_in_flight;
+        }
+
+        /**
+         * @brief Wait until an upload is complete before its destination
+         * is destroyed.
+         *
+         * Does nothing if the upload queue has already been destroyed.
+         *
+         * @param value timeline value returned by the upload queue
+         */
+        void wait_for_upload(uint64_t value);
+
+        /**
+         * @brief Set the sharing mode of a buffer or image written by the
+         * upload queue.
+         *
+         * If uploads use a dedicated transfer queue family, the resource
+         * is shared concurrently with the graphics queue family, so no
+         * ownership transfers are needed.
+         *
+         * @param info buffer or image create info
+         */
+        template <typename CreateInfo>
+        void set_upload_sharing_mode(CreateInfo& info) const noexcept
+        {
+            if (m_queue_family_indices[0] != m_queue_family_indices[1]) {
+                info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+                info.queueFamilyIndexCount = 2;
+                info.pQueueFamilyIndices = m_queue_family_indices.data();
+            } else {
+                info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            }
+        }
+
         VkFormat depth_format() const noexcept
         {
             return m_depth_format;
         }
 
+        /**
+         * @brief Check whether optimal tiling images of a format support
+         * features.
+         *
+         * @param format   image format
+         * @param features required format features
+         * @return @c true if all features are supported
+         */
+        bool format_supports(VkFormat format,
+                             VkFormatFeatureFlags features) const;
+
         const std::vector<VkVertexInputAttributeDescription>&
         vertex_input_attribute_descriptions(const mge::vertex_layout& layout);
 
-        VkPipeline pipeline(const vertex_buffer&       buffer,
+        VkPipeline pipeline(const mge::vertex_layout&  layout,
+                            const mge::vertex_layout&  instance_layout,
                             const program&             prog,
                             const mge::pipeline_state& state,
                             VkRenderPass               render_pass);
@@ -85,27 +163,96 @@ namespace mge::vulkan {
                            mge::index_buffer*               ib,
                            const mge::pipeline_state&       state,
                            mge::uniform_block*              ub,
+                           std::span<const std::byte>       uniform_data,
                            const mge::texture_binding_list& textures,
                            VkRenderPass                     render_pass,
                            uint32_t                         index_count = 0,
-                           uint32_t                         index_offset = 0);
+                           uint32_t                         index_offset = 0,
+                           mge::vertex_buffer*              instances = nullptr,
+                           uint32_t instance_count = 1);
+
+        /**
+         * @brief Record indexed draws with arguments read from a buffer.
+         *
+         * Binds the same state as @c draw_geometry. Without the
+         * @c multiDrawIndirect device feature, each draw is recorded as
+         * a separate indirect draw.
+         *
+         * @param command_buffer command buffer to record into
+         * @param prog           program to draw with
+         * @param vb             vertex buffer
+         * @param ib             index buffer
+         * @param state          pipeline state
+         * @param ub             uniform block, may be @c nullptr
+         * @param uniform_data   block data recorded with the command
+         * @param textures       texture bindings
+         * @param render_pass    render pass the draws are recorded in
+         * @param commands       buffer of @c VkDrawIndexedIndirectCommand
+         * @param offset         byte offset of first command
+         * @param draw_count     number of draws
+         * @param instances      per-instance buffer, may be @c nullptr
+         */
+        void
+        draw_geometry_indirect(VkCommandBuffer                  command_buffer,
+                               mge::program*                    prog,
+                               mge::vertex_buffer*              vb,
+                               mge::index_buffer*               ib,
+                               const mge::pipeline_state&       state,
+                               mge::uniform_block*              ub,
+                               std::span<const std::byte>       uniform_data,
+                               const mge::texture_binding_list& textures,
+                               VkRenderPass                     render_pass,
+                               VkBuffer                         commands,
+                               VkDeviceSize                     offset,
+                               uint32_t                         draw_count,
+                               mge::vertex_buffer* instances = nullptr);
 
-        void bind_uniform_block(VkCommandBuffer       command_buffer,
-                                mge::vulkan::program& vk_program,
-                                mge::uniform_block&   ub);
+        /**
+         * @brief Record a compute dispatch.
+         *
+         * Must be recorded outside of a render pass.
+         *
+         * @param command_buffer  command buffer to record into
+         * @param prog            compute program
+         * @param ub              uniform block, may be @c nullptr
+         * @param uniform_data    block data recorded with the command
+         * @param storage_buffers storage buffer bindings
+         * @param groups_x        work groups in x direction
+         * @param groups_y        work groups in y direction
+         * @param groups_z        work groups in z direction
+         */
+        void dispatch(VkCommandBuffer                         command_buffer,
+                      mge::program*                           prog,
+                      mge::uniform_block*                     ub,
+                      std::span<const std::byte>              uniform_data,
+                      const mge::storage_buffer_binding_list& storage_buffers,
+                      uint32_t                                groups_x,
+                      uint32_t                                groups_y,
+                      uint32_t                                groups_z);
 
-        void bind_texture(VkCommandBuffer       command_buffer,
-                          mge::vulkan::program& vk_program,
-                          mge::texture*         tex,
-                          mge::uniform_block*   ub = nullptr);
+        VkPipeline compute_pipeline(const program& prog);
 
-        VkDescriptorSet prepare_uniform_block(mge::vulkan::program& vk_program,
-                                              mge::uniform_block&   ub);
+        VkDescriptorSet prepare_descriptor_set(
+            mge::vulkan::program&                   vk_program,
+            mge::uniform_block*                     ub,
+            VkBuffer                                uniform_buffer,
+            const mge::texture_binding_list&        textures,
+            const mge::storage_buffer_binding_list& storage_buffers = {});
 
-        VkDescriptorSet
-        prepare_texture(mge::vulkan::program&            vk_program,
-                        const mge::texture_binding_list& textures,
-                        mge::uniform_block*              ub);
+        /**
+         * @brief Drop cached descriptor sets referencing an image view.
+         *
+         * @param view image view that is destroyed
+         */
+        void forget_descriptor_sets(VkImageView view);
+
+        /**
+         * @brief Drop cached descriptor sets referencing a buffer bound
+         * as storage buffer.
+         *
+         * @param buffer buffer that is destroyed
+         */
+        void forget_descriptor_sets(VkBuffer buffer);
 
     protected:
         render_context_base(mge::vulkan::render_system& rs,
@@ -113,17 +260,72 @@ namespace mge::vulkan {
 
         virtual std::vector<const char*> get_device_extensions() const;
 
+        /**
+         * @brief Render pass of the default render target.
+         *
+         * @return render pass, @c VK_NULL_HANDLE if the context has no
+         *  default render target
+         */
+        virtual VkRenderPass default_render_pass() const noexcept;
+
+        bool on_prewarm_pipeline(
+            mge::program&                        prog,
+            const mge::pipeline_manifest::entry& entry) override;
+
         void create_device();
         void create_allocator();
         void get_device_queue();
         void resolve_device_functions();
         void clear_functions();
         void create_graphics_command_pool();
-        void create_descriptor_pool();
+        void create_frame_resources();
+        void begin_frame_resources(uint32_t frame_index);
+        void create_upload_queue();
+
+        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+        // stages of a frame that wait for uploaded data
+        static constexpr VkPipelineStageFlags UPLOAD_WAIT_STAGES =
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        // stages of draws that consume buffers written by dispatches
+        static constexpr VkPipelineStageFlags DRAW_BUFFER_STAGES =
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+            VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        void create_pipeline_cache();
+        void destroy_pipeline_cache();
         void init_capabilities();
         void find_depth_format();
         void teardown_shared();
 
+        void record_dispatches(const mge::pass& p,
+                               VkCommandBuffer  command_buffer);
+
+        void bind_geometry(VkCommandBuffer                  command_buffer,
+                           mge::program*                    prog,
+                           mge::vertex_buffer*              vb,
+                           mge::index_buffer*               ib,
+                           const mge::pipeline_state&       state,
+                           mge::uniform_block*              ub,
+                           std::span<const std::byte>       uniform_data,
+                           const mge::texture_binding_list& textures,
+                           VkRenderPass                     render_pass,
+                           mge::vertex_buffer*              instances);
+
+        void bind_descriptor_set(
+            VkCommandBuffer                         command_buffer,
+            VkPipelineBindPoint                     bind_point,
+            mge::vulkan::program&                   vk_program,
+            mge::uniform_block*                     ub,
+            std::span<const std::byte>              uniform_data,
+            const mge::texture_binding_list&        textures,
+            const mge::storage_buffer_binding_list& storage_buffers);
+
         void record_render_pass(const mge::pass& p,
                                 VkRenderPass     render_pass,
                                 VkFramebuffer    framebuffer,
@@ -134,29 +336,37 @@ namespace mge::vulkan {
         VkDevice                                    m_device{VK_NULL_HANDLE};
         VmaAllocator                                m_allocator{VK_NULL_HANDLE};
         VkQueue                                     m_queue{VK_NULL_HANDLE};
+        VkQueue                  m_transfer_queue{VK_NULL_HANDLE};
+        std::array<uint32_t, 2>  m_queue_family_indices{};
+        // serializes submissions to m_queue, it may be shared with the
+        // upload queue
+        mge::mutex               m_queue_lock;
         VkCommandPool            m_graphics_command_pool{VK_NULL_HANDLE};
-        VkDescriptorPool         m_descriptor_pool{VK_NULL_HANDLE};
+        VkPipelineCache          m_pipeline_cache{VK_NULL_HANDLE};
         VkFormat                 m_depth_format{VK_FORMAT_UNDEFINED};
+        uint32_t                 m_frames_in_flight{1};
+        bool                     m_multi_draw_indirect_supported{false};
 
-        struct uniform_buffer_data
-        {
-            VkBuffer      buffer{VK_NULL_HANDLE};
-            VmaAllocation allocation{VK_NULL_HANDLE};
-            uint64_t      version{0};
-            void*         mapped_data{nullptr};
-        };
-        std::map<mge::uniform_block*, uniform_buffer_data> m_uniform_buffers;
-        using descriptor_set_key = std::tuple<mge::uniform_block*,
-                                              std::vector<mge::texture*>,
-                                              VkDescriptorSetLayout>;
-        std::map<descriptor_set_key, VkDescriptorSet> m_descriptor_sets;
-
-        using pipeline_key_type =
-            std::tuple<VkBuffer, VkPipelineLayout, mge::pipeline_state,
-                       VkRenderPass>;
+        std::unique_ptr<uniform_ring>         m_uniform_ring;
+        std::unique_ptr<descriptor_allocator> m_descriptor_allocator;
+        std::unique_ptr<upload_queue>         m_upload_queue;
+
+        // vertex layout, instance layout, pipeline layout, state, render pass
+        using pipeline_key_type = std::tuple<mge::vertex_layout,
+                                             mge::vertex_layout,
+                                             VkPipelineLayout,
+                                             mge::pipeline_state,
+                                             VkRenderPass>;
         using pipeline_cache_type =
             std::unordered_map<pipeline_key_type, VkPipeline>;
+
+        VkPipeline create_pipeline(const pipeline_key_type& key,
+                                   const program&           prog);
+
+        mge::mutex          m_pipelines_lock;
         pipeline_cache_type m_pipelines;
+        // compute pipelines by pipeline layout of their program
+        std::unordered_map<VkPipelineLayout, VkPipeline> m_compute_pipelines;
 
         std::unordered_map<mge::vertex_layout,
                            std::vector<VkVertexInputAttributeDescription>>
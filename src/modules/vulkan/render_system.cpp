@@ -10,10 +10,15 @@
 
 #include "mge/core/atexit.hpp"
 #include "mge/core/executable_name.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/core/iterator_index.hpp"
 #include "mge/core/parameter.hpp"
 #include "mge/core/trace.hpp"
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
 #ifdef MGE_OS_WINDOWS
 #    include "mge/win32/monitor.hpp"
 #elif defined(MGE_OS_MACOSX) || defined(MGE_OS_LINUX)
@@ -59,6 +64,12 @@ namespace mge {
                                       stop_on_validation_error,
                                       "Stop on Vulkan validation errors",
                                       true);
+    MGE_DEFINE_PARAMETER_WITH_DEFAULT(
+        std::string,
+        vulkan,
+        pipeline_cache,
+        "File to persist the Vulkan pipeline cache, empty to disable",
+        "");
 } // namespace mge
 
 namespace mge::vulkan {
@@ -543,6 +554,7 @@ namespace mge::vulkan {
             s_glslang_initialized = false;
         }
         m_graphics_queue_index = 0;
+        m_transfer_queue_index = 0;
         m_queue_family_properties.clear();
         m_physical_device = VK_NULL_HANDLE;
         m_physical_device_features.clear();
@@ -588,6 +600,173 @@ namespace mge::vulkan {
         return MGE_PARAMETER(vulkan, stop_on_validation_error).get();
     }
 
+    const VkPhysicalDeviceProperties&
+    render_system::physical_device_properties() const
+    {
+        auto it = m_physical_device_properties.find(m_physical_device);
+        if (it == m_physical_device_properties.end()) {
+            MGE_THROW(vulkan::error) << "No physical device selected";
+        }
+        return it->second;
+    }
+
+    const VkPhysicalDeviceFeatures&
+    render_system::physical_device_features() const
+    {
+        auto it = m_physical_device_features.find(m_physical_device);
+        if (it == m_physical_device_features.end()) {
+            MGE_THROW(vulkan::error) << "No physical device selected";
+        }
+        return it->second;
+    }
+
+    namespace {
+        constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x4350474D; // "MGPC"
+        constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+        /**
+         * Header of the pipeline cache file. The driver validates the
+         * cache data itself, but not all drivers reject stale data
+         * gracefully, so the identifying properties are checked before
+         * the data is handed to the driver.
+         */
+        struct pipeline_cache_file_header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vendor_id;
+            uint32_t device_id;
+            uint32_t driver_version;
+            uint8_t  pipeline_cache_uuid[VK_UUID_SIZE];
+            uint64_t data_size;
+            uint64_t data_hash;
+        };
+
+        pipeline_cache_file_header
+        make_pipeline_cache_header(const VkPhysicalDeviceProperties& props)
+        {
+            pipeline_cache_file_header header{};
+            header.magic = PIPELINE_CACHE_MAGIC;
+            header.version = PIPELINE_CACHE_VERSION;
+            header.vendor_id = props.vendorID;
+            header.device_id = props.deviceID;
+            header.driver_version = props.driverVersion;
+            std::memcpy(header.pipeline_cache_uuid,
+                        props.pipelineCacheUUID,
+                        VK_UUID_SIZE);
+            return header;
+        }
+    } // namespace
+
+    std::vector<uint8_t> render_system::load_pipeline_cache_data() const
+    {
+        std::vector<uint8_t> result;
+        const auto&          file_name =
+            MGE_PARAMETER(vulkan, pipeline_cache).get();
+        if (file_name.empty()) {
+            return result;
+        }
+        std::ifstream input(std::filesystem::path(file_name),
+                            std::ios::binary);
+        if (!input) {
+            MGE_DEBUG_TRACE(VULKAN, "No pipeline cache file {}", file_name);
+            return result;
+        }
+
+        pipeline_cache_file_header header{};
+        input.read(reinterpret_cast<char*>(&header), sizeof(header));
+        const auto expected =
+            make_pipeline_cache_header(physical_device_properties());
+        if (!input || header.magic != expected.magic ||
+            header.version != expected.version ||
+            header.vendor_id != expected.vendor_id ||
+            header.device_id != expected.device_id ||
+            header.driver_version != expected.driver_version ||
+            std::memcmp(header.pipeline_cache_uuid,
+                        expected.pipeline_cache_uuid,
+                        VK_UUID_SIZE) != 0) {
+            MGE_INFO_TRACE(VULKAN,
+                           "Ignoring pipeline cache {} of other device or "
+                           "driver",
+                           file_name);
+            return result;
+        }
+
+        // the size is checked against the file before it is trusted for
+        // an allocation, a corrupt header could request any size
+        std::error_code ec;
+        const auto      file_size =
+            std::filesystem::file_size(std::filesystem::path(file_name), ec);
+        if (ec || file_size < sizeof(header) ||
+            header.data_size > file_size - sizeof(header)) {
+            MGE_WARNING_TRACE(VULKAN,
+                              "Ignoring truncated pipeline cache {}",
+                              file_name);
+            return result;
+        }
+        result.resize(static_cast<size_t>(header.data_size));
+        input.read(reinterpret_cast<char*>(result.data()),
+                   static_cast<std::streamsize>(result.size()));
+        if (!input ||
+            mge::fnv1a(result.data(), result.size()) != header.data_hash) {
+            MGE_WARNING_TRACE(VULKAN,
+                              "Ignoring corrupt pipeline cache {}",
+                              file_name);
+            result.clear();
+            return result;
+        }
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Loaded {} bytes pipeline cache from {}",
+                        result.size(),
+                        file_name);
+        return result;
+    }
+
+    void
+    render_system::store_pipeline_cache_data(std::span<const uint8_t> data) const
+    {
+        const auto& file_name = MGE_PARAMETER(vulkan, pipeline_cache).get();
+        if (file_name.empty() || data.empty()) {
+            return;
+        }
+        auto header = make_pipeline_cache_header(physical_device_properties());
+        header.data_size = data.size();
+        header.data_hash = mge::fnv1a(data.data(), data.size());
+
+        // write to a temporary file first so a crash does not leave a
+        // truncated cache behind
+        std::filesystem::path path(file_name);
+        std::filesystem::path tmp_path(path);
+        tmp_path += ".tmp";
+        {
+            std::ofstream output(tmp_path, std::ios::binary | std::ios::trunc);
+            output.write(reinterpret_cast<const char*>(&header),
+                         sizeof(header));
+            output.write(reinterpret_cast<const char*>(data.data()),
+                         static_cast<std::streamsize>(data.size()));
+            if (!output) {
+                MGE_WARNING_TRACE(VULKAN,
+                                  "Cannot write pipeline cache {}",
+                                  tmp_path.string());
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            MGE_WARNING_TRACE(VULKAN,
+                              "Cannot write pipeline cache {}: {}",
+                              file_name,
+                              ec.message());
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Stored {} bytes pipeline cache to {}",
+                        data.size(),
+                        file_name);
+    }
+
     void render_system::destroy_instance()
     {
         if (m_debug_messenger && vkDestroyDebugUtilsMessengerEXT) {
@@ -680,6 +859,7 @@ namespace mge::vulkan {
             MGE_THROW(error) << "No queue families found";
         }
         m_graphics_queue_index = m_queue_family_properties.size();
+        m_transfer_queue_index = m_queue_family_properties.size();
         for (size_t index = 0; index < m_queue_family_properties.size();
              ++index) {
             const auto& qf = m_queue_family_properties[index];
@@ -707,14 +887,27 @@ namespace mge::vulkan {
                 m_graphics_queue_index == m_queue_family_properties.size()) {
                 m_graphics_queue_index = index;
             }
-            if (qf.queueFlags & VK_QUEUE_GRAPHICS_BIT &&
-                m_graphics_queue_index == m_queue_family_properties.size()) {
-                m_graphics_queue_index = index;
+            // a transfer-only family is backed by the copy engines
+            constexpr VkQueueFlags transfer_only_mask =
+                VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT |
+                VK_QUEUE_COMPUTE_BIT;
+            if ((qf.queueFlags & transfer_only_mask) ==
+                    VK_QUEUE_TRANSFER_BIT &&
+                qf.queueCount > 0 &&
+                m_transfer_queue_index == m_queue_family_properties.size()) {
+                m_transfer_queue_index = index;
             }
         }
         if (m_graphics_queue_index == m_queue_family_properties.size()) {
             MGE_THROW(error) << "No graphics queue family found";
         }
+        if (m_transfer_queue_index == m_queue_family_properties.size()) {
+            m_transfer_queue_index = m_graphics_queue_index;
+        }
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Using queue family {} for graphics, {} for transfer",
+                        m_graphics_queue_index,
+                        m_transfer_queue_index);
     }
 
     void* render_system::renderdoc_device() const
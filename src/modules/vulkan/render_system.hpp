@@ -7,6 +7,9 @@
 #include "vulkan.hpp"
 #include "vulkan_library.hpp"
 
+#include <span>
+#include <vector>
+
 namespace mge::vulkan {
 
     class render_system : public mge::render_system,
@@ -59,6 +62,17 @@ namespace mge::vulkan {
             return static_cast<uint32_t>(m_graphics_queue_index);
         }
 
+        /**
+         * @brief Queue family used for uploads.
+         *
+         * @return index of a transfer-only queue family if the device has
+         *  one, otherwise the graphics queue family
+         */
+        inline uint32_t transfer_queue_index() const noexcept
+        {
+            return static_cast<uint32_t>(m_transfer_queue_index);
+        }
+
         inline vulkan_library& library() noexcept
         {
             return *m_library;
@@ -66,6 +80,40 @@ namespace mge::vulkan {
 
         void* renderdoc_device() const;
 
+        /**
+         * @brief Properties of the selected physical device.
+         * @return physical device properties
+         */
+        const VkPhysicalDeviceProperties& physical_device_properties() const;
+
+        /**
+         * @brief Features of the selected physical device.
+         * @return physical device features
+         */
+        const VkPhysicalDeviceFeatures& physical_device_features() const;
+
+        /**
+         * @brief Load persisted pipeline cache data.
+         *
+         * Reads the file configured by the @c vulkan.pipeline_cache
+         * parameter. Data written for another device, driver version or
+         * pipeline cache UUID is ignored.
+         *
+         * @return initial data for a @c VkPipelineCache, empty if there is
+         *  no valid cache file or persistence is disabled
+         */
+        std::vector<uint8_t> load_pipeline_cache_data() const;
+
+        /**
+         * @brief Persist pipeline cache data.
+         *
+         * Does nothing if persistence is disabled. Failures are logged
+         * and otherwise ignored, the cache is an optimization only.
+         *
+         * @param data data retrieved by @c vkGetPipelineCacheData
+         */
+        void store_pipeline_cache_data(std::span<const uint8_t> data) const;
+
     private:
         void init_capabilities();
         static VkBool32
@@ -100,6 +148,7 @@ namespace mge::vulkan {
                                              m_physical_device_features;
         std::vector<VkQueueFamilyProperties> m_queue_family_properties;
         size_t                               m_graphics_queue_index{0};
+        size_t                               m_transfer_queue_index{0};
         static bool                          s_glslang_initialized;
     };
 } // namespace mge::vulkan
\ No newline at end of file
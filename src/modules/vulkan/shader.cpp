@@ -4,8 +4,10 @@
 #include "shader.hpp"
 #include "error.hpp"
 #include "glslang.hpp"
+#include "mge/core/fnv1a.hpp"
 #include "mge/core/on_leave.hpp"
 #include "mge/core/trace.hpp"
+#include "mge/graphics/shader_cache.hpp"
 #include "render_context_base.hpp"
 #include "spirv-reflect/spirv_reflect.h"
 
@@ -56,6 +58,22 @@ namespace mge::vulkan {
 
     void shader::on_compile(std::string_view code)
     {
+        // key covers compiler version, stage and target of the input below
+        const uint32_t key_data[] = {GLSLANG_VERSION_MAJOR,
+                                     GLSLANG_VERSION_MINOR,
+                                     GLSLANG_VERSION_PATCH,
+                                     static_cast<uint32_t>(stage()),
+                                     GLSLANG_TARGET_VULKAN_1_3,
+                                     GLSLANG_TARGET_SPV_1_6};
+        const uint64_t key =
+            mge::fnv1a(code, mge::fnv1a(key_data, sizeof(key_data)));
+        if (auto cached = mge::shader_cache().get(key)) {
+            MGE_DEBUG_TRACE(VULKAN, "Using cached shader {:016x}", key);
+            m_code = *cached;
+            create_shader_module();
+            return;
+        }
+
         std::string code_str(code.begin(), code.end());
 
         const glslang_input_t input = {
@@ -140,6 +158,7 @@ namespace mge::vulkan {
         MGE_DEBUG_TRACE(VULKAN,
                         "Shader code size: {} bytes",
                         code_size_words * 4);
+        mge::shader_cache().put(key, m_code);
         create_shader_module();
     }
 
@@ -247,7 +266,8 @@ namespace mge::vulkan {
         mge::program::attribute_list&                  attributes,
         mge::program::uniform_list&                    uniforms,
         mge::program::uniform_block_metadata_list&     uniform_buffers,
-        std::vector<std::pair<std::string, uint32_t>>& sampler_bindings) const
+        std::vector<std::pair<std::string, uint32_t>>& sampler_bindings,
+        mge::program::storage_buffer_metadata_list&    storage_buffers) const
     {
         if (m_code.empty()) {
             return;
@@ -295,6 +315,10 @@ namespace mge::vulkan {
                     SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
                     std::string name = binding.name ? binding.name : "";
                     sampler_bindings.push_back({name, binding.binding});
+                } else if (binding.descriptor_type ==
+                           SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
+                    std::string name = binding.name ? binding.name : "";
+                    storage_buffers.push_back({name, binding.binding});
                 } else if (binding.descriptor_type ==
                            SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
                     mge::program::uniform_block_metadata ub_metadata;
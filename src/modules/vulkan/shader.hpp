@@ -21,7 +21,9 @@ namespace mge::vulkan {
                      mge::program::uniform_list&                uniforms,
                      mge::program::uniform_block_metadata_list& uniform_buffers,
                      std::vector<std::pair<std::string, uint32_t>>&
-                         sampler_bindings) const;
+                         sampler_bindings,
+                     mge::program::storage_buffer_metadata_list&
+                         storage_buffers) const;
 
         void set_code_immediate(const mge::buffer& code,
                                 const std::string& entry_point_name);
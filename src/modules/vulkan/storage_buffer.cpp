@@ -0,0 +1,103 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "storage_buffer.hpp"
+#include "error.hpp"
+#include "render_context_base.hpp"
+
+#include <cstring>
+
+namespace mge::vulkan {
+
+    storage_buffer::storage_buffer(render_context_base& context,
+                                   size_t               data_size)
+        : mge::storage_buffer(context, data_size)
+        , m_vulkan_context(context)
+    {
+        create_buffer();
+        set_ready(true);
+    }
+
+    void storage_buffer::create_buffer()
+    {
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size();
+        // storage buffers may also feed draws, e.g. particles or draw
+        // arguments written by a compute shader
+        buffer_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+                            VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                            VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        m_vulkan_context.set_upload_sharing_mode(buffer_info);
+
+        // memory that is not host visible is written by the upload queue
+        VmaAllocationCreateInfo alloc_info{};
+        alloc_info.usage = VMA_MEMORY_USAGE_AUTO;
+        alloc_info.flags =
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT |
+            VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VmaAllocationInfo allocation_info{};
+        CHECK_VK_CALL(vmaCreateBuffer(m_vulkan_context.allocator(),
+                                      &buffer_info,
+                                      &alloc_info,
+                                      &m_buffer,
+                                      &m_allocation,
+                                      &allocation_info));
+        m_mapped_data = static_cast<std::byte*>(allocation_info.pMappedData);
+    }
+
+    storage_buffer::~storage_buffer()
+    {
+        if (m_upload_value != 0) {
+            m_vulkan_context.wait_for_upload(m_upload_value);
+        }
+        if (m_buffer && m_allocation) {
+            m_vulkan_context.forget_descriptor_sets(m_buffer);
+            vmaDestroyBuffer(m_vulkan_context.allocator(),
+                             m_buffer,
+                             m_allocation);
+            m_buffer = VK_NULL_HANDLE;
+            m_allocation = VK_NULL_HANDLE;
+        }
+    }
+
+    void storage_buffer::on_set_data(void* data, size_t data_size)
+    {
+        if (m_mapped_data) {
+            std::memcpy(m_mapped_data, data, data_size);
+            CHECK_VK_CALL(vmaFlushAllocation(m_vulkan_context.allocator(),
+                                             m_allocation,
+                                             0,
+                                             data_size));
+        } else {
+            m_upload_value =
+                m_vulkan_context.uploads().upload(m_buffer, 0, data, data_size);
+        }
+        set_ready(true);
+    }
+
+    void* storage_buffer::on_map_range(size_t offset, size_t)
+    {
+        return m_mapped_data ? m_mapped_data + offset : nullptr;
+    }
+
+    void storage_buffer::on_flush_range(size_t offset, size_t size)
+    {
+        CHECK_VK_CALL(vmaFlushAllocation(m_vulkan_context.allocator(),
+                                         m_allocation,
+                                         offset,
+                                         size));
+    }
+
+    void storage_buffer::on_update(size_t offset, const void* data, size_t size)
+    {
+        m_upload_value =
+            m_vulkan_context.uploads().upload(m_buffer, offset, data, size);
+        set_ready(true);
+    }
+
+} // namespace mge::vulkan
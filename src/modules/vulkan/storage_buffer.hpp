@@ -0,0 +1,41 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/graphics/storage_buffer.hpp"
+#include "vulkan.hpp"
+
+namespace mge::vulkan {
+
+    class render_context_base;
+
+    class storage_buffer : public mge::storage_buffer
+    {
+    public:
+        storage_buffer(render_context_base& context, size_t data_size);
+
+        ~storage_buffer();
+
+        VkBuffer vk_buffer() const
+        {
+            return m_buffer;
+        }
+
+        void on_set_data(void* data, size_t data_size) override;
+
+    protected:
+        void* on_map_range(size_t offset, size_t size) override;
+        void  on_flush_range(size_t offset, size_t size) override;
+        void  on_update(size_t offset, const void* data, size_t size) override;
+
+    private:
+        void create_buffer();
+
+        render_context_base& m_vulkan_context;
+        VkBuffer             m_buffer{VK_NULL_HANDLE};
+        VmaAllocation        m_allocation{VK_NULL_HANDLE};
+        std::byte*           m_mapped_data{nullptr};
+        uint64_t             m_upload_value{0};
+    };
+
+} // namespace mge::vulkan
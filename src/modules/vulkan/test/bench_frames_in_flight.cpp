@@ -0,0 +1,112 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/buffer.hpp"
+#include "mge/core/configuration.hpp"
+#include "mge/graphics/frame_buffer_info.hpp"
+#include "mge/graphics/program.hpp"
+#include "mge/graphics/render_context.hpp"
+#include "mge/graphics/rgba_color.hpp"
+#include "mge/graphics/shader.hpp"
+
+#include "vulkan_test.hpp"
+
+#include "test/benchmark.hpp"
+
+#include <string>
+
+namespace {
+    constexpr uint32_t draws_per_frame = 1000;
+
+    const char* vertex_glsl = R"shader(
+        #version 330 core
+        layout(location = 0) in vec3 vertexPosition;
+        void main() {
+            gl_Position.xyz = vertexPosition;
+            gl_Position.w = 1.0;
+        }
+    )shader";
+
+    const char* fragment_glsl = R"shader(
+        #version 330 core
+        layout(location = 0) out vec4 color;
+        void main() {
+            color = vec4(1.0, 0.0, 0.0, 1.0);
+        }
+    )shader";
+} // namespace
+
+class frames_in_flight_bench : public mge::vulkan::vulkantest
+{};
+
+TEST_F(frames_in_flight_bench, headless_frame_throughput)
+{
+    auto& frames_in_flight =
+        mge::configuration::find_parameter("vulkan", "frames_in_flight");
+
+    for (uint32_t n = 1; n <= 3; ++n) {
+        frames_in_flight.set_value(n);
+
+        mge::extent ext(800, 600);
+        auto context = m_render_system->create_headless_render_context(ext);
+
+        mge::frame_buffer_info fb_info;
+        fb_info.color_attachments.push_back(
+            {mge::image_format(mge::image_format::data_format::RGBA,
+                               mge::data_type::UINT8),
+             ext});
+        auto frame_buffer = context->create_frame_buffer(fb_info);
+
+        auto vertex_shader = context->create_shader(mge::shader_type::VERTEX);
+        auto pixel_shader = context->create_shader(mge::shader_type::FRAGMENT);
+        vertex_shader->compile(vertex_glsl);
+        pixel_shader->compile(fragment_glsl);
+        auto program = context->create_program();
+        program->set_shader(vertex_shader);
+        program->set_shader(pixel_shader);
+        program->link();
+
+        float triangle_coords[] = {
+            0.0f,   0.5f,  0.0f,
+            0.45f, -0.5f,  0.0f,
+           -0.45f, -0.5f,  0.0f,
+        };
+        int triangle_indices[] = {0, 1, 2};
+
+        mge::vertex_layout layout;
+        layout.push_back(mge::vertex_format(mge::data_type::FLOAT, 3));
+        auto vertices =
+            context->create_vertex_buffer(layout,
+                                          sizeof(triangle_coords),
+                                          mge::make_buffer(triangle_coords));
+        auto indices =
+            context->create_index_buffer(mge::data_type::INT32,
+                                         sizeof(triangle_indices),
+                                         mge::make_buffer(triangle_indices));
+
+        auto& pass = context->pass(0);
+        pass.set_frame_buffer(frame_buffer);
+        pass.set_viewport(context->default_viewport());
+        pass.set_scissor(context->default_scissor());
+        pass.clear_color(mge::rgba_color(0.0f, 0.0f, 0.2f, 1.0f));
+        pass.disable_clear_depth();
+
+        std::string name =
+            "headless_frames_in_flight_" + std::to_string(n);
+        mge::benchmark().run(name, [&]() {
+            auto& cmd = context->command_buffer(true);
+            for (uint32_t i = 0; i < draws_per_frame; ++i) {
+                cmd.draw(pass, program, vertices, indices);
+            }
+            context->frame();
+        });
+
+        program = {};
+        vertices = {};
+        indices = {};
+        frame_buffer = {};
+        context.reset();
+    }
+
+    frames_in_flight.reset();
+}
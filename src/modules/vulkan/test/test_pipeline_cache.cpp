@@ -0,0 +1,136 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "mge/core/configuration.hpp"
+#include "vulkan_test.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+    // layout of the pipeline cache file header written by the render
+    // system
+    struct pipeline_cache_file_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint32_t driver_version;
+        uint8_t  pipeline_cache_uuid[16];
+        uint64_t data_size;
+        uint64_t data_hash;
+    };
+} // namespace
+
+class pipeline_cache_test : public mge::vulkan::vulkantest
+{
+protected:
+    void SetUp() override
+    {
+        vulkantest::SetUp();
+        m_path = std::filesystem::temp_directory_path() /
+                 "mge_test_pipeline_cache.bin";
+        std::filesystem::remove(m_path);
+        mge::configuration::find_parameter("vulkan", "pipeline_cache")
+            .set_value(m_path.string());
+    }
+
+    void TearDown() override
+    {
+        mge::configuration::find_parameter("vulkan", "pipeline_cache")
+            .set_value(std::string());
+        std::filesystem::remove(m_path);
+        vulkantest::TearDown();
+    }
+
+    // the cache is loaded when a context is created and stored when it
+    // is destroyed
+    void open_and_close_window()
+    {
+        auto window = m_render_system->create_window(
+            mge::extent(320, 200),
+            mge::window_options::standard_options());
+        window->render_context().frame();
+        window.reset();
+    }
+
+    std::vector<char> read_file() const
+    {
+        std::ifstream input(m_path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(input),
+                                 std::istreambuf_iterator<char>());
+    }
+
+    void write_file(const std::vector<char>& data) const
+    {
+        std::ofstream output(m_path, std::ios::binary | std::ios::trunc);
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    // a stored file holds as many bytes as its header announces
+    void expect_stored_file() const
+    {
+        auto data = read_file();
+        ASSERT_GE(data.size(), sizeof(pipeline_cache_file_header));
+        pipeline_cache_file_header header{};
+        std::memcpy(&header, data.data(), sizeof(header));
+        EXPECT_EQ(data.size() - sizeof(header), header.data_size);
+    }
+
+    std::filesystem::path m_path;
+};
+
+TEST_F(pipeline_cache_test, stored_when_context_is_destroyed)
+{
+    open_and_close_window();
+    if (!std::filesystem::exists(m_path)) {
+        GTEST_SKIP() << "Driver returned no pipeline cache data";
+    }
+    expect_stored_file();
+
+    // a valid file is loaded and stored again
+    open_and_close_window();
+    expect_stored_file();
+}
+
+TEST_F(pipeline_cache_test, ignores_truncated_and_oversized_files)
+{
+    open_and_close_window();
+    if (!std::filesystem::exists(m_path)) {
+        GTEST_SKIP() << "Driver returned no pipeline cache data";
+    }
+    const auto valid = read_file();
+    ASSERT_GT(valid.size(), sizeof(pipeline_cache_file_header));
+
+    // data shorter than the header announces
+    auto truncated = valid;
+    truncated.resize(sizeof(pipeline_cache_file_header) +
+                     (valid.size() - sizeof(pipeline_cache_file_header)) / 2);
+    write_file(truncated);
+    EXPECT_NO_THROW(open_and_close_window());
+    expect_stored_file();
+
+    // a size no file can hold must not be allocated
+    auto oversized = valid;
+    pipeline_cache_file_header header{};
+    std::memcpy(&header, oversized.data(), sizeof(header));
+    header.data_size = UINT64_MAX / 2;
+    std::memcpy(oversized.data(), &header, sizeof(header));
+    write_file(oversized);
+    EXPECT_NO_THROW(open_and_close_window());
+    expect_stored_file();
+
+    // only the header
+    write_file(std::vector<char>(valid.begin(),
+                                 valid.begin() +
+                                     sizeof(pipeline_cache_file_header)));
+    EXPECT_NO_THROW(open_and_close_window());
+    expect_stored_file();
+}
@@ -7,6 +7,9 @@
 
 #include "mge/core/checked_cast.hpp"
 #include "mge/core/trace.hpp"
+#include "mge/graphics/mipmap.hpp"
+
+#include <vector>
 
 namespace mge {
     MGE_USE_TRACE(VULKAN);
@@ -38,10 +41,14 @@ namespace mge::vulkan {
     {
         auto& ctx = static_cast<render_context_base&>(context());
 
+        if (m_upload_value != 0 && !ready()) {
+            ctx.wait_for_upload(m_upload_value);
+        }
         if (m_sampler != VK_NULL_HANDLE) {
             ctx.vkDestroySampler(ctx.device(), m_sampler, nullptr);
         }
         if (m_image_view != VK_NULL_HANDLE) {
+            ctx.forget_descriptor_sets(m_image_view);
             ctx.vkDestroyImageView(ctx.device(), m_image_view, nullptr);
         }
         if (m_image != VK_NULL_HANDLE) {
@@ -52,6 +59,26 @@ namespace mge::vulkan {
     VkFormat texture::texture_format(const mge::image_format& format) const
     {
         switch (format.format()) {
+        case mge::image_format::data_format::BC1:
+            return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+        case mge::image_format::data_format::BC2:
+            return VK_FORMAT_BC2_UNORM_BLOCK;
+        case mge::image_format::data_format::BC3:
+            return VK_FORMAT_BC3_UNORM_BLOCK;
+        case mge::image_format::data_format::BC4:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case mge::image_format::data_format::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case mge::image_format::data_format::BC6H:
+            return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+        case mge::image_format::data_format::BC7:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+        case mge::image_format::data_format::ETC2_RGB:
+            return VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK;
+        case mge::image_format::data_format::ETC2_RGBA:
+            return VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK;
+        case mge::image_format::data_format::ASTC_4x4:
+            return VK_FORMAT_ASTC_4x4_UNORM_BLOCK;
         case mge::image_format::data_format::RGB:
             switch (format.type()) {
             case mge::data_type::FLOAT:
@@ -97,7 +124,7 @@ namespace mge::vulkan {
         image_info.extent.width = width;
         image_info.extent.height = height;
         image_info.extent.depth = 1;
-        image_info.mipLevels = 1;
+        image_info.mipLevels = m_mip_levels;
         image_info.arrayLayers = 1;
         image_info.format = format;
         image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -105,7 +132,7 @@ namespace mge::vulkan {
         image_info.usage =
             VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
         image_info.samples = VK_SAMPLE_COUNT_1_BIT;
-        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        ctx.set_upload_sharing_mode(image_info);
 
         VmaAllocationCreateInfo alloc_info = {};
         alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -172,7 +199,7 @@ namespace mge::vulkan {
         view_info.subresourceRange.aspectMask =
             m_is_depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
         view_info.subresourceRange.baseMipLevel = 0;
-        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.levelCount = m_mip_levels;
         view_info.subresourceRange.baseArrayLayer = 0;
         view_info.subresourceRange.layerCount = 1;
 
@@ -210,7 +237,7 @@ namespace mge::vulkan {
         sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
         sampler_info.mipLodBias = 0.0f;
         sampler_info.minLod = 0.0f;
-        sampler_info.maxLod = 0.0f;
+        sampler_info.maxLod = static_cast<float>(m_mip_levels - 1);
 
         CHECK_VK_CALL(ctx.vkCreateSampler(ctx.device(),
                                           &sampler_info,
@@ -218,157 +245,56 @@ namespace mge::vulkan {
                                           &m_sampler));
     }
 
-    void texture::transition_image_layout(VkCommandBuffer command_buffer,
-                                          VkImageLayout   old_layout,
-                                          VkImageLayout   new_layout)
+    void texture::upload_data(const mge::image_format& format,
+                              const mge::extent&       extent,
+                              const void*              data,
+                              size_t                   size)
     {
-        VkImageMemoryBarrier barrier = {};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = old_layout;
-        barrier.newLayout = new_layout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = m_image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        VkPipelineStageFlags src_stage;
-        VkPipelineStageFlags dst_stage;
-
-        if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED &&
-            new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
-                   new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else {
-            MGE_THROW(mge::illegal_argument) << "Unsupported layout transition";
-        }
-
         auto& ctx = static_cast<render_context_base&>(context());
-        ctx.vkCmdPipelineBarrier(command_buffer,
-                                 src_stage,
-                                 dst_stage,
-                                 0,
-                                 0,
-                                 nullptr,
-                                 0,
-                                 nullptr,
-                                 1,
-                                 &barrier);
+
+        std::vector<VkBufferImageCopy> regions(m_mip_levels);
+        for (uint32_t level = 0; level < m_mip_levels; ++level) {
+            mge::extent level_extent = mip_level_extent(extent, level);
+            auto&       region = regions[level];
+            region.bufferOffset = mip_level_offset(format, extent, level);
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {level_extent.width, level_extent.height, 1};
+        }
+        VkDeviceSize element_size =
+            format.compressed() ? format.block_size() : format.binary_size();
+
+        set_ready(false);
+        m_upload_value = ctx.uploads().upload(m_image,
+                                              regions,
+                                              data,
+                                              size,
+                                              element_size,
+                                              [this]() { set_ready(true); });
     }
 
-    void texture::upload_data(const void* data,
-                              size_t      size,
-                              uint32_t    width,
-                              uint32_t    height,
-                              size_t      row_pitch)
+    void texture::create_texture(const mge::image_format& format,
+                                 const mge::extent&       extent,
+                                 const void*              data,
+                                 size_t                   size)
     {
-        auto& ctx = static_cast<render_context_base&>(context());
-
-        // Create staging buffer
-        VkBufferCreateInfo buffer_info = {};
-        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        buffer_info.size = size;
-        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        auto&    ctx = static_cast<render_context_base&>(context());
+        VkFormat vk_format = texture_format(format);
+        if (format.compressed() &&
+            !ctx.format_supports(vk_format,
+                                 VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+            MGE_THROW(mge::illegal_argument)
+                << "Compressed image format " << format
+                << " is not supported by the device";
+        }
 
-        VmaAllocationCreateInfo alloc_info = {};
-        alloc_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
-
-        VkBuffer      staging_buffer = VK_NULL_HANDLE;
-        VmaAllocation staging_allocation = VK_NULL_HANDLE;
-
-        CHECK_VK_CALL(vmaCreateBuffer(ctx.allocator(),
-                                      &buffer_info,
-                                      &alloc_info,
-                                      &staging_buffer,
-                                      &staging_allocation,
-                                      nullptr));
-
-        // Copy data to staging buffer
-        void* mapped = nullptr;
-        CHECK_VK_CALL(
-            vmaMapMemory(ctx.allocator(), staging_allocation, &mapped));
-        memcpy(mapped, data, size);
-        vmaUnmapMemory(ctx.allocator(), staging_allocation);
-
-        // Allocate a one-shot command buffer
-        VkCommandBufferAllocateInfo cmd_alloc_info = {};
-        cmd_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        cmd_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        cmd_alloc_info.commandPool = ctx.graphics_command_pool();
-        cmd_alloc_info.commandBufferCount = 1;
-
-        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
-        CHECK_VK_CALL(ctx.vkAllocateCommandBuffers(ctx.device(),
-                                                   &cmd_alloc_info,
-                                                   &command_buffer));
-
-        VkCommandBufferBeginInfo begin_info = {};
-        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        CHECK_VK_CALL(ctx.vkBeginCommandBuffer(command_buffer, &begin_info));
-
-        // Transition to transfer destination
-        transition_image_layout(command_buffer,
-                                VK_IMAGE_LAYOUT_UNDEFINED,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        // Copy buffer to image
-        VkBufferImageCopy region = {};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, 1};
-
-        ctx.vkCmdCopyBufferToImage(command_buffer,
-                                   staging_buffer,
-                                   m_image,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                   1,
-                                   &region);
-
-        // Transition to shader read-only
-        transition_image_layout(command_buffer,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        CHECK_VK_CALL(ctx.vkEndCommandBuffer(command_buffer));
-
-        // Submit and wait
-        VkSubmitInfo submit_info = {};
-        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit_info.commandBufferCount = 1;
-        submit_info.pCommandBuffers = &command_buffer;
-
-        CHECK_VK_CALL(ctx.vkQueueSubmit(ctx.graphics_queue(),
-                                        1,
-                                        &submit_info,
-                                        VK_NULL_HANDLE));
-        CHECK_VK_CALL(ctx.vkQueueWaitIdle(ctx.graphics_queue()));
-
-        ctx.vkFreeCommandBuffers(ctx.device(),
-                                 ctx.graphics_command_pool(),
-                                 1,
-                                 &command_buffer);
-
-        // Destroy staging buffer
-        vmaDestroyBuffer(ctx.allocator(), staging_buffer, staging_allocation);
+        create_image(vk_format, extent.width, extent.height);
+        upload_data(format, extent, data, size);
+        create_image_view(vk_format);
+        create_sampler();
     }
 
     void texture::set_data(const mge::image_format& format,
@@ -382,13 +308,45 @@ namespace mge::vulkan {
                         extent.height,
                         format);
 
-        VkFormat vk_format = texture_format(format);
-        size_t   row_pitch = extent.width * format.binary_size();
+        // The upload queue may run on a transfer-only queue, which cannot
+        // blit, so the mip chain is computed before uploading it.
+        bool is_color =
+            format.format() == mge::image_format::data_format::RGB ||
+            format.format() == mge::image_format::data_format::RGBA;
+        if (is_color && mip_level_count(extent) > 1) {
+            auto chain = generate_mip_chain(format, extent, data);
+            m_mip_levels = chain->mip_levels();
+            create_texture(format,
+                           extent,
+                           chain->data(),
+                           chain->binary_size());
+        } else {
+            m_mip_levels = 1;
+            create_texture(format, extent, data, size);
+        }
+    }
 
-        create_image(vk_format, extent.width, extent.height);
-        upload_data(data, size, extent.width, extent.height, row_pitch);
-        create_image_view(vk_format);
-        create_sampler();
+    void texture::set_mip_data(const mge::image_format& format,
+                               const mge::extent&       extent,
+                               const void*              data,
+                               size_t                   size,
+                               uint32_t                 levels)
+    {
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Set texture data: {}x{}, format {}, {} mip levels",
+                        extent.width,
+                        extent.height,
+                        format,
+                        levels);
+
+        if (levels == 0 || levels > mip_level_count(extent) ||
+            size < mip_level_offset(format, extent, levels)) {
+            MGE_THROW(mge::illegal_argument)
+                << "Invalid mip chain of " << levels << " levels and "
+                << size << " bytes for extent " << extent;
+        }
+        m_mip_levels = levels;
+        create_texture(format, extent, data, size);
     }
 
 } // namespace mge::vulkan
@@ -23,6 +23,12 @@ namespace mge::vulkan {
                       const void*              data,
                       size_t                   size) override;
 
+        void set_mip_data(const mge::image_format& format,
+                          const mge::extent&       extent,
+                          const void*              data,
+                          size_t                   size,
+                          uint32_t                 levels) override;
+
         VkImage vk_image() const noexcept
         {
             return m_image;
@@ -56,14 +62,14 @@ namespace mge::vulkan {
                                                uint32_t height);
         void     create_image_view(VkFormat format);
         void     create_sampler();
-        void     upload_data(const void* data,
-                             size_t      size,
-                             uint32_t    width,
-                             uint32_t    height,
-                             size_t      row_pitch);
-        void     transition_image_layout(VkCommandBuffer command_buffer,
-                                         VkImageLayout   old_layout,
-                                         VkImageLayout   new_layout);
+        void     upload_data(const mge::image_format& format,
+                             const mge::extent&       extent,
+                             const void*              data,
+                             size_t                   size);
+        void     create_texture(const mge::image_format& format,
+                                const mge::extent&       extent,
+                                const void*              data,
+                                size_t                   size);
 
         VkImage       m_image{VK_NULL_HANDLE};
         VmaAllocation m_allocation{VK_NULL_HANDLE};
@@ -71,5 +77,7 @@ namespace mge::vulkan {
         VkSampler     m_sampler{VK_NULL_HANDLE};
         VkFormat      m_vk_format{VK_FORMAT_UNDEFINED};
         bool          m_is_depth{false};
+        uint32_t      m_mip_levels{1};
+        uint64_t      m_upload_value{0};
     };
 } // namespace mge::vulkan
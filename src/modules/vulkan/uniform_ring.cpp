@@ -0,0 +1,112 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "uniform_ring.hpp"
+#include "error.hpp"
+#include "render_context_base.hpp"
+
+#include "mge/core/trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mge {
+    MGE_USE_TRACE(VULKAN);
+}
+
+namespace mge::vulkan {
+
+    static constexpr VkDeviceSize UNIFORM_RING_BLOCK_SIZE = 1024 * 1024;
+
+    uniform_ring::uniform_ring(render_context_base& context,
+                               uint32_t             frame_count,
+                               VkDeviceSize         alignment)
+        : m_context(context)
+        , m_alignment(std::max<VkDeviceSize>(alignment, 1))
+        , m_frames(std::max<uint32_t>(frame_count, 1))
+    {}
+
+    uniform_ring::~uniform_ring()
+    {
+        for (auto& f : m_frames) {
+            for (auto& b : f.blocks) {
+                vmaDestroyBuffer(m_context.allocator(), b.buffer, b.allocation);
+            }
+        }
+    }
+
+    void uniform_ring::begin_frame(uint32_t frame_index)
+    {
+        m_current_frame = frame_index % static_cast<uint32_t>(m_frames.size());
+        auto& f = m_frames[m_current_frame];
+        for (auto& b : f.blocks) {
+            b.used = 0;
+        }
+        f.current = 0;
+    }
+
+    uniform_ring::allocation uniform_ring::push(const void* data, size_t size)
+    {
+        auto& f = m_frames[m_current_frame];
+        while (f.current < f.blocks.size()) {
+            auto&        b = f.blocks[f.current];
+            VkDeviceSize offset =
+                (b.used + m_alignment - 1) / m_alignment * m_alignment;
+            if (offset + size <= b.size) {
+                std::memcpy(b.mapped_data + offset, data, size);
+                b.used = offset + size;
+                return {b.buffer, static_cast<uint32_t>(offset)};
+            }
+            ++f.current;
+        }
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Adding uniform ring block to frame {}",
+                        m_current_frame);
+        f.blocks.push_back(create_block(
+            std::max<VkDeviceSize>(UNIFORM_RING_BLOCK_SIZE, size)));
+        auto& b = f.blocks.back();
+        std::memcpy(b.mapped_data, data, size);
+        b.used = size;
+        return {b.buffer, 0};
+    }
+
+    void uniform_ring::flush()
+    {
+        auto& f = m_frames[m_current_frame];
+        for (auto& b : f.blocks) {
+            if (b.used > 0) {
+                CHECK_VK_CALL(vmaFlushAllocation(m_context.allocator(),
+                                                 b.allocation,
+                                                 0,
+                                                 b.used));
+            }
+        }
+    }
+
+    uniform_ring::block uniform_ring::create_block(VkDeviceSize size)
+    {
+        VkBufferCreateInfo buffer_info = {};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo alloc_info = {};
+        alloc_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+        alloc_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        block             b;
+        VmaAllocationInfo allocation_info = {};
+        CHECK_VK_CALL(vmaCreateBuffer(m_context.allocator(),
+                                      &buffer_info,
+                                      &alloc_info,
+                                      &b.buffer,
+                                      &b.allocation,
+                                      &allocation_info));
+        b.mapped_data = static_cast<std::byte*>(allocation_info.pMappedData);
+        b.size = size;
+        return b;
+    }
+
+} // namespace mge::vulkan
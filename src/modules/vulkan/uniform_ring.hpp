@@ -0,0 +1,92 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/noncopyable.hpp"
+#include "vulkan.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace mge::vulkan {
+
+    class render_context_base;
+
+    /**
+     * @brief Linear allocator for uniform data of the frames in flight.
+     *
+     * Each frame in flight owns a list of persistently mapped buffers.
+     * Uniform data is appended to the buffers of the current frame and
+     * bound with a dynamic offset, so a block can be updated between
+     * draws without overwriting data a previous draw or frame still
+     * reads. Buffers are only added if a frame needs more space than
+     * before and are reused in later frames.
+     *
+     * The buffers can also be used as indirect buffers, packed draws
+     * push their draw commands into the ring.
+     */
+    class uniform_ring : public mge::noncopyable
+    {
+    public:
+        /// Location of data pushed into the ring.
+        struct allocation
+        {
+            VkBuffer buffer{VK_NULL_HANDLE};
+            uint32_t offset{0};
+        };
+
+        uniform_ring(render_context_base& context,
+                     uint32_t             frame_count,
+                     VkDeviceSize         alignment);
+        ~uniform_ring();
+
+        /**
+         * @brief Start writing the buffers of a frame.
+         *
+         * The caller must ensure the GPU has finished the frame that used
+         * the buffers before.
+         *
+         * @param frame_index index of frame in flight
+         */
+        void begin_frame(uint32_t frame_index);
+
+        /**
+         * @brief Copy data into the ring.
+         *
+         * @param data data to copy
+         * @param size data size in bytes
+         * @return buffer and dynamic offset of the copy
+         */
+        allocation push(const void* data, size_t size);
+
+        /**
+         * @brief Make data written in the current frame visible to the
+         * device, to be called before submitting the frame.
+         */
+        void flush();
+
+    private:
+        struct block
+        {
+            VkBuffer      buffer{VK_NULL_HANDLE};
+            VmaAllocation allocation{VK_NULL_HANDLE};
+            std::byte*    mapped_data{nullptr};
+            VkDeviceSize  size{0};
+            VkDeviceSize  used{0};
+        };
+
+        struct frame
+        {
+            std::vector<block> blocks;
+            size_t             current{0};
+        };
+
+        block create_block(VkDeviceSize size);
+
+        render_context_base& m_context;
+        VkDeviceSize         m_alignment;
+        std::vector<frame>   m_frames;
+        uint32_t             m_current_frame{0};
+    };
+
+} // namespace mge::vulkan
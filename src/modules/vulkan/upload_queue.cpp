@@ -0,0 +1,418 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#include "upload_queue.hpp"
+#include "error.hpp"
+#include "render_context_base.hpp"
+
+#include "mge/core/trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace mge {
+    MGE_USE_TRACE(VULKAN);
+}
+
+namespace mge::vulkan {
+
+    upload_queue::upload_queue(render_context_base& context,
+                               uint32_t             queue_family_index,
+                               VkQueue              queue,
+                               mge::mutex*          queue_lock,
+                               VkDeviceSize         ring_size,
+                               VkDeviceSize         alignment)
+        : m_context(context)
+        , m_queue(queue)
+        , m_queue_lock(queue_lock)
+        , m_lock("vulkan::upload_queue")
+        , m_alignment(std::max<VkDeviceSize>(alignment, 16))
+    {
+        VkCommandPoolCreateInfo pool_info = {};
+        pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.queueFamilyIndex = queue_family_index;
+        pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                          VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        CHECK_VK_CALL(context.vkCreateCommandPool(context.device(),
+                                                  &pool_info,
+                                                  nullptr,
+                                                  &m_command_pool));
+
+        VkSemaphoreTypeCreateInfo type_info = {};
+        type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        type_info.initialValue = 0;
+        VkSemaphoreCreateInfo semaphore_info = {};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphore_info.pNext = &type_info;
+        CHECK_VK_CALL(context.vkCreateSemaphore(context.device(),
+                                                &semaphore_info,
+                                                nullptr,
+                                                &m_semaphore));
+
+        create_ring(ring_size);
+    }
+
+    upload_queue::~upload_queue()
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        // copies never submitted are dropped with their handlers
+        for (auto& sb : m_pending.oversized) {
+            vmaDestroyBuffer(m_context.allocator(), sb.buffer, sb.allocation);
+        }
+        if (m_submitted_value != 0) {
+            wait_batches(m_submitted_value);
+        }
+        if (m_command_pool != VK_NULL_HANDLE) {
+            m_context.vkDestroyCommandPool(m_context.device(),
+                                           m_command_pool,
+                                           nullptr);
+        }
+        if (m_semaphore != VK_NULL_HANDLE) {
+            m_context.vkDestroySemaphore(m_context.device(),
+                                         m_semaphore,
+                                         nullptr);
+        }
+        if (m_ring.buffer != VK_NULL_HANDLE) {
+            vmaDestroyBuffer(m_context.allocator(),
+                             m_ring.buffer,
+                             m_ring.allocation);
+        }
+    }
+
+    uint64_t upload_queue::upload(VkBuffer     buffer,
+                                  VkDeviceSize offset,
+                                  const void*  data,
+                                  size_t       size)
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        auto s = allocate_staging(size, m_alignment);
+        std::memcpy(s.data, data, size);
+
+        VkBufferCopy region = {};
+        region.srcOffset = s.offset;
+        region.dstOffset = offset;
+        region.size = size;
+        m_context.vkCmdCopyBuffer(open_batch(), s.buffer, buffer, 1, &region);
+        return m_submitted_value + 1;
+    }
+
+    uint64_t
+    upload_queue::upload(VkImage                             image,
+                         std::span<const VkBufferImageCopy> regions,
+                         const void*                         data,
+                         size_t                              size,
+                         VkDeviceSize                        element_size,
+                         completion                          on_complete)
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        // buffer offset of an image copy must be a multiple of the texel
+        // or block size, which is not a power of two for 3 component
+        // formats
+        auto s = allocate_staging(
+            size,
+            std::lcm(m_alignment, std::max<VkDeviceSize>(element_size, 1)));
+        std::memcpy(s.data, data, size);
+
+        VkCommandBuffer command_buffer = open_batch();
+
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount =
+            static_cast<uint32_t>(regions.size());
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        m_context.vkCmdPipelineBarrier(command_buffer,
+                                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                       0,
+                                       0,
+                                       nullptr,
+                                       0,
+                                       nullptr,
+                                       1,
+                                       &barrier);
+
+        std::vector<VkBufferImageCopy> staged(regions.begin(), regions.end());
+        for (auto& region : staged) {
+            region.bufferOffset += s.offset;
+        }
+        m_context.vkCmdCopyBufferToImage(
+            command_buffer,
+            s.buffer,
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(staged.size()),
+            staged.data());
+
+        // shader stages may not exist on a transfer queue, the wait on
+        // the timeline semaphore makes the copy visible to them
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        m_context.vkCmdPipelineBarrier(command_buffer,
+                                       VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                       0,
+                                       0,
+                                       nullptr,
+                                       0,
+                                       nullptr,
+                                       1,
+                                       &barrier);
+
+        if (on_complete) {
+            m_pending.completions.push_back(std::move(on_complete));
+        }
+        return m_submitted_value + 1;
+    }
+
+    uint64_t upload_queue::submit()
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        submit_batch();
+        return m_submitted_value;
+    }
+
+    void upload_queue::collect()
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        collect_batches();
+    }
+
+    void upload_queue::wait(uint64_t value)
+    {
+        std::lock_guard<mge::mutex> lock(m_lock);
+        wait_batches(value);
+    }
+
+    void upload_queue::create_ring(VkDeviceSize size)
+    {
+        m_ring_size = std::max<VkDeviceSize>(
+            (size + m_alignment - 1) / m_alignment * m_alignment,
+            m_alignment);
+        MGE_DEBUG_TRACE(VULKAN,
+                        "Create upload staging ring of {} bytes",
+                        m_ring_size);
+        m_ring = create_staging_buffer(m_ring_size, &m_ring_data);
+    }
+
+    upload_queue::staging upload_queue::allocate_staging(size_t       size,
+                                                         VkDeviceSize align)
+    {
+        if (size + align > m_ring_size) {
+            MGE_DEBUG_TRACE(VULKAN,
+                            "Upload of {} bytes exceeds staging ring",
+                            size);
+            staging s;
+            open_batch();
+            m_pending.oversized.push_back(create_staging_buffer(size, &s.data));
+            s.buffer = m_pending.oversized.back().buffer;
+            return s;
+        }
+
+        for (;;) {
+            if (m_head == m_tail) {
+                // ring is empty, restart at its beginning
+                m_head = (m_head + m_ring_size - 1) / m_ring_size * m_ring_size;
+                m_tail = m_head;
+            }
+            VkDeviceSize start = m_head % m_ring_size;
+            VkDeviceSize offset = (start + align - 1) / align * align;
+            uint64_t     position = m_head + (offset - start);
+            if (offset + size > m_ring_size) {
+                offset = 0;
+                position = m_head + (m_ring_size - start);
+            }
+            if (position + size - m_tail <= m_ring_size) {
+                m_head = position + size;
+                return {m_ring.buffer, offset, m_ring_data + offset};
+            }
+            // ring is full, the space is used by the pending batch or
+            // by batches in flight
+            if (m_in_flight.empty()) {
+                submit_batch();
+            }
+            if (m_in_flight.empty()) {
+                m_tail = m_head;
+                continue;
+            }
+            wait_batches(m_in_flight.front().value);
+        }
+    }
+
+    upload_queue::staging_buffer
+    upload_queue::create_staging_buffer(VkDeviceSize size, std::byte** data)
+    {
+        VkBufferCreateInfo buffer_info = {};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo alloc_info = {};
+        alloc_info.usage = VMA_MEMORY_USAGE_AUTO;
+        alloc_info.flags =
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+            VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        staging_buffer    sb;
+        VmaAllocationInfo allocation_info = {};
+        CHECK_VK_CALL(vmaCreateBuffer(m_context.allocator(),
+                                      &buffer_info,
+                                      &alloc_info,
+                                      &sb.buffer,
+                                      &sb.allocation,
+                                      &allocation_info));
+        *data = static_cast<std::byte*>(allocation_info.pMappedData);
+        return sb;
+    }
+
+    VkCommandBuffer upload_queue::open_batch()
+    {
+        if (m_pending.command_buffer != VK_NULL_HANDLE) {
+            return m_pending.command_buffer;
+        }
+
+        if (!m_free_command_buffers.empty()) {
+            m_pending.command_buffer = m_free_command_buffers.back();
+            m_free_command_buffers.pop_back();
+        } else {
+            VkCommandBufferAllocateInfo alloc_info = {};
+            alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            alloc_info.commandPool = m_command_pool;
+            alloc_info.commandBufferCount = 1;
+            CHECK_VK_CALL(
+                m_context.vkAllocateCommandBuffers(m_context.device(),
+                                                   &alloc_info,
+                                                   &m_pending.command_buffer));
+        }
+
+        VkCommandBufferBeginInfo begin_info = {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        CHECK_VK_CALL(m_context.vkBeginCommandBuffer(m_pending.command_buffer,
+                                                     &begin_info));
+        return m_pending.command_buffer;
+    }
+
+    void upload_queue::submit_batch()
+    {
+        if (m_pending.command_buffer == VK_NULL_HANDLE) {
+            return;
+        }
+        CHECK_VK_CALL(m_context.vkEndCommandBuffer(m_pending.command_buffer));
+
+        // no-op for host coherent memory
+        CHECK_VK_CALL(vmaFlushAllocation(m_context.allocator(),
+                                         m_ring.allocation,
+                                         0,
+                                         VK_WHOLE_SIZE));
+        for (const auto& sb : m_pending.oversized) {
+            CHECK_VK_CALL(vmaFlushAllocation(m_context.allocator(),
+                                             sb.allocation,
+                                             0,
+                                             VK_WHOLE_SIZE));
+        }
+
+        uint64_t value = m_submitted_value + 1;
+
+        VkTimelineSemaphoreSubmitInfo timeline_info = {};
+        timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.signalSemaphoreValueCount = 1;
+        timeline_info.pSignalSemaphoreValues = &value;
+
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.pNext = &timeline_info;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &m_pending.command_buffer;
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &m_semaphore;
+
+        if (m_queue_lock) {
+            std::lock_guard<mge::mutex> queue_lock(*m_queue_lock);
+            CHECK_VK_CALL(m_context.vkQueueSubmit(m_queue,
+                                                  1,
+                                                  &submit_info,
+                                                  VK_NULL_HANDLE));
+        } else {
+            CHECK_VK_CALL(m_context.vkQueueSubmit(m_queue,
+                                                  1,
+                                                  &submit_info,
+                                                  VK_NULL_HANDLE));
+        }
+
+        m_submitted_value = value;
+        m_pending.value = value;
+        m_pending.ring_end = m_head;
+        m_in_flight.push_back(std::move(m_pending));
+        m_pending = batch{};
+    }
+
+    void upload_queue::collect_batches()
+    {
+        if (m_in_flight.empty()) {
+            return;
+        }
+        uint64_t completed = 0;
+        CHECK_VK_CALL(m_context.vkGetSemaphoreCounterValue(m_context.device(),
+                                                           m_semaphore,
+                                                           &completed));
+        while (!m_in_flight.empty() &&
+               m_in_flight.front().value <= completed) {
+            retire(m_in_flight.front());
+            m_in_flight.pop_front();
+        }
+    }
+
+    void upload_queue::wait_batches(uint64_t value)
+    {
+        if (value > m_submitted_value) {
+            submit_batch();
+        }
+        value = std::min(value, m_submitted_value);
+        if (value == 0) {
+            return;
+        }
+
+        VkSemaphoreWaitInfo wait_info = {};
+        wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        wait_info.semaphoreCount = 1;
+        wait_info.pSemaphores = &m_semaphore;
+        wait_info.pValues = &value;
+        CHECK_VK_CALL(
+            m_context.vkWaitSemaphores(m_context.device(),
+                                       &wait_info,
+                                       std::numeric_limits<uint64_t>::max()));
+        collect_batches();
+    }
+
+    void upload_queue::retire(batch& b)
+    {
+        m_tail = std::max(m_tail, b.ring_end);
+        for (auto& c : b.completions) {
+            c();
+        }
+        for (auto& sb : b.oversized) {
+            vmaDestroyBuffer(m_context.allocator(), sb.buffer, sb.allocation);
+        }
+        CHECK_VK_CALL(m_context.vkResetCommandBuffer(b.command_buffer, 0));
+        m_free_command_buffers.push_back(b.command_buffer);
+    }
+
+} // namespace mge::vulkan
@@ -0,0 +1,181 @@
+// mge - Modern Game Engine
+// Copyright (c) 2017-2026 by Alexander Schroeder
+// All rights reserved.
+#pragma once
+#include "mge/core/mutex.hpp"
+#include "mge/core/noncopyable.hpp"
+#include "vulkan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace mge::vulkan {
+
+    class render_context_base;
+
+    /**
+     * @brief Queue of copies from host memory into buffers and images.
+     *
+     * Data is copied into a persistently mapped staging ring and the copy
+     * commands are recorded into a batch. The batch is submitted once per
+     * frame, on a dedicated transfer queue if the device has one, and
+     * signals a timeline semaphore the frame's submission waits for.
+     * Completed batches are retired by polling the semaphore, which
+     * releases their part of the ring and runs their completion handlers,
+     * so an upload never waits for a queue to become idle.
+     *
+     * All methods are thread-safe. Completion handlers run with the queue
+     * locked and must not call into the queue.
+     */
+    class upload_queue : public mge::noncopyable
+    {
+    public:
+        using completion = std::function<void()>;
+
+        /**
+         * @brief Create an upload queue.
+         *
+         * @param context            render context
+         * @param queue_family_index family of @c queue
+         * @param queue              queue to submit copies to
+         * @param queue_lock         lock serializing submissions to
+         *  @c queue if it is shared with other submitters, @c nullptr if
+         *  the queue is only used for uploads
+         * @param ring_size          size of the staging ring in bytes
+         * @param alignment          minimum alignment of copy sources
+         */
+        upload_queue(render_context_base& context,
+                     uint32_t             queue_family_index,
+                     VkQueue              queue,
+                     mge::mutex*          queue_lock,
+                     VkDeviceSize         ring_size,
+                     VkDeviceSize         alignment);
+        ~upload_queue();
+
+        /**
+         * @brief Copy data into a buffer.
+         *
+         * @param buffer destination buffer, created with
+         *  @c VK_BUFFER_USAGE_TRANSFER_DST_BIT
+         * @param offset offset in destination buffer
+         * @param data   data to copy
+         * @param size   data size in bytes
+         * @return timeline value signalled when the copy is complete
+         */
+        uint64_t upload(VkBuffer     buffer,
+                        VkDeviceSize offset,
+                        const void*  data,
+                        size_t       size);
+
+        /**
+         * @brief Copy data into a 2D image.
+         *
+         * The image is transitioned from undefined layout to
+         * @c VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+         *
+         * @param image        destination image, created with
+         *  @c VK_IMAGE_USAGE_TRANSFER_DST_BIT
+         * @param regions      one region per mip level, starting with the
+         *  base level, buffer offsets are relative to @c data
+         * @param data         texel data of all regions
+         * @param size         data size in bytes
+         * @param element_size size of a texel or compressed block, buffer
+         *  offsets must be a multiple of it
+         * @param on_complete  handler called when the copy is complete
+         * @return timeline value signalled when the copy is complete
+         */
+        uint64_t upload(VkImage                             image,
+                        std::span<const VkBufferImageCopy> regions,
+                        const void*                         data,
+                        size_t                              size,
+                        VkDeviceSize                        element_size,
+                        completion                          on_complete);
+
+        /**
+         * @brief Submit the copies recorded so far.
+         *
+         * @return timeline value to wait for before using any uploaded
+         *  data, 0 if nothing was ever submitted
+         */
+        uint64_t submit();
+
+        /**
+         * @brief Retire batches the device has completed.
+         */
+        void collect();
+
+        /**
+         * @brief Wait until a copy is complete.
+         *
+         * Submits the pending batch if it contains the copy.
+         *
+         * @param value timeline value returned for the copy
+         */
+        void wait(uint64_t value);
+
+        /**
+         * @brief Timeline semaphore signalled by submitted batches.
+         *
+         * @return semaphore
+         */
+        VkSemaphore semaphore() const noexcept
+        {
+            return m_semaphore;
+        }
+
+    private:
+        struct staging_buffer
+        {
+            VkBuffer      buffer{VK_NULL_HANDLE};
+            VmaAllocation allocation{VK_NULL_HANDLE};
+        };
+
+        struct batch
+        {
+            VkCommandBuffer             command_buffer{VK_NULL_HANDLE};
+            uint64_t                    value{0};
+            uint64_t                    ring_end{0};
+            std::vector<completion>     completions;
+            std::vector<staging_buffer> oversized;
+        };
+
+        struct staging
+        {
+            VkBuffer     buffer{VK_NULL_HANDLE};
+            VkDeviceSize offset{0};
+            std::byte*   data{nullptr};
+        };
+
+        void            create_ring(VkDeviceSize size);
+        staging         allocate_staging(size_t size, VkDeviceSize align);
+        staging_buffer  create_staging_buffer(VkDeviceSize size,
+                                              std::byte**  data);
+        VkCommandBuffer open_batch();
+        void            submit_batch();
+        void            collect_batches();
+        void            wait_batches(uint64_t value);
+        void            retire(batch& b);
+
+        render_context_base&         m_context;
+        VkQueue                      m_queue{VK_NULL_HANDLE};
+        mge::mutex*                  m_queue_lock{nullptr};
+        mge::mutex                   m_lock;
+        VkCommandPool                m_command_pool{VK_NULL_HANDLE};
+        VkSemaphore                  m_semaphore{VK_NULL_HANDLE};
+        staging_buffer               m_ring;
+        std::byte*                   m_ring_data{nullptr};
+        VkDeviceSize                 m_ring_size{0};
+        VkDeviceSize                 m_alignment{16};
+        uint64_t                     m_head{0};
+        uint64_t                     m_tail{0};
+        uint64_t                     m_submitted_value{0};
+        batch                        m_pending;
+        std::deque<batch>            m_in_flight;
+        std::vector<VkCommandBuffer> m_free_command_buffers;
+    };
+
+} // namespace mge::vulkan